@@ -22,6 +22,7 @@
 #include "paintop.h"
 #include "f_util.h"
 #include "d_text.h"
+#include "u_bound.h"
 #include "u_create.h"
 #include "u_fonts.h"
 #include "u_list.h"
@@ -448,6 +449,7 @@ create_textobject(void)
 	new_t->ascent  = size.ascent;
 	new_t->descent = size.descent;
 	new_t->length  = size.length;
+	text_metrics_changed(new_t);
 	cur_t = new_t;
     }
     /* draw it and any objects that are on top */
@@ -1852,6 +1854,26 @@ reload_text_fstruct(F_text *t)
     t->fontstruct = lookfont(x_fontnum(psfont_text(t), t->font),
 			round(t->size*display_zoomscale));
     t->zoom = zoomscale;
+    text_metrics_changed(t);
+}
+
+/*
+ * As reload_text_fstruct(), but while the canvas is redrawn the font may
+ * be loaded later. Then, return False and keep the old font structure.
+ */
+
+Boolean
+reload_text_fstruct_budget(F_text *t)
+{
+    XFontStruct	   *fs;
+
+    if ((fs = lookfont_budget(x_fontnum(psfont_text(t), t->font),
+			round(t->size*display_zoomscale))) == NULL)
+	return False;
+    t->fontstruct = fs;
+    t->zoom = zoomscale;
+    text_metrics_changed(t);
+    return True;
 }
 
 
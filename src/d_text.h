@@ -20,6 +20,7 @@ extern void	draw_char_string(void);
 extern void	erase_char_string(void);
 extern void	finish_text_input(int x, int y, int shift);
 extern void	reload_text_fstruct(F_text *t);
+extern Boolean	reload_text_fstruct_budget(F_text *t);
 extern void	reload_text_fstructs(void);
 extern Boolean	text_selection_active;
 extern Boolean	ConvertSelection();
@@ -25,6 +25,7 @@
 #include "u_draw.h"
 #include "u_elastic.h"
 #include "u_list.h"
+#include "u_pick.h"
 #include "u_search.h"
 #include "w_canvas.h"
 #include "w_drawprim.h"
@@ -203,6 +204,8 @@ splinepoint_adding(F_spline *spline, F_point *left_point, F_point *added_point,
     if ((c = create_sfactor()) == NULL)
 	    return;
     set_temp_cursor(wait_cursor);
+    /* the points of the spline are kept in the vertex index */
+    pick_hold_vertices(True);
     /* delete it and redraw underlying objects */
     list_delete_spline(&objects.splines, spline);
     redisplay_spline(spline);
@@ -234,12 +237,14 @@ splinepoint_adding(F_spline *spline, F_point *left_point, F_point *added_point,
       added_point->next = left_point->next; /*right_point;*/
       left_point->next = added_point;
     }
+    pick_point_added(O_SPLINE, spline, left_point, added_point);
     /* put it back in the list and draw the new spline */
     list_add_spline(&objects.splines, spline);
     /* redraw it and anything on top of it */
     redisplay_spline(spline);
     clean_up();
     set_modifiedflag();
+    pick_hold_vertices(False);
     set_last_prevpoint(left_point);
     set_last_selectedpoint(added_point);
     set_action_object(F_ADD_POINT, O_SPLINE);
@@ -306,6 +311,7 @@ linepoint_adding(F_line *line, F_point *left_point, F_point *added_point)
 {
     /* turn off all markers */
     update_markers(0);
+    pick_hold_vertices(True);
     /* delete it and redraw underlying objects */
     list_delete_line(&objects.lines, line);
     redisplay_line(line);
@@ -316,6 +322,7 @@ linepoint_adding(F_line *line, F_point *left_point, F_point *added_point)
 	added_point->next = left_point->next;
 	left_point->next = added_point;
     }
+    pick_point_added(O_POLYLINE, line, left_point, added_point);
     /* put it back in the list and draw the new line */
     list_add_line(&objects.lines, line);
     /* redraw it and anything on top of it */
@@ -326,6 +333,7 @@ linepoint_adding(F_line *line, F_point *left_point, F_point *added_point)
     set_last_prevpoint(left_point);
     set_last_selectedpoint(added_point);
     set_modifiedflag();
+    pick_hold_vertices(False);
 }
 
 /*******************************************************************/
@@ -19,6 +19,7 @@
 #include "object.h"
 #include "paintop.h"
 #include "mode.h"
+#include "f_read.h"
 #include "u_create.h"
 #include "u_draw.h"
 #include "u_search.h"
@@ -86,7 +87,7 @@ init_align_canvas(int x, int y, unsigned int shift)
     cur_c = &objects;
     toggle_all_compoundmarkers();
     draw_compoundelements(cur_c, ERASE);
-    old_c = copy_compound(&objects);
+    save_positions(&objects);
     xcmin=ycmin=0;
 
     /* get the current page size */
@@ -125,8 +126,8 @@ init_align_canvas(int x, int y, unsigned int shift)
     draw_compoundelements(cur_c, PAINT);
     toggle_all_compoundmarkers();
     clean_up();
-    set_latestobjects(old_c);
-    set_action_object(F_EDIT, O_ALL_OBJECT);
+    set_latestshifts();
+    set_action_object(F_ALIGN, O_ALL_OBJECT);
     set_modifiedflag();
 }
 
@@ -136,9 +137,10 @@ init_align(F_line *p, int type, int x, int y, int px, int py)
     if (type != O_COMPOUND)
 	return;
     cur_c = (F_compound *) p;
+    expand_compound(cur_c);
     toggle_compoundmarker(cur_c);
     draw_compoundelements(cur_c, ERASE);
-    old_c = copy_compound(cur_c);
+    save_positions(cur_c);
     compound_bound(cur_c, &xcmin, &ycmin, &xcmax, &ycmax);
     align_ellipse();
     align_arc();
@@ -165,9 +167,9 @@ init_align(F_line *p, int type, int x, int y, int px, int py)
     draw_compoundelements(cur_c, PAINT);
     toggle_compoundmarker(cur_c);
     clean_up();
-    old_c->next = cur_c;
-    set_latestcompound(old_c);
-    set_action_object(F_EDIT, O_COMPOUND);
+    set_latestcompound(cur_c);
+    set_latestshifts();
+    set_action_object(F_ALIGN, O_COMPOUND);
     set_modifiedflag();
 }
 
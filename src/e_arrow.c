@@ -183,26 +183,23 @@ delete_linearrow(F_line *line, F_point *prev_point, F_point *selected_point)
     if (prev_point == NULL) {	/* selected_point is the first point */
 	if (!line->back_arrow)
 	    return;
+	clean_up();
 	draw_line(line, ERASE);
-	saved_back_arrow=line->back_arrow;
-	if (saved_for_arrow && saved_for_arrow != line->for_arrow)
-	    free((char *) saved_for_arrow);
+	saved_back_arrow = line->back_arrow;
 	saved_for_arrow = NULL;
 	line->back_arrow = NULL;
 	redisplay_line(line);
     } else if (selected_point->next == NULL) {	/* forward arrow */
 	if (!line->for_arrow)
 	    return;
+	clean_up();
 	draw_line(line, ERASE);
-	saved_for_arrow=line->for_arrow;
-	if (saved_back_arrow && saved_back_arrow != line->back_arrow)
-	    free((char *) saved_back_arrow);
+	saved_for_arrow = line->for_arrow;
 	saved_back_arrow = NULL;
 	line->for_arrow = NULL;
 	redisplay_line(line);
     } else
 	return;
-    clean_up();
     set_last_prevpoint(prev_point);
     set_last_selectedpoint(selected_point);
     set_latestline(line);
@@ -218,26 +215,23 @@ delete_arcarrow(F_arc *arc, int point_num)
     if (point_num == 0) {	/* backward arrow  */
 	if (!arc->back_arrow)
 	    return;
+	clean_up();
 	draw_arc(arc, ERASE);
-	saved_back_arrow=arc->back_arrow;
-	if (saved_for_arrow && saved_for_arrow != arc->for_arrow)
-	    free((char *) saved_for_arrow);
+	saved_back_arrow = arc->back_arrow;
 	saved_for_arrow = NULL;
 	arc->back_arrow = NULL;
 	redisplay_arc(arc);
     } else if (point_num == 2) {/* for_arrow  */
 	if (!arc->for_arrow)
 	    return;
+	clean_up();
 	draw_arc(arc, ERASE);
-	saved_for_arrow=arc->for_arrow;
-	if (saved_back_arrow && saved_back_arrow != arc->back_arrow)
-	    free((char *) saved_back_arrow);
+	saved_for_arrow = arc->for_arrow;
 	saved_back_arrow = NULL;
 	arc->for_arrow = NULL;
 	redisplay_arc(arc);
     } else
 	return;
-    clean_up();
     set_last_arcpointnum(point_num);
     set_latestarc(arc);
     set_action_object(F_DELETE_ARROW_HEAD, O_ARC);
@@ -252,26 +246,23 @@ delete_splinearrow(F_spline *spline, F_point *prev_point, F_point *selected_poin
     if (prev_point == NULL) {	/* selected_point is the first point */
 	if (!spline->back_arrow)
 	    return;
+	clean_up();
 	draw_spline(spline, ERASE);
-	saved_back_arrow=spline->back_arrow;
-	if (saved_for_arrow && saved_for_arrow != spline->for_arrow)
-	    free((char *) saved_for_arrow);
+	saved_back_arrow = spline->back_arrow;
 	saved_for_arrow = NULL;
 	spline->back_arrow = NULL;
 	redisplay_spline(spline);
     } else if (selected_point->next == NULL) {	/* forward arrow */
 	if (!spline->for_arrow)
 	    return;
+	clean_up();
 	draw_spline(spline, ERASE);
-	saved_for_arrow=spline->for_arrow;
-	if (saved_back_arrow && saved_back_arrow != spline->back_arrow)
-	    free((char *) saved_back_arrow);
+	saved_for_arrow = spline->for_arrow;
 	saved_back_arrow = NULL;
 	spline->for_arrow = NULL;
 	redisplay_spline(spline);
     } else
 	return;
-    clean_up();
     set_last_prevpoint(prev_point);
     set_last_selectedpoint(selected_point);
     set_latestspline(spline);
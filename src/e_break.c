@@ -20,6 +20,7 @@
 #include "mode.h"
 #include "object.h"
 #include "paintop.h"
+#include "f_read.h"
 #include "u_search.h"
 #include "u_list.h"
 #include "u_undo.h"
@@ -70,6 +71,7 @@ init_break(F_line *p, int type, int x, int y, int px, int py, int loc_tag)
 	return;
 
     cur_c = (F_compound *) p;
+    expand_compound(cur_c);
     mask_toggle_compoundmarker(cur_c);
     clean_up();
     list_delete_compound(&objects.compounds, cur_c);
@@ -40,10 +40,12 @@
 #include "w_util.h"
 
 #include "e_scale.h"
+#include "f_read.h"
 #include "u_bound.h"
 #include "u_list.h"
 #include "u_markers.h"
 #include "u_redraw.h"
+#include "u_undo.h"
 #include "w_color.h"
 #include "w_cursor.h"
 #include "w_modepanel.h"
@@ -78,6 +80,7 @@ open_this_compound(F_compound *c, Boolean vis)
 {
   F_compound *d;
 
+  expand_compound(c);
   mask_toggle_compoundmarker(c);
 
   /* save current indicator panel button mask */
@@ -86,6 +89,8 @@ open_this_compound(F_compound *c, Boolean vis)
      the compound when he closes it */
   update_indpanel(cur_indmask | I_POINTPOSN);
 
+  /* the undo history refers to the objects of the figure */
+  clear_undo();
   c->parent = d = (F_compound *) malloc(sizeof(F_compound));
   *d = objects;			/* Preserve the parent, it points to c */
   objects = *c;
@@ -143,6 +148,7 @@ close_compound(void)
 	list_delete_compound(&objects.compounds, d);
     }
     free(c);
+    clear_undo();
     /* popdown close panel if this is the last one */
     if ((F_compound *)objects.parent == NULL) {
 	XtPopdown(close_compound_popup);
@@ -183,6 +189,7 @@ close_all_compounds(void)
       }
       free(c);
     }
+    clear_undo();
     /* popdown close panel */
     XtPopdown(close_compound_popup);
     XtDestroyWidget(close_compound_popup);
@@ -22,6 +22,7 @@
 #include "paintop.h"
 #include "e_deletept.h"
 #include "u_list.h"
+#include "u_pick.h"
 #include "u_search.h"
 #include "u_draw.h"
 #include "w_canvas.h"
@@ -112,6 +113,9 @@ splinepoint_deleting(F_spline *spline, F_point *previous_point, F_point *selecte
     set_temp_cursor(wait_cursor);
     clean_up();
     set_last_prevpoint(previous_point);
+    /* the points of the spline are kept in the vertex index */
+    pick_hold_vertices(True);
+    pick_point_deleted(previous_point, selected_point);
     /* delete it and redraw underlying objects */
     list_delete_spline(&objects.splines, spline);
     draw_spline(spline, ERASE);
@@ -146,6 +150,7 @@ splinepoint_deleting(F_spline *spline, F_point *previous_point, F_point *selecte
     set_last_selectedsfactor(selected_sfactor);
     set_last_nextpoint(next_point);
     set_modifiedflag();
+    pick_hold_vertices(False);
     reset_cursor();
 }
 
@@ -164,6 +169,8 @@ linepoint_deleting(F_line *line, F_point *prev_point, F_point *selected_point)
     F_point	   *p, *next_point;
 
     next_point = selected_point->next;
+    pick_hold_vertices(True);
+    pick_point_deleted(prev_point, selected_point);
     /* delete it and redraw underlying objects */
     list_delete_line(&objects.lines, line);
     redisplay_line(line);
@@ -178,6 +185,7 @@ linepoint_deleting(F_line *line, F_point *prev_point, F_point *selected_point)
 	     * prev_point now points at next to last point (the last point is
 	     * a copy of the first).
 	     */
+	    pick_point_moved(p, next_point->x, next_point->y);
 	    p->x = next_point->x;
 	    p->y = next_point->y;
 	    next_point = p;
@@ -201,6 +209,7 @@ linepoint_deleting(F_line *line, F_point *prev_point, F_point *selected_point)
     redisplay_line(line);
     clean_up();
     set_modifiedflag();
+    pick_hold_vertices(False);
     set_action_object(F_DELETE_POINT, O_POLYLINE);
     set_latestline(line);
     set_last_prevpoint(prev_point);
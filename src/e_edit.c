@@ -102,6 +102,10 @@ static	int what_rotation(int dx, int dy);
 #define ARROWS		True
 #define NO_ARROWS	False
 
+/* exchange the contents of the objects a and b, and the pointers a and b */
+#define EXCHANGE(type, a, b)	{ type *p_ = a; type s_ = *a; \
+				  *a = *b; *b = s_; a = b; b = p_; }
+
 static Position rootx, rooty;
 static void	new_generic_values(void);
 static void	new_arrow_values(void);
@@ -1080,13 +1084,13 @@ done_figure_comments(void)
 
     switch (button_result) {
       case DONE:
+	clean_up();
 	/* save old comments */
 	saved_objects.comments = objects.comments;
 	/* get new comments */
 	s = panel_get_value(comments_panel);
 	/* allocate space and copy */
 	copy_comments(&s, &objects.comments);
-	clean_up();
 	set_action_object(F_EDIT, O_FIGURE);
 	set_modifiedflag();
 	break;
@@ -1467,6 +1471,7 @@ get_new_compound_values(void)
 	t->length = size.length;
 	t->ascent = size.ascent;
 	t->descent = size.descent;
+	text_metrics_changed(t);
     }
 
     translate_compound(new_c, dx, dy);
@@ -1509,7 +1514,7 @@ done_compound(void)
 	old_c->next = new_c;
 	set_latestcompound(old_c);
 	set_action_object(F_EDIT, O_COMPOUND);
-	set_modifiedflag();
+	set_modifiedobject(O_COMPOUND, new_c);
 	remove_compound_depth(old_c);
 	add_compound_depth(new_c);
 	/* if this was a place-and-edit, continue with library place */
@@ -1530,12 +1535,9 @@ done_compound(void)
 
       case CANCEL:
 	list_delete_compound(&objects.compounds, new_c);
+	/* restore the original in place, the undo history refers to it */
+	EXCHANGE(F_compound, new_c, old_c);
 	list_add_compound(&objects.compounds, old_c);
-	if (saved_objects.compounds && saved_objects.compounds->next &&
-	    saved_objects.compounds->next == new_c)
-		saved_objects.compounds->next = old_c;
-	else if (saved_objects.compounds == new_c)
-		saved_objects.compounds = old_c;
 	if (changed)
 	    redisplay_compounds(old_c, new_c);
 	else
@@ -2218,22 +2220,20 @@ done_line(void)
 	old_l->next = new_l;
 	set_latestline(old_l);
 	set_action_object(F_EDIT, O_POLYLINE);
-	set_modifiedflag();
+	set_modifiedobject(O_POLYLINE, new_l);
 	break;
       case CANCEL:
 	list_delete_line(&objects.lines, new_l);
 	/* if user created it but cancelled, delete it */
 	if (new_l->pic && new_l->pic->new) {
 	    redisplay_line(old_l);
+	    set_action(F_NULL);		/* nothing left to undo */
 	    free_line(&new_l);
 	    return;
 	}
+	/* restore the original in place, the undo history refers to it */
+	EXCHANGE(F_line, new_l, old_l);
 	list_add_line(&objects.lines, old_l);
-	if (saved_objects.lines && saved_objects.lines->next &&
-	    saved_objects.lines->next == new_l)
-		saved_objects.lines->next = old_l;
-	else if (saved_objects.lines == new_l)
-		saved_objects.lines = old_l;
 	if (new_l->type == T_PICTURE) {
 	    old_l->type = T_PICTURE;		/* restore type */
 	    if (file_changed) {
@@ -2449,7 +2449,7 @@ get_new_text_values(void)
     new_t->ascent = size.ascent;
     new_t->descent = size.descent;
     new_t->length = size.length;
-    /* now set the fontstruct for this zoom scale */
+    /* now set the fontstruct for this zoom scale, forget the old metrics */
     reload_text_fstruct(new_t);
 }
 
@@ -2480,16 +2480,13 @@ done_text(void)
 	old_t->next = new_t;
 	set_latesttext(old_t);
 	set_action_object(F_EDIT, O_TXT);
-	set_modifiedflag();
+	set_modifiedobject(O_TXT, new_t);
 	break;
       case CANCEL:
 	list_delete_text(&objects.texts, new_t);
+	/* restore the original in place, the undo history refers to it */
+	EXCHANGE(F_text, new_t, old_t);
 	list_add_text(&objects.texts, old_t);
-	if (saved_objects.texts && saved_objects.texts->next &&
-	    saved_objects.texts->next == new_t)
-		saved_objects.texts->next = old_t;
-	else if (saved_objects.texts == new_t)
-		saved_objects.texts = old_t;
 	if (changed)
 	    redisplay_texts(new_t, old_t);
 	else
@@ -2632,16 +2629,13 @@ done_ellipse(void)
 	old_e->next = new_e;
 	set_latestellipse(old_e);
 	set_action_object(F_EDIT, O_ELLIPSE);
-	set_modifiedflag();
+	set_modifiedobject(O_ELLIPSE, new_e);
 	break;
       case CANCEL:
 	list_delete_ellipse(&objects.ellipses, new_e);
+	/* restore the original in place, the undo history refers to it */
+	EXCHANGE(F_ellipse, new_e, old_e);
 	list_add_ellipse(&objects.ellipses, old_e);
-	if (saved_objects.ellipses && saved_objects.ellipses->next &&
-	    saved_objects.ellipses->next == new_e)
-		saved_objects.ellipses->next = old_e;
-	else if (saved_objects.ellipses == new_e)
-		saved_objects.ellipses = old_e;
 	if (changed)
 	    redisplay_ellipses(new_e, old_e);
 	else
@@ -2763,16 +2757,13 @@ done_arc(void)
 	old_a->next = new_a;
 	set_latestarc(old_a);
 	set_action_object(F_EDIT, O_ARC);
-	set_modifiedflag();
+	set_modifiedobject(O_ARC, new_a);
 	break;
       case CANCEL:
 	list_delete_arc(&objects.arcs, new_a);
+	/* restore the original in place, the undo history refers to it */
+	EXCHANGE(F_arc, new_a, old_a);
 	list_add_arc(&objects.arcs, old_a);
-	if (saved_objects.arcs && saved_objects.arcs->next &&
-	    saved_objects.arcs->next == new_a)
-		saved_objects.arcs->next = old_a;
-	else if (saved_objects.arcs == new_a)
-		saved_objects.arcs = old_a;
 	if (changed)
 	    redisplay_arcs(new_a, old_a);
 	else
@@ -2863,16 +2854,13 @@ done_spline(void)
 	old_s->next = new_s;
 	set_latestspline(old_s);
 	set_action_object(F_EDIT, O_SPLINE);
-	set_modifiedflag();
+	set_modifiedobject(O_SPLINE, new_s);
 	break;
       case CANCEL:
 	list_delete_spline(&objects.splines, new_s);
+	/* restore the original in place, the undo history refers to it */
+	EXCHANGE(F_spline, new_s, old_s);
 	list_add_spline(&objects.splines, old_s);
-	if (saved_objects.splines && saved_objects.splines->next &&
-	    saved_objects.splines->next == new_s)
-		saved_objects.splines->next = old_s;
-	else if (saved_objects.splines == new_s)
-		saved_objects.splines = old_s;
 	if (changed)
 	    redisplay_splines(new_s, old_s);
 	else
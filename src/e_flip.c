@@ -21,6 +21,7 @@
 #include "object.h"
 #include "paintop.h"
 #include "e_rotate.h"
+#include "f_read.h"
 #include "u_draw.h"
 #include "u_search.h"
 #include "u_create.h"
@@ -30,6 +31,7 @@
 
 #include "u_markers.h"
 #include "u_redraw.h"
+#include "u_transform.h"
 #include "w_cursor.h"
 
 /* EXPORTS */
@@ -384,12 +386,14 @@ void flip_arc(F_arc *a, int x, int y, int flip_axis)
     }
 }
 
-void flip_compound(F_compound *c, int x, int y, int flip_axis)
+/* flip all but the points of lines and splines, see transform_points() */
+
+static void
+flip_members(F_compound *c, int x, int y, int flip_axis)
 {
     F_line	   *l;
     F_arc	   *a;
     F_ellipse	   *e;
-    F_spline	   *s;
     F_text	   *t;
     F_compound	   *c1;
     int		    p, q;
@@ -409,15 +413,35 @@ void flip_compound(F_compound *c, int x, int y, int flip_axis)
 	break;
     }
     for (l = c->lines; l != NULL; l = l->next)
-	flip_line(l, x, y, flip_axis);
+	if (l->type == T_PICTURE)
+	    l->pic->flipped = 1 - l->pic->flipped;
     for (a = c->arcs; a != NULL; a = a->next)
 	flip_arc(a, x, y, flip_axis);
     for (e = c->ellipses; e != NULL; e = e->next)
 	flip_ellipse(e, x, y, flip_axis);
-    for (s = c->splines; s != NULL; s = s->next)
-	flip_spline(s, x, y, flip_axis);
     for (t = c->texts; t != NULL; t = t->next)
 	flip_text(t, x, y, flip_axis);
     for (c1 = c->compounds; c1 != NULL; c1 = c1->next)
-	flip_compound(c1, x, y, flip_axis);
+	flip_members(c1, x, y, flip_axis);
+}
+
+void flip_compound(F_compound *c, int x, int y, int flip_axis)
+{
+    xform	    t;
+
+    t.x = x;
+    t.y = y;
+    switch (flip_axis) {
+    case UD_FLIP:		/* x axis  */
+	t.op = XF_FLIP_UD;
+	transform_points(c, &t, True, NULL);
+	break;
+    case LR_FLIP:		/* y axis  */
+	t.op = XF_FLIP_LR;
+	transform_points(c, &t, True, NULL);
+	break;
+    default:
+	expand_compound(c);
+    }
+    flip_members(c, x, y, flip_axis);
 }
@@ -27,6 +27,7 @@
 #include "u_draw.h"
 #include "u_elastic.h"
 #include "u_list.h"
+#include "u_pick.h"
 #include "u_search.h"
 #include "u_undo.h"
 #include "w_canvas.h"
@@ -193,12 +194,15 @@ create_compoundobject(int x, int y)
 
 void tag_obj_in_region(int xmin, int ymin, int xmax, int ymax)
 {
+    /* draw the markers of all tagged objects at once */
+    start_marker_batch();
     sel_ellipse(xmin, ymin, xmax, ymax);
     sel_line(xmin, ymin, xmax, ymax);
     sel_spline(xmin, ymin, xmax, ymax);
     sel_text(xmin, ymin, xmax, ymax);
     sel_arc(xmin, ymin, xmax, ymax);
     sel_compound(xmin, ymin, xmax, ymax);
+    flush_marker_batch();
 }
 
 
@@ -241,18 +245,16 @@ static void
 sel_ellipse(int xmin, int ymin, int xmax, int ymax)
 {
     F_ellipse	   *e;
-
-    for (e = objects.ellipses; e != NULL; e = e->next) {
+    void	  **obj;
+    int		   *in;
+    int		    i, num;
+
+    pick_objects(O_ELLIPSE, &obj);
+    num = pick_region(O_ELLIPSE, xmin, ymin, xmax, ymax, &in);
+    for (i = 0; i < num; i++) {
+	e = (F_ellipse *) obj[in[i]];
 	if (!active_layer(e->depth))
 	    continue;
-	if (xmin > e->center.x - e->radiuses.x)
-	    continue;
-	if (xmax < e->center.x + e->radiuses.x)
-	    continue;
-	if (ymin > e->center.y - e->radiuses.y)
-	    continue;
-	if (ymax < e->center.y + e->radiuses.y)
-	    continue;
 	e->tagged = 1 - e->tagged;
 	toggle_ellipsehighlight(e);
     }
@@ -288,20 +290,16 @@ static void
 sel_arc(int xmin, int ymin, int xmax, int ymax)
 {
     F_arc	   *a;
-    int		    urx, ury, llx, lly;
-
-    for (a = objects.arcs; a != NULL; a = a->next) {
+    void	  **obj;
+    int		   *in;
+    int		    i, num;
+
+    pick_objects(O_ARC, &obj);
+    num = pick_region(O_ARC, xmin, ymin, xmax, ymax, &in);
+    for (i = 0; i < num; i++) {
+	a = (F_arc *) obj[in[i]];
 	if (!active_layer(a->depth))
 	    continue;
-	arc_bound(a, &llx, &lly, &urx, &ury);
-	if (xmin > llx)
-	    continue;
-	if (xmax < urx)
-	    continue;
-	if (ymin > lly)
-	    continue;
-	if (ymax < ury)
-	    continue;
 	a->tagged = 1 - a->tagged;
 	toggle_archighlight(a);
     }
@@ -336,27 +334,16 @@ static void
 sel_line(int xmin, int ymin, int xmax, int ymax)
 {
     F_line	   *l;
-    F_point	   *p;
-    int		    inbound;
-
-    for (l = objects.lines; l != NULL; l = l->next) {
+    void	  **obj;
+    int		   *in;
+    int		    i, num;
+
+    pick_objects(O_POLYLINE, &obj);
+    num = pick_region(O_POLYLINE, xmin, ymin, xmax, ymax, &in);
+    for (i = 0; i < num; i++) {
+	l = (F_line *) obj[in[i]];
 	if (!active_layer(l->depth))
 	    continue;
-	for (inbound = 1, p = l->points; p != NULL && inbound;
-	     p = p->next) {
-	    inbound = 0;
-	    if (xmin > p->x)
-		continue;
-	    if (xmax < p->x)
-		continue;
-	    if (ymin > p->y)
-		continue;
-	    if (ymax < p->y)
-		continue;
-	    inbound = 1;
-	}
-	if (!inbound)
-	    continue;
 	l->tagged = 1 - l->tagged;
 	toggle_linehighlight(l);
     }
@@ -391,20 +378,16 @@ static void
 sel_spline(int xmin, int ymin, int xmax, int ymax)
 {
     F_spline	   *s;
-    int		    urx, ury, llx, lly;
-
-    for (s = objects.splines; s != NULL; s = s->next) {
+    void	  **obj;
+    int		   *in;
+    int		    i, num;
+
+    pick_objects(O_SPLINE, &obj);
+    num = pick_region(O_SPLINE, xmin, ymin, xmax, ymax, &in);
+    for (i = 0; i < num; i++) {
+	s = (F_spline *) obj[in[i]];
 	if (!active_layer(s->depth))
 	    continue;
-	spline_bound(s, &llx, &lly, &urx, &ury);
-	if (xmin > llx)
-	    continue;
-	if (xmax < urx)
-	    continue;
-	if (ymin > lly)
-	    continue;
-	if (ymax < ury)
-	    continue;
 	s->tagged = 1 - s->tagged;
 	toggle_splinehighlight(s);
     }
@@ -439,17 +422,16 @@ static void
 sel_text(int xmin, int ymin, int xmax, int ymax)
 {
     F_text	   *t;
-    int		    txmin, txmax, tymin, tymax;
-    int		    dum;
-
-    for (t = objects.texts; t != NULL; t = t->next) {
+    void	  **obj;
+    int		   *in;
+    int		    i, num;
+
+    pick_objects(O_TXT, &obj);
+    num = pick_region(O_TXT, xmin, ymin, xmax, ymax, &in);
+    for (i = 0; i < num; i++) {
+	t = (F_text *) obj[in[i]];
 	if (!active_layer(t->depth))
 	    continue;
-	text_bound(t, &txmin, &tymin, &txmax, &tymax,
-			&dum,&dum,&dum,&dum,&dum,&dum,&dum,&dum);
-	if (xmin > txmin || xmax < txmax ||
-	    ymin > tymin || ymax < tymax)
-		continue;
 	t->tagged = 1 - t->tagged;
 	toggle_texthighlight(t);
     }
@@ -484,18 +466,16 @@ static void
 sel_compound(int xmin, int ymin, int xmax, int ymax)
 {
     F_compound	   *c;
-
-    for (c = objects.compounds; c != NULL; c = c->next) {
+    void	  **obj;
+    int		   *in;
+    int		    i, num;
+
+    pick_objects(O_COMPOUND, &obj);
+    num = pick_region(O_COMPOUND, xmin, ymin, xmax, ymax, &in);
+    for (i = 0; i < num; i++) {
+	c = (F_compound *) obj[in[i]];
 	if (!any_active_in_compound(c))
 	    continue;
-	if (xmin > c->nwcorner.x)
-	    continue;
-	if (xmax < c->secorner.x)
-	    continue;
-	if (ymin > c->nwcorner.y)
-	    continue;
-	if (ymax < c->secorner.y)
-	    continue;
 	c->tagged = 1 - c->tagged;
 	toggle_compoundhighlight(c);
     }
@@ -27,6 +27,7 @@
 #include "u_elastic.h"
 #include "u_list.h"
 #include "u_markers.h"
+#include "u_pick.h"
 #include "u_undo.h"
 #include "w_canvas.h"
 #include "w_modepanel.h"
@@ -34,6 +35,7 @@
 #include "w_msgpanel.h"
 
 #include "f_util.h"
+#include "u_bound.h"
 #include "u_geom.h"
 #include "u_redraw.h"
 #include "w_cursor.h"
@@ -495,21 +497,27 @@ cancel_movedsplinepoint(void)
 static void
 fix_movedsplinepoint(int x, int y)
 {
+    int		    xmin1, ymin1, xmax1, ymax1;
+    int		    xmin2, ymin2, xmax2, ymax2;
+
     (*canvas_locmove_proc) (x, y);
     canvas_ref_proc = canvas_locmove_proc = null_proc;
     elastic_linelink();
     /* erase last lengths if appres.showlengths is true */
     erase_lengths();
-    old_s = copy_spline(cur_s);
+    /* remember the point moved, and where from */
     clean_up();
-    set_latestspline(old_s);
-    set_action_object(F_EDIT, O_SPLINE);
-    old_s->next = cur_s;
+    set_latestspline(cur_s);
+    set_last_prevpoint(left_point);
+    set_last_selectedpoint(moved_point);
+    set_lastposition(moved_point->x, moved_point->y);
+    set_newposition(cur_x, cur_y);
+    set_action_object(F_MOVE_POINT, O_SPLINE);
+    spline_bound(cur_s, &xmin1, &ymin1, &xmax1, &ymax1);
     relocate_splinepoint(cur_s, cur_x, cur_y, moved_point);
-    /* redraw anything under the old spline */
-    redisplay_spline(old_s);
-    /* and the new one */
-    redisplay_spline(cur_s);
+    spline_bound(cur_s, &xmin2, &ymin2, &xmax2, &ymax2);
+    /* redraw anything under the old spline, and the new one */
+    redisplay_regions(xmin1, ymin1, xmax1, ymax1, xmin2, ymin2, xmax2, ymax2);
     /* turn back on all relevant markers */
     update_markers(new_objmask);
     wrapup_movepoint();
@@ -518,9 +526,12 @@ fix_movedsplinepoint(int x, int y)
 static void
 relocate_splinepoint(F_spline *s, int x, int y, F_point *moved_point)
 {
+    pick_hold_vertices(True);
+    pick_point_moved(moved_point, x, y);
     moved_point->x = x;
     moved_point->y = y;
-    set_modifiedflag();
+    set_modifiedobject(O_SPLINE, s);
+    pick_hold_vertices(False);
 }
 
 /***************************  compound	********************************/
@@ -615,7 +626,7 @@ fix_movedcompoundpoint(int x, int y)
 
     set_lastposition(from_x, from_y);
     set_newposition(cur_x, cur_y);
-    set_modifiedflag();
+    set_modifiedobject(O_COMPOUND, cur_c);
     wrapup_movepoint();
 }
 
@@ -799,6 +810,9 @@ cancel_movedlinepoint(void)
 static void
 fix_movedlinepoint(int x, int y)
 {
+    int		    xmin1, ymin1, xmax1, ymax1;
+    int		    xmin2, ymin2, xmax2, ymax2;
+
     (*canvas_locmove_proc) (x, y);
     canvas_ref_proc = canvas_locmove_proc = null_proc;
     elastic_linelink();
@@ -806,18 +820,19 @@ fix_movedlinepoint(int x, int y)
     erase_lengths();
     if (cur_latexcursor != crosshair_cursor)
 	set_cursor(crosshair_cursor);
-    /* make a copy of the original and save as unchanged object */
-    old_l = copy_line(cur_l);
+    /* remember the point moved, and where from */
     clean_up();
-    set_latestline(old_l);
-    set_action_object(F_EDIT, O_POLYLINE);
-    old_l->next = cur_l;
-    /* now change the original to become the new object */
+    set_latestline(cur_l);
+    set_last_prevpoint(left_point);
+    set_last_selectedpoint(moved_point);
+    set_lastposition(moved_point->x, moved_point->y);
+    set_newposition(cur_x, cur_y);
+    set_action_object(F_MOVE_POINT, O_POLYLINE);
+    line_bound(cur_l, &xmin1, &ymin1, &xmax1, &ymax1);
     relocate_linepoint(cur_l, cur_x, cur_y, moved_point, left_point);
-    /* redraw anything under the old line */
-    redisplay_line(old_l);
-    /* and the new line */
-    redisplay_line(cur_l);
+    line_bound(cur_l, &xmin2, &ymin2, &xmax2, &ymax2);
+    /* redraw anything under the old line, and the new one */
+    redisplay_regions(xmin1, ymin1, xmax1, ymax1, xmin2, ymin2, xmax2, ymax2);
     /* turn back on all relevant markers */
     update_markers(new_objmask);
     wrapup_movepoint();
@@ -826,12 +841,16 @@ fix_movedlinepoint(int x, int y)
 static void
 relocate_linepoint(F_line *line, int x, int y, F_point *moved_point, F_point *left_point)
 {
+    pick_hold_vertices(True);
     if (line->type == T_POLYGON)
 	if (line->points == moved_point) {
+	    pick_point_moved(left_point->next, x, y);
 	    left_point->next->x = x;
 	    left_point->next->y = y;
 	}
+    pick_point_moved(moved_point, x, y);
     moved_point->x = x;
     moved_point->y = y;
-    set_modifiedflag();
+    set_modifiedobject(O_POLYLINE, line);
+    pick_hold_vertices(False);
 }
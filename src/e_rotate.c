@@ -21,6 +21,7 @@
 #include "object.h"
 #include "paintop.h"
 #include "e_flip.h"
+#include "f_read.h"
 #include "u_draw.h"
 #include "u_geom.h"
 #include "u_search.h"
@@ -34,6 +35,7 @@
 #include "u_bound.h"
 #include "u_markers.h"
 #include "u_redraw.h"
+#include "u_transform.h"
 #include "w_cursor.h"
 
 /* EXPORTS  */
@@ -313,6 +315,7 @@ void init_rotatecompound(F_compound *c, int px, int py)
 {
     F_compound	   *compound;
 
+    expand_compound(c);
     if (!valid_rot_angle(c)) {
 	put_msg("Invalid rotation angle for this compound object");
 	return;
@@ -488,35 +491,46 @@ int valid_rot_angle(F_compound *c)
     return 1;
 }
 
-void rotate_compound(F_compound *c, int x, int y)
+/* rotate all but the lines and splines, see transform_points() */
+
+static void
+rotate_members(F_compound *c, int x, int y)
 {
-    F_line	   *l;
     F_arc	   *a;
     F_ellipse	   *e;
-    F_spline	   *s;
     F_text	   *t;
     F_compound	   *c1;
 
-    for (l = c->lines; l != NULL; l = l->next)
-	rotate_line(l, x, y);
     for (a = c->arcs; a != NULL; a = a->next)
 	rotate_arc(a, x, y);
     for (e = c->ellipses; e != NULL; e = e->next)
 	rotate_ellipse(e, x, y);
-    for (s = c->splines; s != NULL; s = s->next)
-	rotate_spline(s, x, y);
     for (t = c->texts; t != NULL; t = t->next)
 	rotate_text(t, x, y);
     for (c1 = c->compounds; c1 != NULL; c1 = c1->next)
-	rotate_compound(c1, x, y);
+	rotate_members(c1, x, y);
 
     /*
      * Make the bounding box exactly match the dimensions of the compound.
+     * The compounds within are bounded already.
      */
     compound_bound(c, &c->nwcorner.x, &c->nwcorner.y,
 		   &c->secorner.x, &c->secorner.y);
 }
 
+void rotate_compound(F_compound *c, int x, int y)
+{
+    xform	    t;
+
+    /* for speed we treat 90 degrees as a special case, see rotate_line() */
+    t.op = act_rotnangle == 90.0 ? XF_ROTATE90 : XF_ROTATE;
+    t.x = x;
+    t.y = y;
+    t.dirn = rotn_dirn;
+    transform_points(c, &t, True, NULL);
+    rotate_members(c, x, y);
+}
+
 void rotate_point(F_point *p, int x, int y)
 {
     /* rotate point p about coordinate (x, y) */
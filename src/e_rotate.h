@@ -23,5 +23,6 @@ extern float	act_rotnangle;
 
 extern int rotate_compound (F_compound *c, int x, int y);
 extern int rotate_line (F_line *l, int x, int y);
+extern void rotate_xy (int *orig_x, int *orig_y, int x, int y);
 extern void rotate_ccw_selected (void);
 extern void rotate_cw_selected (void);
@@ -35,6 +35,7 @@
 #include "w_setup.h"
 
 #include "e_movept.h"
+#include "f_read.h"
 #include "f_util.h"
 #include "u_bound.h"
 #include "u_fonts.h"
@@ -42,6 +43,7 @@
 #include "u_list.h"
 #include "u_markers.h"
 #include "u_redraw.h"
+#include "u_transform.h"
 #include "w_cursor.h"
 
 static Boolean	init_boxscale_ellipse(int x, int y);
@@ -52,11 +54,7 @@ static Boolean	init_scale_ellipse(void);
 static Boolean	init_scale_line(void);
 static Boolean	init_scale_spline(void);
 
-static void	scale_line(F_line *l, float sx, float sy, int refx, int refy);
-static void	scale_spline(F_spline *s, float sx, float sy, int refx, int refy);
-static void	scale_arc(F_arc *a, float sx, float sy, int refx, int refy);
-static void	scale_ellipse(F_ellipse *e, float sx, float sy, int refx, int refy);
-static void	scale_text(F_text *t, float sx, float sy, int refx, int refy);
+static void	scale_line_shape(F_line *l, float sx, float sy);
 static void	scale_arrows(F_line *obj, float sx, float sy);
 static void	scale_arrow(F_arrow *arrow, float sx, float sy);
 
@@ -760,8 +758,20 @@ prescale_compound(F_compound *c, int x, int y)
     scale_compound(c, scalefact, scalefact, fix_x, fix_y);
 }
 
-void
-scale_compound(F_compound *c, double sx, double sy, int refx, int refy)
+/* a dimension line, its points are scaled by rescale_dimension_line() */
+
+static Boolean
+is_dimline(F_compound *c)
+{
+    F_line	   *line, *box, *tick1, *tick2;
+
+    return dimline_components(c, &line, &tick1, &tick2, &box) && line;
+}
+
+/* scale all but the points of lines and splines, see transform_points() */
+
+static void
+scale_members(F_compound *c, double sx, double sy, int refx, int refy)
 {
     F_line	   *l;
     F_spline	   *s;
@@ -771,10 +781,6 @@ scale_compound(F_compound *c, double sx, double sy, int refx, int refy)
     F_compound	   *c1;
     int		    x1, y1, x2, y2;
 
-    /* if sx and sy == 1.0, return now */
-    if (sx == 0.0 && sy == 0.0)
-	return;
-
     /* check if really a dimension line */
     if (rescale_dimension_line(c, sx, sy, refx, refy))
 	return; /* yes, return now */
@@ -789,10 +795,11 @@ scale_compound(F_compound *c, double sx, double sy, int refx, int refy)
     c->secorner.y = max2(y1, y2);
 
     for (l = c->lines; l != NULL; l = l->next) {
-	scale_line(l, sx, sy, refx, refy);
+	scale_line_shape(l, sx, sy);
     }
     for (s = c->splines; s != NULL; s = s->next) {
-	scale_spline(s, sx, sy, refx, refy);
+	/* scale any arrowheads */
+	scale_arrows((F_line *)s, sx, sy);
     }
     for (a = c->arcs; a != NULL; a = a->next) {
 	scale_arc(a, sx, sy, refx, refy);
@@ -804,7 +811,7 @@ scale_compound(F_compound *c, double sx, double sy, int refx, int refy)
 	scale_text(t, sx, sy, refx, refy);
     }
     for (c1 = c->compounds; c1 != NULL; c1 = c1->next) {
-	scale_compound(c1, sx, sy, refx, refy);
+	scale_members(c1, sx, sy, refx, refy);
 	/* if there's a dimension line in this compound reset corners */
 	c->nwcorner.x = min2(c->nwcorner.x, c1->nwcorner.x);
 	c->nwcorner.y = min2(c->nwcorner.y, c1->nwcorner.y);
@@ -813,6 +820,24 @@ scale_compound(F_compound *c, double sx, double sy, int refx, int refy)
     }
 }
 
+void
+scale_compound(F_compound *c, double sx, double sy, int refx, int refy)
+{
+    xform	    t;
+
+    /* if sx and sy == 1.0, return now */
+    if (sx == 0.0 && sy == 0.0)
+	return;
+
+    t.op = XF_SCALE;
+    t.x = refx;
+    t.y = refy;
+    t.sx = sx;
+    t.sy = sy;
+    transform_points(c, &t, True, is_dimline);
+    scale_members(c, sx, sy, refx, refy);
+}
+
 Boolean
 rescale_dimension_line(F_compound *dimline, float scalex, float scaley, int refx, int refy)
 {
@@ -915,6 +940,7 @@ rescale_dimension_line(F_compound *dimline, float scalex, float scaley, int refx
     text->ascent  = tsize.ascent;
     text->descent = tsize.descent;
     text->length  = tsize.length;
+    text_metrics_changed(text);
     theight = tsize.ascent + tsize.descent;
     text->angle = angle;
     text->base_x = centerx + sin(angle)*round(theight/2.0 - tsize.descent);
@@ -1010,7 +1036,7 @@ rescale_dimension_line(F_compound *dimline, float scalex, float scaley, int refx
     return True;
 }
 
-static void
+void
 scale_line(F_line *l, float sx, float sy, int refx, int refy)
 {
     F_point	   *p;
@@ -1019,6 +1045,14 @@ scale_line(F_line *l, float sx, float sy, int refx, int refy)
 	p->x = round(refx + (p->x - refx) * sx);
 	p->y = round(refy + (p->y - refy) * sy);
     }
+    scale_line_shape(l, sx, sy);
+}
+
+/* scale the radius and the arrows of l, the points are scaled already */
+
+static void
+scale_line_shape(F_line *l, float sx, float sy)
+{
     /* now scale the radius for an arc-box */
     if (l->type == T_ARCBOX) {
 	int h,w;
@@ -1038,7 +1072,7 @@ scale_line(F_line *l, float sx, float sy, int refx, int refy)
     scale_arrows(l,sx,sy);
 }
 
-static void
+void
 scale_spline(F_spline *s, float sx, float sy, int refx, int refy)
 {
     F_point	   *p;
@@ -1051,7 +1085,7 @@ scale_spline(F_spline *s, float sx, float sy, int refx, int refy)
     scale_arrows((F_line *)s,sx,sy);
 }
 
-static void
+void
 scale_arc(F_arc *a, float sx, float sy, int refx, int refy)
 {
     int		    i;
@@ -1093,7 +1127,7 @@ scale_arc(F_arc *a, float sx, float sy, int refx, int refy)
     scale_arrows((F_line *)a,sx,sy);
 }
 
-static void
+void
 scale_ellipse(F_ellipse *e, float sx, float sy, int refx, int refy)
 {
     e->center.x = round(refx + (e->center.x - refx) * sx);
@@ -1116,7 +1150,7 @@ scale_ellipse(F_ellipse *e, float sx, float sy, int refx, int refy)
     }
 }
 
-static void
+void
 scale_text(F_text *t, float sx, float sy, int refx, int refy)
 {
     int newsize;
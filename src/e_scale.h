@@ -16,6 +16,11 @@
  */
 
 extern void	scale_compound(F_compound *c, double sx, double sy, int refx, int refy);
+extern void	scale_line(F_line *l, float sx, float sy, int refx, int refy);
+extern void	scale_spline(F_spline *s, float sx, float sy, int refx, int refy);
+extern void	scale_arc(F_arc *a, float sx, float sy, int refx, int refy);
+extern void	scale_ellipse(F_ellipse *e, float sx, float sy, int refx, int refy);
+extern void	scale_text(F_text *t, float sx, float sy, int refx, int refy);
 extern void	scale_radius(F_line *old, F_line *new, int owd, int oht, int nwd, int nht);
 extern Boolean	rescale_dimension_line(F_compound *dimline, float scalex, float scaley, int refx, int refy);
 
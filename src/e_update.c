@@ -33,6 +33,7 @@
 #include "w_util.h"
 
 #include "e_scale.h"
+#include "f_read.h"
 #include "f_util.h"
 #include "u_bound.h"
 #include "u_fonts.h"
@@ -136,6 +137,7 @@ init_update_settings(F_line *p, int type, int x, int y, int px, int py)
     switch (type) {
       case O_COMPOUND:
 	cur_c = (F_compound *) p;
+	expand_compound(cur_c);
 
 	/* if this is a dimension line, update the dimline settings from it */
 	if (dimline_components(cur_c, &dline, &dtick1, &dtick2, &dbox)) {
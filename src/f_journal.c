@@ -0,0 +1,909 @@
+/*
+ * FIG : Facility for Interactive Generation of figures
+ * Copyright (c) 1985-1988 by Supoj Sutanthavibul
+ * Parts Copyright (c) 1989-2015 by Brian V. Smith
+ * Parts Copyright (c) 1991 by Paul King
+ * Parts Copyright (c) 2016-2020 by Thomas Loimer
+ *
+ * Any party obtaining a copy of these files is granted, free of charge, a
+ * full and unrestricted irrevocable, world-wide, paid up, royalty-free,
+ * nonexclusive right and license to deal in this software and documentation
+ * files (the "Software"), including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense and/or sell copies of
+ * the Software, and to permit persons who receive copies from any such
+ * party to do so, with the only requirement being that the above copyright
+ * and this permission notice remain intact.
+ *
+ */
+
+/*
+ * The edit journal.
+ *
+ * Each action committed to the figure is appended as a small record to the
+ * journal, "name.fig.jnl", next to the Fig file. A record lists the objects
+ * removed from and added to the figure, in Fig format. To recover, the last
+ * saved figure, the base of the journal, is read and the records are
+ * replayed onto it. Removed objects are found by their contents.
+ * A change of the page settings, e.g., of the orientation or the units,
+ * is recorded as a line with the new settings.
+ * Actions that cannot be described this way, e.g., scaling or adding a
+ * point, and every JOURNAL_MAX_RECORDS records cause the journal to be
+ * compacted: When xfig is idle, the whole figure is written into a new
+ * journal. Until then, the figure is not current in the journal.
+ *
+ * Layout:
+ *	#FIG-JOURNAL 1
+ *	%F size mtime		the base is the Fig file, as saved, or
+ *	%B			the base is embedded,
+ *	<figure>		comments, resolution, user colors and objects,
+ *	%E
+ *	%S settings		its page settings,
+ *	records:
+ *	%R action object
+ *	%-			objects removed from the figure
+ *	<objects>		resolution, user colors and objects
+ *	%+			objects added to the figure
+ *	<objects>
+ *	%E			a record without %E is ignored
+ *	%S settings		or the page settings changed
+ * No line of a Fig file starts with '%'.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "fig.h"
+#include "resources.h"
+#include "mode.h"
+#include "object.h"
+
+#include "f_journal.h"
+#include "f_read.h"
+#include "f_save.h"
+#include "f_util.h"
+#include "u_free.h"
+#include "u_list.h"
+#include "u_redraw.h"
+#include "u_translate.h"
+#include "u_undo.h"
+#include "w_msgpanel.h"
+#include "w_setup.h"
+#include "w_util.h"
+
+#define JOURNAL_HEADER	"#FIG-JOURNAL 1\n"
+
+static char	jnl_file[PATH_MAX] = "";	/* the journal */
+static char	jnl_fig[PATH_MAX] = "";		/* the figure it belongs to */
+static FILE	*jnl_fp = NULL;
+static Boolean	fig_is_base = False;	/* jnl_fig, as saved, is the base */
+static Boolean	need_compact = False;	/* a compaction was deferred */
+static Boolean	jnl_failed = False;	/* could not write the journal */
+static int	lost = 0;		/* actions missing from the journal */
+static int	num_records = 0;
+static unsigned long journaled = 0;	/* action_count when last journaled */
+static fig_settings jnl_settings;	/* the page settings last journaled */
+static Boolean	replaying = False;
+static XtWorkProcId compact_proc = 0;
+
+static int	write_record(int action, int object, int dx, int dy,
+				Boolean links);
+static void	compact(void);
+static void	get_settings(fig_settings *s);
+static Boolean	open_journal(void);
+static void	stop_journal(Boolean remove);
+static Boolean	replay(char *buf);
+
+static void
+full_name(char *name, char *full)
+{
+    if (*name == '/')
+	strcpy(full, name);
+    else
+	sprintf(full, "%s/%s", cur_file_dir, name);
+}
+
+static void
+set_target(char *figfile)
+{
+    full_name(figfile, jnl_fig);
+    sprintf(jnl_file, "%s%s", jnl_fig, JOURNAL_SUFFIX);
+    journaled = action_count;
+    get_settings(&jnl_settings);
+    lost = 0;
+    num_records = 0;
+    need_compact = False;
+    jnl_failed = False;
+}
+
+char *
+journal_name(void)
+{
+    return jnl_file;
+}
+
+/* the page settings of the figure */
+
+static void
+get_settings(fig_settings *s)
+{
+    s->landscape = appres.landscape;
+    s->flushleft = appres.flushleft;
+    s->units = appres.INCHES;
+    s->grid_unit = cur_gridunit;
+    s->papersize = appres.papersize;
+    s->magnification = appres.magnification;
+    s->multiple = appres.multiple;
+    s->transparent = appres.transparent;
+}
+
+static Boolean
+same_settings(fig_settings *a, fig_settings *b)
+{
+    return a->landscape == b->landscape && a->flushleft == b->flushleft &&
+		a->units == b->units && a->grid_unit == b->grid_unit &&
+		a->papersize == b->papersize &&
+		a->magnification == b->magnification &&
+		a->multiple == b->multiple && a->transparent == b->transparent;
+}
+
+static int
+write_settings(FILE *fp, fig_settings *s)
+{
+#ifdef I18N
+    setlocale(LC_NUMERIC, "C");
+#endif  /* I18N */
+    fprintf(fp, "%%S %d %d %d %d %d %.2f %d %d\n", s->landscape,
+		s->flushleft, s->units, s->grid_unit, s->papersize,
+		s->magnification, s->multiple, s->transparent);
+#ifdef I18N
+    setlocale(LC_NUMERIC, "");
+#endif  /* I18N */
+    return fflush(fp) == 0 && !ferror(fp) ? 0 : -1;
+}
+
+/* record a change of the page settings, they are not undoable */
+
+static void
+journal_settings(void)
+{
+    fig_settings    s;
+
+    get_settings(&s);
+    if (same_settings(&s, &jnl_settings))
+	return;
+    jnl_settings = s;
+    if (jnl_failed || emptyname(jnl_fig))
+	return;
+    if (!need_compact && open_journal() && write_settings(jnl_fp, &s) == 0)
+	return;
+    ++lost;
+    compact();
+}
+
+/*
+ * Record the last action, or a change of the page settings, in the
+ * journal. Called from set_modifiedflag(), clean_up() and undo(); an
+ * action is only recorded once.
+ */
+
+void
+journal_commit(void)
+{
+    char	    fig[PATH_MAX];
+    int		    action, object, dx, dy;
+    Boolean	    links;
+
+    if (!appres.journal || update_figs || replaying)
+	return;
+    journal_settings();
+    if (journaled == action_count)
+	return;
+    if ((action = get_last_action(&object, &dx, &dy, &links)) == F_NULL)
+	return;
+    journaled = action_count;
+
+    /* untitled figures are not journaled, see emergency_quit() */
+    if (emptyname(cur_filename)) {
+	stop_journal(True);
+	jnl_fig[0] = '\0';
+	return;
+    }
+    full_name(cur_filename, fig);
+    if (strcmp(fig, jnl_fig) != 0) {
+	/* the figure got a new name, e.g., by undoing a load */
+	stop_journal(True);
+	set_target(cur_filename);
+	fig_is_base = False;
+    }
+    if (jnl_failed)
+	return;
+
+    if (objects.parent == NULL && !need_compact && open_journal() &&
+		write_record(action, object, dx, dy, links) == 0) {
+	if (++num_records >= JOURNAL_MAX_RECORDS)
+	    compact();
+	return;
+    }
+    ++lost;
+    compact();
+}
+
+/* the figure was changed in a way not known to undo(), e.g., search/replace */
+
+void
+journal_checkpoint(void)
+{
+    if (!appres.journal || update_figs || jnl_failed || emptyname(jnl_fig))
+	return;
+    ++lost;
+    compact();
+}
+
+/*
+ * Open the journal for appending. If there is none, start it with the
+ * Fig file as its base.
+ */
+
+static Boolean
+open_journal(void)
+{
+    struct stat	    st;
+
+    if (jnl_fp != NULL)
+	return True;
+    if (!fig_is_base || stat(jnl_fig, &st) != 0)
+	return False;
+    if ((jnl_fp = fopen(jnl_file, "w")) == NULL)
+	return False;
+    fprintf(jnl_fp, "%s%%F %ld %ld\n", JOURNAL_HEADER,
+		(long) st.st_size, (long) st.st_mtime);
+    if (fflush(jnl_fp) != 0) {
+	fclose(jnl_fp);
+	jnl_fp = NULL;
+	unlink(jnl_file);
+	return False;
+    }
+    return True;
+}
+
+/* close the journal, and remove it if remove is True */
+
+static void
+stop_journal(Boolean remove)
+{
+    if (jnl_fp != NULL) {
+	fclose(jnl_fp);
+	jnl_fp = NULL;
+    }
+    if (remove && jnl_file[0] != '\0')
+	unlink(jnl_file);
+    fig_is_base = False;
+}
+
+/*****************************/
+/* writing journal records   */
+/*****************************/
+
+/* start the list of removed ('-') or added ('+') objects */
+
+static void
+begin_objects(FILE *fp, int sign)
+{
+    fprintf(fp, "%%%c\n%d 2\n", sign, PIX_PER_INCH);
+    write_colordefs(fp);
+}
+
+/* write all objects in the lists of c, but not c itself */
+
+static void
+write_members(FILE *fp, F_compound *c)
+{
+    F_arc	   *a;
+    F_compound	   *cc;
+    F_ellipse	   *e;
+    F_line	   *l;
+    F_spline	   *s;
+    F_text	   *t;
+
+    for (a = c->arcs; a != NULL; a = a->next)
+	write_arc(fp, a);
+    for (cc = c->compounds; cc != NULL; cc = cc->next)
+	write_compound(fp, cc);
+    for (e = c->ellipses; e != NULL; e = e->next)
+	write_ellipse(fp, e);
+    for (l = c->lines; l != NULL; l = l->next)
+	write_line(fp, l);
+    for (s = c->splines; s != NULL; s = s->next)
+	write_spline(fp, s);
+    for (t = c->texts; t != NULL; t = t->next)
+	write_text(fp, t);
+}
+
+/* the object last acted on, from saved_objects */
+
+static void *
+latest_object(int type)
+{
+    switch (type) {
+      case O_ARC:
+	return saved_objects.arcs;
+      case O_COMPOUND:
+	return saved_objects.compounds;
+      case O_ELLIPSE:
+	return saved_objects.ellipses;
+      case O_POLYLINE:
+	return saved_objects.lines;
+      case O_SPLINE:
+	return saved_objects.splines;
+      case O_TXT:
+	return saved_objects.texts;
+    }
+    return NULL;
+}
+
+/* the object following obj, for F_EDIT this is the changed object */
+
+static void *
+next_object(int type, void *obj)
+{
+    switch (type) {
+      case O_ARC:
+	return ((F_arc *) obj)->next;
+      case O_COMPOUND:
+	return ((F_compound *) obj)->next;
+      case O_ELLIPSE:
+	return ((F_ellipse *) obj)->next;
+      case O_POLYLINE:
+	return ((F_line *) obj)->next;
+      case O_SPLINE:
+	return ((F_spline *) obj)->next;
+      case O_TXT:
+	return ((F_text *) obj)->next;
+    }
+    return NULL;
+}
+
+static void
+translate_object(int type, void *obj, int dx, int dy)
+{
+    switch (type) {
+      case O_ARC:
+	translate_arc((F_arc *) obj, dx, dy);
+	break;
+      case O_COMPOUND:
+	translate_compound((F_compound *) obj, dx, dy);
+	break;
+      case O_ELLIPSE:
+	translate_ellipse((F_ellipse *) obj, dx, dy);
+	break;
+      case O_POLYLINE:
+	translate_line((F_line *) obj, dx, dy);
+	break;
+      case O_SPLINE:
+	translate_spline((F_spline *) obj, dx, dy);
+	break;
+      case O_TXT:
+	translate_text((F_text *) obj, dx, dy);
+	break;
+    }
+}
+
+/*
+ * Append a record for the last action to the journal.
+ * Return -1 if the action cannot be recorded or on error.
+ */
+
+static int
+write_record(int action, int object, int dx, int dy, Boolean links)
+{
+    void	   *obj, *changed;
+    F_compound	   *c;
+
+    if (object == O_ALL_OBJECT) {
+	if (action != F_ADD && action != F_DELETE)
+	    return -1;
+    } else if ((obj = latest_object(object)) == NULL) {
+	return -1;
+    }
+
+#ifdef I18N
+    setlocale(LC_NUMERIC, "C");
+#endif  /* I18N */
+    fprintf(jnl_fp, "%%R %d %d\n", action, object);
+    switch (action) {
+      case F_ADD:
+      case F_DELETE:
+	begin_objects(jnl_fp, action == F_ADD ? '+' : '-');
+	if (object == O_ALL_OBJECT)
+	    write_members(jnl_fp, &saved_objects);
+	else
+	    write_object(jnl_fp, object, obj);
+	break;
+      case F_EDIT:
+	/* the original object, followed by the changed one */
+	if ((changed = next_object(object, obj)) == NULL)
+	    goto unknown;
+	begin_objects(jnl_fp, '-');
+	write_object(jnl_fp, object, obj);
+	begin_objects(jnl_fp, '+');
+	write_object(jnl_fp, object, changed);
+	break;
+      case F_MOVE:
+	/* lines linked to a compound were moved, too */
+	if (links)
+	    goto unknown;
+	translate_object(object, obj, -dx, -dy);
+	begin_objects(jnl_fp, '-');
+	write_object(jnl_fp, object, obj);
+	translate_object(object, obj, dx, dy);
+	begin_objects(jnl_fp, '+');
+	write_object(jnl_fp, object, obj);
+	break;
+      case F_MOVE_POINT:
+	shift_lastpoint(-dx, -dy);
+	begin_objects(jnl_fp, '-');
+	write_object(jnl_fp, object, obj);
+	shift_lastpoint(dx, dy);
+	begin_objects(jnl_fp, '+');
+	write_object(jnl_fp, object, obj);
+	break;
+      case F_GLUE:
+	/* the members of the new compound were removed from the figure */
+	c = (F_compound *) obj;
+	begin_objects(jnl_fp, '-');
+	write_members(jnl_fp, c);
+	begin_objects(jnl_fp, '+');
+	write_compound(jnl_fp, c);
+	break;
+      case F_BREAK:
+	c = (F_compound *) obj;
+	begin_objects(jnl_fp, '-');
+	write_compound(jnl_fp, c);
+	begin_objects(jnl_fp, '+');
+	write_members(jnl_fp, c);
+	break;
+      default:
+	goto unknown;
+    }
+    fprintf(jnl_fp, "%%E\n");
+#ifdef I18N
+    setlocale(LC_NUMERIC, "");
+#endif  /* I18N */
+    return fflush(jnl_fp) == 0 && !ferror(jnl_fp) ? 0 : -1;
+
+unknown:
+    /* a record without "%E" is skipped on recovery */
+    fflush(jnl_fp);
+#ifdef I18N
+    setlocale(LC_NUMERIC, "");
+#endif  /* I18N */
+    return -1;
+}
+
+/*****************************/
+/* compacting the journal    */
+/*****************************/
+
+/* write the whole figure as the base of a new journal */
+
+static int
+write_base(char *file)
+{
+    FILE	   *fp;
+    int		    err;
+
+    if ((fp = fopen(file, "w")) == NULL)
+	return -1;
+#ifdef I18N
+    setlocale(LC_NUMERIC, "C");
+#endif  /* I18N */
+    fprintf(fp, "%s%%B\n", JOURNAL_HEADER);
+    write_comments(fp, objects.comments);
+    fprintf(fp, "%d 2\n", PIX_PER_INCH);
+    write_colordefs(fp);
+    write_members(fp, &objects);
+    fprintf(fp, "%%E\n");
+#ifdef I18N
+    setlocale(LC_NUMERIC, "");
+#endif  /* I18N */
+    get_settings(&jnl_settings);
+    err = write_settings(fp, &jnl_settings);
+    if (fclose(fp) == EOF || err) {
+	unlink(file);
+	return -1;
+    }
+    return 0;
+}
+
+static void
+journal_failed(void)
+{
+    stop_journal(False);
+    jnl_failed = True;
+    file_msg("Cannot write the journal %s, changes are not journaled",
+		jnl_file);
+}
+
+/* replace the journal by the figure, called by XtAppAddWorkProc */
+
+static Boolean
+compact_idle(XtPointer client_data)
+{
+    char	    part[PATH_MAX + 8];
+
+    (void)client_data;
+    compact_proc = 0;
+    /* the journal was closed, or restarted when the figure was saved */
+    if (!need_compact || jnl_failed || emptyname(jnl_fig))
+	return True;
+    /* a compound is open, journal_commit() asks again */
+    if (objects.parent != NULL)
+	return True;
+    need_compact = False;
+    num_records = 0;
+    sprintf(part, "%s.part", jnl_file);
+    if (write_base(part) != 0 || rename(part, jnl_file) != 0) {
+	unlink(part);
+	journal_failed();
+	return True;
+    }
+    if (jnl_fp != NULL)
+	fclose(jnl_fp);
+    if ((jnl_fp = fopen(jnl_file, "a")) == NULL) {
+	journal_failed();
+	return True;
+    }
+    lost = 0;
+    return True;
+}
+
+/* compact the journal when xfig is idle */
+
+static void
+compact(void)
+{
+    need_compact = True;
+    if (compact_proc == 0)
+	compact_proc = XtAppAddWorkProc(tool_app, compact_idle, NULL);
+}
+
+/* Return True if all changes to the figure are in the journal */
+
+Boolean
+journal_current(void)
+{
+    journal_commit();
+    return appres.journal && jnl_fp != NULL && lost == 0 &&
+		fflush(jnl_fp) == 0;
+}
+
+/*****************************/
+/* starting and recovery     */
+/*****************************/
+
+/* the figure was saved as figfile, start a new journal */
+
+void
+journal_saved(char *figfile)
+{
+    stop_journal(True);
+    set_target(figfile);
+    fig_is_base = True;
+}
+
+/* normal exit, the user was asked to save the figure */
+
+void
+journal_close(void)
+{
+    stop_journal(True);
+    jnl_file[0] = jnl_fig[0] = '\0';
+}
+
+/*
+ * The figure was loaded from figfile. If there is a journal that belongs
+ * to figfile, offer to recover the changes recorded in it.
+ */
+
+void
+journal_open(char *figfile)
+{
+    FILE	   *fp;
+    struct stat	    st, fst;
+    char	   *buf;
+    char	    msg[PATH_MAX + 80];
+    long	    size, mtime;
+    Boolean	    stale;
+
+    /* the changes to the previous figure were saved or discarded */
+    stop_journal(True);
+    set_target(figfile);
+    fig_is_base = True;
+
+    if (!appres.journal || update_figs || stat(jnl_file, &st) != 0)
+	return;
+
+    /* read the whole journal */
+    if ((buf = malloc(st.st_size + 1)) == NULL)
+	return;
+    if ((fp = fopen(jnl_file, "r")) == NULL) {
+	free(buf);
+	return;
+    }
+    size = fread(buf, 1, st.st_size, fp);
+    fclose(fp);
+    buf[size] = '\0';
+
+    /* a journal based on another version of the Fig file is useless */
+    stale = strncmp(buf, JOURNAL_HEADER, strlen(JOURNAL_HEADER)) != 0;
+    if (!stale && strncmp(buf + strlen(JOURNAL_HEADER), "%F ", 3) == 0)
+	stale = sscanf(buf + strlen(JOURNAL_HEADER) + 3, "%ld %ld",
+			&size, &mtime) != 2 || stat(jnl_fig, &fst) != 0 ||
+		    (long) fst.st_size != size || (long) fst.st_mtime != mtime;
+    if (stale) {
+	file_msg("Journal %s does not belong to %s, ignored.",
+			jnl_file, figfile);
+	sprintf(msg, "%s.old", jnl_file);
+	rename(jnl_file, msg);
+	free(buf);
+	return;
+    }
+
+    sprintf(msg, "Found a journal of unsaved changes to\n\"%s\".\n"
+			"Recover these changes?", figfile);
+    if (popup_query(QUERY_YESNO, msg) != RESULT_YES) {
+	unlink(jnl_file);
+	free(buf);
+	return;
+    }
+    /* update_settings() may call set_modifiedflag() */
+    replaying = True;
+    if (!replay(buf))
+	file_msg("Could not recover all changes from %s", jnl_file);
+    replaying = False;
+    get_settings(&jnl_settings);
+    free(buf);
+
+    /* keep appending to this journal */
+    jnl_fp = fopen(jnl_file, "a");
+    redisplay_canvas();
+    set_modifiedflag();
+    put_msg("Recovered unsaved changes to \"%s\"", figfile);
+}
+
+/* read the objects of a journal record between start and end */
+
+static int
+read_part(char *start, char *end, F_compound *c)
+{
+    FILE	   *fp;
+    int		    status;
+
+    if ((fp = tmpfile()) == NULL)
+	return -1;
+    if (fwrite(start, 1, end - start, fp) != (size_t)(end - start) ||
+		fseek(fp, 0L, SEEK_SET) != 0) {
+	fclose(fp);
+	return -1;
+    }
+    status = read_journal_objects(fp, c);
+    fclose(fp);
+    return status;
+}
+
+static Boolean
+same_object(int type, void *a, void *b)
+{
+    char	   *ta, *tb;
+    Boolean	    same;
+
+    ta = object_string(type, a);
+    tb = object_string(type, b);
+    same = ta != NULL && tb != NULL && strcmp(ta, tb) == 0;
+    free(ta);
+    free(tb);
+    return same;
+}
+
+/*
+ * Remove the objects in c from the figure. Compare the text of objects
+ * at the same depth and position.
+ */
+
+static void
+remove_objects(F_compound *c)
+{
+    F_arc	   *a, *aa;
+    F_compound	   *cc, *ccc;
+    F_ellipse	   *e, *ee;
+    F_line	   *l, *ll;
+    F_spline	   *s, *ss;
+    F_text	   *t, *tt;
+
+    for (a = c->arcs; a != NULL; a = a->next)
+	for (aa = objects.arcs; aa != NULL; aa = aa->next)
+	    if (aa->depth == a->depth && aa->point[0].x == a->point[0].x &&
+			aa->point[0].y == a->point[0].y &&
+			same_object(O_ARC, aa, a)) {
+		list_delete_arc(&objects.arcs, aa);
+		free_arc(&aa);
+		break;
+	    }
+    for (cc = c->compounds; cc != NULL; cc = cc->next)
+	for (ccc = objects.compounds; ccc != NULL; ccc = ccc->next)
+	    if (ccc->nwcorner.x == cc->nwcorner.x &&
+			ccc->nwcorner.y == cc->nwcorner.y &&
+			ccc->secorner.x == cc->secorner.x &&
+			ccc->secorner.y == cc->secorner.y &&
+			same_object(O_COMPOUND, ccc, cc)) {
+		list_delete_compound(&objects.compounds, ccc);
+		free_compound(&ccc);
+		break;
+	    }
+    for (e = c->ellipses; e != NULL; e = e->next)
+	for (ee = objects.ellipses; ee != NULL; ee = ee->next)
+	    if (ee->depth == e->depth && ee->center.x == e->center.x &&
+			ee->center.y == e->center.y &&
+			same_object(O_ELLIPSE, ee, e)) {
+		list_delete_ellipse(&objects.ellipses, ee);
+		free_ellipse(&ee);
+		break;
+	    }
+    for (l = c->lines; l != NULL; l = l->next)
+	for (ll = objects.lines; ll != NULL; ll = ll->next)
+	    if (ll->depth == l->depth && ll->points && l->points &&
+			ll->points->x == l->points->x &&
+			ll->points->y == l->points->y &&
+			same_object(O_POLYLINE, ll, l)) {
+		list_delete_line(&objects.lines, ll);
+		free_line(&ll);
+		break;
+	    }
+    for (s = c->splines; s != NULL; s = s->next)
+	for (ss = objects.splines; ss != NULL; ss = ss->next)
+	    if (ss->depth == s->depth && ss->points && s->points &&
+			ss->points->x == s->points->x &&
+			ss->points->y == s->points->y &&
+			same_object(O_SPLINE, ss, s)) {
+		list_delete_spline(&objects.splines, ss);
+		free_spline(&ss);
+		break;
+	    }
+    for (t = c->texts; t != NULL; t = t->next)
+	for (tt = objects.texts; tt != NULL; tt = tt->next)
+	    if (tt->depth == t->depth && tt->base_x == t->base_x &&
+			tt->base_y == t->base_y &&
+			same_object(O_TXT, tt, t)) {
+		list_delete_text(&objects.texts, tt);
+		free_text(&tt);
+		break;
+	    }
+}
+
+/* append the objects in c to the figure, c is emptied */
+
+static void
+add_objects(F_compound *c)
+{
+    F_compound	    tails;
+
+    /* splice the lists, instead of walking to the end for each object */
+    tail(&objects, &tails);
+    append_objects(&objects, c, &tails);
+    c->arcs = NULL;
+    c->compounds = NULL;
+    c->ellipses = NULL;
+    c->lines = NULL;
+    c->splines = NULL;
+    c->texts = NULL;
+}
+
+static void
+free_objects(F_compound *c)
+{
+    free_arc(&c->arcs);
+    free_compound(&c->compounds);
+    free_ellipse(&c->ellipses);
+    free_line(&c->lines);
+    free_spline(&c->splines);
+    free_text(&c->texts);
+}
+
+/* return the start of the line following p */
+
+static char *
+next_line(char *p)
+{
+    if ((p = strchr(p, '\n')) == NULL)
+	return NULL;
+    return p + 1;
+}
+
+/*
+ * Replay the journal in buf onto the figure. Return False if not all
+ * records could be replayed.
+ */
+
+static Boolean
+replay(char *buf)
+{
+    F_compound	    c;
+    fig_settings    s;
+    char	   *p, *start, *minus, *plus, *end;
+    int		    landscape, flushleft, units, multiple, n;
+
+    p = next_line(buf);		/* skip the header */
+
+    if (p != NULL && strncmp(p, "%B", 2) == 0) {
+	/* replace the figure by the embedded one */
+	start = next_line(p);
+	for (end = start; end != NULL && strncmp(end, "%E", 2) != 0;
+			end = next_line(end))
+	    ;
+	if (end == NULL || read_part(start, end, &c) != 0)
+	    return False;
+	remove_compound_depth(&objects);
+	free_objects(&objects);
+	if (objects.comments)
+	    free(objects.comments);
+	objects.comments = c.comments;
+	add_objects(&c);
+	p = next_line(end);
+    } else if (p != NULL) {
+	p = next_line(p);	/* %F */
+    }
+
+    /* the records */
+    minus = plus = NULL;
+    for (; p != NULL && *p != '\0'; p = next_line(p)) {
+	if (strncmp(p, "%R", 2) == 0) {
+	    minus = plus = NULL;	/* an incomplete record is skipped */
+	} else if (strncmp(p, "%S", 2) == 0) {
+#ifdef I18N
+	    setlocale(LC_NUMERIC, "C");
+#endif  /* I18N */
+	    n = sscanf(p + 2, "%d %d %d %d %d %f %d %d", &landscape,
+			&flushleft, &units, &s.grid_unit, &s.papersize,
+			&s.magnification, &multiple, &s.transparent);
+#ifdef I18N
+	    setlocale(LC_NUMERIC, "");
+#endif  /* I18N */
+	    if (n == 8) {
+		s.landscape = landscape;
+		s.flushleft = flushleft;
+		s.units = units;
+		s.multiple = multiple;
+		update_settings(&s);
+	    }
+	} else if (strncmp(p, "%-", 2) == 0) {
+	    minus = p;
+	} else if (strncmp(p, "%+", 2) == 0) {
+	    plus = p;
+	} else if (strncmp(p, "%E", 2) == 0) {
+	    if (minus) {
+		end = (plus && plus > minus) ? plus : p;
+		if (read_part(next_line(minus), end, &c) != 0)
+		    return False;
+		remove_objects(&c);
+		free_objects(&c);
+	    }
+	    if (plus) {
+		end = (minus && minus > plus) ? minus : p;
+		if (read_part(next_line(plus), end, &c) != 0)
+		    return False;
+		add_objects(&c);
+	    }
+	    minus = plus = NULL;
+	}
+    }
+    return True;
+}
@@ -0,0 +1,37 @@
+/*
+ * FIG : Facility for Interactive Generation of figures
+ * Copyright (c) 1985-1988 by Supoj Sutanthavibul
+ * Parts Copyright (c) 1989-2015 by Brian V. Smith
+ * Parts Copyright (c) 1991 by Paul King
+ * Parts Copyright (c) 2016-2020 by Thomas Loimer
+ *
+ * Any party obtaining a copy of these files is granted, free of charge, a
+ * full and unrestricted irrevocable, world-wide, paid up, royalty-free,
+ * nonexclusive right and license to deal in this software and documentation
+ * files (the "Software"), including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense and/or sell copies of
+ * the Software, and to permit persons who receive copies from any such
+ * party to do so, with the only requirement being that the above copyright
+ * and this permission notice remain intact.
+ *
+ */
+
+#ifndef F_JOURNAL_H
+#define F_JOURNAL_H
+
+#include <X11/Intrinsic.h>	/* Boolean */
+
+/* suffix appended to "name.fig" to get the name of its journal */
+#define JOURNAL_SUFFIX		".jnl"
+/* compact the journal after this many records */
+#define JOURNAL_MAX_RECORDS	500
+
+extern void	journal_commit(void);
+extern void	journal_checkpoint(void);
+extern void	journal_open(char *figfile);
+extern void	journal_saved(char *figfile);
+extern void	journal_close(void);
+extern Boolean	journal_current(void);
+extern char	*journal_name(void);
+
+#endif /* F_JOURNAL_H */
@@ -20,7 +20,9 @@
 #include "resources.h"
 #include "mode.h"
 #include "object.h"
+#include "f_journal.h"
 #include "f_read.h"
+#include "f_save.h"
 #include "f_util.h"
 #include "u_create.h"
 #include "u_undo.h"
@@ -113,6 +115,8 @@ load_file(char *file, int xoff, int yoff)
 	reset_cursor();
 	/* reset modified flag in case any change in orientation set it */
 	reset_modifiedflag();
+	/* offer to recover unsaved changes, and start a new journal */
+	journal_open(file);
 	/* update the recent list */
 	update_recent_list(file);
 	return 0;
@@ -134,6 +138,7 @@ load_file(char *file, int xoff, int yoff)
 	set_action(F_LOAD);
 	reset_cursor();
 	reset_modifiedflag();
+	journal_open(file);
 	return 0;
     }
 
@@ -143,6 +148,275 @@ load_file(char *file, int xoff, int yoff)
     return 1;
 }
 
+/*
+ * Reload the figure after the file was changed by another program
+ * (-autorefresh). Objects are compared by their text in the Fig file, only
+ * the regions of objects that were removed or added are redrawn. If the
+ * page settings or the user colors changed, the whole canvas is redrawn.
+ */
+
+#define MAX_REGIONS	8
+
+typedef struct {
+    int		type;
+    void       *obj;
+    char       *text;
+    Boolean	old;		/* from the figure currently displayed */
+} reload_entry;
+
+typedef struct {
+    int		xmin, ymin, xmax, ymax;
+} region;
+
+static int
+cmp_entries(const void *a, const void *b)
+{
+    const reload_entry *ea = (const reload_entry *) a;
+    const reload_entry *eb = (const reload_entry *) b;
+
+    if (ea->type != eb->type)
+	return ea->type - eb->type;
+    return strcmp(ea->text, eb->text);
+}
+
+static int
+add_entries(reload_entry *e, int n, F_compound *c, Boolean old)
+{
+    F_arc	   *a;
+    F_compound	   *cc;
+    F_ellipse	   *el;
+    F_line	   *l;
+    F_spline	   *s;
+    F_text	   *t;
+
+#define ADD_ENTRY(typ, o)	e[n].type = typ; e[n].obj = (void *) o;	\
+				e[n].old = old; e[n++].text = object_string(typ, o)
+    for (a = c->arcs; a != NULL; a = a->next) {
+	ADD_ENTRY(O_ARC, a);
+    }
+    for (cc = c->compounds; cc != NULL; cc = cc->next) {
+	ADD_ENTRY(O_COMPOUND, cc);
+    }
+    for (el = c->ellipses; el != NULL; el = el->next) {
+	ADD_ENTRY(O_ELLIPSE, el);
+    }
+    for (l = c->lines; l != NULL; l = l->next) {
+	ADD_ENTRY(O_POLYLINE, l);
+    }
+    for (s = c->splines; s != NULL; s = s->next) {
+	ADD_ENTRY(O_SPLINE, s);
+    }
+    for (t = c->texts; t != NULL; t = t->next) {
+	ADD_ENTRY(O_TXT, t);
+    }
+#undef ADD_ENTRY
+    return n;
+}
+
+/* add the bounding box of an object to the regions to redraw */
+
+static void
+add_region(region *r, int *nr, int type, void *obj)
+{
+    int		    xmin, ymin, xmax, ymax;
+    int		    i, best, area, barea;
+    int		    dum;
+
+    switch (type) {
+      case O_ARC:
+	arc_bound((F_arc *) obj, &xmin, &ymin, &xmax, &ymax);
+	break;
+      case O_COMPOUND:
+	compound_bound((F_compound *) obj, &xmin, &ymin, &xmax, &ymax);
+	break;
+      case O_ELLIPSE:
+	ellipse_bound((F_ellipse *) obj, &xmin, &ymin, &xmax, &ymax);
+	break;
+      case O_POLYLINE:
+	line_bound((F_line *) obj, &xmin, &ymin, &xmax, &ymax);
+	break;
+      case O_SPLINE:
+	spline_bound((F_spline *) obj, &xmin, &ymin, &xmax, &ymax);
+	break;
+      case O_TXT:
+	text_bound((F_text *) obj, &xmin, &ymin, &xmax, &ymax,
+		&dum,&dum,&dum,&dum,&dum,&dum,&dum,&dum);
+	break;
+      default:
+	return;
+    }
+
+    /* merge with an overlapping region, or with the one growing least */
+    best = -1;
+    barea = 0;
+    for (i = 0; i < *nr; i++) {
+	if (xmin <= r[i].xmax && xmax >= r[i].xmin &&
+		ymin <= r[i].ymax && ymax >= r[i].ymin) {
+	    best = i;
+	    break;
+	}
+	area = (max2(xmax, r[i].xmax) - min2(xmin, r[i].xmin)) / 100 *
+		((max2(ymax, r[i].ymax) - min2(ymin, r[i].ymin)) / 100);
+	if (best < 0 || area < barea) {
+	    best = i;
+	    barea = area;
+	}
+    }
+    if (i == *nr && *nr < MAX_REGIONS) {
+	r[*nr].xmin = xmin;
+	r[*nr].ymin = ymin;
+	r[*nr].xmax = xmax;
+	r[*nr].ymax = ymax;
+	++(*nr);
+	return;
+    }
+    r[best].xmin = min2(xmin, r[best].xmin);
+    r[best].ymin = min2(ymin, r[best].ymin);
+    r[best].xmax = max2(xmax, r[best].xmax);
+    r[best].ymax = max2(ymax, r[best].ymax);
+}
+
+/*
+ * Find the objects in new, but not in old, and vice versa, and return the
+ * regions they cover. Return -1 if the comparison failed.
+ */
+
+static int
+changed_regions(F_compound *old, F_compound *new, region *r)
+{
+    reload_entry   *e;
+    int		    n, i, j, k, nold, nr;
+
+    n = object_count(old) + object_count(new);
+    if (n == 0)
+	return 0;
+    if ((e = malloc(n * sizeof(reload_entry))) == NULL)
+	return -1;
+    n = add_entries(e, 0, old, True);
+    n = add_entries(e, n, new, False);
+    for (i = 0; i < n; i++)
+	if (e[i].text == NULL) {
+	    for (j = 0; j < n; j++)
+		free(e[j].text);
+	    free(e);
+	    return -1;
+	}
+
+    /* equal objects are now next to each other; if a run of equal objects
+       has more old than new objects, or vice versa, the excess changed */
+    qsort(e, n, sizeof(reload_entry), cmp_entries);
+    nr = 0;
+    for (i = 0; i < n; i = j) {
+	nold = 0;
+	for (j = i; j < n && cmp_entries(&e[i], &e[j]) == 0; j++)
+	    if (e[j].old)
+		++nold;
+	if (2 * nold != j - i) {
+	    for (k = i; k < j && e[k].old != (2 * nold > j - i); k++)
+		;
+	    add_region(r, &nr, e[k].type, e[k].obj);
+	}
+    }
+    for (i = 0; i < n; i++)
+	free(e[i].text);
+    free(e);
+    return nr;
+}
+
+/* return True if the user colors just swapped in differ from the old ones */
+
+static Boolean
+colors_changed(void)
+{
+    int		    i;
+
+    /* swap_colors() put the old colors into n_user_colors */
+    if (num_usr_cols != n_num_usr_cols)
+	return True;
+    for (i = 0; i < num_usr_cols; i++) {
+	if (colorFree[i] != n_colorFree[i])
+	    return True;
+	if (!colorFree[i] && (user_colors[i].red != n_user_colors[i].red ||
+			user_colors[i].green != n_user_colors[i].green ||
+			user_colors[i].blue != n_user_colors[i].blue))
+	    return True;
+    }
+    return False;
+}
+
+int
+reload_file(char *file)
+{
+    int		    s, i, nr;
+    F_compound	    c;
+    fig_settings    settings;
+    region	    r[MAX_REGIONS];
+
+    /* the user is editing a compound, or the file name changed */
+    if (objects.parent != NULL || strcmp(file, cur_filename) != 0)
+	return load_file(file, 0, 0);
+
+    c.parent = NULL;
+    c.GABPtr = NULL;
+    c.arcs = NULL;
+    c.compounds = NULL;
+    c.ellipses = NULL;
+    c.lines = NULL;
+    c.splines = NULL;
+    c.texts = NULL;
+    c.comments = NULL;
+    c.next = NULL;
+    set_temp_cursor(wait_cursor);
+
+    s = read_figc(file, &c, DONT_MERGE, REMAP_IMAGES, 0, 0, &settings);
+    if (s != 0) {
+	/* possibly still being written, wait for the next change */
+	reset_cursor();
+	return s;
+    }
+
+    if (settings.landscape != (int) appres.landscape ||
+		settings.flushleft != (int) appres.flushleft ||
+		settings.units != (int) appres.INCHES ||
+		settings.papersize != appres.papersize ||
+		settings.magnification != appres.magnification ||
+		settings.multiple != (int) appres.multiple ||
+		settings.transparent != appres.transparent ||
+		colors_changed())
+	nr = -1;
+    else
+	nr = changed_regions(&objects, &c, r);
+
+    clean_up();
+    /* the file name is the same, but undo_load() swaps it back */
+    (void) strcpy(save_filename, cur_filename);
+    saved_objects = objects;
+    objects = c;
+
+    /* count objects at each depth */
+    reset_depths();
+    clearallcounts();
+    defer_update_layers = 1;
+    add_compound_depth(&objects);
+    defer_update_layers = 0;
+    update_layers();
+
+    if (nr < 0) {
+	update_settings(&settings);
+	redisplay_canvas();
+    } else {
+	for (i = 0; i < nr; i++)
+	    redisplay_zoomed_region(r[i].xmin, r[i].ymin, r[i].xmax, r[i].ymax);
+    }
+
+    put_msg("Current figure \"%s\" (%d objects)", file, num_object);
+    set_action(F_LOAD);
+    reset_cursor();
+    reset_modifiedflag();
+    journal_open(file);
+    return 0;
+}
+
 void update_settings(fig_settings *settings)
 {
 	DeclareArgs(2);
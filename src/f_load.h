@@ -1,3 +1,4 @@
 extern int load_file (char *file, int xoff, int yoff);
+extern int reload_file (char *file);
 extern int update_recent_list (char *file);
 extern void merge_file(char *file, int xoff, int yoff);
@@ -41,11 +41,13 @@
 #include "d_spline.h"
 #include "e_update.h"
 #include "f_picobj.h"
+#include "f_snapshot.h"
 #include "f_util.h"
 #include "u_bound.h"
 #include "u_create.h"
 #include "u_fonts.h"
 #include "u_free.h"
+#include "u_list.h"
 #include "u_scale.h"
 #include "u_translate.h"
 #include "w_canvas.h"
@@ -70,6 +72,7 @@ void	fix_angle (float *angle);
 int	line_no, save_line;	/* current input line number */
 int	num_object;		/* current number of objects */
 char	*read_file_name;	/* current input file name */
+int	lazy_compounds = 0;	/* number of compounds not read yet */
 void	swap_colors (void);
 
 /* LOCAL */
@@ -83,6 +86,8 @@ static F_text     *read_textobject(FILE *fp);
 static F_spline   *read_splineobject(FILE *fp);
 static F_arc      *read_arcobject(FILE *fp);
 static F_compound *read_compoundobject(FILE *fp);
+static F_compound *skim_compoundobject(FILE *fp);
+static void	   read_compoundbody(F_compound *com);
 static int	  save_comment(void);
 static char	  *attach_comments(void);
 static void	   count_lines_correctly(FILE *fp);
@@ -110,6 +115,18 @@ static int	TFX;			/* true for 1.4TFX protocol */
 static int	proto;			/* file protocol*10 */
 static float	fproto, xfigproto;	/* floating values for protocol of
 					   figure file and current protocol */
+static Boolean	read_lazily = False;	/* skim top-level compounds */
+
+/*
+ * The objects of a compound that were not read yet. The lines from the
+ * "6 ..." line to the matching "-6" line are kept as they are in the file.
+ */
+struct f_lazy {
+	char	*text;
+	size_t	 len;
+	int	 line;		/* line number of the "6 ..." line */
+	int	 dx, dy;	/* translation to apply to the objects */
+};
 
 /* initialize the user color counter - then read figure file.
    Called from load_file(), merge_file(), preview_figure(), load_lib_obj(),
@@ -118,6 +135,10 @@ static float	fproto, xfigproto;	/* floating values for protocol of
 static void	merge_colors (F_compound *objects);
 static int	readfp_fig (FILE *fp, F_compound *obj, Boolean merge, int xoff,
 				int yoff, fig_settings *settings);
+static int	readsnap_fig (char *snapfile, F_compound *obj, Boolean merge,
+				int xoff, int yoff, fig_settings *settings);
+static int	finish_fig (F_compound *obj, Boolean merge, int xoff, int yoff,
+				fig_settings *settings, int resolution);
 static int	read_line (FILE *fp);
 static int	read_objects (FILE *fp, F_compound *obj, int *res);
 static void	scale_figure (F_compound *obj, float mul, int offset);
@@ -215,11 +236,26 @@ read_fig(char *file_name, F_compound *obj, Boolean merge, int xoff, int yoff, fi
 {
     FILE	   *fp;
     int		    status;
+    char	    snapfile[PATH_MAX];
 
     read_file_name = file_name;
     first_file_msg = True;
     if (uncompress_file(file_name) == False)
 	return ENOENT;		/* doesn't exist */
+
+    /* use the binary snapshot, if it is up to date */
+    if (appres.snapshots && !update_figs) {
+	snapshot_name(file_name, snapfile);
+	if (snapshot_current(file_name, snapfile)) {
+	    put_msg("Reading objects from \"%s\" ...", snapfile);
+	    status = readsnap_fig(snapfile, obj, merge, xoff, yoff, settings);
+	    if (status == 0) {
+		first_file_msg = False;
+		return status;
+	    }
+	    /* else, fall back to the Fig file */
+	}
+    }
     if ((fp = fopen(file_name, "r")) == NULL)
 	return errno;
     else {
@@ -370,8 +406,12 @@ readfp_fig(FILE *fp, F_compound *obj, Boolean merge, int xoff, int yoff, fig_set
 		}
 	    }
 	}
+	/* top-level compounds may be read later, see expand_compound() */
+	read_lazily = appres.lazy_compounds && proto >= 32 && !merge &&
+		!update_figs && !preview_in_progress && scale_factor == 1.0;
 	/* now read the figure itself */
 	status = read_objects(fp, obj, &resolution);
+	read_lazily = False;
 
     } else {
 	file_msg("Seeing if this figure is Fig format 1.3");
@@ -384,6 +424,83 @@ readfp_fig(FILE *fp, F_compound *obj, Boolean merge, int xoff, int yoff, fig_set
 	return read_return(status);
     }
 
+    return finish_fig(obj, merge, xoff, yoff, settings, resolution);
+}
+
+/*
+ * Read the binary snapshot of a Fig file. The snapshot holds the figure
+ * at the current resolution and protocol, but the figure must still be
+ * scaled and shifted as requested by the user.
+ */
+
+static int
+readsnap_fig(char *snapfile, F_compound *obj, Boolean merge, int xoff,
+		int yoff, fig_settings *settings)
+{
+    int		    status;
+
+    defer_update_layers = 1;	/* prevent update_layers() from updating */
+    num_object = 0;
+    proto = 32;		/* snapshots are written in the current protocol */
+    TFX = False;
+    status = read_snapshot(snapfile, obj, settings);
+    if (status != 0)
+	return read_return(status);
+    return finish_fig(obj, merge, xoff, yoff, settings, PIX_PER_INCH);
+}
+
+/*
+ * Read the objects of a record of the edit journal, see f_journal.c.
+ * A record holds the resolution line, user color definitions and objects
+ * of a Fig file written by this xfig, hence nothing needs to be converted,
+ * scaled or shifted. The user colors are merged into those of the figure.
+ */
+
+int
+read_journal_objects(FILE *fp, F_compound *obj)
+{
+    int		    status;
+    int		    i;
+    int		    resolution;
+
+    n_num_usr_cols = -1;
+    for (i=0; i<MAX_USR_COLS; i++)
+	n_colorFree[i] = True;
+
+    defer_update_layers = 1;	/* prevent update_layers() from updating */
+    num_object = 0;
+    numcom = 0;
+    if (!com_alloc)
+	for (i=0; i<MAXCOMMENTS; i++)
+	    comments[i] = (char *) NULL;
+    com_alloc = True;
+    memset(obj, 0, COMOBJ_SIZE);
+    line_no = 1;
+    proto = 32;
+    TFX = False;
+
+#ifdef I18N
+    setlocale(LC_NUMERIC, "C");
+#endif  /* I18N */
+    status = read_objects(fp, obj, &resolution);
+#ifdef I18N
+    setlocale(LC_NUMERIC, "");
+#endif  /* I18N */
+    if (status == 0) {
+	n_num_usr_cols++;
+	merge_colors(obj);
+    }
+    return read_return(status);
+}
+
+/* the common part of reading a Fig file or its snapshot */
+
+static int
+finish_fig(F_compound *obj, Boolean merge, int xoff, int yoff,
+		fig_settings *settings, int resolution)
+{
+    int		    status = 0;
+
     n_num_usr_cols++;	/* number of user colors = max index + 1 */
     /***************************************************************************
 	The older versions of xfig (1.3 to 2.1) used values that ended in 4 or 9
@@ -454,7 +571,7 @@ readfp_fig(FILE *fp, F_compound *obj, Boolean merge, int xoff, int yoff, fig_set
 
     /* return with status */
     return read_return(status);
-    }
+}
 
 /* clear defer_update_layers counter, update the layer buttons and return status */
 
@@ -500,6 +617,9 @@ read_objects(FILE *fp, F_compound *obj, int *res)
 
     /* save the resolution for caller */
     *res = ppi;
+    /* the objects in a skimmed compound could not be scaled */
+    if (ppi != PIX_PER_INCH)
+	read_lazily = False;
 
     while (read_line(fp) > 0) {
 	if (sscanf(buf, "%d", &object) != 1) {
@@ -560,7 +680,11 @@ read_objects(FILE *fp, F_compound *obj, int *res)
 	    num_object++;
 	    break;
 	case O_COMPOUND:
-	    if ((c = read_compoundobject(fp)) == NULL)
+	    if (read_lazily)
+		c = skim_compoundobject(fp);
+	    else
+		c = read_compoundobject(fp);
+	    if (c == NULL)
 		continue;
 	    if (lc)
 		lc = (lc->next = c);
@@ -838,6 +962,230 @@ read_compoundobject(FILE *fp)
     }
 }
 
+/*
+ * Read only the bounding box of a top-level compound and keep the lines
+ * of the compound as text, if the -lazy_compounds option is set.
+ * The objects in the compound are read by expand_compound(), when the
+ * compound is drawn at a visible size, opened, edited or searched.
+ * A compound without a bounding box is read right away.
+ */
+
+static F_compound *
+skim_compoundobject(FILE *fp)
+{
+    F_compound	   *com;
+    struct f_lazy  *lazy;
+    char	   *text, *p;
+    size_t	    len, size, n;
+    int		    level, x1, y1, x2, y2;
+    Boolean	    bol;
+
+    if (sscanf(buf, "%*d%d%d%d%d", &x1, &y1, &x2, &y2) != 4 ||
+		(x1 == 0 && y1 == 0 && x2 == 0 && y2 == 0))
+	return read_compoundobject(fp);
+
+    if ((com = create_compound()) == NULL ||
+		(lazy = malloc(sizeof(struct f_lazy))) == NULL) {
+	free(com);
+	numcom = 0;
+	return NULL;
+    }
+    com->comments = attach_comments();
+    com->nwcorner.x = x1;
+    com->nwcorner.y = y1;
+    com->secorner.x = x2;
+    com->secorner.y = y2;
+    lazy->line = line_no;
+    lazy->dx = lazy->dy = 0;
+
+    /* copy lines up to the matching "-6", only count at line starts */
+    len = strlen(buf);
+    size = 2 * BUF_SIZE;
+    if ((text = malloc(size)) == NULL) {
+	free(lazy);
+	free(com);
+	return NULL;
+    }
+    memcpy(text, buf, len);
+    level = 1;
+    bol = True;
+    while (level > 0 && fgets(buf, BUF_SIZE, fp) != NULL) {
+	n = strlen(buf);
+	if (len + n >= size) {
+	    size *= 2;
+	    if ((p = realloc(text, size)) == NULL) {
+		free(text);
+		free(lazy);
+		free(com);
+		return NULL;
+	    }
+	    text = p;
+	}
+	memcpy(text + len, buf, n);
+	len += n;
+	if (bol) {
+	    line_no++;
+	    if (buf[0] == '6' && isspace((unsigned char)buf[1]))
+		level++;
+	    else if (buf[0] == '-' && buf[1] == '6' &&
+			(buf[2] == '\0' || isspace((unsigned char)buf[2])))
+		level--;
+	}
+	bol = n > 0 && buf[n - 1] == '\n';
+    }
+    lazy->text = text;
+    lazy->len = len;
+    com->lazy = lazy;
+    ++lazy_compounds;
+
+    /* the compound is not closed, read what there is */
+    if (level > 0)
+	read_compoundbody(com);
+    return com;
+}
+
+/* read the objects kept by skim_compoundobject() into com */
+
+static void
+read_compoundbody(F_compound *com)
+{
+    struct f_lazy  *lazy = com->lazy;
+    F_compound	   *body = NULL;
+    FILE	   *fp;
+
+    com->lazy = NULL;
+    --lazy_compounds;
+    if ((fp = tmpfile()) != NULL) {
+	if (fwrite(lazy->text, 1, lazy->len, fp) == lazy->len &&
+		    fseek(fp, 0L, SEEK_SET) == 0) {
+	    line_no = lazy->line - 1;
+	    numcom = 0;
+	    if (read_line(fp) > 0)
+		body = read_compoundobject(fp);
+	}
+	fclose(fp);
+    }
+    if (body == NULL) {
+	file_msg("Cannot read the objects of the compound at line %d.",
+			lazy->line);
+    } else {
+	if (lazy->dx != 0 || lazy->dy != 0)
+	    translate_compound(body, lazy->dx, lazy->dy);
+	com->arcs = body->arcs;
+	com->compounds = body->compounds;
+	com->ellipses = body->ellipses;
+	com->lines = body->lines;
+	com->splines = body->splines;
+	com->texts = body->texts;
+	free(body->comments);
+	free(body);
+    }
+    free(lazy->text);
+    free(lazy);
+}
+
+static Boolean
+contains_compound(F_compound *list, F_compound *c)
+{
+    for (; list != NULL; list = list->next)
+	if (list == c || contains_compound(list->compounds, c))
+	    return True;
+    return False;
+}
+
+/*
+ * Read the objects of a compound that was skimmed on loading the figure.
+ * The objects are checked against the user colors of the current figure.
+ */
+
+void
+expand_compound(F_compound *c)
+{
+    Boolean	    savefree[MAX_USR_COLS];
+    F_compound	   *o;
+    int		    old_line, old_proto, old_tfx;
+
+    if (c == NULL || c->lazy == NULL)
+	return;
+
+    memcpy(savefree, n_colorFree, sizeof(savefree));
+    memcpy(n_colorFree, colorFree, sizeof(savefree));
+    old_line = line_no;
+    old_proto = proto;
+    old_tfx = TFX;
+    proto = 32;
+    TFX = False;
+#ifdef I18N
+    setlocale(LC_NUMERIC, "C");
+#endif  /* I18N */
+    read_compoundbody(c);
+#ifdef I18N
+    setlocale(LC_NUMERIC, "");
+#endif  /* I18N */
+    line_no = old_line;
+    proto = old_proto;
+    TFX = old_tfx;
+    memcpy(n_colorFree, savefree, sizeof(savefree));
+
+    /* the depths of the new objects count, if they are in the figure */
+    for (o = &objects; o != NULL; o = o->parent)
+	if (contains_compound(o->compounds, c)) {
+	    add_compound_depth(c);
+	    break;
+	}
+}
+
+/* read the objects of all compounds in list and in their members */
+
+void
+expand_compounds(F_compound *list)
+{
+    F_compound	   *c;
+
+    if (lazy_compounds == 0)
+	return;
+    for (c = list; c != NULL; c = c->next) {
+	expand_compound(c);
+	expand_compounds(c->compounds);
+    }
+}
+
+/* move a skimmed compound, the objects are moved when they are read */
+
+void
+translate_lazy_compound(F_compound *c, int dx, int dy)
+{
+    c->nwcorner.x += dx;
+    c->nwcorner.y += dy;
+    c->secorner.x += dx;
+    c->secorner.y += dy;
+    c->lazy->dx += dx;
+    c->lazy->dy += dy;
+}
+
+/*
+ * Write the lines of a skimmed compound as they were read.
+ * Return -1, if the compound was moved and must be read first.
+ */
+
+int
+write_lazy_compound(FILE *fp, F_compound *c)
+{
+    if (c->lazy->dx != 0 || c->lazy->dy != 0)
+	return -1;
+    fwrite(c->lazy->text, 1, c->lazy->len, fp);
+    return 0;
+}
+
+void
+free_lazy_compound(F_compound *c)
+{
+    free(c->lazy->text);
+    free(c->lazy);
+    c->lazy = NULL;
+    --lazy_compounds;
+}
+
 static F_ellipse *
 read_ellipseobject(void)
 {
@@ -16,6 +16,7 @@
  *
  */
 
+#include <stdio.h>		/* FILE */
 #include <X11/Intrinsic.h>	/* Boolean */
 #include <X11/Xlib.h>		/* True, False*/
 
@@ -36,6 +37,7 @@ extern int	 defer_update_layers;	/* if == 0, update_layers() updates */
 extern int	 line_no;
 extern int	 num_object;
 extern char	*read_file_name;
+extern int	 lazy_compounds;	/* compounds not read yet */
 
 /* structure which is filled by readfp_fig */
 typedef struct {
@@ -54,6 +56,13 @@ extern int	 read_figc(char *file_name, F_compound *obj, Boolean merge,
 	Boolean remapimages, int xoff, int yoff, fig_settings *settings);
 extern int	 read_fig(char *file_name, F_compound *obj, Boolean merge,
 			     int xoff, int yoff, fig_settings *settings);
+extern int	read_journal_objects(FILE *fp, F_compound *obj);
+extern void	update_settings(fig_settings *settings);
+extern void	expand_compound(F_compound *c);
+extern void	expand_compounds(F_compound *list);
+extern void	translate_lazy_compound(F_compound *c, int dx, int dy);
+extern int	write_lazy_compound(FILE *fp, F_compound *c);
+extern void	free_lazy_compound(F_compound *c);
 extern int	parse_papersize(char *size);
 extern void	fix_angle (float *angle);
 extern void	swap_colors (void);
@@ -522,16 +522,24 @@ read_1_3_textobject(FILE *fp)
 	return (NULL);
     }
 
-    /* get the font struct */
-    t->zoom = zoomscale;
-    t->fontstruct = lookfont(x_fontnum(psfont_text(t), t->font),
-			round(t->size*display_zoomscale));
-
     if (t->font >= MAXFONT(t)) {
 	file_msg("Invalid text font (%d) at line %d, setting to DEFAULT.",
 		t->font, line_no);
 	t->font = DEFAULT;
     }
+
+    /* without a display (xfig -update), keep the length and ascent
+       given in the file; they are recalculated when the figure is loaded */
+    if (update_figs) {
+	t->descent = 0;
+	return (t);
+    }
+
+    /* get the font struct */
+    t->zoom = zoomscale;
+    t->fontstruct = lookfont(x_fontnum(psfont_text(t), t->font),
+			round(t->size*display_zoomscale));
+
     /* now calculate the actual length and height of the string in fig units */
     tx_dim = textsize(t->fontstruct, strlen(t->cstring), t->cstring);
     t->length = round(tx_dim.length);
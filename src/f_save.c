@@ -31,6 +31,7 @@
 
 #include "e_compound.h"
 #include "f_load.h"
+#include "f_snapshot.h"
 #include "u_bound.h"
 
 static int	write_tmpfile = 0;
@@ -49,6 +50,8 @@ void write_ellipse (FILE *fp, F_ellipse *e);
 void write_line (FILE *fp, F_line *l);
 void write_spline (FILE *fp, F_spline *s);
 void write_text (FILE *fp, F_text *t);
+void write_object (FILE *fp, int type, void *obj);
+char *object_string (int type, void *obj);
 void write_comments (FILE *fp, char *com);
 void write_colordefs (FILE *fp);
 
@@ -90,6 +93,11 @@ int write_file(char *file_name, Boolean update_recent)
     if (!update_figs)
 	put_msg("%d object(s) saved in \"%s\"", num_object, file_name);
 
+    /* keep the binary snapshot up to date */
+    if (appres.snapshots && !update_figs)
+	if (write_snapshot(file_name, &objects))
+	    file_msg("Couldn't write the snapshot of %s", file_name);
+
     /* update the recent list if caller desires */
     if (update_recent)
 	update_recent_list(file_name);
@@ -313,6 +321,13 @@ void write_compound(FILE *fp, F_compound *com)
     /* any comments first */
     write_comments(fp, com->comments);
 
+    /* a compound not read yet is written as it was read */
+    if (com->lazy != NULL) {
+	if (!appres.write_v40 && write_lazy_compound(fp, com) == 0)
+	    return;
+	expand_compound(com);
+    }
+
     if (appres.write_v40) {
 	fprintf(fp, "Compound (%d %d %d %d) {\n",
 			com->nwcorner.x, com->nwcorner.y,
@@ -543,6 +558,55 @@ void write_text(FILE *fp, F_text *t)
     fprintf(fp,"\\001\n");	      /* finish off with '\001' string */
 }
 
+/* write an object of the given type */
+
+void write_object(FILE *fp, int type, void *obj)
+{
+    switch (type) {
+      case O_ARC:
+	write_arc(fp, (F_arc *) obj);
+	break;
+      case O_COMPOUND:
+	write_compound(fp, (F_compound *) obj);
+	break;
+      case O_ELLIPSE:
+	write_ellipse(fp, (F_ellipse *) obj);
+	break;
+      case O_POLYLINE:
+	write_line(fp, (F_line *) obj);
+	break;
+      case O_SPLINE:
+	write_spline(fp, (F_spline *) obj);
+	break;
+      case O_TXT:
+	write_text(fp, (F_text *) obj);
+	break;
+    }
+}
+
+/* return the text of an object as written to a Fig file, in a malloc'ed
+   string, to compare objects by their contents */
+
+char *object_string(int type, void *obj)
+{
+    static FILE	   *fp = NULL;
+    char	   *str;
+    long	    len;
+
+    if (fp == NULL && (fp = tmpfile()) == NULL)
+	return NULL;
+    rewind(fp);
+    write_object(fp, type, obj);
+    fflush(fp);
+    len = ftell(fp);
+    if ((str = malloc(len + 1)) == NULL)
+	return NULL;
+    rewind(fp);
+    len = fread(str, 1, len, fp);
+    str[len] = '\0';
+    return str;
+}
+
 /* write any arrow heads */
 
 static void
@@ -0,0 +1,1043 @@
+/*
+ * FIG : Facility for Interactive Generation of figures
+ * Copyright (c) 1985-1988 by Supoj Sutanthavibul
+ * Parts Copyright (c) 1989-2015 by Brian V. Smith
+ * Parts Copyright (c) 1991 by Paul King
+ * Parts Copyright (c) 2016-2020 by Thomas Loimer
+ *
+ * Any party obtaining a copy of these files is granted, free of charge, a
+ * full and unrestricted irrevocable, world-wide, paid up, royalty-free,
+ * nonexclusive right and license to deal in this software and documentation
+ * files (the "Software"), including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense and/or sell copies of
+ * the Software, and to permit persons who receive copies from any such
+ * party to do so, with the only requirement being that the above copyright
+ * and this permission notice remain intact.
+ *
+ */
+
+/*
+ * Binary snapshots of Fig files.
+ *
+ * A snapshot, "name.figb", is written next to "name.fig" and records the
+ * figure exactly as it is held in memory, i.e., after all the conversions
+ * done by read_fig(). It is versioned and position-independent: objects
+ * refer to their points, shape factors and strings by index or offset into
+ * separate tables, never by pointer. Hence the file can be mapped into
+ * memory and converted to a F_compound without any tokenizing.
+ * The modification and change times, the inode and the size of the Fig
+ * file the snapshot was made from are stored in the header. A snapshot is
+ * only used while these still match the Fig file, and if it was written
+ * after the time stamp of the Fig file ticked over. Otherwise, the Fig file
+ * might have been changed again within the same tick.
+ *
+ * Layout:
+ *	snap_header
+ *	user colors	snap_color[num_colors]
+ *	points		int32_t x, y [num_points]
+ *	shape factors	double [num_sfactors]
+ *	strings		NUL-terminated, referenced by offset
+ *	records		one record per object, a compound is followed by
+ *			its members and a record with code O_END_COMPOUND
+ * Each section starts on an 8-byte boundary.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
+
+#include "resources.h"
+#include "object.h"
+#include "mode.h"
+
+#include "f_picobj.h"
+#include "f_read.h"
+#include "f_snapshot.h"
+#include "u_create.h"
+#include "u_fonts.h"
+#include "u_free.h"
+#include "w_drawprim.h"
+#include "w_msgpanel.h"
+#include "w_setup.h"
+#include "w_util.h"
+#include "w_zoom.h"
+
+#include "xfig_math.h"
+
+#define SNAP_MAGIC	"FIGB"
+#define SNAP_VERSION	2
+#define SNAP_BYTEORDER	0x01020304
+#define SNAP_NONE	(-1)	/* string offset or index of "no object" */
+
+/* the nanoseconds of the time stamps, 0 if not known */
+#ifdef HAVE_STRUCT_STAT_ST_MTIM_TV_NSEC
+#define MTIME_NSEC(st)	((int64_t) (st).st_mtim.tv_nsec)
+#define CTIME_NSEC(st)	((int64_t) (st).st_ctim.tv_nsec)
+#else
+#define MTIME_NSEC(st)	((int64_t) 0)
+#define CTIME_NSEC(st)	((int64_t) 0)
+#endif
+
+typedef struct {
+	char	magic[4];
+	int32_t	version;
+	int32_t	byteorder;	/* SNAP_BYTEORDER, as written */
+	int32_t	resolution;
+	int64_t	src_mtime;	/* of the Fig file the snapshot belongs to */
+	int64_t	src_mtime_nsec;
+	int64_t	src_ctime, src_ctime_nsec;
+	int64_t	src_ino;
+	int64_t	src_size;
+	int32_t	landscape, flushleft, units, papersize;
+	float	magnification;
+	int32_t	multiple, transparent, num_objects;
+	int64_t	comments;	/* comments of the whole figure */
+	int64_t	colors_off, num_colors;
+	int64_t	points_off, num_points;
+	int64_t	sfactors_off, num_sfactors;
+	int64_t	strings_off, strings_size;
+	int64_t	records_off, records_size;
+} snap_header;
+
+typedef struct {
+	int32_t	num;		/* 0 ... MAX_USR_COLS-1 */
+	int32_t	red, green, blue;
+} snap_color;
+
+typedef struct {
+	int32_t	code;		/* O_ELLIPSE, ..., O_END_COMPOUND */
+	int32_t	size;		/* size of the whole record */
+	int64_t	comments;
+} snap_head;
+
+typedef struct {
+	int32_t	present;
+	int32_t	type, style;
+	float	thickness, wd, ht;
+} snap_arrow;
+
+typedef struct {
+	snap_head	h;
+	int32_t		type, style, thickness, pen_color, fill_color;
+	int32_t		fill_style, depth, pen_style;
+	float		style_val, angle;
+	int32_t		direction;
+	int32_t		center_x, center_y, radius_x, radius_y;
+	int32_t		start_x, start_y, end_x, end_y;
+} snap_ellipse;
+
+typedef struct {
+	snap_head	h;
+	int32_t		type, style, thickness, pen_color, fill_color;
+	int32_t		fill_style, depth, pen_style;
+	float		style_val;
+	int32_t		cap_style, direction;
+	float		angle, center_x, center_y;
+	int32_t		point[6];
+	snap_arrow	arrow[2];
+} snap_arc;
+
+typedef struct {
+	snap_head	h;
+	int32_t		type, style, thickness, pen_color, fill_color;
+	int32_t		fill_style, depth, pen_style;
+	float		style_val;
+	int32_t		cap_style, join_style, radius;
+	snap_arrow	arrow[2];
+	int32_t		is_pic, pic_flipped;
+	int64_t		pic_file;
+	int64_t		first_point, num_points;
+} snap_line;
+
+typedef struct {
+	snap_head	h;
+	int32_t		type, style, thickness, pen_color, fill_color;
+	int32_t		fill_style, depth, pen_style;
+	float		style_val;
+	int32_t		cap_style;
+	snap_arrow	arrow[2];
+	int64_t		first_point, num_points;
+	int64_t		first_sfactor, num_sfactors;
+} snap_spline;
+
+typedef struct {
+	snap_head	h;
+	int32_t		type, font, size, color, depth;
+	float		angle;
+	int32_t		flags, ascent, length, descent;
+	int32_t		base_x, base_y, pen_style;
+	int32_t		pad;
+	int64_t		cstring;
+} snap_text;
+
+typedef struct {
+	snap_head	h;
+	int32_t		nw_x, nw_y, se_x, se_y;
+} snap_compound;
+
+/* growable buffer used when writing a snapshot */
+typedef struct {
+	char	*data;
+	size_t	 len, size;
+} snap_buf;
+
+/* the mapped snapshot, while reading */
+typedef struct {
+	const char	*rec, *rec_end;
+	const int32_t	*points;
+	int64_t		 num_points;
+	const double	*sfactors;
+	int64_t		 num_sfactors;
+	const char	*strings;
+	int64_t		 strings_size;
+	int		 num_object;
+} snap_map;
+
+static int	 buf_add(snap_buf *b, const void *data, size_t n);
+static int64_t	 buf_string(snap_buf *b, const char *s);
+static int	 put_objects(F_compound *c, snap_buf *bufs, int toplevel);
+static int	 get_objects(snap_map *m, F_compound *com, int toplevel);
+static char	*get_string(snap_map *m, int64_t off);
+static F_point	*get_points(snap_map *m, int64_t first, int64_t num);
+
+#define ALIGN8(n)	(((n) + 7) & ~((size_t) 7))
+
+/* indices into the array of buffers */
+#define B_COLORS	0
+#define B_POINTS	1
+#define B_SFACTORS	2
+#define B_STRINGS	3
+#define B_RECORDS	4
+#define B_NUM		5
+
+/*
+ * Make the name of the snapshot from the name of a Fig file,
+ * "name.fig" -> "name.figb", "name" -> "name.figb".
+ */
+
+void
+snapshot_name(char *figfile, char *snapfile)
+{
+    size_t	len = strlen(figfile);
+
+    if (len > 4 && strcmp(figfile + len - 4, ".fig") == 0)
+	sprintf(snapfile, "%s%s", figfile, SNAPSHOT_SUFFIX);
+    else
+	sprintf(snapfile, "%s.fig%s", figfile, SNAPSHOT_SUFFIX);
+}
+
+Boolean
+is_snapshot_name(char *file)
+{
+    size_t	len = strlen(file);
+
+    return len > 5 && strcmp(file + len - 5, ".fig" SNAPSHOT_SUFFIX) == 0;
+}
+
+static Boolean
+header_ok(snap_header *h)
+{
+    return strncmp(h->magic, SNAP_MAGIC, 4) == 0 &&
+		h->version == SNAP_VERSION && h->byteorder == SNAP_BYTEORDER;
+}
+
+/*
+ * Return True, if snapfile exists, can be read by this version of xfig
+ * and was made from figfile as it is now.
+ */
+
+Boolean
+snapshot_current(char *figfile, char *snapfile)
+{
+    struct stat	    st, snap_st;
+    snap_header	    h;
+    int		    fd;
+    ssize_t	    n;
+
+    if (stat(figfile, &st) != 0)
+	return False;
+    if ((fd = open(snapfile, O_RDONLY)) < 0)
+	return False;
+    if (fstat(fd, &snap_st) != 0) {
+	close(fd);
+	return False;
+    }
+    n = read(fd, &h, sizeof(h));
+    close(fd);
+    if (n != (ssize_t) sizeof(h) || !header_ok(&h))
+	return False;
+    if (h.src_mtime != (int64_t) st.st_mtime ||
+		h.src_mtime_nsec != MTIME_NSEC(st) ||
+		h.src_ctime != (int64_t) st.st_ctime ||
+		h.src_ctime_nsec != CTIME_NSEC(st) ||
+		h.src_ino != (int64_t) st.st_ino ||
+		h.src_size != (int64_t) st.st_size)
+	return False;
+    /* a snapshot written within the tick of the Fig file may be stale */
+    return snap_st.st_mtime > st.st_mtime ||
+		(snap_st.st_mtime == st.st_mtime &&
+		 MTIME_NSEC(snap_st) > MTIME_NSEC(st));
+}
+
+/***************************** writing ******************************/
+
+static int
+buf_add(snap_buf *b, const void *data, size_t n)
+{
+    size_t	    need = ALIGN8(b->len + n);
+    char	   *p;
+
+    if (need > b->size) {
+	size_t	size = b->size ? b->size : 4096;
+
+	while (size < need)
+	    size *= 2;
+	if ((p = realloc(b->data, size)) == NULL)
+	    return -1;
+	b->data = p;
+	b->size = size;
+    }
+    memcpy(b->data + b->len, data, n);
+    memset(b->data + b->len + n, 0, need - b->len - n);
+    b->len = need;
+    return 0;
+}
+
+/* strings are packed, not aligned */
+
+static int64_t
+buf_string(snap_buf *b, const char *s)
+{
+    size_t	    n;
+    int64_t	    off;
+    char	   *p;
+
+    if (s == NULL)
+	return SNAP_NONE;
+    n = strlen(s) + 1;
+    if (b->len + n > b->size) {
+	size_t	size = b->size ? b->size : 4096;
+
+	while (size < b->len + n)
+	    size *= 2;
+	if ((p = realloc(b->data, size)) == NULL)
+	    return SNAP_NONE;
+	b->data = p;
+	b->size = size;
+    }
+    off = b->len;
+    memcpy(b->data + b->len, s, n);
+    b->len += n;
+    return off;
+}
+
+static void
+put_arrow(snap_arrow *sa, F_arrow *a)
+{
+    memset(sa, 0, sizeof(snap_arrow));
+    if (a == NULL)
+	return;
+    sa->present = 1;
+    sa->type = a->type;
+    sa->style = a->style;
+    sa->thickness = a->thickness;
+    sa->wd = a->wd;
+    sa->ht = a->ht;
+}
+
+static int
+put_points(F_point *p, snap_buf *b, int64_t *first, int64_t *num)
+{
+    int32_t	    xy[2];
+
+    *first = b->len / sizeof(xy);
+    for (*num = 0; p != NULL; p = p->next, ++*num) {
+	xy[0] = p->x;
+	xy[1] = p->y;
+	if (buf_add(b, xy, sizeof(xy)))
+	    return -1;
+    }
+    return 0;
+}
+
+#define PUT_HEAD(r, c, o)	(r).h.code = (c); (r).h.size = ALIGN8(sizeof(r)); \
+				(r).h.comments = buf_string(&bufs[B_STRINGS], \
+							(o)->comments)
+
+#define PUT_COMMON(r, o)	(r).type = (o)->type; (r).style = (o)->style; \
+				(r).thickness = (o)->thickness; \
+				(r).pen_color = (o)->pen_color; \
+				(r).fill_color = (o)->fill_color; \
+				(r).fill_style = (o)->fill_style; \
+				(r).depth = (o)->depth; \
+				(r).pen_style = (o)->pen_style; \
+				(r).style_val = (o)->style_val
+
+/* write the records of all objects in c, in the order used by write_objects() */
+
+static int
+put_objects(F_compound *c, snap_buf *bufs, int toplevel)
+{
+    F_arc	   *a;
+    F_compound	   *cc;
+    F_ellipse	   *e;
+    F_line	   *l;
+    F_spline	   *s;
+    F_text	   *t;
+    snap_buf	   *rec = &bufs[B_RECORDS];
+
+    for (a = c->arcs; a != NULL; a = a->next) {
+	snap_arc	r;
+
+	memset(&r, 0, sizeof(r));
+	PUT_HEAD(r, O_ARC, a);
+	PUT_COMMON(r, a);
+	r.cap_style = a->cap_style;
+	r.direction = a->direction;
+	r.angle = a->angle;
+	r.center_x = a->center.x;
+	r.center_y = a->center.y;
+	r.point[0] = a->point[0].x; r.point[1] = a->point[0].y;
+	r.point[2] = a->point[1].x; r.point[3] = a->point[1].y;
+	r.point[4] = a->point[2].x; r.point[5] = a->point[2].y;
+	put_arrow(&r.arrow[0], a->for_arrow);
+	put_arrow(&r.arrow[1], a->back_arrow);
+	if (buf_add(rec, &r, sizeof(r)))
+	    return -1;
+	if (toplevel)
+	    num_object++;
+    }
+    for (cc = c->compounds; cc != NULL; cc = cc->next) {
+	snap_compound	r;
+	snap_head	end;
+
+	expand_compound(cc);
+	memset(&r, 0, sizeof(r));
+	PUT_HEAD(r, O_COMPOUND, cc);
+	r.nw_x = cc->nwcorner.x;
+	r.nw_y = cc->nwcorner.y;
+	r.se_x = cc->secorner.x;
+	r.se_y = cc->secorner.y;
+	if (buf_add(rec, &r, sizeof(r)) || put_objects(cc, bufs, False))
+	    return -1;
+	end.code = O_END_COMPOUND;
+	end.size = sizeof(end);
+	end.comments = SNAP_NONE;
+	if (buf_add(rec, &end, sizeof(end)))
+	    return -1;
+	if (toplevel)
+	    num_object++;
+    }
+    for (e = c->ellipses; e != NULL; e = e->next) {
+	snap_ellipse	r;
+
+	/* write_ellipse() drops these, too */
+	if (e->radiuses.x == 0 || e->radiuses.y == 0)
+	    continue;
+	memset(&r, 0, sizeof(r));
+	PUT_HEAD(r, O_ELLIPSE, e);
+	PUT_COMMON(r, e);
+	r.angle = e->angle;
+	r.direction = e->direction;
+	r.center_x = e->center.x;	r.center_y = e->center.y;
+	r.radius_x = e->radiuses.x;	r.radius_y = e->radiuses.y;
+	r.start_x = e->start.x;		r.start_y = e->start.y;
+	r.end_x = e->end.x;		r.end_y = e->end.y;
+	if (buf_add(rec, &r, sizeof(r)))
+	    return -1;
+	if (toplevel)
+	    num_object++;
+    }
+    for (l = c->lines; l != NULL; l = l->next) {
+	snap_line	r;
+
+	if (l->points == NULL)
+	    continue;
+	memset(&r, 0, sizeof(r));
+	PUT_HEAD(r, O_POLYLINE, l);
+	PUT_COMMON(r, l);
+	r.cap_style = l->cap_style;
+	r.join_style = l->join_style;
+	r.radius = l->radius;
+	put_arrow(&r.arrow[0], l->for_arrow);
+	put_arrow(&r.arrow[1], l->back_arrow);
+	r.pic_file = SNAP_NONE;
+	if (l->type == T_PICTURE && l->pic) {
+	    r.is_pic = 1;
+	    r.pic_flipped = l->pic->flipped;
+	    if (l->pic->pic_cache)
+		r.pic_file = buf_string(&bufs[B_STRINGS],
+					l->pic->pic_cache->file);
+	}
+	if (put_points(l->points, &bufs[B_POINTS], &r.first_point,
+				&r.num_points))
+	    return -1;
+	if (buf_add(rec, &r, sizeof(r)))
+	    return -1;
+	if (toplevel)
+	    num_object++;
+    }
+    for (s = c->splines; s != NULL; s = s->next) {
+	snap_spline	r;
+	F_sfactor	*sf;
+
+	if (s->points == NULL)
+	    continue;
+	memset(&r, 0, sizeof(r));
+	PUT_HEAD(r, O_SPLINE, s);
+	PUT_COMMON(r, s);
+	r.cap_style = s->cap_style;
+	put_arrow(&r.arrow[0], s->for_arrow);
+	put_arrow(&r.arrow[1], s->back_arrow);
+	if (put_points(s->points, &bufs[B_POINTS], &r.first_point,
+				&r.num_points))
+	    return -1;
+	r.first_sfactor = bufs[B_SFACTORS].len / sizeof(double);
+	for (sf = s->sfactors; sf != NULL; sf = sf->next, ++r.num_sfactors)
+	    if (buf_add(&bufs[B_SFACTORS], &sf->s, sizeof(double)))
+		return -1;
+	if (buf_add(rec, &r, sizeof(r)))
+	    return -1;
+	if (toplevel)
+	    num_object++;
+    }
+    for (t = c->texts; t != NULL; t = t->next) {
+	snap_text	r;
+
+	if (t->length == 0)
+	    continue;
+	memset(&r, 0, sizeof(r));
+	PUT_HEAD(r, O_TXT, t);
+	r.type = t->type;
+	r.font = t->font;
+	r.size = t->size;
+	r.color = t->color;
+	r.depth = t->depth;
+	r.angle = t->angle;
+	r.flags = t->flags;
+	r.ascent = t->ascent;
+	r.length = t->length;
+	r.descent = t->descent;
+	r.base_x = t->base_x;
+	r.base_y = t->base_y;
+	r.pen_style = t->pen_style;
+	r.cstring = buf_string(&bufs[B_STRINGS], t->cstring);
+	if (buf_add(rec, &r, sizeof(r)))
+	    return -1;
+	if (toplevel)
+	    num_object++;
+    }
+    return 0;
+}
+
+/*
+ * Write the snapshot of obj, to be used for the Fig file figfile.
+ * The settings and user colors are taken from appres and user_colors[],
+ * as in write_fig_header(). Call after figfile was written.
+ * The snapshot is written to a temporary file, which is then renamed.
+ */
+
+int
+write_snapshot(char *figfile, F_compound *obj)
+{
+    snap_header	    h;
+    snap_buf	    bufs[B_NUM];
+    struct stat	    st;
+    char	    snapfile[PATH_MAX], tmpfile[PATH_MAX];
+    int64_t	    off, *offs[B_NUM];
+    int		    i, status = -1;
+    FILE	   *fp;
+
+    if (stat(figfile, &st) != 0)
+	return -1;
+
+    memset(&h, 0, sizeof(h));
+    memset(bufs, 0, sizeof(bufs));
+    memcpy(h.magic, SNAP_MAGIC, 4);
+    h.version = SNAP_VERSION;
+    h.byteorder = SNAP_BYTEORDER;
+    h.resolution = PIX_PER_INCH;
+    h.src_mtime = st.st_mtime;
+    h.src_mtime_nsec = MTIME_NSEC(st);
+    h.src_ctime = st.st_ctime;
+    h.src_ctime_nsec = CTIME_NSEC(st);
+    h.src_ino = st.st_ino;
+    h.src_size = st.st_size;
+    h.landscape = appres.landscape;
+    h.flushleft = appres.flushleft;
+    h.units = appres.INCHES;
+    h.papersize = appres.papersize;
+    h.magnification = appres.magnification;
+    h.multiple = appres.multiple;
+    h.transparent = appres.transparent;
+
+    for (i = 0; i < num_usr_cols; i++) {
+	snap_color	col;
+
+	if (!colorUsed[i])
+	    continue;
+	col.num = i;
+	col.red = user_colors[i].red / 256;
+	col.green = user_colors[i].green / 256;
+	col.blue = user_colors[i].blue / 256;
+	if (buf_add(&bufs[B_COLORS], &col, sizeof(col)))
+	    goto done;
+    }
+    h.num_colors = bufs[B_COLORS].len / sizeof(snap_color);
+
+    h.comments = buf_string(&bufs[B_STRINGS], obj->comments);
+    num_object = 0;
+    if (put_objects(obj, bufs, True))
+	goto done;
+    h.num_objects = num_object;
+    h.num_points = bufs[B_POINTS].len / (2 * sizeof(int32_t));
+    h.num_sfactors = bufs[B_SFACTORS].len / sizeof(double);
+    h.strings_size = bufs[B_STRINGS].len;
+    h.records_size = bufs[B_RECORDS].len;
+
+    offs[B_COLORS] = &h.colors_off;
+    offs[B_POINTS] = &h.points_off;
+    offs[B_SFACTORS] = &h.sfactors_off;
+    offs[B_STRINGS] = &h.strings_off;
+    offs[B_RECORDS] = &h.records_off;
+    off = ALIGN8(sizeof(h));
+    for (i = 0; i < B_NUM; i++) {
+	*offs[i] = off;
+	off += ALIGN8(bufs[i].len);
+    }
+
+    snapshot_name(figfile, snapfile);
+    sprintf(tmpfile, "%s.tmp", snapfile);
+    if ((fp = fopen(tmpfile, "wb")) == NULL)
+	goto done;
+    fwrite(&h, sizeof(h), 1, fp);
+    for (i = 0; i < B_NUM; i++) {
+	static const char	zeros[8];
+
+	if (bufs[i].len)
+	    fwrite(bufs[i].data, 1, bufs[i].len, fp);
+	fwrite(zeros, 1, ALIGN8(bufs[i].len) - bufs[i].len, fp);
+    }
+    i = ferror(fp);
+    if (fclose(fp) == EOF || i || rename(tmpfile, snapfile)) {
+	unlink(tmpfile);
+	goto done;
+    }
+    status = 0;
+
+done:
+    for (i = 0; i < B_NUM; i++)
+	free(bufs[i].data);
+    return status;
+}
+
+/***************************** reading ******************************/
+
+static char *
+get_string(snap_map *m, int64_t off)
+{
+    const char	   *s;
+    char	   *str;
+    size_t	    n;
+
+    if (off < 0 || off >= m->strings_size)
+	return NULL;
+    s = m->strings + off;
+    if (memchr(s, '\0', m->strings_size - off) == NULL)
+	return NULL;
+    n = strlen(s);
+    if ((str = new_string(n)) != NULL)
+	memcpy(str, s, n + 1);
+    return str;
+}
+
+static F_point *
+get_points(snap_map *m, int64_t first, int64_t num)
+{
+    F_point	   *p, *q, *first_pt = NULL;
+    const int32_t  *xy;
+    int64_t	    i;
+
+    if (first < 0 || num <= 0 || first + num > m->num_points)
+	return NULL;
+    xy = m->points + 2 * first;
+    for (p = NULL, i = 0; i < num; i++, xy += 2) {
+	if ((q = create_point()) == NULL) {
+	    free_points(first_pt);
+	    return NULL;
+	}
+	q->x = xy[0];
+	q->y = xy[1];
+	if (p)
+	    p->next = q;
+	else
+	    first_pt = q;
+	p = q;
+    }
+    return first_pt;
+}
+
+static F_arrow *
+get_arrow(snap_arrow *sa)
+{
+    if (!sa->present)
+	return NULL;
+    return new_arrow(sa->type, sa->style, sa->thickness, sa->wd, sa->ht);
+}
+
+#define GET_COMMON(o, r)	(o)->type = (r).type; (o)->style = (r).style; \
+				(o)->thickness = (r).thickness; \
+				(o)->pen_color = (r).pen_color; \
+				(o)->fill_color = (r).fill_color; \
+				(o)->fill_style = (r).fill_style; \
+				(o)->depth = (r).depth; \
+				(o)->pen_style = (r).pen_style; \
+				(o)->style_val = (r).style_val
+
+/* append o to the list whose last element is *last */
+#define APPEND(list, last, o)	if (last) \
+				    last = (last->next = o); \
+				else \
+				    last = list = o
+
+/*
+ * Read the records up to the end of the compound, or up to the end of
+ * the record section for the toplevel. Return 0 on success.
+ */
+
+static int
+get_objects(snap_map *m, F_compound *com, int toplevel)
+{
+    F_arc	   *a, *la = NULL;
+    F_compound	   *c, *lc = NULL;
+    F_ellipse	   *e, *le = NULL;
+    F_line	   *l, *ll = NULL;
+    F_spline	   *s, *ls = NULL;
+    F_text	   *t, *lt = NULL;
+    snap_head	    h;
+    const char	   *rec;
+
+    while (m->rec + sizeof(h) <= m->rec_end) {
+	rec = m->rec;
+	memcpy(&h, rec, sizeof(h));
+	if (h.size < (int32_t) sizeof(h) || h.size > m->rec_end - rec)
+	    return BAD_FORMAT;
+	m->rec += ALIGN8(h.size);
+
+	switch (h.code) {
+	case O_END_COMPOUND:
+	    return toplevel ? BAD_FORMAT : 0;
+
+	case O_ARC: {
+	    snap_arc	r;
+
+	    if (h.size < (int32_t) sizeof(r) || (a = create_arc()) == NULL)
+		return BAD_FORMAT;
+	    memcpy(&r, rec, sizeof(r));
+	    GET_COMMON(a, r);
+	    a->cap_style = r.cap_style;
+	    a->direction = r.direction;
+	    a->angle = r.angle;
+	    a->center.x = r.center_x;
+	    a->center.y = r.center_y;
+	    a->point[0].x = r.point[0]; a->point[0].y = r.point[1];
+	    a->point[1].x = r.point[2]; a->point[1].y = r.point[3];
+	    a->point[2].x = r.point[4]; a->point[2].y = r.point[5];
+	    a->for_arrow = get_arrow(&r.arrow[0]);
+	    a->back_arrow = get_arrow(&r.arrow[1]);
+	    a->comments = get_string(m, h.comments);
+	    APPEND(com->arcs, la, a);
+	    break;
+	}
+
+	case O_COMPOUND: {
+	    snap_compound	r;
+	    int			status;
+
+	    if (h.size < (int32_t) sizeof(r) || (c = create_compound()) == NULL)
+		return BAD_FORMAT;
+	    memcpy(&r, rec, sizeof(r));
+	    c->nwcorner.x = r.nw_x;
+	    c->nwcorner.y = r.nw_y;
+	    c->secorner.x = r.se_x;
+	    c->secorner.y = r.se_y;
+	    c->comments = get_string(m, h.comments);
+	    /* link it first, so that it is freed on error */
+	    APPEND(com->compounds, lc, c);
+	    if ((status = get_objects(m, c, False)) != 0)
+		return status;
+	    break;
+	}
+
+	case O_ELLIPSE: {
+	    snap_ellipse	r;
+
+	    if (h.size < (int32_t) sizeof(r) || (e = create_ellipse()) == NULL)
+		return BAD_FORMAT;
+	    memcpy(&r, rec, sizeof(r));
+	    GET_COMMON(e, r);
+	    e->angle = r.angle;
+	    e->direction = r.direction;
+	    e->center.x = r.center_x;	e->center.y = r.center_y;
+	    e->radiuses.x = r.radius_x;	e->radiuses.y = r.radius_y;
+	    e->start.x = r.start_x;	e->start.y = r.start_y;
+	    e->end.x = r.end_x;		e->end.y = r.end_y;
+	    e->comments = get_string(m, h.comments);
+	    APPEND(com->ellipses, le, e);
+	    break;
+	}
+
+	case O_POLYLINE: {
+	    snap_line	r;
+
+	    if (h.size < (int32_t) sizeof(r) || (l = create_line()) == NULL)
+		return BAD_FORMAT;
+	    memcpy(&r, rec, sizeof(r));
+	    GET_COMMON(l, r);
+	    l->cap_style = r.cap_style;
+	    l->join_style = r.join_style;
+	    l->radius = r.radius;
+	    l->for_arrow = get_arrow(&r.arrow[0]);
+	    l->back_arrow = get_arrow(&r.arrow[1]);
+	    l->comments = get_string(m, h.comments);
+	    APPEND(com->lines, ll, l);
+	    if ((l->points = get_points(m, r.first_point, r.num_points))
+			== NULL)
+		return BAD_FORMAT;
+	    if (r.is_pic) {
+		char	   *file;
+		Boolean	    dum;
+
+		if ((l->pic = create_pic()) == NULL)
+		    return BAD_FORMAT;
+		l->pic->flipped = r.pic_flipped;
+		if ((file = get_string(m, r.pic_file)) == NULL) {
+		    file = new_string(strlen(cur_file_dir) + 8);
+		    sprintf(file, "%s/<empty>", cur_file_dir);
+		}
+		if (!update_figs) {
+		    read_picobj(l->pic, file, l->pen_color, False, &dum);
+		    free(file);
+		} else {
+		    l->pic->pic_cache = create_picture_entry();
+		    l->pic->pic_cache->file = file;
+		}
+		pic_obj_read = True;
+	    }
+	    break;
+	}
+
+	case O_SPLINE: {
+	    snap_spline	r;
+	    F_sfactor	*sf, *lsf = NULL;
+	    int64_t	 i;
+
+	    if (h.size < (int32_t) sizeof(r) || (s = create_spline()) == NULL)
+		return BAD_FORMAT;
+	    memcpy(&r, rec, sizeof(r));
+	    GET_COMMON(s, r);
+	    s->cap_style = r.cap_style;
+	    s->for_arrow = get_arrow(&r.arrow[0]);
+	    s->back_arrow = get_arrow(&r.arrow[1]);
+	    s->comments = get_string(m, h.comments);
+	    s->sfactors = NULL;
+	    APPEND(com->splines, ls, s);
+	    if ((s->points = get_points(m, r.first_point, r.num_points))
+			== NULL)
+		return BAD_FORMAT;
+	    if (r.first_sfactor < 0 ||
+			r.first_sfactor + r.num_sfactors > m->num_sfactors)
+		return BAD_FORMAT;
+	    for (i = 0; i < r.num_sfactors; i++) {
+		if ((sf = create_sfactor()) == NULL)
+		    return BAD_FORMAT;
+		sf->s = m->sfactors[r.first_sfactor + i];
+		sf->next = NULL;
+		APPEND(s->sfactors, lsf, sf);
+	    }
+	    break;
+	}
+
+	case O_TXT: {
+	    snap_text	r;
+
+	    if (h.size < (int32_t) sizeof(r) || (t = create_text()) == NULL)
+		return BAD_FORMAT;
+	    memcpy(&r, rec, sizeof(r));
+	    t->type = r.type;
+	    t->font = r.font;
+	    t->size = r.size;
+	    t->color = r.color;
+	    t->depth = r.depth;
+	    t->angle = r.angle;
+	    t->flags = r.flags;
+	    t->ascent = r.ascent;
+	    t->length = r.length;
+	    t->descent = r.descent;
+	    t->base_x = r.base_x;
+	    t->base_y = r.base_y;
+	    t->pen_style = r.pen_style;
+	    t->zoom = zoomscale;
+	    t->comments = get_string(m, h.comments);
+	    APPEND(com->texts, lt, t);
+	    if ((t->cstring = get_string(m, r.cstring)) == NULL)
+		return BAD_FORMAT;
+	    if (!update_figs) {
+		PR_SIZE	    tx_dim;
+
+		/* as in read_textobject(), the fonts may differ from
+		   those used when the snapshot was written */
+		t->fontstruct = lookfont(x_fontnum(psfont_text(t), t->font),
+				t->size);
+		tx_dim = textsize(t->fontstruct, strlen(t->cstring),
+				t->cstring);
+		t->length = round(tx_dim.length);
+		t->ascent = round(tx_dim.ascent);
+		t->descent = round(tx_dim.descent);
+		if (display_zoomscale != 1.0)
+		    t->fontstruct = lookfont(x_fontnum(psfont_text(t), t->font),
+				round(t->size*display_zoomscale));
+	    }
+	    break;
+	}
+
+	default:
+	    /* unknown record, skip it */
+	    continue;
+	}
+	if (toplevel)
+	    m->num_object++;
+    }
+    return toplevel ? 0 : BAD_FORMAT;
+}
+
+/*
+ * Read the snapshot snapfile into obj. Return 0 on success, else an error
+ * code as returned by read_fig(). The user colors are put into
+ * n_user_colors[], as done by read_colordef() in f_read.c.
+ */
+
+int
+read_snapshot(char *snapfile, F_compound *obj, fig_settings *settings)
+{
+    snap_header	    h;
+    snap_map	    m;
+    struct stat	    st;
+    const char	   *base;
+    const snap_color *col;
+    int64_t	    i;
+    int		    fd, status;
+
+    if ((fd = open(snapfile, O_RDONLY)) < 0)
+	return errno;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof(h)) {
+	close(fd);
+	return BAD_FORMAT;
+    }
+#ifdef HAVE_MMAP
+    base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+	return errno;
+#else
+    {
+	char	*p;
+	ssize_t	 n, got = 0;
+
+	if ((p = malloc(st.st_size)) == NULL) {
+	    close(fd);
+	    return ENOMEM;
+	}
+	while (got < st.st_size && (n = read(fd, p + got, st.st_size - got)) > 0)
+	    got += n;
+	close(fd);
+	if (got != st.st_size) {
+	    free(p);
+	    return BAD_FORMAT;
+	}
+	base = p;
+    }
+#endif
+
+    memcpy(&h, base, sizeof(h));
+    status = BAD_FORMAT;
+    if (!header_ok(&h) || h.resolution != PIX_PER_INCH)
+	goto done;
+    /* all sections must lie within the file */
+    if (h.colors_off < 0 || h.num_colors < 0 ||
+	    h.colors_off + h.num_colors * (int64_t) sizeof(snap_color) > st.st_size ||
+	    h.points_off < 0 || h.num_points < 0 ||
+	    h.points_off + h.num_points * 2 * (int64_t) sizeof(int32_t) > st.st_size ||
+	    h.sfactors_off < 0 || h.num_sfactors < 0 ||
+	    h.sfactors_off + h.num_sfactors * (int64_t) sizeof(double) > st.st_size ||
+	    h.strings_off < 0 || h.strings_size < 0 ||
+	    h.strings_off + h.strings_size > st.st_size ||
+	    h.records_off < 0 || h.records_size < 0 ||
+	    h.records_off + h.records_size > st.st_size)
+	goto done;
+
+    settings->landscape = h.landscape;
+    settings->flushleft = h.flushleft;
+    settings->units = h.units;
+    settings->papersize = h.papersize;
+    settings->magnification = h.magnification;
+    settings->multiple = h.multiple;
+    settings->transparent = h.transparent;
+
+    col = (const snap_color *) (base + h.colors_off);
+    for (i = 0; i < h.num_colors; i++, col++) {
+	if (col->num < 0 || col->num >= MAX_USR_COLS)
+	    goto done;
+	n_user_colors[col->num].red = col->red*256;
+	n_user_colors[col->num].green = col->green*256;
+	n_user_colors[col->num].blue = col->blue*256;
+	n_colorFree[col->num] = False;
+	n_num_usr_cols = max2(col->num, n_num_usr_cols);
+    }
+
+    m.rec = base + h.records_off;
+    m.rec_end = m.rec + h.records_size;
+    m.points = (const int32_t *) (base + h.points_off);
+    m.num_points = h.num_points;
+    m.sfactors = (const double *) (base + h.sfactors_off);
+    m.num_sfactors = h.num_sfactors;
+    m.strings = base + h.strings_off;
+    m.strings_size = h.strings_size;
+    m.num_object = 0;
+
+    memset(obj, 0, COMOBJ_SIZE);
+    obj->comments = get_string(&m, h.comments);
+    if ((status = get_objects(&m, obj, True)) != 0) {
+	free_arc(&obj->arcs);
+	free_compound(&obj->compounds);
+	free_ellipse(&obj->ellipses);
+	free_line(&obj->lines);
+	free_spline(&obj->splines);
+	free_text(&obj->texts);
+	if (obj->comments)
+	    free(obj->comments);
+	memset(obj, 0, COMOBJ_SIZE);
+    } else {
+	num_object = m.num_object;
+    }
+
+done:
+#ifdef HAVE_MMAP
+    munmap((void *) base, st.st_size);
+#else
+    free((void *) base);
+#endif
+    return status;
+}
@@ -0,0 +1,38 @@
+/*
+ * FIG : Facility for Interactive Generation of figures
+ * Copyright (c) 1985-1988 by Supoj Sutanthavibul
+ * Parts Copyright (c) 1989-2015 by Brian V. Smith
+ * Parts Copyright (c) 1991 by Paul King
+ * Parts Copyright (c) 2016-2020 by Thomas Loimer
+ *
+ * Any party obtaining a copy of these files is granted, free of charge, a
+ * full and unrestricted irrevocable, world-wide, paid up, royalty-free,
+ * nonexclusive right and license to deal in this software and documentation
+ * files (the "Software"), including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense and/or sell copies of
+ * the Software, and to permit persons who receive copies from any such
+ * party to do so, with the only requirement being that the above copyright
+ * and this permission notice remain intact.
+ *
+ */
+
+#ifndef F_SNAPSHOT_H
+#define F_SNAPSHOT_H
+
+#include <X11/Intrinsic.h>	/* Boolean */
+
+#include "object.h"
+
+/* needs fig_settings from f_read.h, which has no include guard */
+
+/* suffix appended to "name.fig" to get the name of the binary snapshot */
+#define SNAPSHOT_SUFFIX		"b"
+
+extern void	snapshot_name(char *figfile, char *snapfile);
+extern Boolean	is_snapshot_name(char *file);
+extern Boolean	snapshot_current(char *figfile, char *snapfile);
+extern int	read_snapshot(char *snapfile, F_compound *obj,
+				fig_settings *settings);
+extern int	write_snapshot(char *figfile, F_compound *obj);
+
+#endif /* F_SNAPSHOT_H */
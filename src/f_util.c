@@ -26,6 +26,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
 #include "resources.h"
@@ -34,6 +36,7 @@
 #include "f_neuclrtab.h"
 #include "f_read.h"
 #include "f_save.h"		/* write_file() */
+#include "f_snapshot.h"
 #include "f_util.h"
 #include "u_create.h"		/* new_string() */
 #include "u_fonts.h"		/* psfontnum() */
@@ -65,6 +68,7 @@ void free_pixmaps (F_compound *obj);
 void add_recent_file (char *file);
 int strain_out (char *name);
 void finish_update_xfigrc (void);
+static void use_read_settings (fig_settings *settings);
 
 int
 emptyname(char *name)
@@ -662,7 +666,9 @@ void map_to_mono(F_pic *pic)
 
 void beep(void)
 {
-	XBell(tool_d,0);
+	/* no display when updating figures */
+	if (!update_figs)
+		XBell(tool_d,0);
 }
 
 /* this routine will safely copy overlapping strings */
@@ -1029,68 +1035,205 @@ void init_settings(void)
 
 } /* init_settings() */
 
-/* This is called to read a list of Fig files specified in the command line
-   and write them back (renaming the original to xxxx.fig.bak) so that they
-   are updated to the current version.
-   If the file is already in the current version it is untouched.
-*/
+/*
+ * Run convert(file) for each file given on the command line, in up to jobs
+ * child processes at a time. No X connection is needed. Each child prints
+ * a status line for its file, a summary is printed when all are done.
+ * A crash while converting one file does not stop the others.
+ * Return 1 if any file could not be converted.
+ */
 
-int
-update_fig_files(int argc, char **argv)
+static int
+reap_child(pid_t *pids, char **names, int *running)
 {
-    fig_settings    settings;
-    char	    file[PATH_MAX];
-    int		    i,col;
-    Boolean	    status;
-    int		    allstat;
+    pid_t	    pid;
+    int		    i, wstat;
 
-    /* overall status - if any one file can't be read, return status is 1 */
-    allstat = 0;
+    do {
+	if ((pid = wait(&wstat)) < 0) {
+	    *running = 0;
+	    return 1;
+	}
+	for (i = 0; i < *running && pids[i] != pid; i++)
+	    ;
+    } while (i == *running);
+
+    if (WIFSIGNALED(wstat))
+	fprintf(stderr, "* %s: *** Crashed with signal %d\n", names[i],
+			WTERMSIG(wstat));
+    --(*running);
+    pids[i] = pids[*running];
+    names[i] = names[*running];
+    return !WIFEXITED(wstat) || WEXITSTATUS(wstat) != 0;
+}
+
+static int
+run_batch(int argc, char **argv, int jobs, int (*convert)(char *file))
+{
+    pid_t	   *pids;
+    char	  **names;
+    pid_t	    pid;
+    int		    i, running, files, failed;
 
     update_figs = True;
+    if (jobs < 1)
+	jobs = 1;
+    pids = malloc(jobs * sizeof(pid_t));
+    names = malloc(jobs * sizeof(char *));
+    if (pids == NULL || names == NULL) {
+	fprintf(stderr, "xfig: out of memory\n");
+	return 1;
+    }
 
+    running = files = failed = 0;
     for (i=1; i<argc; i++) {
 	/* skip any other options the user may have given */
-	if (argv[i][0] == '-') {
+	if (argv[i][0] == '-')
 	    continue;
-	}
-	strcpy(file,argv[i]);
-	fprintf(stderr,"* Reading %s ... ",file);
-	/* reset user colors */
-	for (col=0; col<MAX_USR_COLS; col++)
-	    n_colorFree[col] = True;
-	/* read Fig file but don't import any images */
-	status = read_fig(file, &objects, DONT_MERGE, 0, 0, &settings);
-	if (status != 0) {
-	    fprintf(stderr," *** Error in reading, not updating this file\n");
-	    allstat = 1;
+	++files;
+	if (running == jobs)
+	    failed += reap_child(pids, names, &running);
+	fflush(NULL);
+	if ((pid = fork()) == 0) {
+	    i = convert(argv[i]);
+	    fflush(NULL);
+	    _exit(i);
+	} else if (pid < 0) {
+	    /* cannot fork, convert it here */
+	    failed += convert(argv[i]) != 0;
 	} else {
-	    fprintf(stderr,"Ok. Renamed to %s.bak. ",file);
-	    /* now rename original file to file.bak */
-	    renamefile(file);
-	    fprintf(stderr,"Writing as protocol %s ... ",PROTOCOL_VERSION);
-	    /* first update the settings from appres */
-	    appres.landscape = settings.landscape;
-	    appres.flushleft = settings.flushleft;
-	    appres.INCHES = settings.units;
-	    appres.papersize = settings.papersize;
-	    appres.magnification = settings.magnification;
-	    appres.multiple = settings.multiple;
-	    appres.transparent = settings.transparent;
-	    /* copy user colors */
-	    for (col=0; col<MAX_USR_COLS; col++) {
-		colorUsed[col] = !n_colorFree[col];
-		user_colors[col].red = n_user_colors[col].red;
-		user_colors[col].green = n_user_colors[col].green;
-		user_colors[col].blue = n_user_colors[col].blue;
-	    }
-	    /* now write out the new one */
-	    num_usr_cols = MAX_USR_COLS;
-	    write_file(file, False);
-	    fprintf(stderr,"Ok\n");
+	    pids[running] = pid;
+	    names[running++] = argv[i];
 	}
     }
-    return allstat;
+    while (running > 0)
+	failed += reap_child(pids, names, &running);
+
+    free(pids);
+    free(names);
+    fprintf(stderr, "xfig: %d file%s, %d failed\n", files,
+		files == 1 ? "" : "s", failed);
+    return failed ? 1 : 0;
+}
+
+/* Read one Fig file and write it back, renaming the original to xxxx.fig.bak
+   so that it is updated to the current version. */
+
+static int
+update_file(char *file)
+{
+    fig_settings    settings;
+    int		    col;
+
+    /* reset user colors */
+    for (col=0; col<MAX_USR_COLS; col++)
+	n_colorFree[col] = True;
+    /* read Fig file but don't import any images */
+    if (read_fig(file, &objects, DONT_MERGE, 0, 0, &settings) != 0) {
+	fprintf(stderr, "* %s: *** Error in reading, not updating this file\n",
+			file);
+	return 1;
+    }
+    /* now rename original file to file.bak */
+    renamefile(file);
+    /* first update the settings from appres */
+    use_read_settings(&settings);
+    /* now write out the new one */
+    if (write_file(file, False) != 0) {
+	fprintf(stderr, "* %s: *** Error in writing\n", file);
+	return 1;
+    }
+    fprintf(stderr, "* %s: Ok. Renamed to %s.bak, written as protocol %s\n",
+		file, file, PROTOCOL_VERSION);
+    return 0;
+}
+
+/* This is called to read a list of Fig files specified in the command line
+   and write them back (renaming the original to xxxx.fig.bak) so that they
+   are updated to the current version. Up to jobs files are updated
+   concurrently.
+*/
+
+int
+update_fig_files(int argc, char **argv, int jobs)
+{
+    return run_batch(argc, argv, jobs, update_file);
+}
+
+/* copy the settings and user colors of a figure just read to appres */
+
+static void
+use_read_settings(fig_settings *settings)
+{
+    int		    col;
+
+    appres.landscape = settings->landscape;
+    appres.flushleft = settings->flushleft;
+    appres.INCHES = settings->units;
+    appres.papersize = settings->papersize;
+    appres.magnification = settings->magnification;
+    appres.multiple = settings->multiple;
+    appres.transparent = settings->transparent;
+    /* copy user colors */
+    for (col=0; col<MAX_USR_COLS; col++) {
+	colorUsed[col] = !n_colorFree[col];
+	user_colors[col].red = n_user_colors[col].red;
+	user_colors[col].green = n_user_colors[col].green;
+	user_colors[col].blue = n_user_colors[col].blue;
+    }
+    num_usr_cols = MAX_USR_COLS;
+}
+
+/*
+ * Convert between Fig files and their binary snapshots (xfig -snapshot).
+ * For "name.figb" write "name.fig", the original is kept as name.fig.bak.
+ * For any other file, write its snapshot.
+ */
+
+static int
+convert_snapshot(char *file)
+{
+    fig_settings    settings;
+    char	    other[PATH_MAX];
+    int		    col;
+    int		    status;
+
+    for (col=0; col<MAX_USR_COLS; col++)
+	n_colorFree[col] = True;
+    n_num_usr_cols = -1;
+    if (is_snapshot_name(file)) {
+	status = read_snapshot(file, &objects, &settings);
+	strcpy(other, file);
+	other[strlen(other) - strlen(SNAPSHOT_SUFFIX)] = '\0';
+    } else {
+	status = read_fig(file, &objects, DONT_MERGE, 0, 0, &settings);
+	snapshot_name(file, other);
+    }
+    if (status != 0) {
+	fprintf(stderr, "* %s: *** Error in reading, not converting this file\n",
+			file);
+	return 1;
+    }
+    use_read_settings(&settings);
+    if (is_snapshot_name(file)) {
+	if (access(other, F_OK) == 0)
+	    renamefile(other);
+	status = write_file(other, False);
+    } else {
+	status = write_snapshot(file, &objects);
+    }
+    if (status != 0) {
+	fprintf(stderr, "* %s: *** Error in writing %s\n", file, other);
+	return 1;
+    }
+    fprintf(stderr, "* %s: Ok. Written %s\n", file, other);
+    return 0;
+}
+
+int
+convert_snapshots(int argc, char **argv, int jobs)
+{
+    return run_batch(argc, argv, jobs, convert_snapshot);
 }
 
 /* replace all "%f" in "program" with value in filename */
@@ -47,4 +47,5 @@ extern int	ok_to_write(char *file_name, char *op_name);
 extern void	remap_imagecolors(void);
 extern void	update_recent_files(void);
 extern void	update_xfigrc(char *name, char *string);
-extern int	update_fig_files(int argc, char **argv);
+extern int	update_fig_files(int argc, char **argv, int jobs);
+extern int	convert_snapshots(int argc, char **argv, int jobs);
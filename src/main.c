@@ -33,6 +33,10 @@
 #endif
 #include <unistd.h>
 #include <sys/types.h>
+#include <sys/stat.h>
+#ifdef HAVE_SYS_INOTIFY_H
+#include <sys/inotify.h>
+#endif
 
 #include <X11/IntrinsicP.h>
 #include <X11/CoreP.h>		/* requires X11/IntrinsicP.h */
@@ -154,6 +158,7 @@ static XtActionsRec	main_actions[] =
     {"PopupCharmap",	(XtActionProc) popup_character_map},
     {"PopupGlobals",	(XtActionProc) show_global_settings},
     {"Undo",		(XtActionProc) undo},
+    {"Redo",		(XtActionProc) redo},
     {"Paste",		(XtActionProc) paste},
     {"SpellCheck",	(XtActionProc) spell_check},
     {"Search",		(XtActionProc) popup_search_panel},
@@ -361,6 +366,25 @@ static XtResource application_resources[] = {
       XtOffset(appresPtr, autorefresh), XtRBoolean, (caddr_t) & false},
     {"write_bak", "Refresh",   XtRBoolean, sizeof(Boolean),
       XtOffset(appresPtr, write_bak), XtRBoolean, (caddr_t) & true},
+    {"snapshots", "Snapshots",   XtRBoolean, sizeof(Boolean),
+      XtOffset(appresPtr, snapshots), XtRBoolean, (caddr_t) & false},
+    {"journal", "Journal",   XtRBoolean, sizeof(Boolean),
+      XtOffset(appresPtr, journal), XtRBoolean, (caddr_t) & true},
+    {"preview_cache", "Preview_cache",   XtRBoolean, sizeof(Boolean),
+      XtOffset(appresPtr, preview_cache), XtRBoolean, (caddr_t) & true},
+    {"lazy_compounds", "Lazy_compounds",   XtRBoolean, sizeof(Boolean),
+      XtOffset(appresPtr, lazy_compounds), XtRBoolean, (caddr_t) & false},
+    {"undo_memory", "Undo_memory", XtRInt, sizeof(int),
+      XtOffset(appresPtr, undo_memory), XtRImmediate, (caddr_t) DEF_UNDO_MEMORY},
+    {"drag_proxy", "Drag_proxy", XtRInt, sizeof(int),
+      XtOffset(appresPtr, drag_proxy), XtRImmediate, (caddr_t) DEF_DRAG_PROXY},
+    {"rotated_text_cache", "Rotated_text_cache", XtRInt, sizeof(int),
+      XtOffset(appresPtr, rotated_text_cache), XtRImmediate,
+      (caddr_t) DEF_ROTATED_TEXT_CACHE},
+    {"text_greek", "Text_greek", XtRInt, sizeof(int),
+      XtOffset(appresPtr, text_greek), XtRImmediate, (caddr_t) DEF_TEXT_GREEK},
+    {"text_cull", "Text_cull", XtRInt, sizeof(int),
+      XtOffset(appresPtr, text_cull), XtRImmediate, (caddr_t) DEF_TEXT_CULL},
 
 #ifdef I18N
     {"international", "International", XtRBoolean, sizeof(Boolean),
@@ -420,6 +444,7 @@ static XrmOptionDescRec options[] =
     {"-dontshownums", ".shownums", XrmoptionNoArg, "False"},
     {"-dontshowpageborder", ".showpageborder", XrmoptionNoArg, "False"},
     {"-dontswitchcmap", ".dontswitchcmap", XrmoptionNoArg, "True"},
+    {"-drag_proxy", ".drag_proxy", XrmoptionSepArg, 0},
     {"-encoding", ".encoding", XrmoptionSepArg, 0},
     {"-exportLanguage", ".exportLanguage", XrmoptionSepArg, 0},
     {"-export_margin", ".export_margin", XrmoptionSepArg, 0},
@@ -439,11 +464,13 @@ static XrmOptionDescRec options[] =
     {"-inches", ".inches", XrmoptionNoArg, "True"},
     {"-installowncmap", ".installowncmap", XrmoptionNoArg, "True"},
     {"-internalBW", ".internalborderwidth", XrmoptionSepArg, 0},
+    {"-journal", ".journal", XrmoptionNoArg, "True"},
     {"-jpeg_quality", ".jpeg_quality", XrmoptionSepArg, 0},
     {"-keyFile", ".keyFile", XrmoptionSepArg, 0},
     {"-Landscape", ".landscape", XrmoptionNoArg, "True"},
     {"-landscape", ".landscape", XrmoptionNoArg, "True"},
     {"-latexfonts", ".latexfonts", XrmoptionNoArg, "True"},
+    {"-lazy_compounds", ".lazy_compounds", XrmoptionNoArg, "True"},
     {"-left", ".justify", XrmoptionNoArg, "False"},
     {"-library_dir", ".library_dir", XrmoptionSepArg, 0},
     {"-library_icon_size", ".library_icon_size", XrmoptionSepArg, 0},
@@ -453,9 +480,13 @@ static XrmOptionDescRec options[] =
     {"-metric", ".inches", XrmoptionNoArg, "False"},
     {"-monochrome", ".monochrome", XrmoptionNoArg, "True"},
     {"-multiple", ".multiple", XrmoptionNoArg, "True"},
+    {"-nojournal", ".journal", XrmoptionNoArg, "False"},
+    {"-nolazy_compounds", ".lazy_compounds", XrmoptionNoArg, "False"},
     {"-nooverlap", ".overlap", XrmoptionNoArg, "False"},
+    {"-nopreview_cache", ".preview_cache", XrmoptionNoArg, "False"},
     {"-normalFont", ".normalFont", XrmoptionSepArg, 0},
     {"-noscalablefonts", ".scalablefonts", XrmoptionNoArg, "False"},
+    {"-nosnapshots", ".snapshots", XrmoptionNoArg, "False"},
     {"-nosplash", ".splash", XrmoptionNoArg, "False"},
     {"-notrack", ".trackCursor", XrmoptionNoArg, "False"},
     {"-nowrite_bak", ".write_bak", XrmoptionNoArg, "False"},
@@ -465,9 +496,11 @@ static XrmOptionDescRec options[] =
     {"-pheight", ".pheight", XrmoptionSepArg, 0},
     {"-Portrait", ".landscape", XrmoptionNoArg, "False"},
     {"-portrait", ".landscape", XrmoptionNoArg, "False"},
+    {"-preview_cache", ".preview_cache", XrmoptionNoArg, "True"},
     {"-pwidth", ".pwidth", XrmoptionSepArg, 0},
     {"-right", ".justify", XrmoptionNoArg, "True"},
     {"-rigidtext", ".rigidtext", XrmoptionNoArg, "True"},
+    {"-rotated_text_cache", ".rotated_text_cache", XrmoptionSepArg, 0},
     {"-rulerthick", ".rulerthick", XrmoptionSepArg, 0},
     {"-scalablefonts", ".scalablefonts", XrmoptionNoArg, "True"},
     {"-scale_factor", ".scale_factor", XrmoptionSepArg, 0},
@@ -481,6 +514,7 @@ static XrmOptionDescRec options[] =
     {"-single", ".multiple", XrmoptionNoArg, "False"},
     {"-smooth_factor", ".smooth_factor", XrmoptionSepArg, 0},
     {"-smallicons", ".smallicons", XrmoptionNoArg, "True"},
+    {"-snapshots", ".snapshots", XrmoptionNoArg, "True"},
     {"-specialtext", ".specialtext", XrmoptionNoArg, "True"},
     {"-spellcheckcommand", ".spellcheckcommand", XrmoptionSepArg, 0},
     {"-spinner_delay", ".spinner_delay", XrmoptionSepArg, 0},
@@ -501,8 +535,11 @@ static XrmOptionDescRec options[] =
     {"-startpsFont", ".startpsFont", XrmoptionSepArg, 0},
     {"-starttextstep", ".starttextstep",  XrmoptionSepArg, 0},
     {"-tablet", ".tablet", XrmoptionNoArg, "True"},
+    {"-text_cull", ".text_cull", XrmoptionSepArg, 0},
+    {"-text_greek", ".text_greek", XrmoptionSepArg, 0},
     {"-track", ".trackCursor", XrmoptionNoArg, "True"},
     {"-transparent_color", ".transparent", XrmoptionSepArg, 0},
+    {"-undo_memory", ".undo_memory", XrmoptionSepArg, 0},
     {"-userscale", ".userscale", XrmoptionSepArg, 0},
     {"-write_v40", ".write_v40", XrmoptionNoArg, "True"},
     {"-write_bak", ".write_bak", XrmoptionNoArg, "True"},
@@ -537,6 +574,7 @@ static char *help_list[] = {
 	"[-dontshowpageborder] ",
 	"[-dontshownums] ",
 	"[-dontswitchcmap] ",
+	"[-drag_proxy <points>] ",
 	"[-encoding <ISO-8859 encoding>] ",
 	"[-exportLanguage <language>] ",
 	"[-export_margin <pixels>] ",
@@ -557,10 +595,12 @@ static char *help_list[] = {
 	"[-inches] ",
 	"[-installowncmap] ",
 	"[-internalBW <width>] ",
+	"[-journal] ",
 	"[-jpeg_quality <quality>] ",
 	"[-keyFile <file>] ",
 	"[-landscape] ",
 	"[-latexfonts] ",
+	"[-lazy_compounds] ",
 	"[-left] ",
 	"[-library_dir <directory>] ",
 	"[-library_icon_size <size>] ",
@@ -570,8 +610,12 @@ static char *help_list[] = {
 	"[-metric] ",
 	"[-monochrome] ",
 	"[-multiple] ",
+	"[-nojournal] ",
+	"[-nolazy_compounds] ",
+	"[-nopreview_cache] ",
 	"[-normalFont <font>] ",
 	"[-noscalablefonts] ",
+	"[-nosnapshots] ",
 	"[-nosplash] ",
 	"[-notrack] ",
 	"[-nowrite_bak] ",
@@ -580,9 +624,11 @@ static char *help_list[] = {
 	"[-paper_size <size>] ",
 	"[-pheight <height>] ",
 	"[-portrait] ",
+	"[-preview_cache] ",
 	"[-pwidth <width>] ",
 	"[-right] ",
 	"[-rigidtext] ",
+	"[-rotated_text_cache <kilobytes>] ",
 	"[-rulerthick <width>] ",
 	"[-scale_factor <factor>] ",
 	"[-scalablefonts] ",
@@ -596,6 +642,8 @@ static char *help_list[] = {
 	"[-single] ",
 	"[-smallicons] ",
 	"[-smooth_factor <factor>] ",
+	"[-snapshot [-j n] file1 file2 ...] ",
+	"[-snapshots] ",
 	"[-specialtext] ",
 	"[-spellcheckcommand <command>] ",
 	"[-spinner_delay <delay>] ",
@@ -611,9 +659,12 @@ static char *help_list[] = {
 	"[-startpsFont <font>] ",
 	"[-starttextstep <number>] ",
 	"[-tablet] ",
+	"[-text_cull <pixels>] ",
+	"[-text_greek <pixels>] ",
 	"[-track] ",
 	"[-transparent_color <color number>] ",
-	"[-update file1 file2 ...] ",
+	"[-undo_memory <kilobytes>] ",
+	"[-update [-j n] file1 file2 ...] ",
 	"[-userscale <scale>] ",
 	"[-userunit <units>] ",
 	"[-visual <visual>] ",
@@ -642,7 +693,9 @@ static void	parse_canvas_colors(void);
 static void	set_xpm_icon(void);
 static void	resize_canvas(void);
 static void	check_refresh(XtPointer client_data, XtIntervalId *id);
+static void	settle_refresh(XtPointer client_data, XtIntervalId *id);
 static int	setup_visual (int *argc_p, char **argv, Arg *args);
+static int	batch_args (int *argc_p, char **argv);
 static void	get_pointer_mapping (void);
 
 
@@ -659,6 +712,7 @@ main(int argc, char **argv)
     XColor	    dumcolor;
     char	   *dval;
     char	    tmpstr[PATH_MAX];
+    int		    jobs;
 
 
     export_up = False;
@@ -694,15 +748,24 @@ main(int argc, char **argv)
     if (scale_factor <= 0.0)
 	scale_factor = 1.0;
 
-    if (argc > 1 && (strcasecmp(argv[1],"-update")==0)) {
+    if (argc > 1 && (strcasecmp(argv[1],"-update")==0 ||
+			strcasecmp(argv[1],"-snapshot")==0)) {
 	/*****************************************************************/
 	/* see if user just wants to update Fig files to current version */
+	/* or convert them to or from binary snapshots			 */
 	/*****************************************************************/
 
-	/* if the fig file contains text objects,
-	   update_fig_files() depends on font information */
-	cnt = setup_visual(&argc, argv, args);
-	init_font();
+	/* no connection to the X server is made and no fonts are loaded,
+	   the text metrics are kept as found in the files; neither are the
+	   resources read, so set the defaults of those used when a figure is
+	   read and written */
+	appres.allownegcoords = True;
+	appres.tgrid_unit = "default";
+	appres.userscale = 1.0f;
+	appres.userunit = "";
+	appres.export_margin = DEF_EXPORT_MARGIN;
+	appres.encoding = 1;
+	jobs = batch_args(&argc, argv);
 	/* v1.3 fig files query display_zoomscale in read_1_3_textobject()
 	   in f_readold.c */
 	display_zoomscale = 1.0f;
@@ -719,7 +782,9 @@ main(int argc, char **argv)
 	/* but do not set correct_font_size; Originally, font sizes were given
 	   in pixel, and xfig displayed with 80 pixels to the inch. */
 
-	exit(update_fig_files(argc,argv));
+	if (strcasecmp(argv[1],"-snapshot")==0)
+	    exit(convert_snapshots(argc,argv,jobs));
+	exit(update_fig_files(argc,argv,jobs));
 
     } else if (argc > 1) {
 	char *p1,*p2,*p;
@@ -1377,6 +1442,9 @@ main(int argc, char **argv)
     if (strlen(cur_filename))
 	load_file(cur_filename, 0, 0);
 
+    /* read the object library directories in the background */
+    start_library_scan();
+
     /* reset the cursor */
     reset_cursor();
 
@@ -1601,6 +1669,48 @@ notablet:
     }
 }
 
+/*
+ * Parse the options given with -update or -snapshot, without the X toolkit.
+ * Remove all options and their arguments from argv, so only the file names
+ * remain. Return the number of files to convert concurrently, -j n.
+ */
+
+static int
+batch_args(int *argc_p, char **argv)
+{
+    int		    i, j, n;
+    int		    jobs = 1;
+
+    for (i = j = 2; i < *argc_p; i++) {
+	if (argv[i][0] != '-') {
+	    argv[j++] = argv[i];
+	    continue;
+	}
+	if (strcmp(argv[i], "-j") == 0 && i < *argc_p - 1) {
+	    jobs = atoi(argv[++i]);
+	    if (jobs < 1)
+		jobs = 1;
+	    continue;
+	}
+	if (strcasecmp(argv[i], "-write_v40") == 0)
+	    appres.write_v40 = True;
+	else if (strcasecmp(argv[i], "-allownegcoords") == 0)
+	    appres.allownegcoords = True;
+	else if (strcasecmp(argv[i], "-dontallownegcoords") == 0)
+	    appres.allownegcoords = False;
+	/* skip the argument of an option */
+	for (n = 0; n < XtNumber(options); n++)
+	    if (strcasecmp(argv[i], options[n].option) == 0) {
+		if (options[n].argKind == XrmoptionSepArg && i < *argc_p - 1)
+		    ++i;
+		break;
+	    }
+    }
+    *argc_p = j;
+    argv[j] = NULL;
+    return jobs;
+}
+
 /* setup all the visual and depth stuff */
 
 static int
@@ -1981,13 +2091,22 @@ get_pointer_mapping(void)
 }
 
 XtIntervalId refresh_timeout_id = 0;
+static	XtIntervalId refresh_settle_id = 0;
+static	Boolean	refresh_on = False;
+static	time_t	refresh_mtime;		/* state of the file when it changed */
+static	off_t	refresh_size;
+#ifdef HAVE_SYS_INOTIFY_H
+static	int	refresh_fd = -1;	/* inotify instance */
+static	int	refresh_wd = -1;	/* watch on the directory of the figure */
+static	XtInputId refresh_input_id = 0;
+#endif /* HAVE_SYS_INOTIFY_H */
 static	Widget	refresh_indicator = (Widget) NULL;
 static	Dimension	refresh_w = 0;
 static	Dimension	msg_w = 0;
 static	Dimension	new_msg_width;
 
 /* Turn on autorefresh mode
- * Add a AppTimeOut and insert a label widget to the left of the
+ * Watch the file for changes and insert a label widget to the left of the
  * message window with a red background saying "Autorefresh Mode"
  */
 
@@ -1998,8 +2117,8 @@ set_autorefresh(void)
 
 	/* get the initial timestamp */
 	figure_timestamp = file_timestamp(cur_filename);
-	refresh_timeout_id = XtAppAddTimeOut(tool_app, CHECK_REFRESH_TIME,
-			(XtTimerCallbackProc) check_refresh, (XtPointer) NULL);
+	refresh_on = True;
+	watch_refresh_file();
 	XtUnmanageChild(msg_panel);
 	if (!refresh_indicator) {
 	    FirstArg(XtNlabel, "Autorefresh Mode");
@@ -2025,7 +2144,8 @@ set_autorefresh(void)
 }
 
 /* Cancel the autorefresh mode
- * remove the timer and the indicator to the left of the message window
+ * stop watching the file and remove the indicator to the left of the
+ * message window
  */
 
 void
@@ -2033,8 +2153,20 @@ cancel_autorefresh(void)
 {
 	DeclareArgs(4);
 
-	XtRemoveTimeOut(refresh_timeout_id);
+	refresh_on = False;
+	if (refresh_timeout_id)
+	    XtRemoveTimeOut(refresh_timeout_id);
 	refresh_timeout_id = 0;
+	if (refresh_settle_id)
+	    XtRemoveTimeOut(refresh_settle_id);
+	refresh_settle_id = 0;
+#ifdef HAVE_SYS_INOTIFY_H
+	if (refresh_fd >= 0) {
+	    XtRemoveInput(refresh_input_id);
+	    close(refresh_fd);
+	    refresh_fd = refresh_wd = -1;
+	}
+#endif /* HAVE_SYS_INOTIFY_H */
 	put_msg("Autorefresh mode OFF");
 	XtUnmanageChild(msg_panel);
 	XtUnmanageChild(refresh_indicator);
@@ -2051,13 +2183,148 @@ toggle_refresh_mode(void)
 	appres.autorefresh = !appres.autorefresh;
 	if (appres.autorefresh) {
 	    set_autorefresh();
-	} else if (refresh_timeout_id) {
+	} else if (refresh_on) {
 	    cancel_autorefresh();
 	}
 	/* update the View menu */
 	refresh_view_menu();
 }
 
+/* get the modification time and size of the figure file, size -1 if the
+   file does not exist */
+
+static void
+refresh_file_state(time_t *mtime, off_t *size)
+{
+	struct stat	st;
+
+	if (stat(cur_filename, &st) == 0) {
+	    *mtime = st.st_mtime;
+	    *size = st.st_size;
+	} else {
+	    *mtime = 0;
+	    *size = -1;
+	}
+}
+
+/* wait until the file settles, a program may write it in several steps */
+
+static void
+figure_changed(void)
+{
+	refresh_file_state(&refresh_mtime, &refresh_size);
+	if (refresh_settle_id)
+	    XtRemoveTimeOut(refresh_settle_id);
+	refresh_settle_id = XtAppAddTimeOut(tool_app, REFRESH_SETTLE_TIME,
+			(XtTimerCallbackProc) settle_refresh, (XtPointer) NULL);
+}
+
+/* reload the file if it did not change during the last REFRESH_SETTLE_TIME */
+
+static void
+settle_refresh(XtPointer client_data, XtIntervalId *id)
+{
+	time_t	    mtime;
+	off_t	    size;
+
+	refresh_settle_id = 0;
+	refresh_file_state(&mtime, &size);
+	if (mtime != refresh_mtime || size != refresh_size) {
+	    figure_changed();
+	    return;
+	}
+	/* removed, or renamed to create a new one */
+	if (size < 0)
+	    return;
+	figure_timestamp = mtime;
+	reload_file(cur_filename);
+}
+
+#ifdef HAVE_SYS_INOTIFY_H
+/* read the events of the inotify instance, called by XtAppAddInput */
+
+static void
+refresh_input(XtPointer client_data, int *fd, XtInputId *id)
+{
+	union {
+	    struct inotify_event ev;	/* for the alignment */
+	    char	buf[4096];
+	} u;
+	char	   *buf = u.buf;
+	struct inotify_event *ev;
+	char	   *p;
+	ssize_t	    len;
+	Boolean	    changed = False;
+
+	while ((len = read(*fd, buf, sizeof(u.buf))) > 0) {
+	    for (p = buf; p < buf + len; p += sizeof(*ev) + ev->len) {
+		ev = (struct inotify_event *) p;
+		if (ev->mask & IN_Q_OVERFLOW)
+		    changed = True;
+		else if (ev->len > 0 &&
+			    strcmp(ev->name, xf_basename(cur_filename)) == 0)
+		    changed = True;
+	    }
+	}
+	if (changed)
+	    figure_changed();
+}
+#endif /* HAVE_SYS_INOTIFY_H */
+
+/*
+ * Watch the file for changes. With inotify, the directory of the file is
+ * watched, because programs often write a new file and rename it. Else,
+ * or if the watch cannot be set up, the file is polled.
+ * This is called again if the name of the figure changes.
+ */
+
+void
+watch_refresh_file(void)
+{
+#ifdef HAVE_SYS_INOTIFY_H
+	char	    dir[PATH_MAX];
+	char	   *p;
+#endif /* HAVE_SYS_INOTIFY_H */
+
+	if (!refresh_on)
+	    return;
+	if (refresh_settle_id)
+	    XtRemoveTimeOut(refresh_settle_id);
+	refresh_settle_id = 0;
+
+#ifdef HAVE_SYS_INOTIFY_H
+	if (refresh_fd < 0 && (refresh_fd = inotify_init1(IN_NONBLOCK |
+				IN_CLOEXEC)) >= 0)
+	    refresh_input_id = XtAppAddInput(tool_app, refresh_fd,
+			(XtPointer) XtInputReadMask,
+			(XtInputCallbackProc) refresh_input, (XtPointer) NULL);
+	if (refresh_fd >= 0) {
+	    if (refresh_wd >= 0)
+		inotify_rm_watch(refresh_fd, refresh_wd);
+	    strcpy(dir, cur_filename);
+	    if ((p = strrchr(dir, '/')) == NULL)
+		strcpy(dir, ".");
+	    else if (p == dir)
+		dir[1] = '\0';
+	    else
+		*p = '\0';
+	    refresh_wd = inotify_add_watch(refresh_fd, dir, IN_CLOSE_WRITE |
+			IN_MODIFY | IN_MOVED_TO | IN_CREATE | IN_DELETE);
+	}
+	if (refresh_wd >= 0) {
+	    if (refresh_timeout_id)
+		XtRemoveTimeOut(refresh_timeout_id);
+	    refresh_timeout_id = 0;
+	    return;
+	}
+#endif /* HAVE_SYS_INOTIFY_H */
+
+	/* poll the file */
+	if (!refresh_timeout_id)
+	    refresh_timeout_id = XtAppAddTimeOut(tool_app, CHECK_REFRESH_TIME,
+			(XtTimerCallbackProc) check_refresh, (XtPointer) NULL);
+}
+
 /* check if the file timestamp has changed since last displayed and redisplay it */
 /* This is called by XtAppAddTimeOut */
 
@@ -2068,12 +2335,12 @@ check_refresh(XtPointer client_data, XtIntervalId *id)
 
 	/* get current timestamp and reload if newer */
 	cur_timestamp = file_timestamp(cur_filename);
-	if (cur_timestamp > figure_timestamp)
-	    load_file(cur_filename, 0, 0);
+	if (cur_timestamp > figure_timestamp && !refresh_settle_id)
+	    figure_changed();
 	figure_timestamp = cur_timestamp;
 
 	/* keep being called */
-	(void) XtAppAddTimeOut(tool_app, CHECK_REFRESH_TIME,
+	refresh_timeout_id = XtAppAddTimeOut(tool_app, CHECK_REFRESH_TIME,
 			(XtTimerCallbackProc) check_refresh, (XtPointer) NULL);
 	return;
 }
@@ -24,3 +24,4 @@ extern Boolean	geomspec;
 extern void	toggle_refresh_mode(void);
 extern void	cancel_autorefresh(void);
 extern void	set_autorefresh(void);
+extern void	watch_refresh_file(void);
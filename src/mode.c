@@ -20,7 +20,9 @@
 #include "resources.h"
 #include "mode.h"
 #include "object.h"
+#include "f_journal.h"
 #include "u_fonts.h"
+#include "u_pick.h"
 #include "w_indpanel.h"
 #include "w_msgpanel.h"
 #include "w_setup.h"
@@ -265,12 +267,24 @@ void
 reset_modifiedflag(void)
 {
 	figure_modified = 0;
+	pick_changed();
 }
 
 void
 set_modifiedflag(void)
 {
 	figure_modified = 1;
+	journal_commit();
+	pick_changed();
+}
+
+/* like set_modifiedflag(), if only obj was added, deleted or changed */
+void
+set_modifiedobject(int type, void *obj)
+{
+	figure_modified = 1;
+	journal_commit();
+	pick_object_changed(type, obj);
 }
 
 void
@@ -190,6 +190,7 @@ extern Boolean	warnexist;
 
 extern void	reset_modifiedflag(void);
 extern void	set_modifiedflag(void);
+extern void	set_modifiedobject(int type, void *obj);
 extern void	reset_action_on(void);
 extern void	set_action_on(void);
 
@@ -295,6 +295,23 @@ typedef struct f_line {
 /* Text object */
 /***************/
 
+/* the bounds of a text and, at a zoom, the start of its string on the
+   canvas, kept by text_bound() and text_origin() in u_bound.c; valid while
+   the values they were computed from are equal */
+typedef struct f_text_metrics {
+	char *cstring;		/* NULL if not valid */
+	int type;
+	int flags;
+	float angle;
+	int base_x, base_y;
+	int ascent, descent, length;
+	int xmin, ymin, xmax, ymax;
+	int rx[4], ry[4];	/* the corners */
+	XFontStruct *fontstruct;	/* NULL if the origin is not valid */
+	float zoom;
+	int origin_x, origin_y;
+} F_text_metrics;
+
 typedef struct f_text {
 	int tagged;
 	int distrib;
@@ -323,6 +340,7 @@ typedef struct f_text {
 	int pen_style;
 	char *cstring;
 	char *comments;
+	F_text_metrics metrics;	/* not in file */
 	struct f_text *next;
 } F_text;
 
@@ -429,6 +447,7 @@ typedef struct f_compound {
 	Boolean draw_parent;
 	struct f_compound *compounds;
 	struct f_compound *next;
+	struct f_lazy *lazy;		/* objects not read yet, see f_read.c */
 } F_compound;
 
 typedef struct f_linkinfo {
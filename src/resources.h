@@ -107,9 +107,27 @@
 /* default border margin for export */
 #define DEF_EXPORT_MARGIN	0
 
+/* default number of points of a polyline or spline drawn while dragging
+   it (-drag_proxy) */
+#define DEF_DRAG_PROXY		1000
+
+/* default size of the cache of rotated text bitmaps, kilobytes
+   (-rotated_text_cache) */
+#define DEF_ROTATED_TEXT_CACHE	4096
+
+/* default size in pixels below which texts are greeked (-text_greek) and
+   not drawn at all (-text_cull) */
+#define DEF_TEXT_GREEK		MIN_X_FONT_SIZE
+#define DEF_TEXT_CULL		0
+
+/* default memory for the undo history, kilobytes (-undo_memory) */
+#define DEF_UNDO_MEMORY		32768
+
 /* how often to check for external file change, milliseconds (-autorefresh) */
 
 #define CHECK_REFRESH_TIME	1000
+/* reload only after the file did not change for this long, milliseconds */
+#define REFRESH_SETTLE_TIME	250
 
 /* for screen capture */
 
@@ -275,6 +293,15 @@ typedef struct _appres {
     Boolean	 crosshair;		/* draw crosshair cursor wherever the pointer is */
     Boolean	 autorefresh;		/* automatically redraw figure when file has changed */
     Boolean	 write_bak;		/* automatically rename current to .bak when saving */
+    Boolean	 snapshots;		/* write/use binary snapshots (.figb) of Fig files */
+    Boolean	 journal;		/* record changes in a journal (.fig.jnl) */
+    Boolean	 preview_cache;		/* keep the previews of figures on disk */
+    Boolean	 lazy_compounds;	/* read top-level compounds when needed */
+    int		 undo_memory;		/* memory for the undo history, kilobytes */
+    int		 drag_proxy;		/* points of a line drawn while dragging */
+    int		 rotated_text_cache;	/* cache of rotated texts, kilobytes */
+    int		 text_greek;		/* greek texts smaller, pixels */
+    int		 text_cull;		/* do not draw texts smaller, pixels */
 
 #ifdef I18N
     Boolean	 international;
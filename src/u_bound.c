@@ -180,6 +180,14 @@ void active_compound_bound(F_compound *compound, int *xmin, int *ymin, int *xmax
 	*xmin = *ymin = *xmax = *ymax = 0;
 	return;
     }
+    /* the objects of a skimmed compound are not read, see f_read.c */
+    if (compound->lazy != NULL) {
+	*xmin = compound->nwcorner.x;
+	*ymin = compound->nwcorner.y;
+	*xmax = compound->secorner.x;
+	*ymax = compound->secorner.y;
+	return;
+    }
 
     llx = lly = urx = ury = 0;
 
@@ -201,8 +209,8 @@ void active_compound_bound(F_compound *compound, int *xmin, int *ymin, int *xmax
 	}
     }
 
+    /* use the corners of the compounds within, no need to descend */
     for (c = compound->compounds; c != NULL; c = c->next) {
-	active_compound_bound(c, &sx, &sy, &bx, &by, active_only);
 	sx = c->nwcorner.x;
 	sy = c->nwcorner.y;
 	bx = c->secorner.x;
@@ -518,6 +526,31 @@ approx_spline_bound(F_spline *s, int *xmin, int *ymin, int *xmax, int *ymax)
       }
 }
 
+/*
+ * The metrics of a text are kept in t->metrics. Call text_metrics_changed()
+ * if the string is changed in place or replaced, or the font is reloaded;
+ * changes of the position, angle, justification and size are noticed.
+ */
+
+void
+text_metrics_changed(F_text *t)
+{
+    t->metrics.cstring = NULL;
+    t->metrics.fontstruct = NULL;
+}
+
+static Boolean
+text_metrics_valid(F_text *t)
+{
+    F_text_metrics  *m = &t->metrics;
+
+    return m->cstring == t->cstring && m->cstring != NULL &&
+	m->base_x == t->base_x && m->base_y == t->base_y &&
+	m->angle == t->angle && m->type == t->type &&
+	m->flags == t->flags && m->length == t->length &&
+	m->ascent == t->ascent && m->descent == t->descent;
+}
+
 /* This procedure calculates the bounding box for text.  It returns
    the min/max x and y coords of the enclosing HORIZONTAL rectangle.
    The actual corners of the rectangle are returned in (rx1,ry1)...(rx4,ry4)
@@ -529,6 +562,17 @@ void text_bound(F_text *t, int *xmin, int *ymin, int *xmax, int *ymax, int *rx1,
     int		    x1,y1, x2,y2, x3,y3, x4,y4;
     double	    cost, sint;
     double	    dcost, dsint, lcost, lsint, hcost, hsint;
+    F_text_metrics  *m = &t->metrics;
+
+    if (text_metrics_valid(t)) {
+	*xmin = m->xmin; *ymin = m->ymin;
+	*xmax = m->xmax; *ymax = m->ymax;
+	*rx1 = m->rx[0]; *ry1 = m->ry[0];
+	*rx2 = m->rx[1]; *ry2 = m->ry[1];
+	*rx3 = m->rx[2]; *ry3 = m->ry[2];
+	*rx4 = m->rx[3]; *ry4 = m->ry[3];
+	return;
+    }
 
     cost = cos((double)t->angle);
     sint = sin((double)t->angle);
@@ -571,6 +615,68 @@ void text_bound(F_text *t, int *xmin, int *ymin, int *xmax, int *ymax, int *rx1,
     *rx2=x2; *ry2=y2;
     *rx3=x3; *ry3=y3;
     *rx4=x4; *ry4=y4;
+
+    m->cstring = t->cstring;
+    m->type = t->type;
+    m->flags = t->flags;
+    m->angle = t->angle;
+    m->base_x = t->base_x;
+    m->base_y = t->base_y;
+    m->ascent = t->ascent;
+    m->descent = t->descent;
+    m->length = t->length;
+    m->xmin = *xmin; m->ymin = *ymin;
+    m->xmax = *xmax; m->ymax = *ymax;
+    m->rx[0] = x1; m->ry[0] = y1;
+    m->rx[1] = x2; m->ry[1] = y2;
+    m->rx[2] = x3; m->ry[2] = y3;
+    m->rx[3] = x4; m->ry[3] = y4;
+    m->fontstruct = NULL;
+}
+
+/*
+ * Return in (x, y) where the string of t starts when drawn on the canvas
+ * with t->fontstruct, at the current zoom. Centered and right justified
+ * texts are shifted by the length of the string in that font.
+ */
+
+void
+text_origin(F_text *t, int *x, int *y)
+{
+    PR_SIZE	    size;
+    double	    cost, sint;
+    int		    xmin, ymin, xmax, ymax;
+    int		    x1,y1, x2,y2, x3,y3, x4,y4;
+    F_text_metrics  *m = &t->metrics;
+
+    if (!text_metrics_valid(t))
+	text_bound(t, &xmin, &ymin, &xmax, &ymax,
+		   &x1,&y1, &x2,&y2, &x3,&y3, &x4,&y4);
+    if (m->fontstruct == t->fontstruct && m->zoom == display_zoomscale) {
+	*x = m->origin_x;
+	*y = m->origin_y;
+	return;
+    }
+
+    *x = t->base_x;
+    *y = t->base_y;
+    if (t->type == T_CENTER_JUSTIFIED || t->type == T_RIGHT_JUSTIFIED) {
+	cost = cos(t->angle);
+	sint = sin(t->angle);
+	size = textsize(t->fontstruct, strlen(t->cstring), t->cstring);
+	size.length = size.length/display_zoomscale;
+	if (t->type == T_CENTER_JUSTIFIED) {
+	    *x = round(*x-cost*size.length/2);
+	    *y = round(*y+sint*size.length/2);
+	} else {	/* T_RIGHT_JUSTIFIED */
+	    *x = round(*x-cost*size.length);
+	    *y = round(*y+sint*size.length);
+	}
+    }
+    m->fontstruct = t->fontstruct;
+    m->zoom = display_zoomscale;
+    m->origin_x = *x;
+    m->origin_y = *y;
 }
 
 static void
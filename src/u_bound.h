@@ -30,5 +30,7 @@ extern void ellipse_bound (F_ellipse *e, int *xmin, int *ymin, int *xmax, int *y
 extern void line_bound (F_line *l, int *xmin, int *ymin, int *xmax, int *ymax);
 extern void spline_bound (F_spline *s, int *xmin, int *ymin, int *xmax, int *ymax);
 extern void text_bound (F_text *t, int *xmin, int *ymin, int *xmax, int *ymax, int *rx1, int *ry1, int *rx2, int *ry2, int *rx3, int *ry3, int *rx4, int *ry4);
+extern void text_origin(F_text *t, int *x, int *y);
+extern void text_metrics_changed(F_text *t);
 
 #endif /* U_BOUND_H */
@@ -26,6 +26,8 @@
 #include "object.h"
 #include "e_edit.h"
 #include "e_scale.h"
+#include "f_read.h"
+#include "u_bound.h"
 #include "u_create.h"
 #include "u_free.h"
 #include "u_list.h"
@@ -626,6 +628,7 @@ create_text(void)
     t->fontstruct = 0;
     t->comments = NULL;
     t->cstring = NULL;
+    text_metrics_changed(t);
     t->next = NULL;
     return t;
 }
@@ -692,6 +695,7 @@ create_compound(void)
     c->parent = NULL;
     c->GABPtr = NULL;
     c->next = NULL;
+    c->lazy = NULL;
 
     return c;
 }
@@ -705,10 +709,12 @@ copy_compound(F_compound *c)
     F_spline	   *s, *ss;
     F_text	   *t, *tt;
     F_compound	   *cc, *ccc, *compound;
+    F_compound	    tails;
 
     if ((compound = create_compound()) == NULL)
 	return NULL;
 
+    expand_compound(c);
     compound->nwcorner = c->nwcorner;
     compound->secorner = c->secorner;
     compound->arcs = NULL;
@@ -722,47 +728,84 @@ copy_compound(F_compound *c)
     /* do comments first */
     copy_comments(&c->comments, &compound->comments);
 
+    /* append to the tails of the new lists, see tail() */
+    tails.ellipses = NULL;
     for (e = c->ellipses; e != NULL; e = e->next) {
 	if (NULL == (ee = copy_ellipse(e))) {
 	    put_msg(Err_mem);
 	    return NULL;
 	}
-	list_add_ellipse(&compound->ellipses, ee);
+	ee->next = NULL;
+	if (tails.ellipses)
+	    tails.ellipses->next = ee;
+	else
+	    compound->ellipses = ee;
+	tails.ellipses = ee;
     }
+    tails.arcs = NULL;
     for (a = c->arcs; a != NULL; a = a->next) {
 	if (NULL == (aa = copy_arc(a))) {
 	    put_msg(Err_mem);
 	    return NULL;
 	}
-	list_add_arc(&compound->arcs, aa);
+	aa->next = NULL;
+	if (tails.arcs)
+	    tails.arcs->next = aa;
+	else
+	    compound->arcs = aa;
+	tails.arcs = aa;
     }
+    tails.lines = NULL;
     for (l = c->lines; l != NULL; l = l->next) {
 	if (NULL == (ll = copy_line(l))) {
 	    put_msg(Err_mem);
 	    return NULL;
 	}
-	list_add_line(&compound->lines, ll);
+	ll->next = NULL;
+	if (tails.lines)
+	    tails.lines->next = ll;
+	else
+	    compound->lines = ll;
+	tails.lines = ll;
     }
+    tails.splines = NULL;
     for (s = c->splines; s != NULL; s = s->next) {
 	if (NULL == (ss = copy_spline(s))) {
 	    put_msg(Err_mem);
 	    return NULL;
 	}
-	list_add_spline(&compound->splines, ss);
+	ss->next = NULL;
+	if (tails.splines)
+	    tails.splines->next = ss;
+	else
+	    compound->splines = ss;
+	tails.splines = ss;
     }
+    tails.texts = NULL;
     for (t = c->texts; t != NULL; t = t->next) {
 	if (NULL == (tt = copy_text(t))) {
 	    put_msg(Err_mem);
 	    return NULL;
 	}
-	list_add_text(&compound->texts, tt);
+	tt->next = NULL;
+	if (tails.texts)
+	    tails.texts->next = tt;
+	else
+	    compound->texts = tt;
+	tails.texts = tt;
     }
+    tails.compounds = NULL;
     for (cc = c->compounds; cc != NULL; cc = cc->next) {
 	if (NULL == (ccc = copy_compound(cc))) {
 	    put_msg(Err_mem);
 	    return NULL;
 	}
-	list_add_compound(&compound->compounds, ccc);
+	ccc->next = NULL;
+	if (tails.compounds)
+	    tails.compounds->next = ccc;
+	else
+	    compound->compounds = ccc;
+	tails.compounds = ccc;
     }
     return compound;
 }
@@ -100,7 +100,10 @@ array_place_ellipse(int x, int y)
     /* erase last lengths if appres.showlengths is true */
     erase_lengths();
 
+    /* commit the action before, it keeps its own object_tails */
+    clean_up();
     tail(&objects, &object_tails);
+    begin_undo_group();
     save_ellipse = new_e;
 
     if ((!cur_numxcopies) && (!cur_numycopies)) {
@@ -140,6 +143,7 @@ array_place_ellipse(int x, int y)
     /* put all new ellipses in the saved objects structure for undo */
     saved_objects.ellipses = save_ellipse;
     set_action_object(F_ADD, O_ALL_OBJECT);
+    end_undo_group();
     /* turn back on all relevant markers */
     update_markers(new_objmask);
 }
@@ -172,7 +176,7 @@ place_ellipse_x(int x, int y)
 	set_newposition(x, y);
 	set_action_object(F_MOVE, O_ELLIPSE);
 	set_latestellipse(new_e);
-	set_modifiedflag();
+	set_modifiedobject(O_ELLIPSE, new_e);
     }
     redisplay_ellipse(new_e);
     /* turn back on all relevant markers */
@@ -228,7 +232,10 @@ array_place_arc(int x, int y)
     /* erase last lengths if appres.showlengths is true */
     erase_lengths();
 
+    /* commit the action before, it keeps its own object_tails */
+    clean_up();
     tail(&objects, &object_tails);
+    begin_undo_group();
     save_arc = new_a;
 
     if ((!cur_numxcopies) && (!cur_numycopies)) {
@@ -267,6 +274,7 @@ array_place_arc(int x, int y)
     /* put all new arcs in the saved objects structure for undo */
     saved_objects.arcs = save_arc;
     set_action_object(F_ADD, O_ALL_OBJECT);
+    end_undo_group();
     /* turn back on all relevant markers */
     update_markers(new_objmask);
 }
@@ -299,7 +307,7 @@ place_arc_x(int x, int y)
 	set_newposition(x, y);
 	set_action_object(F_MOVE, O_ARC);
 	set_latestarc(new_a);
-	set_modifiedflag();
+	set_modifiedobject(O_ARC, new_a);
     }
     redisplay_arc(new_a);
     /* turn back on all relevant markers */
@@ -361,7 +369,10 @@ array_place_line(int x, int y)
     elastic_moveline(new_l->points);
     /* erase last lengths if appres.showlengths is true */
     erase_lengths();
+    /* commit the action before, it keeps its own object_tails */
+    clean_up();
     tail(&objects, &object_tails);
+    begin_undo_group();
     save_line = new_l;
     if ((cur_numxcopies==0) && (cur_numycopies==0)) {
 	place_line(x, y);
@@ -399,6 +410,7 @@ array_place_line(int x, int y)
     /* put all new lines in the saved objects structure for undo */
     saved_objects.lines = save_line;
     set_action_object(F_ADD, O_ALL_OBJECT);
+    end_undo_group();
     /* turn back on all relevant markers */
     update_markers(new_objmask);
 }
@@ -416,6 +428,8 @@ static void
 place_line_x(int x, int y)
 {
     int		    dx, dy;
+    Boolean	    linked = cur_links != NULL;
+
     canvas_leftbut_proc = null_proc;
     canvas_middlebut_proc = null_proc;
     canvas_rightbut_proc = null_proc;
@@ -440,7 +454,11 @@ place_line_x(int x, int y)
 	cur_links = NULL;
 	set_action_object(F_MOVE, O_POLYLINE);
     }
-    set_modifiedflag();
+    /* the linked objects moved, too */
+    if (linked)
+	set_modifiedflag();
+    else
+	set_modifiedobject(O_POLYLINE, new_l);
     redisplay_line(new_l);
     /* turn back on all relevant markers */
     update_markers(new_objmask);
@@ -501,7 +519,10 @@ array_place_text(int x, int y)
     /* erase last lengths if appres.showlengths is true */
     erase_lengths();
 
+    /* commit the action before, it keeps its own object_tails */
+    clean_up();
     tail(&objects, &object_tails);
+    begin_undo_group();
     save_text = new_t;
 
     if ((!cur_numxcopies) && (!cur_numycopies)) {
@@ -540,6 +561,7 @@ array_place_text(int x, int y)
     /* put all new texts in the saved objects structure for undo */
     saved_objects.texts = save_text;
     set_action_object(F_ADD, O_ALL_OBJECT);
+    end_undo_group();
     /* turn back on all relevant markers */
     update_markers(new_objmask);
 }
@@ -591,7 +613,7 @@ place_text_x(int x, int y)
 	set_newposition(x, y);
 	set_action_object(F_MOVE, O_TXT);
 	set_latesttext(new_t);
-	set_modifiedflag();
+	set_modifiedobject(O_TXT, new_t);
     }
     redisplay_text(new_t);
     /* turn back on all relevant markers */
@@ -647,7 +669,10 @@ array_place_spline(int x, int y)
     /* erase last lengths if appres.showlengths is true */
     erase_lengths();
 
+    /* commit the action before, it keeps its own object_tails */
+    clean_up();
     tail(&objects, &object_tails);
+    begin_undo_group();
     save_spline = new_s;
 
     if ((!cur_numxcopies) && (!cur_numycopies)) {
@@ -686,6 +711,7 @@ array_place_spline(int x, int y)
     /* put all new splines in the saved objects structure for undo */
     saved_objects.splines = save_spline;
     set_action_object(F_ADD, O_ALL_OBJECT);
+    end_undo_group();
     /* turn back on all relevant markers */
     update_markers(new_objmask);
 }
@@ -718,7 +744,7 @@ place_spline_x(int x, int y)
 	set_newposition(x, y);
 	set_action_object(F_MOVE, O_SPLINE);
 	set_latestspline(new_s);
-	set_modifiedflag();
+	set_modifiedobject(O_SPLINE, new_s);
     }
     redisplay_spline(new_s);
     /* turn back on all relevant markers */
@@ -780,7 +806,10 @@ array_place_compound(int x, int y)
     /* erase last lengths if appres.showlengths is true */
     erase_lengths();
 
+    /* commit the action before, it keeps its own object_tails */
+    clean_up();
     tail(&objects, &object_tails);
+    begin_undo_group();
     save_compound = new_c;
 
     if ((!cur_numxcopies) && (!cur_numycopies)) {
@@ -819,6 +848,7 @@ array_place_compound(int x, int y)
     /* put all new compounds in the saved objects structure for undo */
     saved_objects.compounds = save_compound;
     set_action_object(F_ADD, O_ALL_OBJECT);
+    end_undo_group();
     /* turn back on all relevant markers */
     update_markers(new_objmask);
 }
@@ -837,6 +867,7 @@ static void
 place_compound_x(int x, int y)
 {
     int		    dx, dy;
+    Boolean	    linked = cur_links != NULL;
 
     canvas_leftbut_proc = null_proc;
     canvas_middlebut_proc = null_proc;
@@ -862,7 +893,11 @@ place_compound_x(int x, int y)
 	cur_links = NULL;
 	set_action_object(F_MOVE, O_COMPOUND);
     }
-    set_modifiedflag();
+    /* the linked objects moved, too */
+    if (linked)
+	set_modifiedflag();
+    else
+	set_modifiedobject(O_COMPOUND, new_c);
     redisplay_compound(new_c);
     /* turn back on all relevant markers */
     update_markers(new_objmask);
@@ -1261,14 +1261,15 @@ static char    *hidden_text_string = "<<>>";
 
 void draw_text(F_text *text, int op)
 {
-    PR_SIZE	    size;
     int		    x,y;
     int		    xmin, ymin, xmax, ymax;
     int		    x1,y1, x2,y2, x3,y3, x4,y4;
-    double	    cost, sint;
+    Boolean	    loaded = True;
 
-    if (text->zoom != zoomscale || text->fontstruct == (XFontStruct*) 0)
+    if (text->fontstruct == (XFontStruct*) 0)
 	reload_text_fstruct(text);
+    else if (text->zoom != zoomscale)
+	loaded = reload_text_fstruct_budget(text);
     text_bound(text, &xmin, &ymin, &xmax, &ymax,
 	       &x1,&y1, &x2,&y2, &x3,&y3, &x4,&y4);
 
@@ -1276,6 +1277,16 @@ void draw_text(F_text *text, int op)
 		     clip_xmin, clip_ymin, clip_xmax, clip_ymax))
 	return;
 
+    /* do not draw texts too small to be seen */
+    if (text->size*display_zoomscale < appres.text_cull)
+	return;
+
+    /* the font of a new zoom is loaded in the background, Greek the text */
+    if (!loaded) {
+	greek_text(text, (x1+x4)/2, (y1+y4)/2, (x2+x3)/2, (y2+y3)/2);
+	return;
+    }
+
     /* outline the text bounds in red if debug resource is set */
     if (appres.DEBUG) {
 	pw_vector(canvas_win, x1, y1, x2, y2, op, 1, RUBBER_LINE, 0.0, RED);
@@ -1284,29 +1295,16 @@ void draw_text(F_text *text, int op)
 	pw_vector(canvas_win, x4, y4, x1, y1, op, 1, RUBBER_LINE, 0.0, RED);
     }
 
-    x = text->base_x;
-    y = text->base_y;
-    cost = cos(text->angle);
-    sint = sin(text->angle);
-    if (text->type == T_CENTER_JUSTIFIED || text->type == T_RIGHT_JUSTIFIED) {
-	size = textsize(text->fontstruct, strlen(text->cstring),
-			    text->cstring);
-	size.length = size.length/display_zoomscale;
-	if (text->type == T_CENTER_JUSTIFIED) {
-	    x = round(x-cost*size.length/2);
-	    y = round(y+sint*size.length/2);
-	} else {	/* T_RIGHT_JUSTIFIED */
-	    x = round(x-cost*size.length);
-	    y = round(y+sint*size.length);
-	}
-    }
+    text_origin(text, &x, &y);
     if (hidden_text(text)) {
 	pw_text(canvas_win, x, y, op, text->depth, lookfont(0,12),
 		text->angle, hidden_text_string, DEFAULT, COLOR_NONE);
     } else {
-	/* if size is less than the displayable size, Greek it by drawing a DARK gray line,
-	   UNLESS the depth is inactive in which case draw it in MED_GRAY */
-	if (text->size*display_zoomscale < MIN_X_FONT_SIZE) {
+	/* if size is less than the displayable size, or -text_greek, Greek it
+	   by drawing a DARK gray line, UNLESS the depth is inactive in which
+	   case draw it in MED_GRAY */
+	if (text->size*display_zoomscale < MIN_X_FONT_SIZE ||
+		text->size*display_zoomscale < appres.text_greek) {
 	    x1 = (x1+x4)/2;
 	    x2 = (x2+x3)/2;
 	    y1 = (y1+y4)/2;
@@ -1336,6 +1334,9 @@ void greek_text(F_text *text, int x1, int y1, int x2, int y2)
     float	 dx, dy;
     char	 *cp;
 
+    /* keep the order of drawing */
+    flush_text_batch();
+
     if (text->depth < MAX_DEPTH+1 && !active_layer(text->depth))
 	color = MED_GRAY;
     else
@@ -1386,12 +1387,26 @@ draw_compoundelements(F_compound *c, int op)
     F_text	   *t;
     F_arc	   *a;
     F_compound	   *c1;
+    int		    x1, y1, x2, y2;
 
     if (!overlapping(ZOOMX(c->nwcorner.x), ZOOMY(c->nwcorner.y),
 		     ZOOMX(c->secorner.x), ZOOMY(c->secorner.y),
 		     clip_xmin, clip_ymin, clip_xmax, clip_ymax))
 	return;
 
+    /* draw a compound that is not read yet as its bounding box */
+    if (c->lazy != NULL) {
+	x1 = c->nwcorner.x;
+	y1 = c->nwcorner.y;
+	x2 = c->secorner.x;
+	y2 = c->secorner.y;
+	pw_vector(canvas_win, x1, y1, x2, y1, op, 1, RUBBER_LINE, 0.0, DARK_GRAY);
+	pw_vector(canvas_win, x2, y1, x2, y2, op, 1, RUBBER_LINE, 0.0, DARK_GRAY);
+	pw_vector(canvas_win, x2, y2, x1, y2, op, 1, RUBBER_LINE, 0.0, DARK_GRAY);
+	pw_vector(canvas_win, x1, y2, x1, y1, op, 1, RUBBER_LINE, 0.0, DARK_GRAY);
+	return;
+    }
+
     for (l = c->lines; l != NULL; l = l->next) {
 	if (active_layer(l->depth))
 	    draw_line(l, op);
@@ -2132,6 +2147,27 @@ draw_spline(F_spline *spline, int op)
     }
 }
 
+/*
+ * Compute the points of the spline as drawn at high precision, and return
+ * their number. *pts points to an array owned by u_draw.c, which is valid
+ * until the next object is drawn or computed.
+ */
+
+int
+spline_points(F_spline *spline, zXPoint **pts)
+{
+    Boolean         success;
+
+    if (open_spline(spline))
+	success = compute_open_spline(spline, HIGH_PRECISION);
+    else
+	success = compute_closed_spline(spline, HIGH_PRECISION);
+    if (!success)
+	return 0;
+    *pts = points;
+    return npoints;
+}
+
 void
 quick_draw_spline(F_spline *spline, int operator)
 {
@@ -31,6 +31,7 @@
 #include "u_draw.h"
 #include "w_cursor.h"
 #include "w_msgpanel.h"
+#include "w_util.h"
 
 /********************** EXPORTS **************/
 
@@ -51,6 +52,25 @@ static void	angle0_line(int x, int y);
 static void	angle45_line(int x, int y);
 static void	angle90_line(int x, int y);
 static void	angle135_line(int x, int y);
+static int	drag_step(F_point *pts);
+static void	drag_adapt(void);
+
+/*
+ * A polyline or spline with many points is drawn as a proxy while it is
+ * dragged or scaled, of only every n-th point. At most drag_points points
+ * are drawn, initially appres.drag_proxy. If drawing, until the X server
+ * is done with it, takes longer than DRAG_FRAME, drag_points is halved, if
+ * it is much faster, doubled again.
+ * It only changes between erasing and redrawing, see moving_line(), so
+ * that the rubber band is always erased exactly. On dropping, the object
+ * is drawn in full.
+ */
+
+#define DRAG_FRAME	0.02		/* seconds */
+#define DRAG_MIN_POINTS	32
+
+static int	drag_points = -1;	/* -1, not yet set */
+static double	drag_time = 0.0;	/* time for drawing the rubber band */
 
 /*************************** BOXES *************************/
 
@@ -327,6 +347,7 @@ moving_line(int x, int y)
     elastic_moveline(new_l->points);
     adjust_pos(x, y, fix_x, fix_y, &cur_x, &cur_y);
     length_msg(MSG_DIST);
+    drag_adapt();
     elastic_moveline(new_l->points);
 }
 
@@ -341,17 +362,27 @@ elastic_moveline(F_point *pts)
 {
     F_point	   *p;
     int		    dx, dy, x, y, xx, yy;
+    int		    i, step;
+    double	    start;
 
     p = pts;
     if (p->next == NULL) {	/* dot */
 	pw_vector(canvas_win, cur_x, cur_y, cur_x, cur_y,
 		  INV_PAINT, 1, RUBBER_LINE, 0.0, DEFAULT);
     } else {
+	start = seconds();
+	step = drag_step(pts);
 	dx = cur_x - fix_x;
 	dy = cur_y - fix_y;
 	x = p->x + dx;
 	y = p->y + dy;
-	for (p = p->next; p != NULL; x = xx, y = yy, p = p->next) {
+	for (i = 1, p = p->next; p != NULL; x = xx, y = yy, p = p->next, i++) {
+	    /* of a proxy, skip points but the last */
+	    if (i % step && p->next) {
+		xx = x;
+		yy = y;
+		continue;
+	    }
 	    xx = p->x + dx;
 	    yy = p->y + dy;
 	    pw_vector(canvas_win, x, y, xx, yy, INV_PAINT, 1,
@@ -362,9 +393,49 @@ elastic_moveline(F_point *pts)
 		      RUBBER_LINE, 0.0, DEFAULT);
 	}
 	elastic_links(dx, dy, 1.0, 1.0);
+	/* the requests are only queued, wait until they are drawn */
+	XSync(tool_d, False);
+	drag_time = seconds() - start;
     }
 }
 
+/* return n, to draw only every n-th point of pts, see drag_points */
+
+static int
+drag_step(F_point *pts)
+{
+    F_point	   *p;
+    int		    n;
+
+    if (appres.drag_proxy <= 0)
+	return 1;
+    if (drag_points < 0)
+	drag_points = max2(appres.drag_proxy, 2);
+    for (n = 0, p = pts; p != NULL; p = p->next)
+	++n;
+    if (n <= drag_points)
+	return 1;
+    /* draw the first, the last and at most drag_points - 2 between */
+    return (n - 2) / (drag_points - 1) + 1;
+}
+
+/* adapt the number of points drawn to the time taken, between erasing
+   and redrawing the rubber band */
+
+static void
+drag_adapt(void)
+{
+    int		    limit;
+
+    if (appres.drag_proxy <= 0 || drag_points < 0)
+	return;
+    limit = max2(appres.drag_proxy, 2);
+    if (drag_time > DRAG_FRAME)
+	drag_points = max2(drag_points / 2, min2(DRAG_MIN_POINTS, limit));
+    else if (drag_time < DRAG_FRAME / 4)
+	drag_points = min2(2 * drag_points, limit);
+}
+
 static void
 elastic_links(int dx, int dy, float sx, float sy)
 {
@@ -412,6 +483,7 @@ scaling_line(int x, int y)
     adjust_box_pos(x, y, fix_x, fix_y, &cur_x, &cur_y);
     if (cur_l->type == T_BOX || cur_l->type == T_ARCBOX || cur_l->type == T_PICTURE)
 	boxsize_msg(2);
+    drag_adapt();
     elastic_scalepts(cur_l->points);
 }
 
@@ -426,6 +498,7 @@ scaling_spline(int x, int y)
 {
     elastic_scalepts(cur_s->points);
     adjust_box_pos(x, y, fix_x, fix_y, &cur_x, &cur_y);
+    drag_adapt();
     elastic_scalepts(cur_s->points);
 }
 
@@ -442,7 +515,11 @@ elastic_scalepts(F_point *pts)
     double	    newx, newy, oldx, oldy;
     double	    newd, oldd, scalefact;
     int		    ox, oy, xx, yy;
+    int		    i, step;
+    double	    start;
 
+    start = seconds();
+    step = drag_step(pts);
     p = pts;
     newx = cur_x - fix_x;
     newy = cur_y - fix_y;
@@ -455,12 +532,18 @@ elastic_scalepts(F_point *pts)
     scalefact = newd / oldd;
     ox = fix_x + round((p->x - fix_x) * scalefact);
     oy = fix_y + round((p->y - fix_y) * scalefact);
-    for (p = p->next; p != NULL; ox = xx, oy = yy, p = p->next) {
+    for (i = 1, p = p->next; p != NULL; p = p->next, i++) {
+	if (i % step && p->next)
+	    continue;
 	xx = fix_x + round((p->x - fix_x) * scalefact);
 	yy = fix_y + round((p->y - fix_y) * scalefact);
 	pw_vector(canvas_win, ox, oy, xx, yy, INV_PAINT, 1,
 		  RUBBER_LINE, 0.0, DEFAULT);
+	ox = xx;
+	oy = yy;
     }
+    XSync(tool_d, False);
+    drag_time = seconds() - start;
 }
 
 void
@@ -892,6 +975,7 @@ moving_spline(int x, int y)
     elastic_moveline(new_s->points);
     adjust_pos(x, y, fix_x, fix_y, &cur_x, &cur_y);
     length_msg(MSG_DIST);
+    drag_adapt();
     elastic_moveline(new_s->points);
 }
 
@@ -21,6 +21,7 @@
 #include "mode.h"
 
 #include "object.h"
+#include "f_journal.h"
 #include "f_save.h"
 #include "f_util.h"
 #include "w_cmdpanel.h"
@@ -93,7 +94,10 @@ void emergency_quit(Boolean abortflag)
     signal(SIGSEGV, SIG_DFL);
 
     aborting = abortflag;
-    if (figure_modified && !emptyfigure()) {
+    if (figure_modified && !emptyfigure() && journal_current()) {
+	fprintf(stderr, "xfig: changes to the figure are in the journal %s\n",
+		journal_name());
+    } else if (figure_modified && !emptyfigure()) {
 	fprintf(stderr, "xfig: attempting to save figure\n");
 	if (emergency_save("SAVE.fig") == -1)
 	    if (emergency_save(strcat(TMPDIR,"/SAVE.fig")) == -1)
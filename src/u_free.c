@@ -25,6 +25,7 @@
 #include <stdlib.h>
 
 #include "object.h"
+#include "f_read.h"
 #include "u_fonts.h"
 #include "u_free.h"
 #include "w_drawprim.h"
@@ -61,6 +62,8 @@ void free_compound(F_compound **list)
 	free_line(&compound->lines);
 	free_spline(&compound->splines);
 	free_text(&compound->texts);
+	if (compound->lazy)
+	    free_lazy_compound(compound);
 	if (compound->comments) {
 	    free(compound->comments);
 	    compound->comments = NULL;
@@ -24,6 +24,7 @@
 #include "f_read.h"
 #include "u_create.h"
 #include "u_list.h"
+#include "u_pick.h"
 #include "u_elastic.h"
 #include "u_redraw.h"
 #include "u_undo.h"
@@ -51,8 +52,10 @@ list_delete_arc(F_arc **arc_list, F_arc *arc)
     if (arc == NULL)
 	return;
 
-    if (arc_list == &objects.arcs)
+    if (arc_list == &objects.arcs) {
+	pick_object_deleted(O_ARC, arc);
 	remove_depth(O_ARC, arc->depth);
+    }
     for (a = aa = *arc_list; aa != NULL; a = aa, aa = aa->next) {
 	if (aa == arc) {
 	    if (aa == *arc_list)
@@ -75,8 +78,10 @@ list_delete_ellipse(F_ellipse **ellipse_list, F_ellipse *ellipse)
     if (ellipse == NULL)
 	return;
 
-    if (ellipse_list == &objects.ellipses)
+    if (ellipse_list == &objects.ellipses) {
+	pick_object_deleted(O_ELLIPSE, ellipse);
 	remove_depth(O_ELLIPSE, ellipse->depth);
+    }
     for (q = r = *ellipse_list; r != NULL; q = r, r = r->next) {
 	if (r == ellipse) {
 	    if (r == *ellipse_list)
@@ -99,8 +104,10 @@ list_delete_line(F_line **line_list, F_line *line)
     if (line == NULL)
 	return;
 
-    if (line_list == &objects.lines)
+    if (line_list == &objects.lines) {
+	pick_object_deleted(O_POLYLINE, line);
 	remove_depth(O_POLYLINE, line->depth);
+    }
     for (q = r = *line_list; r != NULL; q = r, r = r->next) {
 	if (r == line) {
 	    if (r == *line_list)
@@ -123,8 +130,10 @@ list_delete_spline(F_spline **spline_list, F_spline *spline)
     if (spline == NULL)
 	return;
 
-    if (spline_list == &objects.splines)
+    if (spline_list == &objects.splines) {
+	pick_object_deleted(O_SPLINE, spline);
 	remove_depth(O_SPLINE, spline->depth);
+    }
     for (q = r = *spline_list; r != NULL; q = r, r = r->next) {
 	if (r == spline) {
 	    if (r == *spline_list)
@@ -147,8 +156,10 @@ list_delete_text(F_text **text_list, F_text *text)
     if (text == NULL)
 	return;
 
-    if (text_list == &objects.texts)
+    if (text_list == &objects.texts) {
+	pick_object_deleted(O_TXT, text);
 	remove_depth(O_TXT, text->depth);
+    }
     for (q = r = *text_list; r != NULL; q = r, r = r->next)
 	if (r == text) {
 	    if (r == *text_list)
@@ -170,8 +181,10 @@ list_delete_compound(F_compound **list, F_compound *compound)
     if (compound == NULL)
 	return;
 
-    if (list == &objects.compounds)
+    if (list == &objects.compounds) {
+	pick_object_deleted(O_COMPOUND, compound);
 	remove_compound_depth(compound);
+    }
 
     for (cc = c = *list; c != NULL; cc = c, c = c->next) {
 	if (c == compound) {
@@ -296,11 +309,13 @@ list_add_arc(F_arc **list, F_arc *a)
 	*list = a;
     else
 	aa->next = a;
-    if (list == &objects.arcs)
+    if (list == &objects.arcs) {
+	pick_object_added(O_ARC, a);
 	while (a) {
 	    add_depth(O_ARC, a->depth);
 	    a = a->next;
 	}
+    }
 }
 
 void
@@ -313,11 +328,13 @@ list_add_ellipse(F_ellipse **list, F_ellipse *e)
 	*list = e;
     else
 	ee->next = e;
-    if (list == &objects.ellipses)
+    if (list == &objects.ellipses) {
+	pick_object_added(O_ELLIPSE, e);
 	while (e) {
 	    add_depth(O_ELLIPSE, e->depth);
 	    e = e->next;
 	}
+    }
 }
 
 void
@@ -330,11 +347,13 @@ list_add_line(F_line **list, F_line *l)
 	*list = l;
     else
 	ll->next = l;
-    if (list == &objects.lines)
+    if (list == &objects.lines) {
+	pick_object_added(O_POLYLINE, l);
 	while (l) {
 	    add_depth(O_POLYLINE, l->depth);
 	    l = l->next;
 	}
+    }
 }
 
 void
@@ -347,11 +366,13 @@ list_add_spline(F_spline **list, F_spline *s)
 	*list = s;
     else
 	ss->next = s;
-    if (list == &objects.splines)
+    if (list == &objects.splines) {
+	pick_object_added(O_SPLINE, s);
 	while (s) {
 	    add_depth(O_SPLINE, s->depth);
 	    s = s->next;
 	}
+    }
 }
 
 void
@@ -364,11 +385,13 @@ list_add_text(F_text **list, F_text *t)
 	*list = t;
     else
 	tt->next = t;
-    if (list == &objects.texts)
+    if (list == &objects.texts) {
+	pick_object_added(O_TXT, t);
 	while (t) {
 	    add_depth(O_TXT, t->depth);
 	    t = t->next;
 	}
+    }
 }
 
 void
@@ -383,6 +406,7 @@ list_add_compound(F_compound **list, F_compound *c)
 	cc->next = c;
 
     if (list == &objects.compounds) {
+	pick_object_added(O_COMPOUND, c);
 	while (c) {
 	    add_compound_depth(c);
 	    c = c->next;
@@ -491,7 +515,7 @@ delete_line(F_line *old_l)
     clean_up();
     set_latestline(old_l);
     set_action_object(F_DELETE, O_POLYLINE);
-    set_modifiedflag();
+    set_modifiedobject(O_POLYLINE, old_l);
 }
 
 void
@@ -501,7 +525,7 @@ delete_arc(F_arc *old_a)
     clean_up();
     set_latestarc(old_a);
     set_action_object(F_DELETE, O_ARC);
-    set_modifiedflag();
+    set_modifiedobject(O_ARC, old_a);
 }
 
 void
@@ -511,7 +535,7 @@ delete_ellipse(F_ellipse *old_e)
     clean_up();
     set_latestellipse(old_e);
     set_action_object(F_DELETE, O_ELLIPSE);
-    set_modifiedflag();
+    set_modifiedobject(O_ELLIPSE, old_e);
 }
 
 void
@@ -521,7 +545,7 @@ delete_text(F_text *old_t)
     clean_up();
     set_latesttext(old_t);
     set_action_object(F_DELETE, O_TXT);
-    set_modifiedflag();
+    set_modifiedobject(O_TXT, old_t);
 }
 
 void
@@ -531,7 +555,7 @@ delete_spline(F_spline *old_s)
     clean_up();
     set_latestspline(old_s);
     set_action_object(F_DELETE, O_SPLINE);
-    set_modifiedflag();
+    set_modifiedobject(O_SPLINE, old_s);
 }
 
 void
@@ -541,7 +565,7 @@ delete_compound(F_compound *old_c)
     clean_up();
     set_latestcompound(old_c);
     set_action_object(F_DELETE, O_COMPOUND);
-    set_modifiedflag();
+    set_modifiedobject(O_COMPOUND, old_c);
 }
 
 /*******************************/
@@ -555,7 +579,7 @@ add_line(F_line *new_l)
     clean_up();
     set_latestline(new_l);
     set_action_object(F_ADD, O_POLYLINE);
-    set_modifiedflag();
+    set_modifiedobject(O_POLYLINE, new_l);
 }
 
 void
@@ -565,7 +589,7 @@ add_arc(F_arc *new_a)
     clean_up();
     set_latestarc(new_a);
     set_action_object(F_ADD, O_ARC);
-    set_modifiedflag();
+    set_modifiedobject(O_ARC, new_a);
 }
 
 void
@@ -575,7 +599,7 @@ add_ellipse(F_ellipse *new_e)
     clean_up();
     set_latestellipse(new_e);
     set_action_object(F_ADD, O_ELLIPSE);
-    set_modifiedflag();
+    set_modifiedobject(O_ELLIPSE, new_e);
 }
 
 void
@@ -585,7 +609,7 @@ add_text(F_text *new_t)
     clean_up();
     set_latesttext(new_t);
     set_action_object(F_ADD, O_TXT);
-    set_modifiedflag();
+    set_modifiedobject(O_TXT, new_t);
 }
 
 void
@@ -595,7 +619,7 @@ add_spline(F_spline *new_s)
     clean_up();
     set_latestspline(new_s);
     set_action_object(F_ADD, O_SPLINE);
-    set_modifiedflag();
+    set_modifiedobject(O_SPLINE, new_s);
 }
 
 void
@@ -605,7 +629,7 @@ add_compound(F_compound *new_c)
     clean_up();
     set_latestcompound(new_c);
     set_action_object(F_ADD, O_COMPOUND);
-    set_modifiedflag();
+    set_modifiedobject(O_COMPOUND, new_c);
 }
 
 
@@ -618,7 +642,7 @@ change_line(F_line *old_l, F_line *new_l)
     old_l->next = new_l;
     set_latestline(old_l);
     set_action_object(F_EDIT, O_POLYLINE);
-    set_modifiedflag();
+    set_modifiedobject(O_POLYLINE, new_l);
 }
 
 void
@@ -630,7 +654,7 @@ change_arc(F_arc *old_a, F_arc *new_a)
     old_a->next = new_a;
     set_latestarc(old_a);
     set_action_object(F_EDIT, O_ARC);
-    set_modifiedflag();
+    set_modifiedobject(O_ARC, new_a);
 }
 
 void
@@ -642,7 +666,7 @@ change_ellipse(F_ellipse *old_e, F_ellipse *new_e)
     old_e->next = new_e;
     set_latestellipse(old_e);
     set_action_object(F_EDIT, O_ELLIPSE);
-    set_modifiedflag();
+    set_modifiedobject(O_ELLIPSE, new_e);
 }
 
 void
@@ -654,7 +678,7 @@ change_text(F_text *old_t, F_text *new_t)
     old_t->next = new_t;
     set_latesttext(old_t);
     set_action_object(F_EDIT, O_TXT);
-    set_modifiedflag();
+    set_modifiedobject(O_TXT, new_t);
 }
 
 void
@@ -666,7 +690,7 @@ change_spline(F_spline *old_s, F_spline *new_s)
     old_s->next = new_s;
     set_latestspline(old_s);
     set_action_object(F_EDIT, O_SPLINE);
-    set_modifiedflag();
+    set_modifiedobject(O_SPLINE, new_s);
 }
 
 void
@@ -678,7 +702,7 @@ change_compound(F_compound *old_c, F_compound *new_c)
     old_c->next = new_c;
     set_latestcompound(old_c);
     set_action_object(F_EDIT, O_COMPOUND);
-    set_modifiedflag();
+    set_modifiedobject(O_COMPOUND, new_c);
 }
 
 /* find the tails of all the object lists */
@@ -719,6 +743,32 @@ void tail(F_compound *ob, F_compound *tails)
     tails->texts = t;
 }
 
+/* report the objects in the lists of c to the pick index */
+
+static void
+pick_objects_of(F_compound *c, void (*report)(int type, void *obj))
+{
+    F_arc	   *a;
+    F_compound	   *cc;
+    F_ellipse	   *e;
+    F_line	   *l;
+    F_spline	   *s;
+    F_text	   *t;
+
+    for (a = c->arcs; a != NULL; a = a->next)
+	report(O_ARC, a);
+    for (cc = c->compounds; cc != NULL; cc = cc->next)
+	report(O_COMPOUND, cc);
+    for (e = c->ellipses; e != NULL; e = e->next)
+	report(O_ELLIPSE, e);
+    for (l = c->lines; l != NULL; l = l->next)
+	report(O_POLYLINE, l);
+    for (s = c->splines; s != NULL; s = s->next)
+	report(O_SPLINE, s);
+    for (t = c->texts; t != NULL; t = t->next)
+	report(O_TXT, t);
+}
+
 /*
  * Make pointers in tails point to the last element of each list of l1 and
  * Append the lists in l2 after those in l1. The tails pointers must be
@@ -729,6 +779,8 @@ void append_objects(F_compound *l1, F_compound *l2, F_compound *tails)
 {
     /* don't forget to account for the depths */
     add_compound_depth(l2);
+    if (l1 == &objects)
+	pick_objects_of(l2, pick_object_added);
 
     if (tails->arcs)
 	tails->arcs->next = l2->arcs;
@@ -760,6 +812,19 @@ void append_objects(F_compound *l1, F_compound *l2, F_compound *tails)
 
 void cut_objects(F_compound *objects, F_compound *tails)
 {
+    F_compound	   *c;
+    F_compound	    cut;
+
+    /* the objects after the tails */
+    cut.arcs = tails->arcs ? tails->arcs->next : objects->arcs;
+    cut.compounds = tails->compounds ? tails->compounds->next :
+		objects->compounds;
+    cut.ellipses = tails->ellipses ? tails->ellipses->next :
+		objects->ellipses;
+    cut.lines = tails->lines ? tails->lines->next : objects->lines;
+    cut.splines = tails->splines ? tails->splines->next : objects->splines;
+    cut.texts = tails->texts ? tails->texts->next : objects->texts;
+    pick_objects_of(&cut, pick_object_deleted);
     if (tails->arcs) {
 	remove_arc_depths(tails->arcs->next);
 	tails->arcs->next = NULL;
@@ -768,10 +833,12 @@ void cut_objects(F_compound *objects, F_compound *tails)
 	objects->arcs = NULL;
     }
     if (tails->compounds) {
-	remove_compound_depth(tails->compounds->next);
+	for (c = tails->compounds->next; c != NULL; c = c->next)
+	    remove_compound_depth(c);
 	tails->compounds->next = NULL;
     } else if (objects->compounds) {
-	remove_compound_depth(objects->compounds);
+	for (c = objects->compounds; c != NULL; c = c->next)
+	    remove_compound_depth(c);
 	objects->compounds = NULL;
     }
     if (tails->ellipses) {
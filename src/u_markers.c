@@ -26,14 +26,69 @@
 #include "w_zoom.h"
 
 #include <limits.h>	/* INT_MIN */
+#include <stdlib.h>
 
 #define set_marker(win,x,y,w,h) \
-	XDrawRectangle(tool_d,(win),gccache[INV_PAINT], \
+	draw_marker((win), \
 	     ZOOMX(x)-((w-1)/2),ZOOMY(y)-((w-1)/2),(w),(h))
 
 #define CHANGED_MASK(msk) \
     ((oldmask & msk) != (newmask & msk))
 
+/* markers collected between start_marker_batch() and flush_marker_batch() */
+static Boolean	   marker_batch = False;
+static XRectangle *marker_rects = NULL;
+static int	   num_marker_rects = 0, alloc_marker_rects = 0;
+
+static void
+draw_marker(Window win, int x, int y, int w, int h)
+{
+    XRectangle	   *r;
+    int		    n;
+
+    if (marker_batch && win == canvas_win) {
+	if (num_marker_rects == alloc_marker_rects) {
+	    n = alloc_marker_rects ? 2 * alloc_marker_rects : 256;
+	    if ((r = realloc(marker_rects, n * sizeof(XRectangle))) == NULL) {
+		flush_marker_batch();
+		marker_batch = True;
+		XDrawRectangle(tool_d, win, gccache[INV_PAINT], x, y, w, h);
+		return;
+	    }
+	    marker_rects = r;
+	    alloc_marker_rects = n;
+	}
+	r = &marker_rects[num_marker_rects++];
+	r->x = x;
+	r->y = y;
+	r->width = w;
+	r->height = h;
+	return;
+    }
+    XDrawRectangle(tool_d, win, gccache[INV_PAINT], x, y, w, h);
+}
+
+/*
+ * Collect the markers drawn on the canvas, and draw them with a single
+ * request in flush_marker_batch(). Used when many objects get tagged.
+ */
+
+void
+start_marker_batch(void)
+{
+    marker_batch = True;
+}
+
+void
+flush_marker_batch(void)
+{
+    if (num_marker_rects > 0)
+	XDrawRectangles(tool_d, canvas_win, gccache[INV_PAINT], marker_rects,
+			num_marker_rects);
+    num_marker_rects = 0;
+    marker_batch = False;
+}
+
 
 
 void center_marker(int x, int y)
@@ -24,6 +24,8 @@ extern int anyspline_in_mask (void);
 extern int anytext_in_mask (void);
 extern int arc_in_mask (void);
 extern void center_marker (int x, int y);
+extern void start_marker_batch (void);
+extern void flush_marker_batch (void);
 extern int compound_in_mask (void);
 extern int ellipse_in_mask (void);
 extern void mask_toggle_arcmarker (F_arc *a);
@@ -0,0 +1,1559 @@
+/*
+ * FIG : Facility for Interactive Generation of figures
+ * Copyright (c) 1985-1988 by Supoj Sutanthavibul
+ * Parts Copyright (c) 1989-2015 by Brian V. Smith
+ * Parts Copyright (c) 1991 by Paul King
+ * Parts Copyright (c) 2016-2020 by Thomas Loimer
+ *
+ * Any party obtaining a copy of these files is granted, free of charge, a
+ * full and unrestricted irrevocable, world-wide, paid up, royalty-free,
+ * nonexclusive right and license to deal in this software and documentation
+ * files (the "Software"), including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense and/or sell copies of
+ * the Software, and to permit persons who receive copies from any such
+ * party to do so, with the only requirement being that the above copyright
+ * and this permission notice remain intact.
+ *
+ */
+
+/*
+ * The pick index: for each type of object, a tree of bounding boxes over
+ * the top-level objects of the figure. pick_candidates() returns the
+ * numbers of the objects, counted in list order, whose bounding box comes
+ * within the tolerance of a point. Only these objects can be close enough
+ * to the point to be picked, see u_search.c. pick_region() returns the
+ * objects within a region, see e_glue.c, pick_nearest() the objects
+ * closest to a point, see u_smartsearch.c.
+ *
+ * The index is built on first use after the figure changed. Any change to
+ * the figure must be reported. Adding to or deleting from the object lists
+ * of the figure calls pick_object_added() or pick_object_deleted(), see
+ * u_list.c; changing an object in place, e.g., by moving or editing it,
+ * calls pick_object_changed(), see set_modifiedobject(). The next search
+ * only computes the boxes of these objects and refits the leaves holding
+ * them and the nodes above. Any other change calls pick_changed(), e.g.,
+ * set_modifiedflag(); then the boxes of all objects are computed again and
+ * the tree is refitted, without sorting. After PICK_REFITS such refits, or
+ * if the list changed in another way, the tree is built anew.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "resources.h"
+#include "object.h"
+#include "mode.h"
+#include "u_bound.h"
+#include "u_pick.h"
+#include "w_msgpanel.h"
+#include "w_setup.h"
+#include "w_zoom.h"
+#include "xfig_math.h"
+
+typedef struct {
+	int	xmin, ymin, xmax, ymax;
+} pick_box;
+
+typedef struct {
+	pick_box box;		/* bounds of all objects below this node */
+	int	 left, right;	/* the children, -1 for a leaf */
+	int	 parent;	/* -1 for the root */
+	int	 first, num;	/* a leaf holds perm[first...first+num-1] */
+} pick_node;
+
+/* a change of the figure, since the index was made */
+#define CHANGE_NONE	0
+#define CHANGE_ADDED	1
+#define CHANGE_DELETED	2
+#define CHANGE_OBJECT	3
+
+typedef struct {
+	void	   *obj;
+	int	    what;
+} pick_change;
+
+typedef struct {
+	int	     num;	/* number of objects in the list */
+	void	   **obj;	/* the objects, in list order */
+	pick_box    *box;	/* their bounding boxes */
+	pick_box    *bound;	/* their bounds used by pick_region() */
+	char	    *bounded;	/* whether bound[] is computed */
+	int	    *leaf;	/* the leaf holding each object */
+	int	    *cand;	/* result of pick_candidates() */
+	int	     alloc;	/* allocated length of the arrays above */
+	int	    *perm;	/* object numbers in the leaves, PICK_SPACE
+				   places for each leaf */
+	int	     alloc_perm;
+	pick_node   *node;
+	int	     num_nodes, alloc_nodes;
+	void	    *head;	/* the list the index was built from */
+	unsigned long changes;	/* value of changes when built */
+	int	     refits;	/* since built */
+	float	     zoom;	/* display_zoomscale when built */
+	int	    *slot;	/* hash table of the object numbers */
+	int	     num_slots;	/* a power of two, larger than alloc */
+	pick_change  change[PICK_CHANGES];	/* since changes */
+	int	     num_changes;	/* -1, if not known */
+} pick_index;
+
+static pick_index	pindex[O_COMPOUND + 1];
+static unsigned long	changes = 1;
+
+/* used by compare_center() */
+static pick_box		*sort_box;
+static int		 sort_axis;
+
+static pick_index	*fresh_index(int type);
+static void		 keep_vertices(void);
+
+
+/* the objects of the figure changed, all boxes must be computed again */
+
+void
+pick_changed(void)
+{
+    int		    type;
+
+    ++changes;
+    keep_vertices();
+    for (type = 0; type <= O_COMPOUND; type++)
+	pindex[type].num_changes = -1;
+}
+
+/* remember the change of obj, until the index of type is searched */
+
+static void
+record_change(int type, void *obj, int what)
+{
+    pick_index	   *p;
+
+    if (type < 0 || type > O_COMPOUND) {
+	pick_changed();
+	return;
+    }
+    ++changes;
+    keep_vertices();
+    p = &pindex[type];
+    if (p->changes == 0 || p->num_changes < 0)
+	return;
+    if (p->num_changes == PICK_CHANGES) {
+	p->num_changes = -1;
+	return;
+    }
+    p->change[p->num_changes].obj = obj;
+    p->change[p->num_changes++].what = what;
+}
+
+/* obj was appended to the list of type in objects */
+
+void
+pick_object_added(int type, void *obj)
+{
+    record_change(type, obj, CHANGE_ADDED);
+}
+
+/* obj is about to be taken from the list of type in objects */
+
+void
+pick_object_deleted(int type, void *obj)
+{
+    record_change(type, obj, CHANGE_DELETED);
+}
+
+/* obj, in the list of type in objects, was changed in place */
+
+void
+pick_object_changed(int type, void *obj)
+{
+    record_change(type, obj, CHANGE_OBJECT);
+}
+
+/* a number that changes with the figure, see u_textindex.c */
+
+unsigned long
+pick_changes(void)
+{
+    return changes;
+}
+
+static void *
+list_head(int type)
+{
+    switch (type) {
+    case O_ARC:
+	return objects.arcs;
+    case O_COMPOUND:
+	return objects.compounds;
+    case O_ELLIPSE:
+	return objects.ellipses;
+    case O_POLYLINE:
+	return objects.lines;
+    case O_SPLINE:
+	return objects.splines;
+    case O_TXT:
+	return objects.texts;
+    }
+    return NULL;
+}
+
+static void *
+next_object(int type, void *obj)
+{
+    switch (type) {
+    case O_ARC:
+	return ((F_arc *) obj)->next;
+    case O_COMPOUND:
+	return ((F_compound *) obj)->next;
+    case O_ELLIPSE:
+	return ((F_ellipse *) obj)->next;
+    case O_POLYLINE:
+	return ((F_line *) obj)->next;
+    case O_SPLINE:
+	return ((F_spline *) obj)->next;
+    case O_TXT:
+	return ((F_text *) obj)->next;
+    }
+    return NULL;
+}
+
+static void
+points_box(F_point *p, pick_box *b)
+{
+    if (p == NULL) {
+	/* an empty box, never picked */
+	b->xmin = b->ymin = 1;
+	b->xmax = b->ymax = -1;
+	return;
+    }
+    b->xmin = b->xmax = p->x;
+    b->ymin = b->ymax = p->y;
+    for (p = p->next; p != NULL; p = p->next) {
+	b->xmin = min2(b->xmin, p->x);
+	b->ymin = min2(b->ymin, p->y);
+	b->xmax = max2(b->xmax, p->x);
+	b->ymax = max2(b->ymax, p->y);
+    }
+}
+
+/*
+ * Get a box that contains every point at which the tests in u_search.c
+ * can find the object, apart from the tolerance.
+ */
+
+static void
+object_box(int type, void *obj, pick_box *b)
+{
+    F_arc	   *a;
+    F_compound	   *c;
+    F_ellipse	   *e;
+    F_text	   *t;
+    double	    r, d;
+    int		    i;
+
+    switch (type) {
+    case O_ARC:
+	/* the whole circle */
+	a = (F_arc *) obj;
+	r = 0.0;
+	for (i = 0; i < 3; i++) {
+	    d = hypot(a->point[i].x - a->center.x, a->point[i].y - a->center.y);
+	    if (d > r)
+		r = d;
+	}
+	b->xmin = floor(a->center.x - r);
+	b->ymin = floor(a->center.y - r);
+	b->xmax = ceil(a->center.x + r);
+	b->ymax = ceil(a->center.y + r);
+	break;
+    case O_COMPOUND:
+	c = (F_compound *) obj;
+	b->xmin = min2(c->nwcorner.x, c->secorner.x);
+	b->ymin = min2(c->nwcorner.y, c->secorner.y);
+	b->xmax = max2(c->nwcorner.x, c->secorner.x);
+	b->ymax = max2(c->nwcorner.y, c->secorner.y);
+	break;
+    case O_ELLIPSE:
+	/* the circle around the larger radius, and the points used to draw it */
+	e = (F_ellipse *) obj;
+	i = max2(abs(e->radiuses.x), abs(e->radiuses.y));
+	b->xmin = min2(e->center.x - i, min2(e->start.x, e->end.x));
+	b->ymin = min2(e->center.y - i, min2(e->start.y, e->end.y));
+	b->xmax = max2(e->center.x + i, max2(e->start.x, e->end.x));
+	b->ymax = max2(e->center.y + i, max2(e->start.y, e->end.y));
+	break;
+    case O_POLYLINE:
+	points_box(((F_line *) obj)->points, b);
+	break;
+    case O_SPLINE:
+	points_box(((F_spline *) obj)->points, b);
+	break;
+    case O_TXT:
+	/* the text, rotated by any angle about its base point */
+	t = (F_text *) obj;
+	i = max2(t->length, hidden_text_length) + abs(t->ascent) +
+		abs(t->descent);
+	b->xmin = t->base_x - i;
+	b->ymin = t->base_y - i;
+	b->xmax = t->base_x + i;
+	b->ymax = t->base_y + i;
+	break;
+    }
+}
+
+static int
+compare_center(const void *a, const void *b)
+{
+    pick_box	   *ba = &sort_box[*(const int *) a];
+    pick_box	   *bb = &sort_box[*(const int *) b];
+    long	    ca, cb;
+
+    if (sort_axis == 0) {
+	ca = (long) ba->xmin + ba->xmax;
+	cb = (long) bb->xmin + bb->xmax;
+    } else {
+	ca = (long) ba->ymin + ba->ymax;
+	cb = (long) bb->ymin + bb->ymax;
+    }
+    return ca < cb ? -1 : ca > cb;
+}
+
+static int
+compare_int(const void *a, const void *b)
+{
+    return *(const int *) a - *(const int *) b;
+}
+
+/* a box that contains nothing, merge_box() into it gives the other box */
+
+static void
+empty_box(pick_box *b)
+{
+    b->xmin = b->ymin = INT_MAX;
+    b->xmax = b->ymax = INT_MIN;
+}
+
+static void
+merge_box(pick_box *b, pick_box *c)
+{
+    b->xmin = min2(b->xmin, c->xmin);
+    b->ymin = min2(b->ymin, c->ymin);
+    b->xmax = max2(b->xmax, c->xmax);
+    b->ymax = max2(b->ymax, c->ymax);
+}
+
+/*
+ * Make a node for the objects cand[first...first+num-1], and split it at
+ * the median of the longer side of its box. Return the node, or -1. The
+ * objects of the leaves are put into perm by layout_leaves().
+ */
+
+static int
+build_node(pick_index *p, int parent, int first, int num)
+{
+    pick_node	   *n;
+    pick_box	    box;
+    int		    i, k, half;
+
+    if (p->num_nodes == p->alloc_nodes) {
+	k = p->alloc_nodes ? 2 * p->alloc_nodes : 64;
+	if ((n = realloc(p->node, k * sizeof(pick_node))) == NULL)
+	    return -1;
+	p->node = n;
+	p->alloc_nodes = k;
+    }
+    empty_box(&box);
+    for (i = first; i < first + num; i++)
+	merge_box(&box, &p->box[p->cand[i]]);
+    k = p->num_nodes++;
+    p->node[k].box = box;
+    p->node[k].parent = parent;
+    p->node[k].first = first;
+    p->node[k].num = num;
+    p->node[k].left = p->node[k].right = -1;
+    if (num <= PICK_LEAF)
+	return k;
+
+    sort_box = p->box;
+    sort_axis = (long) box.xmax - box.xmin < (long) box.ymax - box.ymin;
+    qsort(p->cand + first, num, sizeof(int), compare_center);
+    half = num / 2;
+    /* p->node may be moved by build_node() */
+    if ((i = build_node(p, k, first, half)) < 0)
+	return -1;
+    p->node[k].left = i;
+    if ((i = build_node(p, k, first + half, num - half)) < 0)
+	return -1;
+    p->node[k].right = i;
+    return k;
+}
+
+/* give each leaf PICK_SPACE places in perm, for objects added later */
+
+static Boolean
+layout_leaves(pick_index *p)
+{
+    pick_node	   *n;
+    int		   *perm;
+    int		    i, k, size, first = 0;
+
+    for (size = 0, k = 0; k < p->num_nodes; k++)
+	if (p->node[k].left < 0)
+	    size += PICK_SPACE;
+    if (size > p->alloc_perm) {
+	if ((perm = realloc(p->perm, size * sizeof(int))) == NULL)
+	    return False;
+	p->perm = perm;
+	p->alloc_perm = size;
+    }
+    for (k = 0; k < p->num_nodes; k++) {
+	n = &p->node[k];
+	if (n->left >= 0)
+	    continue;
+	for (i = 0; i < n->num; i++) {
+	    p->perm[first + i] = p->cand[n->first + i];
+	    p->leaf[p->perm[first + i]] = k;
+	}
+	n->first = first;
+	first += PICK_SPACE;
+    }
+    return True;
+}
+
+/* compute the box of node k from its objects, or from its children */
+
+static void
+fit_node(pick_index *p, int k)
+{
+    pick_node	   *n = &p->node[k];
+    int		    i;
+
+    empty_box(&n->box);
+    if (n->left < 0) {
+	for (i = n->first; i < n->first + n->num; i++)
+	    merge_box(&n->box, &p->box[p->perm[i]]);
+    } else {
+	merge_box(&n->box, &p->node[n->left].box);
+	merge_box(&n->box, &p->node[n->right].box);
+    }
+}
+
+/* refit node k and the nodes above */
+
+static void
+fit_up(pick_index *p, int k)
+{
+    for (; k >= 0; k = p->node[k].parent)
+	fit_node(p, k);
+}
+
+static unsigned int
+hash_object(void *obj)
+{
+    return (unsigned int) ((uintptr_t) obj >> 4) * 2654435761u;
+}
+
+static void
+add_slot(pick_index *p, int i)
+{
+    int		    k;
+
+    k = hash_object(p->obj[i]) & (p->num_slots - 1);
+    while (p->slot[k] >= 0)
+	k = (k + 1) & (p->num_slots - 1);
+    p->slot[k] = i;
+}
+
+/* enter the objects into the hash table used by pick_number() */
+
+static Boolean
+build_slots(pick_index *p)
+{
+    int		   *slot;
+    int		    i, k, size;
+
+    for (size = 64; size < 2 * p->alloc; size *= 2)
+	;
+    if (size > p->num_slots) {
+	if ((slot = realloc(p->slot, size * sizeof(int))) == NULL)
+	    return False;
+	p->slot = slot;
+	p->num_slots = size;
+    }
+    for (k = 0; k < p->num_slots; k++)
+	p->slot[k] = -1;
+    for (i = 0; i < p->num; i++)
+	add_slot(p, i);
+    return True;
+}
+
+/* return the number of obj in the index, or -1 */
+
+static int
+find_object(pick_index *p, void *obj)
+{
+    int		    k;
+
+    if (p->num_slots == 0)
+	return -1;
+    for (k = hash_object(obj) & (p->num_slots - 1); p->slot[k] >= 0;
+		k = (k + 1) & (p->num_slots - 1))
+	if (p->obj[p->slot[k]] == obj)
+	    return p->slot[k];
+    return -1;
+}
+
+static Boolean
+build_index(pick_index *p, int type)
+{
+    void	   *o;
+    void	  **obj;
+    pick_box	   *box, *bound;
+    char	   *bounded;
+    int		   *leaf, *cand;
+    int		    n, size;
+
+    p->head = list_head(type);
+    p->changes = changes;
+    p->num_changes = 0;
+    p->refits = 0;
+    p->zoom = display_zoomscale;
+    p->num = p->num_nodes = 0;
+
+    for (n = 0, o = p->head; o != NULL; o = next_object(type, o))
+	n++;
+    if (n > p->alloc) {
+	/* room for objects added later */
+	size = n + PICK_CHANGES;
+	if ((obj = realloc(p->obj, size * sizeof(void *))) != NULL)
+	    p->obj = obj;
+	if ((box = realloc(p->box, size * sizeof(pick_box))) != NULL)
+	    p->box = box;
+	if ((leaf = realloc(p->leaf, size * sizeof(int))) != NULL)
+	    p->leaf = leaf;
+	if ((cand = realloc(p->cand, size * sizeof(int))) != NULL)
+	    p->cand = cand;
+	if ((bound = realloc(p->bound, size * sizeof(pick_box))) != NULL)
+	    p->bound = bound;
+	if ((bounded = realloc(p->bounded, size)) != NULL)
+	    p->bounded = bounded;
+	if (obj == NULL || box == NULL || leaf == NULL || cand == NULL ||
+		bound == NULL || bounded == NULL) {
+	    p->changes = 0;
+	    return False;
+	}
+	p->alloc = size;
+    }
+    for (n = 0, o = p->head; o != NULL; o = next_object(type, o), n++) {
+	p->obj[n] = o;
+	object_box(type, o, &p->box[n]);
+	p->cand[n] = n;
+	p->bounded[n] = False;
+    }
+    p->num = n;
+    if (!build_slots(p) || (n > 0 && (build_node(p, -1, 0, n) < 0 ||
+			!layout_leaves(p)))) {
+	p->changes = 0;
+	p->num = 0;
+	return False;
+    }
+    return True;
+}
+
+/* return whether the list of type holds the objects of p, in this order */
+
+static Boolean
+same_objects(pick_index *p, int type)
+{
+    void	   *o;
+    int		    i;
+
+    for (i = 0, o = list_head(type); o != NULL && i < p->num;
+		o = next_object(type, o), i++)
+	if (o != p->obj[i])
+	    return False;
+    return o == NULL && i == p->num;
+}
+
+/*
+ * If the list of type still holds the objects the index was built from,
+ * in the same order, compute their boxes again and refit the boxes of the
+ * nodes. Return False if the index must be built anew.
+ */
+
+static Boolean
+refit_index(pick_index *p, int type)
+{
+    int		    i, k;
+
+    if (p->changes == 0 || p->refits >= PICK_REFITS ||
+		!same_objects(p, type))
+	return False;
+
+    for (i = 0; i < p->num; i++) {
+	object_box(type, p->obj[i], &p->box[i]);
+	p->bounded[i] = False;
+    }
+    /* the children of a node come after it, see build_node() */
+    for (k = p->num_nodes - 1; k >= 0; k--)
+	fit_node(p, k);
+    p->head = list_head(type);
+    p->changes = changes;
+    p->num_changes = 0;
+    p->zoom = display_zoomscale;
+    ++p->refits;
+    return True;
+}
+
+/*
+ * Return the change of the growth of the half perimeter of a, if b is
+ * added.
+ */
+
+static double
+growth(pick_box *a, pick_box *b)
+{
+    pick_box	    m;
+
+    if (a->xmin > a->xmax)
+	return (double) b->xmax - b->xmin + b->ymax - b->ymin;
+    m = *a;
+    merge_box(&m, b);
+    return (double) m.xmax - m.xmin + m.ymax - m.ymin -
+		((double) a->xmax - a->xmin + a->ymax - a->ymin);
+}
+
+/* put the new object number i into the leaf it enlarges least */
+
+static Boolean
+add_to_leaf(pick_index *p, int i)
+{
+    pick_node	   *n;
+    int		    k = 0;
+
+    if (p->num_nodes == 0)
+	return False;
+    for (n = &p->node[k]; n->left >= 0; n = &p->node[k])
+	k = growth(&p->node[n->left].box, &p->box[i]) <=
+		growth(&p->node[n->right].box, &p->box[i]) ?
+		n->left : n->right;
+    if (n->num == PICK_SPACE)
+	return False;
+    p->perm[n->first + n->num++] = i;
+    p->leaf[i] = k;
+    fit_up(p, k);
+    return True;
+}
+
+/* take object number i from its leaf */
+
+static void
+remove_from_leaf(pick_index *p, int i)
+{
+    pick_node	   *n = &p->node[p->leaf[i]];
+    int		    k;
+
+    for (k = n->first; p->perm[k] != i; k++)
+	;
+    p->perm[k] = p->perm[n->first + --n->num];
+    fit_up(p, p->leaf[i]);
+}
+
+/* number the objects again, after deleted objects were set to NULL */
+
+static Boolean
+compact_index(pick_index *p)
+{
+    pick_node	   *n;
+    int		   *renum = p->cand;
+    int		    i, k, num = 0;
+
+    for (i = 0; i < p->num; i++) {
+	renum[i] = num;
+	if (p->obj[i] == NULL)
+	    continue;
+	p->obj[num] = p->obj[i];
+	p->box[num] = p->box[i];
+	p->bound[num] = p->bound[i];
+	p->bounded[num] = p->bounded[i];
+	p->leaf[num++] = p->leaf[i];
+    }
+    for (n = p->node; n < p->node + p->num_nodes; n++)
+	if (n->left < 0)
+	    for (k = n->first; k < n->first + n->num; k++)
+		p->perm[k] = renum[p->perm[k]];
+    p->num = num;
+    return build_slots(p);
+}
+
+static Boolean
+apply_change(pick_index *p, int type, pick_change *c)
+{
+    int		    i;
+
+    switch (c->what) {
+    case CHANGE_ADDED:
+	if (p->num == p->alloc || find_object(p, c->obj) >= 0)
+	    return False;
+	i = p->num++;
+	p->obj[i] = c->obj;
+	object_box(type, c->obj, &p->box[i]);
+	p->bounded[i] = False;
+	add_slot(p, i);
+	return add_to_leaf(p, i);
+    case CHANGE_DELETED:
+	if ((i = find_object(p, c->obj)) < 0)
+	    return False;
+	remove_from_leaf(p, i);
+	/* the slot stays until compact_index() */
+	p->obj[i] = NULL;
+	return True;
+    case CHANGE_OBJECT:
+	if ((i = find_object(p, c->obj)) < 0)
+	    return False;
+	object_box(type, c->obj, &p->box[i]);
+	p->bounded[i] = False;
+	fit_up(p, p->leaf[i]);
+	return True;
+    }
+    return True;
+}
+
+/*
+ * Apply the changes remembered since the index was made. Only the boxes of
+ * the objects added or changed are computed, and only the leaves holding
+ * them and the nodes above are refitted. Return False, if the changes are
+ * not known or the index must be built anew.
+ */
+
+static Boolean
+update_index(pick_index *p, int type)
+{
+    pick_change	   *c, *d, *end = p->change + p->num_changes;
+    Boolean	    listed = False, deleted = False;
+
+    if (p->changes == 0 || p->num_changes < 0 ||
+		(type == O_TXT && p->zoom != display_zoomscale))
+	return False;
+    /* a deleted object may be freed, do not look at it */
+    for (c = p->change; c < end; c++) {
+	if (c->what != CHANGE_OBJECT)
+	    continue;
+	for (d = c - 1; d >= p->change && d->obj != c->obj; d--)
+	    ;
+	if (d >= p->change && d->what == CHANGE_DELETED)
+	    c->what = CHANGE_NONE;
+    }
+    for (c = p->change; c < end; c++) {
+	if (c->what == CHANGE_DELETED || c->what == CHANGE_NONE)
+	    continue;
+	for (d = c + 1; d < end; d++)
+	    if (d->obj == c->obj && d->what == CHANGE_DELETED) {
+		if (c->what == CHANGE_ADDED)
+		    d->what = CHANGE_NONE;
+		c->what = CHANGE_NONE;
+		break;
+	    }
+    }
+    for (c = p->change; c < end; c++) {
+	if (!apply_change(p, type, c)) {
+	    p->changes = 0;
+	    return False;
+	}
+	listed |= c->what == CHANGE_ADDED;
+	deleted |= c->what == CHANGE_DELETED;
+    }
+    /* the objects must be numbered in list order */
+    if ((deleted && !compact_index(p)) ||
+		((listed || deleted) && !same_objects(p, type))) {
+	p->changes = 0;
+	return False;
+    }
+    p->head = list_head(type);
+    p->changes = changes;
+    p->num_changes = 0;
+    return True;
+}
+
+static pick_index *
+fresh_index(int type)
+{
+    pick_index	   *p = &pindex[type];
+
+    if (p->changes != changes || p->head != list_head(type) ||
+		(type == O_TXT && p->zoom != display_zoomscale))
+	if (!update_index(p, type) && !refit_index(p, type) &&
+		!build_index(p, type))
+	    put_msg("Not enough memory to search the objects");
+    return p;
+}
+
+/* return the number of objects of type */
+
+int
+pick_count(int type)
+{
+    return fresh_index(type)->num;
+}
+
+/* return the objects of type, in list order */
+
+int
+pick_objects(int type, void ***obj)
+{
+    pick_index	   *p = fresh_index(type);
+
+    *obj = p->obj;
+    return p->num;
+}
+
+static void
+search_node(pick_index *p, int k, int x, int y, int tol, int *num)
+{
+    pick_node	   *n = &p->node[k];
+    pick_box	   *b;
+    int		    i;
+
+    if (x < n->box.xmin - tol || x > n->box.xmax + tol ||
+		y < n->box.ymin - tol || y > n->box.ymax + tol)
+	return;
+    if (n->left < 0) {
+	for (i = n->first; i < n->first + n->num; i++) {
+	    b = &p->box[p->perm[i]];
+	    if (x >= b->xmin - tol && x <= b->xmax + tol &&
+			y >= b->ymin - tol && y <= b->ymax + tol)
+		p->cand[(*num)++] = p->perm[i];
+	}
+	return;
+    }
+    search_node(p, n->left, x, y, tol, num);
+    search_node(p, n->right, x, y, tol, num);
+}
+
+/*
+ * Return the number of objects of type whose bounding box, enlarged by
+ * tolerance, contains (x, y). The numbers of these objects, counted
+ * from the head of the list, are put into *cand in increasing order.
+ */
+
+int
+pick_candidates(int type, int x, int y, int tolerance, int **cand)
+{
+    pick_index	   *p = fresh_index(type);
+    int		    num = 0;
+
+    *cand = p->cand;
+    if (p->num == 0)
+	return 0;
+    search_node(p, 0, x, y, tolerance, &num);
+    qsort(p->cand, num, sizeof(int), compare_int);
+    return num;
+}
+
+/*
+ * Get the bounds that must lie within a region to select the object, see
+ * tag_obj_in_region() in e_glue.c. The object lies within these bounds,
+ * and also within the box from object_box().
+ */
+
+static void
+region_bound(int type, void *obj, pick_box *b)
+{
+    F_compound	   *c;
+    F_ellipse	   *e;
+    int		    dum;
+
+    switch (type) {
+    case O_ARC:
+	arc_bound((F_arc *) obj, &b->xmin, &b->ymin, &b->xmax, &b->ymax);
+	break;
+    case O_COMPOUND:
+	c = (F_compound *) obj;
+	b->xmin = c->nwcorner.x;
+	b->ymin = c->nwcorner.y;
+	b->xmax = c->secorner.x;
+	b->ymax = c->secorner.y;
+	break;
+    case O_ELLIPSE:
+	e = (F_ellipse *) obj;
+	b->xmin = e->center.x - e->radiuses.x;
+	b->ymin = e->center.y - e->radiuses.y;
+	b->xmax = e->center.x + e->radiuses.x;
+	b->ymax = e->center.y + e->radiuses.y;
+	break;
+    case O_POLYLINE:
+	points_box(((F_line *) obj)->points, b);
+	break;
+    case O_SPLINE:
+	spline_bound((F_spline *) obj, &b->xmin, &b->ymin, &b->xmax, &b->ymax);
+	break;
+    case O_TXT:
+	text_bound((F_text *) obj, &b->xmin, &b->ymin, &b->xmax, &b->ymax,
+			&dum, &dum, &dum, &dum, &dum, &dum, &dum, &dum);
+	break;
+    }
+}
+
+static void
+region_node(pick_index *p, int type, int k, pick_box *r, int *num)
+{
+    pick_node	   *n = &p->node[k];
+    pick_box	   *b;
+    int		    i, j;
+
+    if (n->box.xmax < r->xmin || n->box.xmin > r->xmax ||
+		n->box.ymax < r->ymin || n->box.ymin > r->ymax)
+	return;
+    if (n->left >= 0) {
+	region_node(p, type, n->left, r, num);
+	region_node(p, type, n->right, r, num);
+	return;
+    }
+    for (i = n->first; i < n->first + n->num; i++) {
+	j = p->perm[i];
+	b = &p->box[j];
+	if (b->xmax < r->xmin || b->xmin > r->xmax ||
+		b->ymax < r->ymin || b->ymin > r->ymax)
+	    continue;
+	if (!p->bounded[j]) {
+	    region_bound(type, p->obj[j], &p->bound[j]);
+	    p->bounded[j] = True;
+	}
+	b = &p->bound[j];
+	if (b->xmin >= r->xmin && b->xmax <= r->xmax &&
+		b->ymin >= r->ymin && b->ymax <= r->ymax)
+	    p->cand[(*num)++] = j;
+    }
+}
+
+/*
+ * Return the number of objects of type that lie within the region. The
+ * numbers of these objects are put into *cand in increasing order. The
+ * bounds of the objects are kept until the figure changes.
+ */
+
+int
+pick_region(int type, int xmin, int ymin, int xmax, int ymax, int **cand)
+{
+    pick_index	   *p = fresh_index(type);
+    pick_box	    r;
+    int		    num = 0;
+
+    *cand = p->cand;
+    if (p->num == 0)
+	return 0;
+    r.xmin = xmin;
+    r.ymin = ymin;
+    r.xmax = xmax;
+    r.ymax = ymax;
+    region_node(p, type, 0, &r, &num);
+    qsort(p->cand, num, sizeof(int), compare_int);
+    return num;
+}
+
+/*
+ * The queue of pick_nearest(), a binary heap ordered by the distance to
+ * the point. An entry is a node of the tree, or an object if node < 0.
+ */
+
+typedef struct {
+	double	dist;
+	int	node;
+	int	obj;
+} pick_queue;
+
+static pick_queue	*queue = NULL;
+static int		 num_queue = 0, alloc_queue = 0;
+static double		*nearest_dist = NULL;
+static int		 alloc_nearest = 0;
+
+/* distance of (x, y) from box b, 0 if inside */
+static double
+box_distance(pick_box *b, int x, int y)
+{
+    double	    dx, dy;
+
+    dx = x < b->xmin ? b->xmin - x : (x > b->xmax ? x - b->xmax : 0);
+    dy = y < b->ymin ? b->ymin - y : (y > b->ymax ? y - b->ymax : 0);
+    return sqrt(dx * dx + dy * dy);
+}
+
+static Boolean
+push_queue(double dist, int node, int obj)
+{
+    pick_queue	   *q;
+    int		    i, j;
+
+    if (num_queue == alloc_queue) {
+	i = alloc_queue ? 2 * alloc_queue : 256;
+	if ((q = realloc(queue, i * sizeof(pick_queue))) == NULL)
+	    return False;
+	queue = q;
+	alloc_queue = i;
+    }
+    for (i = num_queue++; i > 0 && queue[j = (i - 1) / 2].dist > dist; i = j)
+	queue[i] = queue[j];
+    queue[i].dist = dist;
+    queue[i].node = node;
+    queue[i].obj = obj;
+    return True;
+}
+
+static pick_queue
+pop_queue(void)
+{
+    pick_queue	    top = queue[0];
+    pick_queue	    last = queue[--num_queue];
+    int		    i, j;
+
+    for (i = 0; (j = 2 * i + 1) < num_queue; i = j) {
+	if (j + 1 < num_queue && queue[j + 1].dist < queue[j].dist)
+	    ++j;
+	if (queue[j].dist >= last.dist)
+	    break;
+	queue[i] = queue[j];
+    }
+    queue[i] = last;
+    return top;
+}
+
+/*
+ * Return the number of the objects of type, at most k, whose bounding box
+ * comes closest to (x, y), but not farther than maxdist. The numbers of the
+ * objects are put into *cand, the distances of their bounding boxes into
+ * *dist, both in increasing order of the distance. The distance of the
+ * bounding box is a lower bound of the distance of the object. The tree
+ * is searched best first, the first k objects are always the same for a
+ * larger k.
+ */
+
+int
+pick_nearest(int type, int x, int y, int maxdist, int k, int **cand,
+		double **dist)
+{
+    pick_index	   *p = fresh_index(type);
+    pick_node	   *n;
+    pick_queue	    q;
+    double	   *d;
+    int		    i, num = 0;
+
+    *cand = p->cand;
+    if (p->num == 0 || k <= 0)
+	return 0;
+    if (alloc_nearest < p->num) {
+	if ((d = realloc(nearest_dist, p->num * sizeof(double))) == NULL)
+	    return 0;
+	nearest_dist = d;
+	alloc_nearest = p->num;
+    }
+    *dist = nearest_dist;
+
+    num_queue = 0;
+    if (!push_queue(box_distance(&p->node[0].box, x, y), 0, -1))
+	return 0;
+    while (num_queue > 0 && num < k) {
+	q = pop_queue();
+	if (q.dist > maxdist)
+	    break;
+	if (q.node < 0) {
+	    p->cand[num] = q.obj;
+	    nearest_dist[num++] = q.dist;
+	    continue;
+	}
+	n = &p->node[q.node];
+	if (n->left >= 0) {
+	    if (!push_queue(box_distance(&p->node[n->left].box, x, y),
+				n->left, -1) ||
+		    !push_queue(box_distance(&p->node[n->right].box, x, y),
+				n->right, -1))
+		break;
+	    continue;
+	}
+	for (i = n->first; i < n->first + n->num; i++)
+	    if (!push_queue(box_distance(&p->box[p->perm[i]], x, y), -1,
+				p->perm[i]))
+		break;
+    }
+    return num;
+}
+
+/* return the number of obj in its list, or -1 */
+
+int
+pick_number(int type, void *obj)
+{
+    pick_index	   *p = fresh_index(type);
+
+    if (p->num == 0)
+	return -1;
+    return find_object(p, obj);
+}
+
+/*
+ * The vertex index: the points of all top-level objects, hashed by the
+ * cell of a square grid they fall into. The cells are about as large as
+ * the tolerance of the searches. Like the pick index above, the vertex
+ * index is built on first use after the figure changed. Adding, moving or
+ * deleting a point of a line or a spline updates the vertex index in
+ * place, if the caller holds it with pick_hold_vertices() across the
+ * change.
+ */
+
+/* the vertex index is rebuilt if the tolerance differs by this factor */
+#define CELL_RATIO	4
+#define MIN_CELL	16
+/* give up pick_nearest_point() after searching this many cells */
+#define MAX_RING_CELLS	4096
+
+typedef struct {
+	pick_vertex  v;
+	int	     type;
+	int	     next;	/* next entry in the same bucket, or -1 */
+} pick_entry;
+
+static struct {
+	pick_entry  *entry;
+	int	     num_entries, alloc_entries;
+	int	     free;	/* list of unused entries, or -1 */
+	int	    *bucket;	/* first entry in each bucket, or -1 */
+	int	     num_buckets; /* a power of two */
+	int	     cell;	/* side of a grid cell */
+	void	    *head[O_COMPOUND + 1];
+	unsigned long changes;	/* value of changes when built */
+	Boolean	     held;	/* kept current by pick_point_*() */
+	pick_vertex *hit;	/* result of pick_vertices() */
+	int	     alloc_hits;
+} vindex = { NULL, 0, 0, -1, NULL, 0, 0, {NULL}, 0, False, NULL, 0 };
+
+/* used by compare_hit() */
+static int	hit_x, hit_y;
+
+static int
+cell_of(int c)
+{
+    /* round towards minus infinity */
+    return c >= 0 ? c / vindex.cell : -1 - (-1 - c) / vindex.cell;
+}
+
+static int *
+bucket_of_cell(int cx, int cy)
+{
+    unsigned int    h;
+
+    h = (unsigned int) cx * 73856093u ^ (unsigned int) cy * 19349663u;
+    return &vindex.bucket[h & (vindex.num_buckets - 1)];
+}
+
+static int *
+bucket_of(int x, int y)
+{
+    return bucket_of_cell(cell_of(x), cell_of(y));
+}
+
+static Boolean
+add_vertex(int type, void *obj, int x, int y, F_point *point, F_point *prev,
+		int pnum)
+{
+    pick_entry	   *e;
+    int		    k, *b;
+
+    if (vindex.free >= 0) {
+	k = vindex.free;
+	vindex.free = vindex.entry[k].next;
+    } else {
+	if (vindex.num_entries == vindex.alloc_entries) {
+	    k = vindex.alloc_entries ? 2 * vindex.alloc_entries : 1024;
+	    if ((e = realloc(vindex.entry, k * sizeof(pick_entry))) == NULL)
+		return False;
+	    vindex.entry = e;
+	    vindex.alloc_entries = k;
+	}
+	k = vindex.num_entries++;
+    }
+    e = &vindex.entry[k];
+    e->type = type;
+    e->v.obj = obj;
+    e->v.x = x;
+    e->v.y = y;
+    e->v.point = point;
+    e->v.prev = prev;
+    e->v.pnum = pnum;
+    b = bucket_of(x, y);
+    e->next = *b;
+    *b = k;
+    return True;
+}
+
+/* unlink the entry of point from its bucket and return it, or -1 */
+
+static int
+remove_vertex(F_point *point)
+{
+    int		   *k, i;
+
+    for (k = bucket_of(point->x, point->y); *k >= 0;
+		k = &vindex.entry[*k].next)
+	if (vindex.entry[*k].v.point == point) {
+	    i = *k;
+	    *k = vindex.entry[i].next;
+	    return i;
+	}
+    return -1;
+}
+
+static pick_entry *
+find_vertex(F_point *point)
+{
+    int		    k;
+
+    for (k = *bucket_of(point->x, point->y); k >= 0; k = vindex.entry[k].next)
+	if (vindex.entry[k].v.point == point)
+	    return &vindex.entry[k];
+    return NULL;
+}
+
+static int
+count_vertices(int type, void *obj)
+{
+    F_point	   *p;
+    int		    n = 0;
+
+    switch (type) {
+    case O_ARC:
+	return 3;
+    case O_COMPOUND:
+	return 4;
+    case O_ELLIPSE:
+	return 2;
+    case O_POLYLINE:
+	p = ((F_line *) obj)->points;
+	break;
+    case O_SPLINE:
+	p = ((F_spline *) obj)->points;
+	break;
+    default:
+	return 0;
+    }
+    for (; p != NULL; p = p->next)
+	n++;
+    return n;
+}
+
+static Boolean
+add_vertices(int type, void *obj)
+{
+    F_arc	   *a;
+    F_compound	   *c;
+    F_ellipse	   *e;
+    F_point	   *p, *prev;
+    int		    i;
+
+    switch (type) {
+    case O_ARC:
+	a = (F_arc *) obj;
+	for (i = 0; i < 3; i++)
+	    if (!add_vertex(type, obj, a->point[i].x, a->point[i].y, NULL,
+				NULL, i))
+		return False;
+	return True;
+    case O_COMPOUND:
+	/* the corners, in the order used by do_point_search() */
+	c = (F_compound *) obj;
+	return add_vertex(type, obj, c->nwcorner.x, c->nwcorner.y, NULL, NULL, 0)
+	    && add_vertex(type, obj, c->nwcorner.x, c->secorner.y, NULL, NULL, 1)
+	    && add_vertex(type, obj, c->secorner.x, c->nwcorner.y, NULL, NULL, 2)
+	    && add_vertex(type, obj, c->secorner.x, c->secorner.y, NULL, NULL, 3);
+    case O_ELLIPSE:
+	e = (F_ellipse *) obj;
+	return add_vertex(type, obj, e->start.x, e->start.y, NULL, NULL, 0) &&
+		add_vertex(type, obj, e->end.x, e->end.y, NULL, NULL, 1);
+    case O_POLYLINE:
+	p = ((F_line *) obj)->points;
+	break;
+    case O_SPLINE:
+	p = ((F_spline *) obj)->points;
+	break;
+    default:
+	return True;
+    }
+    for (prev = NULL; p != NULL; prev = p, p = p->next)
+	if (!add_vertex(type, obj, p->x, p->y, p, prev, 0))
+	    return False;
+    return True;
+}
+
+static Boolean
+build_vertices(int cell)
+{
+    void	   *o;
+    int		   *b;
+    int		    type, num, size, k;
+
+    vindex.changes = changes;
+    vindex.held = False;
+    vindex.cell = cell;
+    vindex.num_entries = 0;
+    vindex.free = -1;
+
+    num = 0;
+    for (type = O_ELLIPSE; type <= O_COMPOUND; type++) {
+	vindex.head[type] = list_head(type);
+	if (type != O_TXT)
+	    for (o = vindex.head[type]; o != NULL; o = next_object(type, o))
+		num += count_vertices(type, o);
+    }
+    for (size = 1024; size < 2 * num; size *= 2)
+	;
+    if (size > vindex.num_buckets) {
+	if ((b = realloc(vindex.bucket, size * sizeof(int))) == NULL) {
+	    vindex.changes = 0;
+	    return False;
+	}
+	vindex.bucket = b;
+	vindex.num_buckets = size;
+    }
+    for (k = 0; k < vindex.num_buckets; k++)
+	vindex.bucket[k] = -1;
+
+    for (type = O_ELLIPSE; type <= O_COMPOUND; type++)
+	for (o = vindex.head[type]; type != O_TXT && o != NULL;
+		o = next_object(type, o))
+	    if (!add_vertices(type, o)) {
+		vindex.changes = 0;
+		return False;
+	    }
+    return True;
+}
+
+static Boolean
+fresh_vertices(int tolerance)
+{
+    Boolean	    fresh;
+    int		    type, cell;
+
+    cell = max2(tolerance, MIN_CELL);
+    fresh = vindex.changes == changes && cell <= CELL_RATIO * vindex.cell &&
+		vindex.cell <= CELL_RATIO * cell;
+    for (type = O_ELLIPSE; type <= O_COMPOUND; type++)
+	if (vindex.head[type] != list_head(type))
+	    fresh = False;
+    if (!fresh && !build_vertices(cell)) {
+	put_msg("Not enough memory to search the points");
+	return False;
+    }
+    return True;
+}
+
+static int
+compare_hit(const void *a, const void *b)
+{
+    const pick_vertex *ha = a;
+    const pick_vertex *hb = b;
+    double	    da, db;
+
+    if (ha->num != hb->num)
+	return ha->num - hb->num;
+    da = hypot((double) (ha->x - hit_x), (double) (ha->y - hit_y));
+    db = hypot((double) (hb->x - hit_x), (double) (hb->y - hit_y));
+    if (da != db)
+	return da < db ? -1 : 1;
+    /* of the first and the closing point of a polygon, take the first */
+    return (ha->prev != NULL) - (hb->prev != NULL);
+}
+
+/*
+ * Return the number of objects of type with a point within tolerance of
+ * (x, y), in both directions. For each object, the point closest to (x, y)
+ * is put into *hit, in the order of the objects in their list.
+ */
+
+int
+pick_vertices(int type, int x, int y, int tolerance, pick_vertex **hit)
+{
+    pick_entry	   *e;
+    pick_vertex	   *h;
+    int		    cx, cy, k, i, num = 0;
+
+    *hit = vindex.hit;
+    if (!fresh_vertices(tolerance))
+	return 0;
+    for (cx = cell_of(x - tolerance); cx <= cell_of(x + tolerance); cx++)
+	for (cy = cell_of(y - tolerance); cy <= cell_of(y + tolerance); cy++)
+	    for (k = *bucket_of_cell(cx, cy); k >= 0; k = e->next) {
+		e = &vindex.entry[k];
+		if (e->type != type || abs(e->v.x - x) > tolerance ||
+			abs(e->v.y - y) > tolerance ||
+			cell_of(e->v.x) != cx || cell_of(e->v.y) != cy)
+		    continue;
+		if (num == vindex.alloc_hits) {
+		    i = vindex.alloc_hits ? 2 * vindex.alloc_hits : 64;
+		    if ((h = realloc(vindex.hit, i * sizeof(pick_vertex))) == NULL)
+			break;
+		    vindex.hit = h;
+		    vindex.alloc_hits = i;
+		}
+		vindex.hit[num] = e->v;
+		vindex.hit[num].num = pick_number(type, e->v.obj);
+		if (vindex.hit[num].num >= 0)
+		    num++;
+	    }
+
+    /* keep the closest point of each object */
+    hit_x = x;
+    hit_y = y;
+    qsort(vindex.hit, num, sizeof(pick_vertex), compare_hit);
+    for (i = k = 0; i < num; i++)
+	if (k == 0 || vindex.hit[i].num != vindex.hit[k - 1].num)
+	    vindex.hit[k++] = vindex.hit[i];
+    *hit = vindex.hit;
+    return k;
+}
+
+/*
+ * Return the point of the line or spline obj that is closest to (x, y).
+ * Search the cells around (x, y) in growing rings, until the rings are
+ * farther away than the closest point found.
+ */
+
+F_point *
+pick_nearest_point(int type, void *obj, int x, int y)
+{
+    F_point	   *p, *best = NULL;
+    pick_entry	   *e;
+    double	    d, dist = HUGE_VAL;
+    int		    cx, cy, r, k, cells = 0;
+
+    /* keep the present grid, or use about the tolerance at zoom 1 */
+    if (fresh_vertices(vindex.cell > 0 ? vindex.cell : PIX_PER_INCH / 8) &&
+		pick_number(type, obj) >= 0) {
+	for (r = 0; cells < MAX_RING_CELLS; r++) {
+	    if (best != NULL && dist <= (double) (r - 1) * vindex.cell)
+		return best;
+	    for (cx = cell_of(x) - r; cx <= cell_of(x) + r; cx++)
+		for (cy = cell_of(y) - r; cy <= cell_of(y) + r; cy++) {
+		    /* only the cells on the ring */
+		    if (abs(cx - cell_of(x)) != r && abs(cy - cell_of(y)) != r)
+			continue;
+		    cells++;
+		    for (k = *bucket_of_cell(cx, cy); k >= 0; k = e->next) {
+			e = &vindex.entry[k];
+			if (e->v.obj != obj || cell_of(e->v.x) != cx ||
+				cell_of(e->v.y) != cy)
+			    continue;
+			d = hypot((double) (e->v.x - x), (double) (e->v.y - y));
+			if (d < dist) {
+			    dist = d;
+			    best = e->v.point;
+			}
+		    }
+		}
+	}
+    }
+
+    /* far away from any point, or not in the figure */
+    p = type == O_POLYLINE ? ((F_line *) obj)->points :
+		((F_spline *) obj)->points;
+    for (best = NULL, dist = HUGE_VAL; p != NULL; p = p->next) {
+	d = hypot((double) (p->x - x), (double) (p->y - y));
+	if (d < dist) {
+	    dist = d;
+	    best = p;
+	}
+    }
+    return best;
+}
+
+/*
+ * While held, changes of the figure do not invalidate the vertex index.
+ * The caller must update it with pick_point_added(), pick_point_moved()
+ * and pick_point_deleted().
+ */
+
+void
+pick_hold_vertices(Boolean hold)
+{
+    vindex.held = hold && vindex.changes == changes;
+}
+
+/* called by pick_changed() */
+
+static void
+keep_vertices(void)
+{
+    int		    type;
+
+    if (!vindex.held)
+	return;
+    vindex.changes = changes;
+    for (type = O_ELLIPSE; type <= O_COMPOUND; type++)
+	vindex.head[type] = list_head(type);
+}
+
+static void
+drop_vertices(void)
+{
+    vindex.held = False;
+    vindex.changes = 0;
+}
+
+/* point was linked into obj after prev */
+
+void
+pick_point_added(int type, void *obj, F_point *prev, F_point *point)
+{
+    pick_entry	   *e;
+
+    if (!vindex.held)
+	return;
+    if (!add_vertex(type, obj, point->x, point->y, point, prev, 0)) {
+	drop_vertices();
+	return;
+    }
+    if (point->next != NULL && (e = find_vertex(point->next)) != NULL)
+	e->v.prev = point;
+}
+
+/* point is about to be moved to (x, y) */
+
+void
+pick_point_moved(F_point *point, int x, int y)
+{
+    int		    k, *b;
+
+    if (!vindex.held)
+	return;
+    if ((k = remove_vertex(point)) < 0) {
+	drop_vertices();
+	return;
+    }
+    vindex.entry[k].v.x = x;
+    vindex.entry[k].v.y = y;
+    b = bucket_of(x, y);
+    vindex.entry[k].next = *b;
+    *b = k;
+}
+
+/* point, following prev, is about to be unlinked */
+
+void
+pick_point_deleted(F_point *prev, F_point *point)
+{
+    pick_entry	   *e;
+    int		    k;
+
+    if (!vindex.held)
+	return;
+    if ((k = remove_vertex(point)) < 0) {
+	drop_vertices();
+	return;
+    }
+    vindex.entry[k].next = vindex.free;
+    vindex.free = k;
+    if (point->next != NULL && (e = find_vertex(point->next)) != NULL)
+	e->v.prev = prev;
+}
@@ -0,0 +1,66 @@
+/*
+ * FIG : Facility for Interactive Generation of figures
+ * Copyright (c) 1985-1988 by Supoj Sutanthavibul
+ * Parts Copyright (c) 1989-2015 by Brian V. Smith
+ * Parts Copyright (c) 1991 by Paul King
+ * Parts Copyright (c) 2016-2020 by Thomas Loimer
+ *
+ * Any party obtaining a copy of these files is granted, free of charge, a
+ * full and unrestricted irrevocable, world-wide, paid up, royalty-free,
+ * nonexclusive right and license to deal in this software and documentation
+ * files (the "Software"), including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense and/or sell copies of
+ * the Software, and to permit persons who receive copies from any such
+ * party to do so, with the only requirement being that the above copyright
+ * and this permission notice remain intact.
+ *
+ */
+
+#ifndef U_PICK_H
+#define U_PICK_H
+
+/* maximum number of objects in a leaf of the bounding box tree */
+#define PICK_LEAF	8
+/* places for objects in a leaf, to add objects without building anew */
+#define PICK_SPACE	(2 * PICK_LEAF)
+/* refits of the whole tree after unknown changes, before it is built anew */
+#define PICK_REFITS	32
+/* objects added, deleted or changed that are remembered between searches */
+#define PICK_CHANGES	64
+
+/* a point found by pick_vertices() */
+typedef struct {
+	void	   *obj;
+	int	    num;	/* the number of obj in its list */
+	int	    x, y;
+	F_point	   *point;	/* for lines and splines, the point */
+	F_point	   *prev;	/* and the point before, or NULL */
+	int	    pnum;	/* the number of the point of an arc, ellipse
+				   or compound */
+} pick_vertex;
+
+extern void	pick_changed(void);
+extern void	pick_object_added(int type, void *obj);
+extern void	pick_object_deleted(int type, void *obj);
+extern void	pick_object_changed(int type, void *obj);
+extern unsigned long pick_changes(void);
+extern int	pick_count(int type);
+extern int	pick_objects(int type, void ***obj);
+extern int	pick_candidates(int type, int x, int y, int tolerance,
+				int **cand);
+extern int	pick_region(int type, int xmin, int ymin, int xmax, int ymax,
+				int **cand);
+extern int	pick_nearest(int type, int x, int y, int maxdist, int k,
+				int **cand, double **dist);
+extern int	pick_number(int type, void *obj);
+
+extern int	pick_vertices(int type, int x, int y, int tolerance,
+				pick_vertex **hit);
+extern F_point *pick_nearest_point(int type, void *obj, int x, int y);
+extern void	pick_hold_vertices(Boolean hold);
+extern void	pick_point_added(int type, void *obj, F_point *prev,
+				F_point *point);
+extern void	pick_point_moved(F_point *point, int x, int y);
+extern void	pick_point_deleted(F_point *prev, F_point *point);
+
+#endif /* U_PICK_H */
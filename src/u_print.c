@@ -16,6 +16,8 @@
  *
  */
 
+#include <sys/wait.h>		/* waitpid() */
+
 #include "fig.h"
 #include "resources.h"
 #include "object.h"
@@ -39,7 +41,6 @@ Boolean	hpgl_specified_font;
 Boolean	pdf_pagemode;
 int	preview_type;
 
-static int	exec_prcmd(char *command, char *msg);
 static void	build_layer_list (char *layers);
 static void	append_group (char *list, char *num, int first, int last);
 
@@ -119,6 +120,318 @@ write_tmpfigfile(char *tmpfile, size_t len, char *template)
 	return 0;
 }
 
+/*
+ * Export and print jobs. The figure is written to a temporary Fig file
+ * when a job is started, so that it can be changed meanwhile, and the
+ * commands that convert the file are run in the background by /bin/sh, at
+ * most MAX_EXPORT_CMDS at a time; the others wait in a queue. A command
+ * runs in the directory that was current when its job was started, the
+ * file panel changes it while the user browses. The error output of a
+ * command goes to a pipe read by an Xt input callback. After the end of the
+ * pipe, the command is reaped without blocking, polling with a timeout if
+ * it did not exit yet. When all commands of a job are done, the temporary
+ * file is removed, and the job reports success or the messages of the
+ * commands that failed.
+ */
+
+#define MAX_EXPORT_CMDS	4	/* commands run at a time */
+#define CMD_MSG_SIZE	4096	/* error output kept of a command */
+#define REAP_INTERVAL	100	/* ms between checks whether a command exited */
+
+typedef struct {
+	char		 tmpfile[PATH_MAX];
+	char		 cwd[PATH_MAX];	/* where the commands run */
+	char		*done_msg;	/* shown if all commands succeeded */
+	int		 cmds;		/* not yet finished */
+	Boolean		 failed;
+	Boolean		 submitted;	/* all commands were added */
+} export_job;
+
+typedef struct export_cmd {
+	export_job	*job;
+	char		*command;
+	char		*msg;		/* e.g., "EXPORT of EPS part" */
+	pid_t		 pid;
+	int		 fd;		/* read end of its error output, or -1 */
+	XtInputId	 id;
+	XtIntervalId	 timer;		/* to reap it, or 0 */
+	char		 err[CMD_MSG_SIZE];
+	int		 errlen;
+	struct export_cmd *next;
+} export_cmd;
+
+static export_cmd	*running_cmds = NULL;
+static export_cmd	*queued_cmds = NULL;	/* the first added first */
+static int		 num_running = 0;
+
+static void	start_cmds(void);
+
+static export_job *
+new_job(char *template)
+{
+	export_job	*job;
+
+	if ((job = calloc(1, sizeof(export_job))) == NULL) {
+		file_msg("Out of memory, cannot export the figure");
+		return NULL;
+	}
+	if (write_tmpfigfile(job->tmpfile, sizeof(job->tmpfile), template)) {
+		free(job);
+		return NULL;
+	}
+	/* if this fails, the commands run wherever xfig is then */
+	(void)get_directory(job->cwd);
+	return job;
+}
+
+static void
+end_job(export_job *job)
+{
+	remove(job->tmpfile);
+	if (!job->failed && job->done_msg)
+		put_msg("%s", job->done_msg);
+	free(job->done_msg);
+	free(job);
+}
+
+/* all commands of job were added; show done_msg when they succeeded */
+static void
+submit_job(export_job *job, char *done_msg)
+{
+	job->done_msg = strdup(done_msg);
+	job->submitted = True;
+	if (job->cmds == 0)
+		end_job(job);
+}
+
+static void
+end_cmd(export_cmd *cmd)
+{
+	export_job	*job = cmd->job;
+
+	free(cmd->command);
+	free(cmd->msg);
+	free(cmd);
+	if (--job->cmds == 0 && job->submitted)
+		end_job(job);
+}
+
+/* queue command, msg names it in error messages */
+static void
+add_cmd(export_job *job, char *command, char *msg)
+{
+	export_cmd	*cmd, **c;
+
+	if ((cmd = calloc(1, sizeof(export_cmd))) == NULL ||
+			(cmd->command = strdup(command)) == NULL ||
+			(cmd->msg = strdup(msg)) == NULL) {
+		if (cmd) {
+			free(cmd->command);
+			free(cmd);
+		}
+		file_msg("Out of memory, cannot run %s", msg);
+		job->failed = True;
+		return;
+	}
+	cmd->job = job;
+	++job->cmds;
+	for (c = &queued_cmds; *c != NULL; c = &(*c)->next)
+		;
+	*c = cmd;
+	start_cmds();
+}
+
+static void
+keep_output(export_cmd *cmd, char *buf, ssize_t n)
+{
+	if (n > CMD_MSG_SIZE - 1 - cmd->errlen)
+		n = CMD_MSG_SIZE - 1 - cmd->errlen;
+	memcpy(cmd->err + cmd->errlen, buf, n);
+	cmd->errlen += n;
+}
+
+static void
+report_errors(export_cmd *cmd)
+{
+	char	*line, *end;
+
+	cmd->job->failed = True;
+	if (cmd->errlen == 0) {
+		file_msg("Error during %s. No messages available.", cmd->msg);
+		return;
+	}
+	cmd->err[cmd->errlen] = '\0';
+	file_msg("Error during %s.  Messages:", cmd->msg);
+	for (line = cmd->err; *line; line = end) {
+		if ((end = strchr(line, '\n')) != NULL)
+			*end++ = '\0';
+		else
+			end = line + strlen(line);
+		file_msg(" %s", line);
+	}
+}
+
+static void	reap_timeout(XtPointer client_data, XtIntervalId *id);
+
+/*
+ * Reap cmd, after its error output was closed. If it did not exit yet,
+ * e.g., it closed its error output before exiting, try again later unless
+ * block is set.
+ */
+static void
+reap_cmd(export_cmd *cmd, Boolean block)
+{
+	export_cmd	**c;
+	pid_t		pid;
+	int		status;
+
+	while ((pid = waitpid(cmd->pid, &status, block ? 0 : WNOHANG)) < 0 &&
+			errno == EINTR)
+		;
+	if (pid == 0) {
+		cmd->timer = XtAppAddTimeOut(tool_app, REAP_INTERVAL,
+				(XtTimerCallbackProc)reap_timeout,
+				(XtPointer)cmd);
+		return;
+	}
+	if (pid != cmd->pid)
+		/* reaped by someone else, see is_preedit_running() */
+		status = cmd->errlen > 0;
+
+	for (c = &running_cmds; *c != cmd; c = &(*c)->next)
+		;
+	*c = cmd->next;
+	--num_running;
+	if (status != 0)
+		report_errors(cmd);
+	end_cmd(cmd);
+	start_cmds();
+}
+
+/* called by XtAppAddTimeOut */
+static void
+reap_timeout(XtPointer client_data, XtIntervalId *id)
+{
+	export_cmd	*cmd = (export_cmd *)client_data;
+
+	cmd->timer = 0;
+	reap_cmd(cmd, False);
+}
+
+/* the error output of cmd was closed, the command finished */
+static void
+cmd_finished(export_cmd *cmd)
+{
+	XtRemoveInput(cmd->id);
+	close(cmd->fd);
+	cmd->fd = -1;
+	reap_cmd(cmd, False);
+}
+
+/* read the error output of a command, called by XtAppAddInput */
+static void
+cmd_input(XtPointer client_data, int *fd, XtInputId *id)
+{
+	export_cmd	*cmd = (export_cmd *)client_data;
+	char		buf[BUFSIZ];
+	ssize_t		n;
+
+	if ((n = read(*fd, buf, sizeof(buf))) > 0)
+		keep_output(cmd, buf, n);
+	else if (n == 0 || errno != EINTR)
+		cmd_finished(cmd);
+}
+
+static void
+start_cmd(export_cmd *cmd)
+{
+	int	fds[2];
+
+	if (appres.DEBUG)
+		fprintf(stderr,"Execing: %s\n",cmd->command);
+	fflush(NULL);
+	if (pipe(fds) != 0) {
+		file_msg("Cannot run %s: %s", cmd->msg, strerror(errno));
+		cmd->job->failed = True;
+		end_cmd(cmd);
+		return;
+	}
+	if ((cmd->pid = fork()) == 0) {
+		/* the error output goes to the pipe */
+		close(fds[0]);
+		if (fds[1] != 2) {
+			dup2(fds[1], 2);
+			close(fds[1]);
+		}
+		if (cmd->job->cwd[0] != '\0' && chdir(cmd->job->cwd) != 0) {
+			fprintf(stderr, "Cannot change to %s: %s\n",
+					cmd->job->cwd, strerror(errno));
+			_exit(127);
+		}
+		/* for the pipe to the print command */
+		signal(SIGPIPE, SIG_DFL);
+		execl("/bin/sh", "sh", "-c", cmd->command, (char *)NULL);
+		_exit(127);
+	}
+	close(fds[1]);
+	if (cmd->pid < 0) {
+		file_msg("Cannot run %s: %s", cmd->msg, strerror(errno));
+		close(fds[0]);
+		cmd->job->failed = True;
+		end_cmd(cmd);
+		return;
+	}
+	(void)fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+	cmd->fd = fds[0];
+	cmd->id = XtAppAddInput(tool_app, cmd->fd, (XtPointer)XtInputReadMask,
+			(XtInputCallbackProc)cmd_input, (XtPointer)cmd);
+	cmd->next = running_cmds;
+	running_cmds = cmd;
+	++num_running;
+}
+
+static void
+start_cmds(void)
+{
+	export_cmd	*cmd;
+
+	while (num_running < MAX_EXPORT_CMDS && queued_cmds != NULL) {
+		cmd = queued_cmds;
+		queued_cmds = cmd->next;
+		cmd->next = NULL;
+		start_cmd(cmd);
+	}
+}
+
+/*
+ * Wait for the export and print jobs to finish, e.g., before quitting or
+ * before the exported file is used.
+ */
+void
+wait_export_jobs(void)
+{
+	export_cmd	*cmd;
+	char		buf[BUFSIZ];
+	ssize_t		n;
+
+	while ((cmd = running_cmds) != NULL) {
+		if (cmd->fd >= 0) {
+			while ((n = read(cmd->fd, buf, sizeof(buf))) > 0 ||
+					(n < 0 && errno == EINTR))
+				if (n > 0)
+					keep_output(cmd, buf, n);
+			XtRemoveInput(cmd->id);
+			close(cmd->fd);
+			cmd->fd = -1;
+		}
+		if (cmd->timer != 0) {
+			XtRemoveTimeOut(cmd->timer);
+			cmd->timer = 0;
+		}
+		reap_cmd(cmd, True);
+	}
+}
+
 /*
  * Construct the initial portion of the conversion command string for
  * language lang and write it to cmd. Use the layer option given in layers.
@@ -159,18 +472,19 @@ print_to_printer(char *printer, char *backgrnd, float mag,
 	char	syspr[2*PATH_MAX+200];
 	char	prcmd[2*PATH_MAX+200];
 	char	tmpcmd[255];
-	char	tmpfile[PATH_MAX];
+	char	msg[PATH_MAX+100];
 	char	*name;
 	int	n;
+	export_job	*job;
 
-	if (write_tmpfigfile(tmpfile, sizeof(tmpfile), "xfig-print"))
+	if ((job = new_job("xfig-print")) == NULL)
 		return;
 
 	/* if the user only wants the active layers, build that list */
 	build_layer_list(layers);
 
 	if (strlen(cur_filename) == 0)
-		name = tmpfile;
+		name = job->tmpfile;
 	else
 		name = shell_protect_string(cur_filename);
 
@@ -202,26 +516,24 @@ print_to_printer(char *printer, char *backgrnd, float mag,
 	gen_print_cmd(syspr, "", printer, params);
 
 	/* make up the whole translate/print command */
-	sprintf(prcmd, "%s %s | %s", tmpcmd, tmpfile, syspr);
+	sprintf(prcmd, "%s %s | %s", tmpcmd, job->tmpfile, syspr);
 #ifdef I18N
 	/* reset to original locale */
 	setlocale(LC_NUMERIC, "");
 #endif /* I18N */
 
-	if (exec_prcmd(prcmd, "PRINT") == 0) {
-		if (emptyname(printer))
-			put_msg(
+	add_cmd(job, prcmd, "PRINT");
+	if (emptyname(printer))
+		snprintf(msg, sizeof(msg),
 	"Printing on default printer with %s paper size in %s mode ... done",
-				paper_sizes[appres.papersize].sname,
-				appres.landscape ? "LANDSCAPE" : "PORTRAIT");
-		else
-			put_msg(
+			paper_sizes[appres.papersize].sname,
+			appres.landscape ? "LANDSCAPE" : "PORTRAIT");
+	else
+		snprintf(msg, sizeof(msg),
 	"Printing on \"%s\" with %s paper size in %s mode ... done",
-				printer, paper_sizes[appres.papersize].sname,
-				appres.landscape ? "LANDSCAPE" : "PORTRAIT");
-	}
-
-	remove(tmpfile);
+			printer, paper_sizes[appres.papersize].sname,
+			appres.landscape ? "LANDSCAPE" : "PORTRAIT");
+	submit_job(job, msg);
 }
 
 static void
@@ -254,17 +566,20 @@ print_to_file(char *file, int xoff, int yoff, char *backgrnd, char *transparent,
 	char	prcmd[2*PATH_MAX+200];
 	char	tmpcmd[255];
 	char	tmp_name[PATH_MAX];
-	char	tmp_fig_file[PATH_MAX];
+	char	msg[2*PATH_MAX+300];
+	char	*tmp_fig_file;
 	char	*outfile, *name, *real_lang;
 	char	*suf;
 	int	n;
+	export_job	*job;
 
 	/* if file exists, ask if ok */
 	if (!ok_to_write(file, "EXPORT"))
 		return (1);
 
-	if (write_tmpfigfile(tmp_fig_file, sizeof(tmp_fig_file), "xfig-fig"))
+	if ((job = new_job("xfig-fig")) == NULL)
 		return 1;
+	tmp_fig_file = job->tmpfile;
 
 	/* if the user only wants the active layers, build that list */
 	build_layer_list(layers);
@@ -377,12 +692,12 @@ print_to_file(char *file, int xoff, int yoff, char *backgrnd, char *transparent,
 			/* make it suitable for pstex. */
 			strcpy(tmpcmd, prcmd);
 			strcat(tmpcmd, ".eps");
-			(void) exec_prcmd(tmpcmd, "EXPORT of EPS part");
+			add_cmd(job, tmpcmd, "EXPORT of EPS part");
 
 			/* make it suitable for pdftex. */
 			strsub(prcmd, "ps", "pdf", tmpcmd, 0);
 			strcat(tmpcmd, ".pdf");
-			(void) exec_prcmd(tmpcmd, "EXPORT of PDF part");
+			add_cmd(job, tmpcmd, "EXPORT of PDF part");
 
 			/* and then the tex code. */
 #ifdef I18N
@@ -402,9 +717,9 @@ print_to_file(char *file, int xoff, int yoff, char *backgrnd, char *transparent,
 			sprintf(prcmd + n, " %s %s", tmp_fig_file, outfile);
 
 			if (cur_exp_lang == LANG_PSTEX)
-				(void)exec_prcmd(prcmd, "EXPORT of EPS part");
+				add_cmd(job, prcmd, "EXPORT of EPS part");
 			else /* LANG_PDFTEX */
-				(void)exec_prcmd(prcmd, "EXPORT of PDF part");
+				add_cmd(job, prcmd, "EXPORT of PDF part");
 
 			/* now the text part */
 			/* add "_t" to the output filename and put in tmp_name*/
@@ -429,7 +744,7 @@ print_to_file(char *file, int xoff, int yoff, char *backgrnd, char *transparent,
 			/* Output first file */
 			sprintf(prcmd + n, " %s %s", tmp_fig_file, outfile);
 
-			(void) exec_prcmd(prcmd, "EXPORT of EPS part");
+			add_cmd(job, prcmd, "EXPORT of EPS part");
 #ifdef I18N
 			setlocale(LC_NUMERIC, "C");
 #endif
@@ -566,26 +881,20 @@ print_to_file(char *file, int xoff, int yoff, char *backgrnd, char *transparent,
 		sprintf(prcmd + n, " %s %s", tmp_fig_file, outfile);
 	}
 
-	/* make a busy cursor */
-	set_temp_cursor(wait_cursor);
-
 #ifdef I18N
 	/* reset to original locale */
 	setlocale(LC_NUMERIC, "");
 #endif
 
-	/* now execute fig2dev */
-	if (exec_prcmd(prcmd, "EXPORT") == 0)
-		put_msg("Export to \"%s\" done - %s", file, prcmd);
-
-	/* and reset the cursor */
-	reset_cursor();
+	/* now execute fig2dev, in the background */
+	add_cmd(job, prcmd, "EXPORT");
+	snprintf(msg, sizeof(msg), "Export to \"%s\" done - %s", file, prcmd);
+	submit_job(job, msg);
 
 	/* free tempnames */
 	free(name);
 	free(outfile);
 
-	remove(tmp_fig_file);
 	return 0;
 }
 
@@ -628,50 +937,6 @@ gen_print_cmd(char *cmd, char *file, char *printer, char *pr_params)
     app_flush();		/* make sure message gets displayed */
 }
 
-int
-exec_prcmd(char *command, char *msg)
-{
-	char	errfname[PATH_MAX];
-	FILE	*errfile;
-	char	str[400];
-	int	status, fd;
-
-	/* make temp filename for any errors */
-	snprintf(errfname, sizeof(errfname), "%s/xfig-export.XXXXXX", TMPDIR);
-	if ((fd = mkstemp(errfname)) == -1) {
-		file_msg("Can't open temp file %s: %s\n",
-				errfname, strerror(errno));
-		return 1;
-	}
-	close(fd);
-
-	/* direct any output from fig2dev to this file */
-	strcat(command, " 2> ");
-	strcat(command, errfname);
-	if (appres.DEBUG)
-		fprintf(stderr,"Execing: %s\n",command);
-	status=system(command);
-	if (status != 0) {
-		/* check if error file has anything in it */
-		if ((errfile = fopen(errfname, "r")) == NULL) {
-			file_msg("Error during %s. No messages available.",msg);
-		} else {
-			if (fgets(str,sizeof(str)-1,errfile) != NULL) {
-				rewind(errfile);
-				file_msg("Error during %s.  Messages:",msg);
-				while (fgets(str,sizeof(str)-1,errfile)!=NULL) {
-					/* remove trailing newlines */
-					str[strlen(str)-1] = '\0';
-					file_msg(" %s",str);
-				}
-			}
-		}
-		fclose(errfile);
-	}
-	remove(errfname);
-	return status;
-}
-
 /*
    make an rgb string from color (e.g. #31ab12)
    if the color is < 0, make empty string
@@ -31,3 +31,4 @@ extern int	print_to_file(char *file, int xoff, int yoff, char *backgrnd,
 extern void	make_rgb_string (int color, char *rgb_string);
 extern void	gen_print_cmd(char *cmd, char *file, char *printer,
 				char *pr_params);
+extern void	wait_export_jobs(void);
@@ -23,6 +23,7 @@
 #include "d_arc.h"
 #include "e_flip.h"
 #include "e_rotate.h"
+#include "f_read.h"
 #include "u_draw.h"
 #include "u_redraw.h"
 #include "w_canvas.h"
@@ -77,6 +78,11 @@ void redisplay_splineobject (F_spline *splines, int depth);
 void redisplay_textobject (F_text *texts, int depth);
 void redraw_pageborder (void);
 void draw_pb (int x, int y, int w, int h);
+static void expand_visible_compounds (F_compound *compounds);
+static void redisplay_lazy_compounds (F_compound *compounds);
+
+/* read a skimmed compound when it is at least this large on the canvas */
+#define LAZY_MIN_SIZE	16		/* pixels */
 
 void
 clearallcounts(void)
@@ -138,7 +144,12 @@ void redisplay_objects(F_compound *active_objects)
 	draw_parent_gray = True;
     }
 
+    /* read the compounds that are now large enough to be seen */
+    expand_visible_compounds(objects->compounds);
+
     clearcounts();
+    /* load the fonts of a new zoom in the background if it takes long */
+    font_budget(True);
 
     /* if user wants gray inactive layers, draw them first */
     if (gray_layers || draw_parent_gray) {
@@ -172,6 +183,9 @@ void redisplay_objects(F_compound *active_objects)
 	    redisplay_textobject(objects->texts, depth);
 	}
     }
+    /* the compounds not read yet are drawn as boxes */
+    redisplay_lazy_compounds(objects->compounds);
+    font_budget(False);
 
     /*
      * Point markers and compounds, not being ``real objects'', are handled
@@ -305,6 +319,8 @@ void redisplay_textobject(F_text *texts, int depth)
 	return;
     cp = &counts[min2(depth, MAX_DEPTH)];
 
+    /* draw horizontal texts on one baseline in one request */
+    text_batch(True);
     text = texts;
     while (text != NULL && cp->cnt_texts < cp->num_texts) {
 	if (depth == text->depth) {
@@ -313,6 +329,48 @@ void redisplay_textobject(F_text *texts, int depth)
 	}
 	text = text->next;
     }
+    text_batch(False);
+}
+
+/*
+ * Read the skimmed compounds in the clip window that are drawn large enough,
+ * see expand_compound(). The other ones are drawn by redisplay_lazy_compounds().
+ */
+
+static void
+expand_visible_compounds(F_compound *compounds)
+{
+    F_compound	   *c;
+
+    if (lazy_compounds == 0)
+	return;
+    for (c = compounds; c != NULL; c = c->next) {
+	if (!overlapping(ZOOMX(c->nwcorner.x), ZOOMY(c->nwcorner.y),
+			ZOOMX(c->secorner.x), ZOOMY(c->secorner.y),
+			clip_xmin, clip_ymin, clip_xmax, clip_ymax))
+	    continue;
+	if (c->lazy != NULL &&
+		ZOOMX(c->secorner.x) - ZOOMX(c->nwcorner.x) < LAZY_MIN_SIZE &&
+		ZOOMY(c->secorner.y) - ZOOMY(c->nwcorner.y) < LAZY_MIN_SIZE)
+	    continue;
+	expand_compound(c);
+	expand_visible_compounds(c->compounds);
+    }
+}
+
+static void
+redisplay_lazy_compounds(F_compound *compounds)
+{
+    F_compound	   *c;
+
+    if (lazy_compounds == 0)
+	return;
+    for (c = compounds; c != NULL; c = c->next) {
+	if (c->lazy != NULL)
+	    draw_compoundelements(c, PAINT);
+	else
+	    redisplay_lazy_compounds(c->compounds);
+    }
 }
 
 /*
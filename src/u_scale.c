@@ -18,6 +18,7 @@
 #include "fig.h"
 #include "resources.h"
 #include "object.h"
+#include "f_read.h"
 
 
 void read_scale_arrow (F_arrow *arrow, float mul);
@@ -104,6 +105,7 @@ void read_scale_arrow(F_arrow *arrow, float mul)
 
 void read_scale_compound(F_compound *compound, float mul, int offset)
 {
+    expand_compound(compound);
     compound->nwcorner.x = compound->nwcorner.x * mul + offset;
     compound->nwcorner.y = compound->nwcorner.y * mul + offset;
     compound->secorner.x = compound->secorner.x * mul + offset;
@@ -19,7 +19,9 @@
 #include "resources.h"
 #include "object.h"
 #include "mode.h"
+#include "u_bound.h"
 #include "u_list.h"
+#include "u_pick.h"
 #include "u_search.h"
 #include "w_drawprim.h"
 #include "w_layers.h"
@@ -51,72 +53,59 @@ static F_spline   *s;
 static F_text     *t;
 static F_compound *c;
 
+void toggle_objecthighlight (void);
+
 /*
  * (px, py) is the control point on the
  * circumference of an arc which is the
  * closest to (x, y)
  */
 
-
-void toggle_objecthighlight (void);
-
-Boolean
-next_arc_found(int x, int y, int tolerance, int *px, int *py, unsigned int shift)
+static Boolean
+arc_found(F_arc *a, int x, int y, int tolerance, int *px, int *py)
 {
     int		    i;
 
-    if (!arc_in_mask())
+    if (!active_layer(a->depth))
 	return False;
-    if (a == NULL)
-	if (shift)
-	    a = last_arc(objects.arcs);
-	else
-	    a = objects.arcs;
-    else if (shift)
-	a = prev_arc(objects.arcs, a);
-
-    for (; a != NULL; a = (shift? prev_arc(objects.arcs, a): a->next), n++) {
-	if (!active_layer(a->depth))
-	    continue;
-	for (i = 0; i < 3; i++) {
-	    if ((abs(a->point[i].x - x) <= tolerance) &&
-		(abs(a->point[i].y - y) <= tolerance)) {
-		*px = a->point[i].x;
-		*py = a->point[i].y;
-		return True;
-	    }
+    for (i = 0; i < 3; i++) {
+	if ((abs(a->point[i].x - x) <= tolerance) &&
+	    (abs(a->point[i].y - y) <= tolerance)) {
+	    *px = a->point[i].x;
+	    *py = a->point[i].y;
+	    return True;
 	}
-	{
-	  /* still nothing */
-
-	  /* check if we're at the arc radius from the arc center */
-
-	  double dist   = hypot((double)y - (double)(a->center.y),
-				(double)x - (double)(a->center.x));
-	  double radius =  hypot((double)(a->point[1].y) - (double)(a->center.y),
-				 (double)(a->point[1].x) - (double)(a->center.x));
-	  if (fabs(radius - dist) < (double)tolerance) {
-	    /* ok, we're somewhere on the circle the arc is part of	*/
-	    /* now, check if we're on the arc itself */
-	    if (True == is_point_on_arc(a, x, y)) {
-	      /* yep, we're on the actual arc */
-	      /* now we find the closest control point */
-	      double mind = HUGE_VAL;
-	      int pp;
-	      for (i = 0; i < 3; i++) {
-		dist = hypot((double)y - (double)(a->point[i].y),
-			     (double)x - (double)(a->point[i].x));
-		if (dist < mind) {
-		  mind = dist;
-		  pp = i;
-		}
-	      }
-	      *px = a->point[pp].x;
-	      *py = a->point[pp].y;
-	      return True;
+    }
+    {
+      /* still nothing */
+
+      /* check if we're at the arc radius from the arc center */
+
+      double dist   = hypot((double)y - (double)(a->center.y),
+			    (double)x - (double)(a->center.x));
+      double radius =  hypot((double)(a->point[1].y) - (double)(a->center.y),
+			     (double)(a->point[1].x) - (double)(a->center.x));
+      if (fabs(radius - dist) < (double)tolerance) {
+	/* ok, we're somewhere on the circle the arc is part of	*/
+	/* now, check if we're on the arc itself */
+	if (True == is_point_on_arc(a, x, y)) {
+	  /* yep, we're on the actual arc */
+	  /* now we find the closest control point */
+	  double mind = HUGE_VAL;
+	  int pp;
+	  for (i = 0; i < 3; i++) {
+	    dist = hypot((double)y - (double)(a->point[i].y),
+			 (double)x - (double)(a->point[i].x));
+	    if (dist < mind) {
+	      mind = dist;
+	      pp = i;
 	    }
 	  }
+	  *px = a->point[pp].x;
+	  *py = a->point[pp].y;
+	  return True;
 	}
+      }
     }
     return False;
 }
@@ -140,227 +129,268 @@ vector_rotate(a, b, angle)
   *b = y;
 }
 
-Boolean
-next_ellipse_found(int x, int y, int tolerance, int *px, int *py, unsigned int shift)
+static Boolean
+ellipse_found(F_ellipse *e, int x, int y, int tolerance, int *px, int *py)
 {
     double	    a, b, dx, dy;
     double	    dis, r, tol;
 
-    if (!ellipse_in_mask())
+    if (!active_layer(e->depth))
 	return False;
-    if (e == NULL)
-	if (shift)
-	    e = last_ellipse(objects.ellipses);
-	else
-	    e = objects.ellipses;
-    else if (shift)
-	e = prev_ellipse(objects.ellipses, e);
-
     tol = (double) tolerance;
-    for (; e != NULL; e = (shift? prev_ellipse(objects.ellipses, e): e->next), n++) {
-	if (!active_layer(e->depth))
-	    continue;
-	dx = x - e->center.x;
-	dy = y - e->center.y;
-	a = e->radiuses.x;
-	b = e->radiuses.y;
-	/* prevent sqrt(0) core dumps */
-	if (dx == 0 && dy == 0)
-	    dis = 0.0;		/* so we return below */
-	else
-	    dis = sqrt(dx * dx + dy * dy);
-	if (dis < tol) {
-	    *px = e->center.x;
-	    *py = e->center.y;
-	    return True;
-	}
-	if (abs(x - e->start.x) <= tolerance && abs(y - e->start.y) <= tolerance) {
-	    *px = e->start.x;
-	    *py = e->start.y;
-	    return True;
-	}
-	if (abs(x - e->end.x) <= tolerance && abs(y - e->end.y) <= tolerance) {
-	    *px = e->end.x;
-	    *py = e->end.y;
-	    return True;
-	}
-	if (a * dy == 0 && b * dx == 0)
-	    r = 0.0;		/* prevent core dumps */
-	else {
-	    vector_rotate(&dx, &dy, (double)(e->angle));
-	    r = a * b * dis / sqrt(1.0 * b * b * dx * dx + 1.0 * a * a * dy * dy);
-	}
-	if (fabs(dis - r) <= tol) {
-	    *px = round(r * dx / dis + (double)e->center.x);
-	    *py = round(r * dy / dis + (double)e->center.y);
-	    return True;
-	}
+    dx = x - e->center.x;
+    dy = y - e->center.y;
+    a = e->radiuses.x;
+    b = e->radiuses.y;
+    /* prevent sqrt(0) core dumps */
+    if (dx == 0 && dy == 0)
+	dis = 0.0;		/* so we return below */
+    else
+	dis = sqrt(dx * dx + dy * dy);
+    if (dis < tol) {
+	*px = e->center.x;
+	*py = e->center.y;
+	return True;
+    }
+    if (abs(x - e->start.x) <= tolerance && abs(y - e->start.y) <= tolerance) {
+	*px = e->start.x;
+	*py = e->start.y;
+	return True;
+    }
+    if (abs(x - e->end.x) <= tolerance && abs(y - e->end.y) <= tolerance) {
+	*px = e->end.x;
+	*py = e->end.y;
+	return True;
+    }
+    if (a * dy == 0 && b * dx == 0)
+	r = 0.0;		/* prevent core dumps */
+    else {
+	vector_rotate(&dx, &dy, (double)(e->angle));
+	r = a * b * dis / sqrt(1.0 * b * b * dx * dx + 1.0 * a * a * dy * dy);
+    }
+    if (fabs(dis - r) <= tol) {
+	*px = round(r * dx / dis + (double)e->center.x);
+	*py = round(r * dy / dis + (double)e->center.y);
+	return True;
     }
     return False;
 }
 
 /*
- * Return the pointer to lines object if the
- * search is successful otherwise return
- * NULL.  The value returned via (px, py) is
- * the closest point on the vector to point (x, y)
+ * The value returned via (px, py) is the
+ * closest point on the vector to point (x, y)
  */
 
-Boolean
-next_line_found(int x, int y, int tolerance, int *px, int *py, unsigned int shift)
+static Boolean
+line_found(F_line *l, int x, int y, int tolerance, int *px, int *py)
 {
     F_point	   *point;
     int		    x1, y1, x2, y2;
     float	    tol2;
 
-    tol2 = (float) tolerance *tolerance;
-
-    if (!anyline_in_mask())
+    if (!active_layer(l->depth) || !validline_in_mask(l))
 	return False;
-    if (l == NULL)
-	if (shift)
-	    l = last_line(objects.lines);
-	else
-	    l = objects.lines;
-    else if (shift)
-	l = prev_line(objects.lines, l);
-
-    for (; l != NULL; l = (shift? prev_line(objects.lines, l): l->next), n++) {
-	if (!active_layer(l->depth))
-	    continue;
-	if (validline_in_mask(l)) {
-	    point = l->points;
-	    x1 = point->x;
-	    y1 = point->y;
-	    if (abs(x - x1) <= tolerance && abs(y - y1) <= tolerance) {
-		*px = x1;
-		*py = y1;
-		return True;
-	    }
-	    for (point = point->next; point != NULL; point = point->next) {
-		x2 = point->x;
-		y2 = point->y;
-		if (close_to_vector(x1, y1, x2, y2, x, y, tolerance, tol2, px, py)) {
-		    return True;
-		}
-		x1 = x2;
-		y1 = y2;
-	    }
+    tol2 = (float) tolerance *tolerance;
+    point = l->points;
+    x1 = point->x;
+    y1 = point->y;
+    if (abs(x - x1) <= tolerance && abs(y - y1) <= tolerance) {
+	*px = x1;
+	*py = y1;
+	return True;
+    }
+    for (point = point->next; point != NULL; point = point->next) {
+	x2 = point->x;
+	y2 = point->y;
+	if (close_to_vector(x1, y1, x2, y2, x, y, tolerance, tol2, px, py)) {
+	    return True;
 	}
+	x1 = x2;
+	y1 = y2;
     }
     return False;
 }
 
-/*
- * Return the pointer to lines object if the
- * search is successful otherwise return NULL.
- */
-
-Boolean
-next_spline_found(int x, int y, int tolerance, int *px, int *py, unsigned int shift)
+static Boolean
+spline_found(F_spline *s, int x, int y, int tolerance, int *px, int *py)
 {
     F_point	   *point;
     int		    x1, y1, x2, y2;
     float	    tol2;
 
-    if (!anyspline_in_mask())
+    if (!active_layer(s->depth) || !validspline_in_mask(s))
 	return False;
-    if (s == NULL)
-	if (shift)
-	    s = last_spline(objects.splines);
-	else
-	    s = objects.splines;
-    else if (shift)
-	s = prev_spline(objects.splines, s);
-
     tol2 = (float) tolerance *tolerance;
-
-    for (; s != NULL; s = (shift? prev_spline(objects.splines, s): s->next), n++) {
-	if (!active_layer(s->depth))
-	    continue;
-	if (validspline_in_mask(s)) {
-	    point = s->points;
-	    x1 = point->x;
-	    y1 = point->y;
-	    for (point = point->next; point != NULL; point = point->next) {
-		x2 = point->x;
-		y2 = point->y;
-		if (close_to_vector(x1, y1, x2, y2, x, y, tolerance, tol2,
-				    px, py))
-		    return True;
-		x1 = x2;
-		y1 = y2;
-	    }
-	}
+    point = s->points;
+    x1 = point->x;
+    y1 = point->y;
+    for (point = point->next; point != NULL; point = point->next) {
+	x2 = point->x;
+	y2 = point->y;
+	if (close_to_vector(x1, y1, x2, y2, x, y, tolerance, tol2,
+			    px, py))
+	    return True;
+	x1 = x2;
+	y1 = y2;
     }
     return False;
 }
 
-Boolean
-next_text_found(int x, int y, int tolerance, int *px, int *py, unsigned int shift)
+static Boolean
+text_found(F_text *t, int x, int y, int *px, int *py)
 {
     int		    dum;
 
-    if (!anytext_in_mask())
+    if (!active_layer(t->depth) || !validtext_in_mask(t))
 	return False;
-    if (t == NULL)
-	if (shift)
-	    t = last_text(objects.texts);
-	else
-	    t = objects.texts;
-    else if (shift)
-	t = prev_text(objects.texts, t);
-
-    for (; t != NULL; t = (shift? prev_text(objects.texts, t): t->next), n++) {
-	if (!active_layer(t->depth))
-	    continue;
-	if (validtext_in_mask(t)) {
-	    if (in_text_bound(t, x, y, &dum, False)) {
-		*px = x;
-		*py = y;
-		return True;
-	    }
-	}
+    if (in_text_bound(t, x, y, &dum, False)) {
+	*px = x;
+	*py = y;
+	return True;
     }
     return False;
 }
 
-Boolean
-next_compound_found(int x, int y, int tolerance, int *px, int *py, unsigned int shift)
+static Boolean
+compound_found(F_compound *c, int x, int y, int tolerance, int *px, int *py)
 {
     float	    tol2;
 
-    if (!compound_in_mask())
+    if (!any_active_in_compound(c))
 	return False;
-    if (c == NULL)
-	if (shift)
-	    c = last_compound(objects.compounds);
-	else
-	    c = objects.compounds;
-    else if (shift)
-	c = prev_compound(objects.compounds, c);
-
     tol2 = tolerance * tolerance;
+    if (close_to_vector(c->nwcorner.x, c->nwcorner.y, c->nwcorner.x,
+			c->secorner.y, x, y, tolerance, tol2, px, py))
+	return True;
+    if (close_to_vector(c->secorner.x, c->secorner.y, c->nwcorner.x,
+			c->secorner.y, x, y, tolerance, tol2, px, py))
+	return True;
+    if (close_to_vector(c->secorner.x, c->secorner.y, c->secorner.x,
+			c->nwcorner.y, x, y, tolerance, tol2, px, py))
+	return True;
+    if (close_to_vector(c->nwcorner.x, c->nwcorner.y, c->secorner.x,
+			c->nwcorner.y, x, y, tolerance, tol2, px, py))
+	return True;
+    return False;
+}
 
-    for (; c != NULL; c = (shift? prev_compound(objects.compounds, c): c->next), n++) {
-	if (!any_active_in_compound(c))
-		continue;
-	if (close_to_vector(c->nwcorner.x, c->nwcorner.y, c->nwcorner.x,
-			    c->secorner.y, x, y, tolerance, tol2, px, py))
-	    return True;
-	if (close_to_vector(c->secorner.x, c->secorner.y, c->nwcorner.x,
-			    c->secorner.y, x, y, tolerance, tol2, px, py))
-	    return True;
-	if (close_to_vector(c->secorner.x, c->secorner.y, c->secorner.x,
-			    c->nwcorner.y, x, y, tolerance, tol2, px, py))
-	    return True;
-	if (close_to_vector(c->nwcorner.x, c->nwcorner.y, c->secorner.x,
-			    c->nwcorner.y, x, y, tolerance, tol2, px, py))
-	    return True;
+static Boolean
+object_found(int type, void *obj, int x, int y, int tolerance, int *px, int *py)
+{
+    switch (type) {
+    case O_ARC:
+	return arc_found((F_arc *) obj, x, y, tolerance, px, py);
+    case O_COMPOUND:
+	return compound_found((F_compound *) obj, x, y, tolerance, px, py);
+    case O_ELLIPSE:
+	return ellipse_found((F_ellipse *) obj, x, y, tolerance, px, py);
+    case O_POLYLINE:
+	return line_found((F_line *) obj, x, y, tolerance, px, py);
+    case O_SPLINE:
+	return spline_found((F_spline *) obj, x, y, tolerance, px, py);
+    case O_TXT:
+	return text_found((F_text *) obj, x, y, px, py);
     }
     return False;
 }
 
+/*
+ * Return the next object of type after cur, or before cur if shift is
+ * set, that is close to (x, y), or NULL. If cur is NULL, start at the
+ * head, or at the end of the list. Only the candidates from the pick index
+ * are tested, but n is advanced as if each object of the list was visited.
+ */
+
+static void *
+next_found(int type, void *cur, int x, int y, int tolerance, int *px, int *py,
+		unsigned int shift)
+{
+    void	  **obj;
+    int		   *cand;
+    int		    num, ncand, start, i;
+
+    num = pick_objects(type, &obj);
+    ncand = pick_candidates(type, x, y, tolerance, &cand);
+    i = cur == NULL ? -1 : pick_number(type, cur);
+
+    if (shift) {
+	start = (i < 0 ? num : i) - 1;
+	for (i = ncand - 1; i >= 0 && cand[i] > start; i--)
+	    ;
+	for (; i >= 0; i--)
+	    if (object_found(type, obj[cand[i]], x, y, tolerance, px, py)) {
+		n += start - cand[i];
+		return obj[cand[i]];
+	    }
+	n += start + 1;
+    } else {
+	start = i < 0 ? 0 : i;
+	for (i = 0; i < ncand && cand[i] < start; i++)
+	    ;
+	for (; i < ncand; i++)
+	    if (object_found(type, obj[cand[i]], x, y, tolerance, px, py)) {
+		n += cand[i] - start;
+		return obj[cand[i]];
+	    }
+	n += num - start;
+    }
+    return NULL;
+}
+
+Boolean
+next_arc_found(int x, int y, int tolerance, int *px, int *py, unsigned int shift)
+{
+    if (!arc_in_mask())
+	return False;
+    a = next_found(O_ARC, a, x, y, tolerance, px, py, shift);
+    return a != NULL;
+}
+
+Boolean
+next_ellipse_found(int x, int y, int tolerance, int *px, int *py, unsigned int shift)
+{
+    if (!ellipse_in_mask())
+	return False;
+    e = next_found(O_ELLIPSE, e, x, y, tolerance, px, py, shift);
+    return e != NULL;
+}
+
+Boolean
+next_line_found(int x, int y, int tolerance, int *px, int *py, unsigned int shift)
+{
+    if (!anyline_in_mask())
+	return False;
+    l = next_found(O_POLYLINE, l, x, y, tolerance, px, py, shift);
+    return l != NULL;
+}
+
+Boolean
+next_spline_found(int x, int y, int tolerance, int *px, int *py, unsigned int shift)
+{
+    if (!anyspline_in_mask())
+	return False;
+    s = next_found(O_SPLINE, s, x, y, tolerance, px, py, shift);
+    return s != NULL;
+}
+
+Boolean
+next_text_found(int x, int y, int tolerance, int *px, int *py, unsigned int shift)
+{
+    if (!anytext_in_mask())
+	return False;
+    t = next_found(O_TXT, t, x, y, tolerance, px, py, shift);
+    return t != NULL;
+}
+
+Boolean
+next_compound_found(int x, int y, int tolerance, int *px, int *py, unsigned int shift)
+{
+    if (!compound_in_mask())
+	return False;
+    c = next_found(O_COMPOUND, c, x, y, tolerance, px, py, shift);
+    return c != NULL;
+}
+
 void show_objecthighlight(void)
 {
     if (highlighting)
@@ -407,34 +437,27 @@ void toggle_objecthighlight(void)
     }
 }
 
+/* count the objects to visit; the point search does not visit texts */
+
 static void
-init_search(void)
+init_search(Boolean texts)
 {
     if (highlighting)
 	erase_objecthighlight();
     else {
 	objectcount = 0;
 	if (ellipse_in_mask())
-	    for (e = objects.ellipses; e != NULL; e = e->next)
-		objectcount++;
+	    objectcount += pick_count(O_ELLIPSE);
 	if (anyline_in_mask())
-	    for (l = objects.lines; l != NULL; l = l->next)
-		if (validline_in_mask(l))
-		    objectcount++;
+	    objectcount += pick_count(O_POLYLINE);
 	if (anyspline_in_mask())
-	    for (s = objects.splines; s != NULL; s = s->next)
-		if (validspline_in_mask(s))
-		    objectcount++;
-	if (anytext_in_mask())
-	    for (t = objects.texts; t != NULL; t = t->next)
-		if (validtext_in_mask(t))
-		    objectcount++;
+	    objectcount += pick_count(O_SPLINE);
+	if (texts && anytext_in_mask())
+	    objectcount += pick_count(O_TXT);
 	if (arc_in_mask())
-	    for (a = objects.arcs; a != NULL; a = a->next)
-		objectcount++;
+	    objectcount += pick_count(O_ARC);
 	if (compound_in_mask())
-	    for (c = objects.compounds; c != NULL; c = c->next)
-		objectcount++;
+	    objectcount += pick_count(O_COMPOUND);
 	e = NULL;
 	type = O_ELLIPSE;
     }
@@ -448,7 +471,7 @@ do_object_search(int x, int y, unsigned int shift)
     int		    px, py;
     Boolean	    found = False;
 
-    init_search();
+    init_search(True);
     for (n = 0; n < objectcount;) {
 	switch (type) {
 	  case O_ELLIPSE:
@@ -560,124 +583,135 @@ object_search_right(int x, int y, unsigned int shift)
     do_object_search(x, y, shift);
 }
 
+/* the tests of next_found() above that do not depend on the position */
+
+static Boolean
+point_object_active(int type, void *obj)
+{
+    switch (type) {
+    case O_ARC:
+	return active_layer(((F_arc *) obj)->depth);
+    case O_COMPOUND:
+	return any_active_in_compound((F_compound *) obj);
+    case O_ELLIPSE:
+	return active_layer(((F_ellipse *) obj)->depth);
+    case O_POLYLINE:
+	return active_layer(((F_line *) obj)->depth) &&
+		validline_in_mask((F_line *) obj);
+    case O_SPLINE:
+	return active_layer(((F_spline *) obj)->depth) &&
+		validspline_in_mask((F_spline *) obj);
+    }
+    return False;
+}
+
+/*
+ * Like next_found(), but return the point of the next object with a point
+ * close to (x, y), or NULL. Of the points of one object, the point closest
+ * to (x, y) is taken.
+ */
+
+static pick_vertex *
+next_point_found(int type, void *cur, int x, int y, int tol, unsigned int shift)
+{
+    pick_vertex	   *hit;
+    void	  **obj;
+    int		    num, nhit, start, i;
+
+    num = pick_objects(type, &obj);
+    nhit = pick_vertices(type, x, y, tol, &hit);
+    i = cur == NULL ? -1 : pick_number(type, cur);
+
+    if (shift) {
+	start = (i < 0 ? num : i) - 1;
+	for (i = nhit - 1; i >= 0 && hit[i].num > start; i--)
+	    ;
+	for (; i >= 0; i--)
+	    if (point_object_active(type, hit[i].obj)) {
+		n += start - hit[i].num;
+		return &hit[i];
+	    }
+	n += start + 1;
+    } else {
+	start = i < 0 ? 0 : i;
+	for (i = 0; i < nhit && hit[i].num < start; i++)
+	    ;
+	for (; i < nhit; i++)
+	    if (point_object_active(type, hit[i].obj)) {
+		n += hit[i].num - start;
+		return &hit[i];
+	    }
+	n += num - start;
+    }
+    return NULL;
+}
+
 Boolean
 next_arc_point_found(int x, int y, int tol, int *point_num, unsigned int shift)
 
 {
-    int		    i;
+    pick_vertex	   *v;
 
     if (!arc_in_mask())
 	return False;
-    if (a == NULL)
-	if (shift)
-	    a = last_arc(objects.arcs);
-	else
-	    a = objects.arcs;
-    else if (shift)
-	a = prev_arc(objects.arcs, a);
-
-    for (; a != NULL; a = (shift? prev_arc(objects.arcs, a): a->next), n++) {
-	if (!active_layer(a->depth))
-	    continue;
-	for (i = 0; i < 3; i++) {
-	    if (abs(a->point[i].x - x) <= tol &&
-		abs(a->point[i].y - y) <= tol) {
-		*point_num = i;
-		return True;
-	    }
-	}
+    if ((v = next_point_found(O_ARC, a, x, y, tol, shift)) == NULL) {
+	a = NULL;
+	return False;
     }
-    return False;
+    a = v->obj;
+    *point_num = v->pnum;
+    return True;
 }
 
 Boolean
 next_ellipse_point_found(int x, int y, int tol, int *point_num, unsigned int shift)
 
 {
+    pick_vertex	   *v;
 
     if (!ellipse_in_mask())
 	return False;
-    if (e == NULL)
-	if (shift)
-	    e = last_ellipse(objects.ellipses);
-	else
-	    e = objects.ellipses;
-    else if (shift)
-	e = prev_ellipse(objects.ellipses, e);
-
-    for (; e != NULL; e = (shift? prev_ellipse(objects.ellipses, e): e->next), n++) {
-	if (!active_layer(e->depth))
-	    continue;
-	if (abs(e->start.x - x) <= tol && abs(e->start.y - y) <= tol) {
-	    *point_num = 0;
-	    return True;
-	}
-	if (abs(e->end.x - x) <= tol && abs(e->end.y - y) <= tol) {
-	    *point_num = 1;
-	    return True;
-	}
+    if ((v = next_point_found(O_ELLIPSE, e, x, y, tol, shift)) == NULL) {
+	e = NULL;
+	return False;
     }
-    return False;
+    e = v->obj;
+    *point_num = v->pnum;
+    return True;
 }
 
 Boolean
 next_line_point_found(int x, int y, int tol, F_point **p, F_point **q, unsigned int shift)
 {
-    F_point	   *a, *b;
+    pick_vertex	   *v;
 
     if (!anyline_in_mask())
 	return False;
-    if (l == NULL)
-	if (shift)
-	    l = last_line(objects.lines);
-	else
-	    l = objects.lines;
-    else if (shift)
-	l = prev_line(objects.lines, l);
-
-    for (; l != NULL; l = (shift? prev_line(objects.lines, l): l->next)) {
-	if (!active_layer(l->depth))
-	    continue;
-	if (validline_in_mask(l)) {
-	    n++;
-	    for (a = NULL, b = l->points; b != NULL; a = b, b = b->next) {
-		if (abs(b->x - x) <= tol && abs(b->y - y) <= tol) {
-		    *p = a;
-		    *q = b;
-		    return True;
-		}
-	    }
-	}
+    if ((v = next_point_found(O_POLYLINE, l, x, y, tol, shift)) == NULL) {
+	l = NULL;
+	return False;
     }
-    return False;
+    l = v->obj;
+    *p = v->prev;
+    *q = v->point;
+    return True;
 }
 
 Boolean
 next_spline_point_found(int x, int y, int tol, F_point **p, F_point **q, unsigned int shift)
 {
+    pick_vertex	   *v;
+
     if (!anyspline_in_mask())
 	return False;
-    if (s == NULL)
-	if (shift)
-	    s = last_spline(objects.splines);
-	else
-	    s = objects.splines;
-    else if (shift)
-	s = prev_spline(objects.splines, s);
-
-    for (; s != NULL; s = (shift? prev_spline(objects.splines, s): s->next)) {
-	if (!active_layer(s->depth))
-	    continue;
-	if (validspline_in_mask(s)) {
-	    n++;
-	    *p = NULL;
-	    for (*q = s->points; *q != NULL; *p = *q, *q = (*q)->next) {
-		if ((abs((*q)->x - x) <= tol) && (abs((*q)->y - y) <= tol))
-		    return True;
-	    }
-	}
+    if ((v = next_point_found(O_SPLINE, s, x, y, tol, shift)) == NULL) {
+	s = NULL;
+	return False;
     }
-    return False;
+    s = v->obj;
+    *p = v->prev;
+    *q = v->point;
+    return True;
 }
 
 Boolean
@@ -685,45 +719,18 @@ next_compound_point_found(int x, int y, int tol, int *p, int *q, unsigned int sh
 
 /* dirty trick - p and q are called with type `F_point' */
 {
+    pick_vertex	   *v;
+
     if (!compound_in_mask())
 	return False;
-    if (c == NULL)
-	if (shift)
-	    c = last_compound(objects.compounds);
-	else
-	    c = objects.compounds;
-    else if (shift)
-	c = prev_compound(objects.compounds, c);
-
-    for (; c != NULL; c = (shift? prev_compound(objects.compounds, c): c->next), n++) {
-	if (!any_active_in_compound(c))
-		continue;
-	if (abs(c->nwcorner.x - x) <= tol &&
-	    abs(c->nwcorner.y - y) <= tol) {
-	    *p = c->nwcorner.x;
-	    *q = c->nwcorner.y;
-	    return True;
-	}
-	if (abs(c->nwcorner.x - x) <= tol &&
-	    abs(c->secorner.y - y) <= tol) {
-	    *p = c->nwcorner.x;
-	    *q = c->secorner.y;
-	    return True;
-	}
-	if (abs(c->secorner.x - x) <= tol &&
-	    abs(c->nwcorner.y - y) <= tol) {
-	    *p = c->secorner.x;
-	    *q = c->nwcorner.y;
-	    return True;
-	}
-	if (abs(c->secorner.x - x) <= tol &&
-	    abs(c->secorner.y - y) <= tol) {
-	    *p = c->secorner.x;
-	    *q = c->secorner.y;
-	    return True;
-	}
+    if ((v = next_point_found(O_COMPOUND, c, x, y, tol, shift)) == NULL) {
+	c = NULL;
+	return False;
     }
-    return False;
+    c = v->obj;
+    *p = v->x;
+    *q = v->y;
+    return True;
 }
 
 void
@@ -755,7 +762,7 @@ do_point_search(int x, int y, unsigned int shift)
 
     px = &point1;
     py = &point2;
-    init_search();
+    init_search(False);
     for (n = 0; n < objectcount;) {
 	switch (type) {
 	case O_ELLIPSE:
@@ -886,6 +893,15 @@ in_text_bound(F_text *t, int x, int y, int *posn, Boolean extra)
     int		    xo,yo, xr,yr;
     int		    x0, x1,y1, x2,y2;
     int		    l, h;
+    int		    dum;
+
+    /* quickly reject points outside the cached bounds of the text */
+    if (!extra) {
+	text_bound(t, &x1, &y1, &x2, &y2,
+		   &dum,&dum, &dum,&dum, &dum,&dum, &dum,&dum);
+	if (x < x1 - 2 || x > x2 + 2 || y < y1 - 2 || y > y2 + 2)
+	    return False;
+    }
 
     cost = cos((double) -t->angle);
     sint = sin((double) -t->angle);
@@ -1008,18 +1024,15 @@ compound_point_search(int x, int y, int tol, int *cx, int *cy, int *fx, int *fy)
 F_spline   *
 get_spline_point(int x, int y, F_point **p, F_point **q)
 {
-    F_spline *spline;
-    spline = last_spline(objects.splines);
-    for (; spline != NULL; spline = prev_spline(objects.splines, spline))
-	if (validspline_in_mask(spline)) {
-	    n++;
-	    *p = NULL;
-	    for (*q = spline->points; *q != NULL; *p = *q, *q = (*q)->next) {
-		if ((abs((*q)->x - x) <= TOLERANCE) &&
-		    (abs((*q)->y - y) <= TOLERANCE))
-		    return spline;
-	    }
+    pick_vertex	   *hit;
+    int		    i;
+
+    /* the last spline in the list with a point close to (x, y) */
+    for (i = pick_vertices(O_SPLINE, x, y, TOLERANCE, &hit) - 1; i >= 0; i--)
+	if (validspline_in_mask((F_spline *) hit[i].obj)) {
+	    *p = hit[i].prev;
+	    *q = hit[i].point;
+	    return (F_spline *) hit[i].obj;
 	}
     return (NULL);
 }
-
@@ -24,6 +24,7 @@
 
 #include "u_geom.h"
 #include "u_markers.h"
+#include "u_pick.h"
 #include "u_search.h"
 
 /* how close to user-selected location? */
@@ -32,14 +33,10 @@
 /* `singularities' */
 #define SING_TOLERANCE (zoomscale>.5?1:(int)(.5/zoomscale))
 
-/***************************************************************************/
+/* candidates first taken from the pick index by smart_nearest_found() */
+#define NEAREST_FIRST 16
 
-Boolean smart_next_arc_found(int x, int y, int tolerance, int *px, int *py, int shift);
-Boolean smart_next_ellipse_found(int x, int y, int tolerance, int *px, int *py, int shift);
-Boolean smart_next_line_found(int x, int y, int tolerance, int *px, int *py, int shift);
-Boolean smart_next_spline_found(int x, int y, int tolerance, int *px, int *py, int shift);
-Boolean smart_next_text_found(int x, int y, int tolerance, int *px, int *py, int shift);
-Boolean smart_next_compound_found(int x, int y, int tolerance, int *px, int *py, int shift);
+/***************************************************************************/
 
 void do_smart_object_search(int x, int y, unsigned int shift);
 
@@ -133,316 +130,397 @@ init_smart_search(void)
     else {
 	objectcount = 0;
 	if (ellipse_in_mask())
-	    for (e = objects.ellipses; e != NULL; e = e->next)
-		objectcount++;
+	    objectcount += pick_count(O_ELLIPSE);
 	if (anyline_in_mask())
-	    for (l = objects.lines; l != NULL; l = l->next)
-		if (validline_in_mask(l))
-		    objectcount++;
+	    objectcount += pick_count(O_POLYLINE);
 	if (anyspline_in_mask())
-	    for (s = objects.splines; s != NULL; s = s->next)
-		if (validspline_in_mask(s))
-		    objectcount++;
+	    objectcount += pick_count(O_SPLINE);
 	if (anytext_in_mask())
-	    for (t = objects.texts; t != NULL; t = t->next)
-		if (validtext_in_mask(t))
-		    objectcount++;
+	    objectcount += pick_count(O_TXT);
 	if (arc_in_mask())
-	    for (a = objects.arcs; a != NULL; a = a->next)
-		objectcount++;
+	    objectcount += pick_count(O_ARC);
 	if (compound_in_mask())
-	    for (c = objects.compounds; c != NULL; c = c->next)
-		objectcount++;
+	    objectcount += pick_count(O_COMPOUND);
 	e = NULL;
 	type = O_ELLIPSE;
     }
 }
 
-void					/* Shift Key Status from XEvent */
-do_smart_object_search(int x, int y, unsigned int shift)
-{
-    int		    px, py;
-    Boolean	    found = False;
+/* the object of the current type */
 
-    init_smart_search();
-    for (n = 0; n < objectcount;) {
-	switch (type) {
-	case O_ELLIPSE:
-	    found = smart_next_ellipse_found(x, y, TOLERANCE, &px, &py, shift);
-	    break;
-	case O_POLYLINE:
-	    found = smart_next_line_found(x, y, TOLERANCE, &px, &py, shift);
-	    break;
-	case O_SPLINE:
-	    found = smart_next_spline_found(x, y, TOLERANCE, &px, &py, shift);
-	    break;
-	case O_TXT:
-	    found = smart_next_text_found(x, y, TOLERANCE, &px, &py, shift);
-	    break;
-	case O_ARC:
-	    found = smart_next_arc_found(x, y, TOLERANCE, &px, &py, shift);
-	    break;
-	case O_COMPOUND:
-	    found = smart_next_compound_found(x, y, TOLERANCE, &px, &py, shift);
-	    break;
-	}
-
-	if (found)
-	    break;
-
-	switch (type) {
-	case O_ELLIPSE:
-	    type = O_POLYLINE;
-	    l = NULL;
-	    break;
-	case O_POLYLINE:
-	    type = O_SPLINE;
-	    s = NULL;
-	    break;
-	case O_SPLINE:
-	    type = O_TXT;
-	    t = NULL;
-	    break;
-	case O_TXT:
-	    type = O_ARC;
-	    a = NULL;
-	    break;
-	case O_ARC:
-	    type = O_COMPOUND;
-	    c = NULL;
-	    break;
-	case O_COMPOUND:
-	    type = O_ELLIPSE;
-	    e = NULL;
-	    break;
-	}
+static void *
+current_object(void)
+{
+    switch (type) {
+    case O_ARC:
+	return a;
+    case O_COMPOUND:
+	return c;
+    case O_ELLIPSE:
+	return e;
+    case O_POLYLINE:
+	return l;
+    case O_SPLINE:
+	return s;
+    case O_TXT:
+	return t;
     }
-    if (!found) {		/* nothing found */
-        /* dummy values */
-        smart_point1.x = smart_point1.y = 0;
-        smart_point2.x = smart_point2.y = 0;
-	csr_x = x;
-	csr_y = y;
-	type = -1;
-	smart_show_objecthighlight();
-    } else if (shift) {		/* show selected object */
-	smart_show_objecthighlight();
-    } else {			/* user selected an object */
-	smart_erase_objecthighlight();
-	switch (type) {
-	case O_ELLIPSE:
-	    manipulate(e, type, x, y, px, py);
-	    break;
-	case O_POLYLINE:
-	    manipulate(l, type, x, y, px, py);
-	    break;
-	case O_SPLINE:
-	    manipulate(s, type, x, y, px, py);
-	    break;
-	case O_TXT:
-	    manipulate(t, type, x, y, px, py);
-	    break;
-	case O_ARC:
-	    manipulate(a, type, x, y, px, py);
-	    break;
-	case O_COMPOUND:
-	    manipulate(c, type, x, y, px, py);
-	    break;
-	}
+    return NULL;
+}
+
+static void
+set_current_object(void *obj)
+{
+    switch (type) {
+    case O_ARC:
+	a = (F_arc *) obj;
+	break;
+    case O_COMPOUND:
+	c = (F_compound *) obj;
+	break;
+    case O_ELLIPSE:
+	e = (F_ellipse *) obj;
+	break;
+    case O_POLYLINE:
+	l = (F_line *) obj;
+	break;
+    case O_SPLINE:
+	s = (F_spline *) obj;
+	break;
+    case O_TXT:
+	t = (F_text *) obj;
+	break;
     }
 }
 
 /***************************************************************************/
 
-Boolean
-smart_next_arc_found(int x, int y, int tolerance, int *px, int *py, int shift)
+static Boolean
+smart_arc_found(F_arc *a, int x, int y, int tolerance, int *px, int *py)
 {
    float ax, ay;
    int x1, y1, x2, y2;
 
-   if (!arc_in_mask())
+   if (!close_to_arc(a, x, y, tolerance, &ax, &ay))
      return 0;
-   if (a == NULL)
-     a = last_arc(objects.arcs);
-   else if (shift)
-     a = prev_arc(objects.arcs, a);
-
-   for (; a != NULL; a = prev_arc(objects.arcs, a), n++) {
-     if (!close_to_arc(a, x, y, tolerance, &ax, &ay))
-       continue;
-     /* point found */
-     *px = x1 = round(ax);
-     *py = y1 = round(ay);
-     x2 = x1 + round(ay - a->center.y);
-     y2 = y1 - round(ax - a->center.x);
-     set_smart_points(x1, y1, x2, y2);
-     return 1;
-   }
-   return 0;
+   /* point found */
+   *px = x1 = round(ax);
+   *py = y1 = round(ay);
+   x2 = x1 + round(ay - a->center.y);
+   y2 = y1 - round(ax - a->center.x);
+   set_smart_points(x1, y1, x2, y2);
+   return 1;
 }
 
-Boolean
-smart_next_ellipse_found(int x, int y, int tolerance, int *px, int *py, int shift)
+static Boolean
+smart_ellipse_found(F_ellipse *e, int x, int y, int tolerance, int *px, int *py)
 {
    float ex, ey, vx, vy;
    int x1, y1, x2, y2;
 
-   if (!ellipse_in_mask())
-        return (0);
-   if (e == NULL)
-	e = last_ellipse(objects.ellipses);
-   else if (shift)
-	e = prev_ellipse(objects.ellipses, e);
-   for (; e != NULL; e = prev_ellipse(objects.ellipses, e), n++) {
-      if (!close_to_ellipse(e, x, y, tolerance, &ex, &ey, &vx, &vy))
-        continue;
-      *px = round(ex);
-      *py = round(ey);
-      /* handle special case of very small ellipse */
-      if (fabs(ex - e->center.x) <= SING_TOLERANCE &&
-          fabs(ey - e->center.y) <= SING_TOLERANCE) {
-        x1 = x2 = *px;
-        y1 = y2 = *py;
-      }
-      else {
-        x1 = *px;
-        y1 = *py;
-        x2 = x1 + round(vx);
-        y2 = y1 + round(vy);
-      }
-      set_smart_points(x1, y1, x2, y2);
-      return 1;
+   if (!close_to_ellipse(e, x, y, tolerance, &ex, &ey, &vx, &vy))
+     return 0;
+   *px = round(ex);
+   *py = round(ey);
+   /* handle special case of very small ellipse */
+   if (fabs(ex - e->center.x) <= SING_TOLERANCE &&
+       fabs(ey - e->center.y) <= SING_TOLERANCE) {
+     x1 = x2 = *px;
+     y1 = y2 = *py;
+   }
+   else {
+     x1 = *px;
+     y1 = *py;
+     x2 = x1 + round(vx);
+     y2 = y1 + round(vy);
    }
-   return 0;
+   set_smart_points(x1, y1, x2, y2);
+   return 1;
 }
 
-Boolean
-smart_next_line_found(int x, int y, int tolerance, int *px, int *py, int shift)
-{				/* return the pointer to lines object if the
-				 * search is successful otherwise return
-				 * NULL.  The value returned via (px, py) is
+static Boolean
+smart_line_found(F_line *l, int x, int y, int tolerance, int *px, int *py)
+{				/* The value returned via (px, py) is
 				 * the closest point on the vector to point
 				 * (x, y)					 */
 
     int lx1, ly1, lx2, ly2;
 
-    if (!anyline_in_mask())
-	return (0);
-    if (l == NULL)
-	l = last_line(objects.lines);
-    else if (shift)
-	l = prev_line(objects.lines, l);
-
-    for (; l != NULL; l = prev_line(objects.lines, l)) {
-	if (validline_in_mask(l)) {
-	    n++;
-            if (close_to_polyline(l, x, y, tolerance, SING_TOLERANCE, px, py,
-                                  &lx1, &ly1, &lx2, &ly2)) {
-              set_smart_points(lx1, ly1, lx2, ly2);
-              return 1;
-	    }
-	}
-    }
-    return 0;
+    if (!validline_in_mask(l))
+	return 0;
+    if (!close_to_polyline(l, x, y, tolerance, SING_TOLERANCE, px, py,
+			   &lx1, &ly1, &lx2, &ly2))
+	return 0;
+    set_smart_points(lx1, ly1, lx2, ly2);
+    return 1;
 }
 
-Boolean
-smart_next_spline_found(int x, int y, int tolerance, int *px, int *py, int shift)
+static Boolean
+smart_spline_found(F_spline *s, int x, int y, int tolerance, int *px, int *py)
 /* We call `close_to_spline' which uses HIGH_PRECISION.
    Think about it.
    */
 {
     int lx1, ly1, lx2, ly2;
 
-    if (!anyspline_in_mask())
-	return (0);
-    if (s == NULL)
-	s = last_spline(objects.splines);
-    else if (shift)
-	s = prev_spline(objects.splines, s);
-
-    for (; s != NULL; s = prev_spline(objects.splines, s)) {
-	if (validspline_in_mask(s)) {
-	    n++;
-            if (close_to_spline(s, x, y, tolerance, px, py,
-				&lx1, &ly1, &lx2, &ly2)) {
-              set_smart_points(lx1, ly1, lx2, ly2);
-              return 1;
-	    }
-	}
-    }
-    return 0;
+    if (!validspline_in_mask(s))
+	return 0;
+    if (!close_to_spline(s, x, y, tolerance, px, py, &lx1, &ly1, &lx2, &ly2))
+	return 0;
+    set_smart_points(lx1, ly1, lx2, ly2);
+    return 1;
 }
 
 /* actually, the following are not very smart */
 
-Boolean
-smart_next_text_found(int x, int y, int tolerance, int *px, int *py, int shift)
+static Boolean
+smart_text_found(F_text *t, int x, int y, int *px, int *py)
 {
     int		    dum, tlength;
 
-    if (!anytext_in_mask())
-	return (0);
-    if (t == NULL)
-	t = last_text(objects.texts);
-    else if (shift)
-	t = prev_text(objects.texts, t);
-
-    for (; t != NULL; t = prev_text(objects.texts, t))
-	if (validtext_in_mask(t)) {
-	    n++;
-	    if (in_text_bound(t, x, y, &dum, False)) {
-		*px = x;
-		*py = y;
-                tlength = text_length(t);
-                set_smart_points(t->base_x, t->base_y,
-                                 t->base_x + round(tlength * cos((double)t->angle)),
-                                 t->base_y + round(tlength * sin((double)t->angle)));
-		return 1;
-	    }
-	}
-    return 0;
+    if (!validtext_in_mask(t) || !in_text_bound(t, x, y, &dum, False))
+	return 0;
+    *px = x;
+    *py = y;
+    tlength = text_length(t);
+    set_smart_points(t->base_x, t->base_y,
+		     t->base_x + round(tlength * cos((double)t->angle)),
+		     t->base_y + round(tlength * sin((double)t->angle)));
+    return 1;
 }
 
-Boolean
-smart_next_compound_found(int x, int y, int tolerance, int *px, int *py, int shift)
+static Boolean
+smart_compound_found(F_compound *c, int x, int y, int tolerance, int *px, int *py)
 {
     float	    tol2;
 
-    if (!compound_in_mask())
-	return (0);
-    if (c == NULL)
-	c = last_compound(objects.compounds);
-    else if (shift)
-	c = prev_compound(objects.compounds, c);
-
     tol2 = tolerance * tolerance;
 
-    for (; c != NULL; c = prev_compound(objects.compounds, c), n++) {
-	if (close_to_vector(c->nwcorner.x, c->nwcorner.y, c->nwcorner.x,
-			    c->secorner.y, x, y, tolerance, tol2, px, py)) {
-            set_smart_points(c->nwcorner.x, c->nwcorner.y, c->nwcorner.x, c->secorner.y);
-            return 1;
-	}
-	else if (close_to_vector(c->secorner.x, c->secorner.y, c->nwcorner.x,
-				 c->secorner.y, x, y, tolerance, tol2, px, py)) {
-            set_smart_points(c->secorner.x, c->secorner.y, c->nwcorner.x, c->secorner.y);
-	    return 1;
+    if (close_to_vector(c->nwcorner.x, c->nwcorner.y, c->nwcorner.x,
+			c->secorner.y, x, y, tolerance, tol2, px, py)) {
+	set_smart_points(c->nwcorner.x, c->nwcorner.y, c->nwcorner.x, c->secorner.y);
+	return 1;
+    }
+    else if (close_to_vector(c->secorner.x, c->secorner.y, c->nwcorner.x,
+			     c->secorner.y, x, y, tolerance, tol2, px, py)) {
+	set_smart_points(c->secorner.x, c->secorner.y, c->nwcorner.x, c->secorner.y);
+	return 1;
+    }
+    else if (close_to_vector(c->secorner.x, c->secorner.y, c->secorner.x,
+			     c->nwcorner.y, x, y, tolerance, tol2, px, py)) {
+	set_smart_points(c->secorner.x, c->secorner.y, c->secorner.x, c->nwcorner.y);
+	return 1;
+    }
+    else if (close_to_vector(c->nwcorner.x, c->nwcorner.y, c->secorner.x,
+			     c->nwcorner.y, x, y, tolerance, tol2, px, py)) {
+	set_smart_points(c->nwcorner.x, c->nwcorner.y, c->secorner.x, c->nwcorner.y);
+	return 1;
+    }
+    return 0;
+}
+
+static Boolean
+smart_object_found(int type, void *obj, int x, int y, int tolerance, int *px, int *py)
+{
+    switch (type) {
+    case O_ARC:
+	return arc_in_mask() &&
+		smart_arc_found((F_arc *) obj, x, y, tolerance, px, py);
+    case O_COMPOUND:
+	return compound_in_mask() &&
+		smart_compound_found((F_compound *) obj, x, y, tolerance, px, py);
+    case O_ELLIPSE:
+	return ellipse_in_mask() &&
+		smart_ellipse_found((F_ellipse *) obj, x, y, tolerance, px, py);
+    case O_POLYLINE:
+	return anyline_in_mask() &&
+		smart_line_found((F_line *) obj, x, y, tolerance, px, py);
+    case O_SPLINE:
+	return anyspline_in_mask() &&
+		smart_spline_found((F_spline *) obj, x, y, tolerance, px, py);
+    case O_TXT:
+	return anytext_in_mask() &&
+		smart_text_found((F_text *) obj, x, y, px, py);
+    }
+    return 0;
+}
+
+/*
+ * Return the object of type at cur, or before cur if shift is set, that
+ * is close to (x, y), or NULL. If cur is NULL, start at the end of the
+ * list. Only the candidates from the pick index are tested, but n is
+ * advanced as if each object of the list was visited.
+ */
+
+static void *
+smart_next_found(int type, void *cur, int x, int y, int tolerance, int *px,
+		int *py, unsigned int shift)
+{
+    void	  **obj;
+    int		   *cand;
+    int		    num, ncand, start, i;
+
+    num = pick_objects(type, &obj);
+    ncand = pick_candidates(type, x, y, tolerance, &cand);
+    i = cur == NULL ? -1 : pick_number(type, cur);
+    start = i < 0 ? num - 1 : (shift ? i - 1 : i);
+
+    for (i = ncand - 1; i >= 0 && cand[i] > start; i--)
+	;
+    for (; i >= 0; i--)
+	if (smart_object_found(type, obj[cand[i]], x, y, tolerance, px, py)) {
+	    n += start - cand[i];
+	    return obj[cand[i]];
 	}
-	else if (close_to_vector(c->secorner.x, c->secorner.y, c->secorner.x,
-				 c->nwcorner.y, x, y, tolerance, tol2, px, py)) {
-            set_smart_points(c->secorner.x, c->secorner.y, c->secorner.x, c->nwcorner.y);
-            return 1;
+    n += start + 1;
+    return NULL;
+}
+
+/*
+ * Return the object of type nearest to (x, y), if nearer than *dist, or
+ * NULL. The objects are taken from the pick index in the order of the
+ * distance of their bounding box, and only tested while that distance is
+ * below the distance of the nearest object found.
+ */
+
+static void *
+smart_nearest_found(int type, int x, int y, int tolerance, int *px, int *py,
+		double *dist)
+{
+    void	  **obj;
+    void	   *found = NULL;
+    int		   *cand;
+    double	   *bound;
+    double	    d;
+    int		    ncand, i, k, qx, qy;
+    F_point	    p1, p2;
+
+    pick_objects(type, &obj);
+    i = 0;
+    for (k = NEAREST_FIRST; ; k *= 2) {
+	ncand = pick_nearest(type, x, y, tolerance, k, &cand, &bound);
+	for (; i < ncand && bound[i] < *dist; i++) {
+	    if (!smart_object_found(type, obj[cand[i]], x, y, tolerance,
+				    &qx, &qy))
+		continue;
+	    d = hypot((double)(qx - x), (double)(qy - y));
+	    if (d < *dist) {
+		*dist = d;
+		*px = qx;
+		*py = qy;
+		p1 = smart_point1;
+		p2 = smart_point2;
+		found = obj[cand[i]];
+	    }
 	}
-	else if (close_to_vector(c->nwcorner.x, c->nwcorner.y, c->secorner.x,
-				 c->nwcorner.y, x, y, tolerance, tol2, px, py)) {
-            set_smart_points(c->nwcorner.x, c->nwcorner.y, c->secorner.x, c->nwcorner.y);
-            return 1;
+	/* all candidates taken, or the next ones are too far away */
+	if (ncand < k || i < ncand)
+	    break;
+    }
+    if (found) {
+	smart_point1 = p1;
+	smart_point2 = p2;
+    }
+    return found;
+}
+
+/* make the object nearest to (x, y) the current object */
+
+static Boolean
+smart_nearest_object(int x, int y, int *px, int *py)
+{
+    static const int types[] = {O_ELLIPSE, O_POLYLINE, O_SPLINE, O_TXT,
+				O_ARC, O_COMPOUND};
+    void	   *obj;
+    double	    dist = HUGE_VAL;
+    int		    i, best = -1;
+    F_point	    p1, p2;
+
+    for (i = 0; i < (int)(sizeof types / sizeof types[0]); i++) {
+	if ((obj = smart_nearest_found(types[i], x, y, TOLERANCE, px, py,
+				       &dist)) == NULL)
+	    continue;
+	best = type = types[i];
+	set_current_object(obj);
+	p1 = smart_point1;
+	p2 = smart_point2;
+    }
+    if (best < 0)
+	return False;
+    type = best;
+    smart_point1 = p1;
+    smart_point2 = p2;
+    return True;
+}
+
+void					/* Shift Key Status from XEvent */
+do_smart_object_search(int x, int y, unsigned int shift)
+{
+    int		    px, py;
+    void	   *obj;
+    Boolean	    found = False;
+    Boolean	    fresh = !highlighting;
+
+    init_smart_search();
+    /* a plain click selects the nearest object */
+    if (fresh && !shift) {
+	found = smart_nearest_object(x, y, &px, &py);
+    } else {
+	for (n = 0; n < objectcount;) {
+	    obj = smart_next_found(type, current_object(), x, y, TOLERANCE,
+				   &px, &py, shift);
+	    set_current_object(obj);
+	    if (obj != NULL) {
+		found = True;
+		break;
+	    }
+
+	    switch (type) {
+	    case O_ELLIPSE:
+		type = O_POLYLINE;
+		l = NULL;
+		break;
+	    case O_POLYLINE:
+		type = O_SPLINE;
+		s = NULL;
+		break;
+	    case O_SPLINE:
+		type = O_TXT;
+		t = NULL;
+		break;
+	    case O_TXT:
+		type = O_ARC;
+		a = NULL;
+		break;
+	    case O_ARC:
+		type = O_COMPOUND;
+		c = NULL;
+		break;
+	    case O_COMPOUND:
+		type = O_ELLIPSE;
+		e = NULL;
+		break;
+	    }
 	}
     }
-    return 0;
+    if (!found) {		/* nothing found */
+        /* dummy values */
+        smart_point1.x = smart_point1.y = 0;
+        smart_point2.x = smart_point2.y = 0;
+	csr_x = x;
+	csr_y = y;
+	type = -1;
+	smart_show_objecthighlight();
+    } else if (shift) {		/* show selected object */
+	smart_show_objecthighlight();
+    } else {			/* user selected an object */
+	smart_erase_objecthighlight();
+	manipulate(current_object(), type, x, y, px, py);
+    }
 }
 
+/***************************************************************************/
+
 void smart_show_objecthighlight(void)
 {
     if (highlighting)
@@ -0,0 +1,546 @@
+/*
+ * FIG : Facility for Interactive Generation of figures
+ * Copyright (c) 1985-1988 by Supoj Sutanthavibul
+ * Parts Copyright (c) 1989-2015 by Brian V. Smith
+ * Parts Copyright (c) 1991 by Paul King
+ * Parts Copyright (c) 2016-2020 by Thomas Loimer
+ *
+ * Any party obtaining a copy of these files is granted, free of charge, a
+ * full and unrestricted irrevocable, world-wide, paid up, royalty-free,
+ * nonexclusive right and license to deal in this software and documentation
+ * files (the "Software"), including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense and/or sell copies of
+ * the Software, and to permit persons who receive copies from any such
+ * party to do so, with the only requirement being that the above copyright
+ * and this permission notice remain intact.
+ *
+ */
+
+/*
+ * The text index: the text objects of the figure, also those within
+ * compounds, and for each trigram, i.e., three consecutive characters
+ * folded to lower case, the texts containing it. textindex_find() returns
+ * the texts containing a pattern, in the order of the figure. Only the
+ * texts holding the least frequent trigram of the pattern are compared
+ * with the pattern, see w_srchrepl.c.
+ *
+ * After the figure changed, see pick_changed(), the objects are walked
+ * again and only the texts whose string changed are indexed anew. Their
+ * old trigrams are not removed, a text found through a trigram is always
+ * compared with the pattern. When too many of these stale entries
+ * accumulate, the index is built from scratch.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <ctype.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "resources.h"
+#include "object.h"
+#include "f_read.h"
+#include "u_bound.h"
+#include "u_pick.h"
+#include "u_textindex.h"
+
+typedef struct {
+	F_text	   *text;
+	F_compound *parent;	/* the compound holding the text, or NULL */
+	char	   *str;	/* text->cstring, when indexed */
+	size_t	    len;
+	uint32_t    hash;
+	int	    pos;	/* position in the figure, -1 if deleted */
+	unsigned long walk;	/* the walk that last saw the text */
+} text_entry;
+
+typedef struct {
+	uint32_t    gram;	/* 0 for an empty slot */
+	int	    num, alloc;
+	int	   *ids;	/* texts containing the trigram */
+} gram_list;
+
+static struct {
+	text_entry *ent;
+	int	    num_ent, alloc_ent;
+	int	   *order;	/* the texts, in the order of the figure */
+	int	    num_order, alloc_order;
+	int	   *slot;	/* hash table of the texts, id + 1 */
+	int	    num_slots;
+	gram_list  *gram;	/* hash table of the trigrams */
+	int	    num_grams, gram_slots;
+	long	    postings, stale;
+	F_compound **cslot;	/* hash table of compounds and their parent */
+	F_compound **cparent;
+	int	    num_cslots, num_comp;
+	int	   *found;	/* ids found by a search */
+	int	    alloc_found;
+	F_text	  **result;
+	int	    alloc_result;
+	unsigned   *mark;	/* ids already looked at by a search */
+	int	    alloc_mark;
+	unsigned    stamp;
+	unsigned long walk;
+	unsigned long changes;	/* pick_changes() when walked */
+	F_text	   *head;	/* the lists the index was built from */
+	F_compound *chead;
+} tindex;
+
+static void	walk_compound(F_compound *c, F_compound *parent);
+
+static uint32_t
+hash_string(char *s, size_t *len)
+{
+    uint32_t    h = 2166136261u;
+    char	   *p;
+
+    for (p = s; *p; p++)
+	h = (h ^ (unsigned char)*p) * 16777619u;
+    *len = p - s;
+    return h;
+}
+
+static unsigned
+hash_pointer(void *p, int num_slots)
+{
+    uintptr_t   u = (uintptr_t)p;
+
+    u ^= u >> 17;
+    u *= 0x9e3779b1u;
+    return (unsigned)(u ^ u >> 15) & (num_slots - 1);
+}
+
+static uint32_t
+trigram(char *s)
+{
+    return (uint32_t)tolower((unsigned char)s[0]) << 16 |
+	(uint32_t)tolower((unsigned char)s[1]) << 8 |
+	(uint32_t)tolower((unsigned char)s[2]);
+}
+
+static Boolean
+grow(void **a, int *alloc, int need, size_t size)
+{
+    void	   *b;
+    int	    n;
+
+    if (need <= *alloc)
+	return True;
+    n = *alloc ? 2 * *alloc : 64;
+    while (n < need)
+	n *= 2;
+    if ((b = realloc(*a, n * size)) == NULL)
+	return False;
+    *a = b;
+    *alloc = n;
+    return True;
+}
+
+/* the list of trigram g, create it if create is True */
+
+static gram_list *
+gram_lookup(uint32_t g, Boolean create)
+{
+    gram_list  *old;
+    int	    i, n;
+    unsigned    k;
+
+    if (tindex.gram_slots == 0 ||
+	    (create && 2 * (tindex.num_grams + 1) > tindex.gram_slots)) {
+	if (!create)
+	    return NULL;
+	/* double the table */
+	old = tindex.gram;
+	n = tindex.gram_slots;
+	tindex.gram_slots = n ? 2 * n : 1024;
+	if ((tindex.gram = calloc(tindex.gram_slots, sizeof(gram_list)))
+		== NULL) {
+	    tindex.gram = old;
+	    tindex.gram_slots = n;
+	    return NULL;
+	}
+	for (i = 0; i < n; i++) {
+	    if (old[i].gram == 0)
+		continue;
+	    k = old[i].gram * 2654435761u & (tindex.gram_slots - 1);
+	    while (tindex.gram[k].gram != 0)
+		k = (k + 1) & (tindex.gram_slots - 1);
+	    tindex.gram[k] = old[i];
+	}
+	free(old);
+    }
+    k = g * 2654435761u & (tindex.gram_slots - 1);
+    while (tindex.gram[k].gram != g) {
+	if (tindex.gram[k].gram == 0) {
+	    if (!create)
+		return NULL;
+	    tindex.gram[k].gram = g;
+	    tindex.num_grams++;
+	    break;
+	}
+	k = (k + 1) & (tindex.gram_slots - 1);
+    }
+    return &tindex.gram[k];
+}
+
+/* enter the trigrams of the string of text id */
+
+static void
+post_text(int id)
+{
+    text_entry *e = &tindex.ent[id];
+    gram_list  *l;
+    size_t	    i;
+
+    for (i = 0; i + 3 <= e->len; i++) {
+	if ((l = gram_lookup(trigram(e->str + i), True)) == NULL)
+	    return;
+	if (l->num > 0 && l->ids[l->num - 1] == id)
+	    continue;
+	if (!grow((void **)&l->ids, &l->alloc, l->num + 1, sizeof(int)))
+	    return;
+	l->ids[l->num++] = id;
+	tindex.postings++;
+    }
+}
+
+static int
+lookup_text(F_text *t)
+{
+    unsigned    k;
+
+    if (tindex.num_slots == 0)
+	return -1;
+    k = hash_pointer(t, tindex.num_slots);
+    while (tindex.slot[k]) {
+	if (tindex.ent[tindex.slot[k] - 1].text == t)
+	    return tindex.slot[k] - 1;
+	k = (k + 1) & (tindex.num_slots - 1);
+    }
+    return -1;
+}
+
+static void
+insert_slot(int id)
+{
+    unsigned    k;
+
+    k = hash_pointer(tindex.ent[id].text, tindex.num_slots);
+    while (tindex.slot[k])
+	k = (k + 1) & (tindex.num_slots - 1);
+    tindex.slot[k] = id + 1;
+}
+
+/* a new entry for text t, or -1 */
+
+static int
+add_text(F_text *t)
+{
+    int	   *slot;
+    int	    i, n;
+
+    if (!grow((void **)&tindex.ent, &tindex.alloc_ent, tindex.num_ent + 1,
+		sizeof(text_entry)))
+	return -1;
+    if (2 * (tindex.num_ent + 1) > tindex.num_slots) {
+	n = tindex.num_slots ? 2 * tindex.num_slots : 1024;
+	if ((slot = calloc(n, sizeof(int))) == NULL)
+	    return -1;
+	free(tindex.slot);
+	tindex.slot = slot;
+	tindex.num_slots = n;
+	for (i = 0; i < tindex.num_ent; i++)
+	    insert_slot(i);
+    }
+    tindex.ent[tindex.num_ent].text = t;
+    tindex.ent[tindex.num_ent].str = NULL;
+    insert_slot(tindex.num_ent);
+    return tindex.num_ent++;
+}
+
+/* remember the parent of compound c */
+
+static void
+add_compound(F_compound *c, F_compound *parent)
+{
+    F_compound **cslot, **cparent;
+    unsigned    k;
+    int	    i, n;
+
+    if (2 * (tindex.num_comp + 1) > tindex.num_cslots) {
+	n = tindex.num_cslots ? 2 * tindex.num_cslots : 256;
+	cslot = calloc(n, sizeof(F_compound *));
+	cparent = malloc(n * sizeof(F_compound *));
+	if (cslot == NULL || cparent == NULL) {
+	    free(cslot);
+	    free(cparent);
+	    return;
+	}
+	for (i = 0; i < tindex.num_cslots; i++) {
+	    if (tindex.cslot[i] == NULL)
+		continue;
+	    k = hash_pointer(tindex.cslot[i], n);
+	    while (cslot[k] != NULL)
+		k = (k + 1) & (n - 1);
+	    cslot[k] = tindex.cslot[i];
+	    cparent[k] = tindex.cparent[i];
+	}
+	free(tindex.cslot);
+	free(tindex.cparent);
+	tindex.cslot = cslot;
+	tindex.cparent = cparent;
+	tindex.num_cslots = n;
+    }
+    k = hash_pointer(c, tindex.num_cslots);
+    while (tindex.cslot[k] != NULL && tindex.cslot[k] != c)
+	k = (k + 1) & (tindex.num_cslots - 1);
+    if (tindex.cslot[k] == NULL)
+	tindex.num_comp++;
+    tindex.cslot[k] = c;
+    tindex.cparent[k] = parent;
+}
+
+static F_compound *
+compound_parent(F_compound *c)
+{
+    unsigned    k;
+
+    if (tindex.num_cslots == 0)
+	return NULL;
+    k = hash_pointer(c, tindex.num_cslots);
+    while (tindex.cslot[k] != NULL) {
+	if (tindex.cslot[k] == c)
+	    return tindex.cparent[k];
+	k = (k + 1) & (tindex.num_cslots - 1);
+    }
+    return NULL;
+}
+
+/* index text t, unless its string is indexed already */
+
+static void
+walk_text(F_text *t, F_compound *parent)
+{
+    text_entry *e;
+    uint32_t    h;
+    size_t	    len;
+    int	    id;
+
+    if (!grow((void **)&tindex.order, &tindex.alloc_order,
+		tindex.num_order + 1, sizeof(int)))
+	return;
+    h = hash_string(t->cstring, &len);
+    if ((id = lookup_text(t)) < 0 && (id = add_text(t)) < 0)
+	return;
+    e = &tindex.ent[id];
+    e->parent = parent;
+    e->pos = tindex.num_order;
+    e->walk = tindex.walk;
+    tindex.order[tindex.num_order++] = id;
+    if (e->str == t->cstring && e->len == len && e->hash == h)
+	return;
+    if (e->str != NULL && e->len >= 3)
+	tindex.stale += e->len - 2;
+    e->str = t->cstring;
+    e->len = len;
+    e->hash = h;
+    post_text(id);
+}
+
+static void
+walk_compound(F_compound *c, F_compound *parent)
+{
+    F_compound *cc;
+    F_text	   *t;
+
+    expand_compound(c);
+    for (cc = c->compounds; cc != NULL; cc = cc->next) {
+	add_compound(cc, parent ? c : NULL);
+	walk_compound(cc, c);
+    }
+    for (t = c->texts; t != NULL; t = t->next)
+	walk_text(t, parent ? c : NULL);
+}
+
+static void
+clear_index(void)
+{
+    int	    i;
+
+    for (i = 0; i < tindex.gram_slots; i++)
+	free(tindex.gram[i].ids);
+    free(tindex.gram);
+    tindex.gram = NULL;
+    tindex.gram_slots = tindex.num_grams = 0;
+    free(tindex.slot);
+    tindex.slot = NULL;
+    tindex.num_slots = 0;
+    tindex.num_ent = 0;
+    tindex.postings = tindex.stale = 0;
+}
+
+/* bring the index up to date with the figure */
+
+static void
+fresh_index(void)
+{
+    int	    i;
+
+    if (tindex.changes == pick_changes() && tindex.head == objects.texts &&
+	    tindex.chead == objects.compounds)
+	return;
+
+    /* too many stale entries, begin anew */
+    if (tindex.stale > tindex.postings / 2 + 4096)
+	clear_index();
+
+    tindex.walk++;
+    tindex.num_order = 0;
+    tindex.num_comp = 0;
+    if (tindex.num_cslots > 0)
+	memset(tindex.cslot, 0, tindex.num_cslots * sizeof(F_compound *));
+    /* the texts and compounds at the top level have the parent NULL */
+    walk_compound(&objects, NULL);
+    for (i = 0; i < tindex.num_ent; i++) {
+	if (tindex.ent[i].walk != tindex.walk && tindex.ent[i].pos >= 0) {
+	    tindex.ent[i].pos = -1;
+	    if (tindex.ent[i].len >= 3)
+		tindex.stale += tindex.ent[i].len - 2;
+	}
+    }
+    tindex.changes = pick_changes();
+    tindex.head = objects.texts;
+    tindex.chead = objects.compounds;
+}
+
+/* the first occurrence of pattern in str, or NULL */
+
+char *
+textindex_match(char *str, char *pattern, Boolean case_sensitive)
+{
+    size_t	    i;
+
+    if (case_sensitive)
+	return strstr(str, pattern);
+    for (; *str; str++) {
+	for (i = 0; pattern[i] && tolower((unsigned char)str[i]) ==
+		tolower((unsigned char)pattern[i]); i++)
+	    ;
+	if (pattern[i] == '\0')
+	    return str;
+    }
+    return *pattern ? NULL : str;
+}
+
+static int
+compare_pos(const void *a, const void *b)
+{
+    return tindex.ent[*(const int *)a].pos -
+	tindex.ent[*(const int *)b].pos;
+}
+
+/*
+ * Return the number of texts of the figure containing pattern, and the
+ * texts in *found, in the order of the figure. An empty pattern matches all
+ * texts. *found is valid until the next call.
+ */
+
+int
+textindex_find(char *pattern, Boolean case_sensitive, F_text ***found)
+{
+    gram_list  *l, *best = NULL;
+    int	   *cand, num_cand;
+    int	    i, id, n = 0;
+    size_t	    plen = strlen(pattern);
+
+    fresh_index();
+    *found = NULL;
+
+    if (plen >= 3) {
+	/* the texts holding the least frequent trigram */
+	for (i = 0; i + 3 <= (int)plen; i++) {
+	    if ((l = gram_lookup(trigram(pattern + i), False)) == NULL)
+		return 0;
+	    if (best == NULL || l->num < best->num)
+		best = l;
+	}
+	cand = best->ids;
+	num_cand = best->num;
+    } else {
+	cand = tindex.order;
+	num_cand = tindex.num_order;
+    }
+
+    if (!grow((void **)&tindex.found, &tindex.alloc_found, num_cand + 1,
+		sizeof(int)) ||
+        !grow((void **)&tindex.result, &tindex.alloc_result, num_cand + 1,
+		sizeof(F_text *)))
+	return 0;
+    if (plen >= 3) {
+	i = tindex.alloc_mark;
+	if (!grow((void **)&tindex.mark, &tindex.alloc_mark,
+		    tindex.num_ent, sizeof(unsigned)))
+	    return 0;
+	memset(tindex.mark + i, 0,
+		(tindex.alloc_mark - i) * sizeof(unsigned));
+	if (++tindex.stamp == 0) {
+	    memset(tindex.mark, 0,
+		tindex.alloc_mark * sizeof(unsigned));
+	    tindex.stamp = 1;
+	}
+    }
+    for (i = 0; i < num_cand; i++) {
+	id = cand[i];
+	if (tindex.ent[id].pos < 0)
+	    continue;
+	if (plen >= 3) {
+	    /* a text may be listed more than once */
+	    if (tindex.mark[id] == tindex.stamp)
+		continue;
+	    tindex.mark[id] = tindex.stamp;
+	}
+	if (textindex_match(tindex.ent[id].text->cstring, pattern,
+		    case_sensitive))
+	    tindex.found[n++] = id;
+    }
+    if (plen >= 3)
+	qsort(tindex.found, n, sizeof(int), compare_pos);
+    for (i = 0; i < n; i++)
+	tindex.result[i] = tindex.ent[tindex.found[i]].text;
+    *found = tindex.result;
+    return n;
+}
+
+/*
+ * The string or the attributes of text t, found by textindex_find(), were
+ * changed. Index its string and update the bounds of the compounds
+ * holding it.
+ */
+
+void
+textindex_changed(F_text *t)
+{
+    text_entry *e;
+    F_compound *c;
+    uint32_t    h;
+    size_t	    len;
+    int	    id;
+
+    if ((id = lookup_text(t)) < 0 || tindex.ent[id].pos < 0)
+	return;
+    e = &tindex.ent[id];
+    h = hash_string(t->cstring, &len);
+    if (e->str != t->cstring || e->len != len || e->hash != h) {
+	if (e->len >= 3)
+	    tindex.stale += e->len - 2;
+	e->str = t->cstring;
+	e->len = len;
+	e->hash = h;
+	post_text(id);
+    }
+    for (c = e->parent; c != NULL; c = compound_parent(c))
+	compound_bound(c, &c->nwcorner.x, &c->nwcorner.y,
+		&c->secorner.x, &c->secorner.y);
+}
@@ -0,0 +1,192 @@
+/*
+ * FIG : Facility for Interactive Generation of figures
+ * Copyright (c) 1985-1988 by Supoj Sutanthavibul
+ * Parts Copyright (c) 1989-2015 by Brian V. Smith
+ * Parts Copyright (c) 1991 by Paul King
+ * Parts Copyright (c) 2016-2020 by Thomas Loimer
+ *
+ * Any party obtaining a copy of these files is granted, free of charge, a
+ * full and unrestricted irrevocable, world-wide, paid up, royalty-free,
+ * nonexclusive right and license to deal in this software and documentation
+ * files (the "Software"), including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense and/or sell copies of
+ * the Software, and to permit persons who receive copies from any such
+ * party to do so, with the only requirement being that the above copyright
+ * and this permission notice remain intact.
+ *
+ */
+/*
+ * Transform the points of all lines and splines of a compound, and of the
+ * compounds within it, in one pass. The coordinates are gathered into
+ * contiguous arrays, transformed in tight loops the compiler can
+ * vectorize, and written back. The arithmetic, including the rounding,
+ * is that of translate_line(), scale_line(), rotate_line() and
+ * flip_line(), thus the result is identical. The other objects, and
+ * attributes such as arrows, are still transformed by these functions.
+ * The bounds are not computed here; the corners of the compounds are
+ * transformed as before, and only rotation calls compound_bound(), which
+ * needs the curves of splines and the arrowheads.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <math.h>
+#include <stdlib.h>
+
+#include "resources.h"
+#include "object.h"
+#include "e_rotate.h"
+#include "f_read.h"
+#include "u_transform.h"
+
+typedef struct {
+    F_point	  **pts;	/* the points gathered */
+    int		   *x, *y;	/* and their coordinates */
+    int		    num, alloc;
+} point_buf;
+
+static Boolean
+add_points(point_buf *b, F_point *p)
+{
+    F_point	  **q;
+    int		   *x, *y;
+    int		    n;
+
+    for (; p != NULL; p = p->next) {
+	if (b->num == b->alloc) {
+	    n = b->alloc ? 2 * b->alloc : 4096;
+	    if ((q = realloc(b->pts, n * sizeof(F_point *))) == NULL)
+		return False;
+	    b->pts = q;
+	    if ((x = realloc(b->x, n * sizeof(int))) == NULL)
+		return False;
+	    b->x = x;
+	    if ((y = realloc(b->y, n * sizeof(int))) == NULL)
+		return False;
+	    b->y = y;
+	    b->alloc = n;
+	}
+	b->pts[b->num] = p;
+	b->x[b->num] = p->x;
+	b->y[b->num++] = p->y;
+    }
+    return True;
+}
+
+static Boolean
+gather(point_buf *b, F_compound *c, Boolean expand,
+		Boolean (*skip)(F_compound *c))
+{
+    F_line	   *l;
+    F_spline	   *s;
+    F_compound	   *c1;
+
+    if (expand)
+	expand_compound(c);
+    if (skip != NULL && (*skip)(c))
+	return True;
+    for (l = c->lines; l != NULL; l = l->next)
+	if (!add_points(b, l->points))
+	    return False;
+    for (s = c->splines; s != NULL; s = s->next)
+	if (!add_points(b, s->points))
+	    return False;
+    for (c1 = c->compounds; c1 != NULL; c1 = c1->next)
+	if (!gather(b, c1, expand, skip))
+	    return False;
+    return True;
+}
+
+static void
+apply(xform *t, int *restrict x, int *restrict y, int n)
+{
+    int		    i, d;
+    int		    rx = t->x, ry = t->y, dirn = t->dirn;
+    float	    sx = t->sx, sy = t->sy;
+
+    switch (t->op) {
+      case XF_TRANSLATE:
+	for (i = 0; i < n; i++) {
+	    x[i] += rx;
+	    y[i] += ry;
+	}
+	break;
+      case XF_SCALE:
+	for (i = 0; i < n; i++) {
+	    x[i] = round(rx + (x[i] - rx) * sx);
+	    y[i] = round(ry + (y[i] - ry) * sy);
+	}
+	break;
+      case XF_ROTATE90:
+	for (i = 0; i < n; i++) {
+	    d = x[i] - rx;
+	    x[i] = rx + dirn * (ry - y[i]);
+	    y[i] = ry + dirn * d;
+	}
+	break;
+      case XF_ROTATE:
+	for (i = 0; i < n; i++)
+	    rotate_xy(&x[i], &y[i], rx, ry);
+	break;
+      case XF_FLIP_UD:
+	for (i = 0; i < n; i++)
+	    y[i] = ry + (ry - y[i]);
+	break;
+      case XF_FLIP_LR:
+	for (i = 0; i < n; i++)
+	    x[i] = rx + (rx - x[i]);
+	break;
+    }
+}
+
+static void
+transform_in_place(F_compound *c, xform *t, Boolean expand,
+		Boolean (*skip)(F_compound *c))
+{
+    F_line	   *l;
+    F_spline	   *s;
+    F_point	   *p;
+    F_compound	   *c1;
+
+    if (expand)
+	expand_compound(c);
+    if (skip != NULL && (*skip)(c))
+	return;
+    for (l = c->lines; l != NULL; l = l->next)
+	for (p = l->points; p != NULL; p = p->next)
+	    apply(t, &p->x, &p->y, 1);
+    for (s = c->splines; s != NULL; s = s->next)
+	for (p = s->points; p != NULL; p = p->next)
+	    apply(t, &p->x, &p->y, 1);
+    for (c1 = c->compounds; c1 != NULL; c1 = c1->next)
+	transform_in_place(c1, t, expand, skip);
+}
+
+/*
+ * Transform the points of the lines and splines in c and the compounds
+ * within, except in those for which skip() returns True. If expand is
+ * True, skimmed compounds are read first.
+ */
+
+void
+transform_points(F_compound *c, xform *t, Boolean expand,
+		Boolean (*skip)(F_compound *c))
+{
+    point_buf	    b = {NULL, NULL, NULL, 0, 0};
+    int		    i;
+
+    if (gather(&b, c, expand, skip)) {
+	apply(t, b.x, b.y, b.num);
+	for (i = 0; i < b.num; i++) {
+	    b.pts[i]->x = b.x[i];
+	    b.pts[i]->y = b.y[i];
+	}
+    } else {
+	/* out of memory, transform one point after the other */
+	transform_in_place(c, t, expand, skip);
+    }
+    free(b.pts);
+    free(b.x);
+    free(b.y);
+}
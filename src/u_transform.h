@@ -0,0 +1,39 @@
+/*
+ * FIG : Facility for Interactive Generation of figures
+ * Copyright (c) 1985-1988 by Supoj Sutanthavibul
+ * Parts Copyright (c) 1989-2015 by Brian V. Smith
+ * Parts Copyright (c) 1991 by Paul King
+ * Parts Copyright (c) 2016-2020 by Thomas Loimer
+ *
+ * Any party obtaining a copy of these files is granted, free of charge, a
+ * full and unrestricted irrevocable, world-wide, paid up, royalty-free,
+ * nonexclusive right and license to deal in this software and documentation
+ * files (the "Software"), including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense and/or sell copies of
+ * the Software, and to permit persons who receive copies from any such
+ * party to do so, with the only requirement being that the above copyright
+ * and this permission notice remain intact.
+ *
+ */
+#ifndef U_TRANSFORM_H
+#define U_TRANSFORM_H
+
+/* the transformations applied by transform_points() */
+#define XF_TRANSLATE	0	/* by (x, y) */
+#define XF_SCALE	1	/* by (sx, sy) about (x, y) */
+#define XF_ROTATE90	2	/* by 90 degrees about (x, y), in direction dirn */
+#define XF_ROTATE	3	/* by act_rotnangle, see rotate_xy() */
+#define XF_FLIP_UD	4	/* up/down about y */
+#define XF_FLIP_LR	5	/* left/right about x */
+
+typedef struct {
+	int	op;
+	int	x, y;
+	float	sx, sy;
+	int	dirn;
+} xform;
+
+extern void	transform_points(F_compound *c, xform *t, Boolean expand,
+				Boolean (*skip)(F_compound *c));
+
+#endif /* U_TRANSFORM_H */
@@ -18,6 +18,8 @@
 #include "fig.h"
 #include "resources.h"
 #include "object.h"
+#include "f_read.h"
+#include "u_transform.h"
 
 
 void translate_lines (F_line *lines, int dx, int dy);
@@ -76,19 +78,45 @@ void translate_spline(F_spline *spline, int dx, int dy)
 
 }
 
-void translate_compound(F_compound *compound, int dx, int dy)
+static Boolean
+is_lazy(F_compound *c)
 {
+    return c->lazy != NULL;
+}
+
+/* translate all but the lines and splines, see transform_points() */
+
+static void
+translate_members(F_compound *compound, int dx, int dy)
+{
+    F_compound	   *c;
+
+    /* the objects of a skimmed compound are moved when they are read */
+    if (compound->lazy != NULL) {
+	translate_lazy_compound(compound, dx, dy);
+	return;
+    }
     compound->nwcorner.x += dx;
     compound->nwcorner.y += dy;
     compound->secorner.x += dx;
     compound->secorner.y += dy;
 
-    translate_lines(compound->lines, dx, dy);
-    translate_splines(compound->splines, dx, dy);
     translate_ellipses(compound->ellipses, dx, dy);
     translate_arcs(compound->arcs, dx, dy);
     translate_texts(compound->texts, dx, dy);
-    translate_compounds(compound->compounds, dx, dy);
+    for (c = compound->compounds; c != NULL; c = c->next)
+	translate_members(c, dx, dy);
+}
+
+void translate_compound(F_compound *compound, int dx, int dy)
+{
+    xform	    t;
+
+    t.op = XF_TRANSLATE;
+    t.x = dx;
+    t.y = dy;
+    transform_points(compound, &t, False, is_lazy);
+    translate_members(compound, dx, dy);
 }
 
 void translate_arcs(F_arc *arcs, int dx, int dy)
@@ -42,10 +42,12 @@
 
 #include "e_deletept.h"
 #include "e_scale.h"
+#include "f_journal.h"
 #include "f_read.h"
 #include "u_bound.h"
 #include "u_free.h"
 #include "u_markers.h"
+#include "u_pick.h"
 #include "u_translate.h"
 #include "w_cmdpanel.h"
 #include "w_indpanel.h"
@@ -76,6 +78,7 @@ F_line		*latest_line;		/* for undo_join (line) */
 F_spline	*latest_spline;		/* for undo_join (spline) */
 
 int		last_action = F_NULL;
+unsigned long	action_count = 0;	/* incremented in clean_up() and undo() */
 
 /*************** LOCAL *****************/
 
@@ -89,6 +92,56 @@ static F_arrow    *last_for_arrow, *last_back_arrow;
 static int	last_linkmode;
 static double	last_origin_tension, last_extremity_tension;
 
+/* an object moved by an alignment, see set_latestshifts() */
+struct shift {
+    int		    type;
+    void	   *obj;
+    int		    dx, dy;
+};
+static struct shift *last_shifts = NULL;
+static int	last_num_shifts = 0;
+static struct shift *pending_shifts = NULL;	/* from save_positions() */
+static int	num_pending = 0;
+
+/*
+ * The undo history. The last action is held in the variables above. When
+ * the next action begins, clean_up() moves it into the history; undone
+ * actions are kept for redo() until a new action is begun. The oldest
+ * actions are dropped when the history holds more than appres.undo_memory
+ * kilobytes. Most actions keep only pointers to objects of the figure,
+ * and positions; memory is held by deleted objects and by the original
+ * copies of changed objects.
+ */
+
+typedef struct undo_step {
+    int		    action, object;
+    F_compound	    saved, tails;
+    F_arrow	   *saved_for_arrow, *saved_back_arrow;
+    F_line	   *latest_line;
+    F_spline	   *latest_spline;
+    F_pos	    last_position, new_position;
+    int		    arcpointnum;
+    F_point	   *prev_point, *selected_point, *next_point;
+    F_sfactor	   *selected_sfactor;
+    F_linkinfo	   *links;
+    int		    linkmode;
+    F_arrow	   *for_arrow, *back_arrow;
+    double	    origin_tension, extremity_tension;
+    struct shift   *shifts;
+    int		    num_shifts;
+    size_t	    size;		/* memory held by the step */
+    unsigned long   count;		/* action_count, when stored */
+    struct undo_step *prev;		/* the step before, or for redo after */
+    struct undo_step *next;
+} undo_step;
+
+static undo_step *newest = NULL, *oldest = NULL;
+static undo_step *redo_steps = NULL;
+static size_t	history_size = 0;
+static Boolean	undone = False;		/* the last action was undone */
+static Boolean	in_undo = False;
+static Boolean	objects_replaced = False;	/* see keep_members() */
+
 
 void undo_add (void);
 void undo_delete (void);
@@ -105,15 +158,169 @@ void undo_delete_arrowhead (void);
 void undo_convert (void);
 void undo_open_close (void);
 void undo_join_split (void);
+void undo_align (void);
+void undo_movepoint (void);
 void set_action_object (int action, int object);
 void swap_newp_lastp (void);
 
+static Boolean	apply_action(void);
+static void	pick_action(void);
+static Boolean	step_valid(void);
+static undo_step *store_step(void);
+static void	load_step(undo_step *s);
+static void	reset_step(void);
+static void	free_saved(void);
+static void	push_history(undo_step *s);
+static undo_step *pop_history(void);
+static void	push_redo(undo_step *s);
+static undo_step *pop_redo(void);
+static void	forget_steps(void);
+static void	forget_redo(void);
+static void	trim_history(void);
+
+/*
+ * Undo the last action or, if it was undone already, the action before.
+ * Undone actions are kept for redo().
+ */
+
 void
 undo(void)
 {
     /* turn off Compose key LED */
     setCompLED(0);
 
+    /* the undo is an action of its own */
+    journal_commit();
+    ++action_count;
+
+    if (last_action == F_NULL || undone) {
+	if (newest == NULL) {
+	    put_msg("Nothing to UNDO");
+	    return;
+	}
+	if (last_action != F_NULL)
+	    push_redo(store_step());
+	load_step(pop_history());
+    }
+    if (!step_valid()) {
+	put_msg("The figure was changed, cannot UNDO");
+	return;
+    }
+    if (!apply_action()) {
+	put_msg("Nothing to UNDO");
+	return;
+    }
+    undone = True;
+    journal_commit();
+    pick_action();
+    put_msg("Undo complete");
+}
+
+/* Redo the action undone last. */
+
+void
+redo(void)
+{
+    /* turn off Compose key LED */
+    setCompLED(0);
+
+    journal_commit();
+    ++action_count;
+
+    if (last_action == F_NULL || !undone) {
+	if (redo_steps == NULL) {
+	    put_msg("Nothing to REDO");
+	    return;
+	}
+	if (last_action != F_NULL)
+	    push_history(store_step());
+	load_step(pop_redo());
+    }
+    if (!step_valid()) {
+	put_msg("The figure was changed, cannot REDO");
+	return;
+    }
+    if (!apply_action()) {
+	put_msg("Nothing to REDO");
+	return;
+    }
+    undone = False;
+    journal_commit();
+    pick_action();
+    put_msg("Redo complete");
+}
+
+/*
+ * Tell the pick index which object was moved or edited in place, see
+ * u_pick.c. The objects added or deleted are reported by u_list.c.
+ */
+
+static void
+pick_action(void)
+{
+    F_compound	   *c = &saved_objects;
+
+    /* the edited object in the figure comes after the saved one */
+    if (last_action == F_EDIT)
+	switch (last_object) {
+	  case O_POLYLINE:
+	    pick_object_changed(O_POLYLINE, c->lines->next);
+	    return;
+	  case O_ELLIPSE:
+	    pick_object_changed(O_ELLIPSE, c->ellipses->next);
+	    return;
+	  case O_TXT:
+	    pick_object_changed(O_TXT, c->texts->next);
+	    return;
+	  case O_SPLINE:
+	    pick_object_changed(O_SPLINE, c->splines->next);
+	    return;
+	  case O_ARC:
+	    pick_object_changed(O_ARC, c->arcs->next);
+	    return;
+	  case O_COMPOUND:
+	    pick_object_changed(O_COMPOUND, c->compounds->next);
+	    return;
+	}
+    if (last_action == F_MOVE && last_links == NULL)
+	switch (last_object) {
+	  case O_POLYLINE:
+	    pick_object_changed(O_POLYLINE, c->lines);
+	    return;
+	  case O_ELLIPSE:
+	    pick_object_changed(O_ELLIPSE, c->ellipses);
+	    return;
+	  case O_TXT:
+	    pick_object_changed(O_TXT, c->texts);
+	    return;
+	  case O_SPLINE:
+	    pick_object_changed(O_SPLINE, c->splines);
+	    return;
+	  case O_ARC:
+	    pick_object_changed(O_ARC, c->arcs);
+	    return;
+	  case O_COMPOUND:
+	    pick_object_changed(O_COMPOUND, c->compounds);
+	    return;
+	}
+    /* reported by undo_movepoint() */
+    if (last_action == F_MOVE_POINT)
+	return;
+    pick_changed();
+}
+
+/*
+ * Reverse the last action. The variables then describe the reverse action,
+ * thus applying it again redoes the action.
+ */
+
+static Boolean
+apply_action(void)
+{
+    int		    action = last_action;
+
+    in_undo = True;
+    objects_replaced = False;
     switch (last_action) {
       case F_ADD:
 	undo_add();
@@ -145,6 +352,9 @@ undo(void)
       case F_DELETE_POINT:
 	undo_deletepoint();
 	break;
+      case F_MOVE_POINT:
+	undo_movepoint();
+	break;
       case F_ADD_ARROW_HEAD:
 	undo_add_arrowhead();
 	break;
@@ -161,11 +371,65 @@ undo(void)
       case F_SPLIT:
 	undo_join_split();
 	break;
-    default:
-	put_msg("Nothing to UNDO");
-	return;
+      case F_ALIGN:
+	undo_align();
+	break;
+      default:
+	in_undo = False;
+	return False;
     }
-    put_msg("Undo complete");
+    in_undo = False;
+
+    /*
+     * Reversing these actions creates new objects in place of the ones
+     * the actions before and after refer to.
+     */
+    if (action == F_CONVERT || action == F_JOIN || action == F_SPLIT ||
+		objects_replaced) {
+	forget_steps();
+	forget_redo();
+    }
+    return True;
+}
+
+/*
+ * Objects added together are cut from the ends of the object lists. Return
+ * False, if other objects were appended after them in the meantime.
+ */
+
+static Boolean
+step_valid(void)
+{
+    F_compound	   *c;
+
+    if (last_action == F_ADD && last_object == O_ALL_OBJECT)
+	c = &saved_objects;
+    else if (last_action == F_BREAK)
+	c = saved_objects.compounds;
+    else
+	return True;
+
+    if ((object_tails.arcs ? object_tails.arcs->next : objects.arcs)
+		    == c->arcs &&
+	    (object_tails.compounds ? object_tails.compounds->next :
+		    objects.compounds) == c->compounds &&
+	    (object_tails.ellipses ? object_tails.ellipses->next :
+		    objects.ellipses) == c->ellipses &&
+	    (object_tails.lines ? object_tails.lines->next : objects.lines)
+		    == c->lines &&
+	    (object_tails.splines ? object_tails.splines->next :
+		    objects.splines) == c->splines &&
+	    (object_tails.texts ? object_tails.texts->next : objects.texts)
+		    == c->texts)
+	return True;
+
+    /* the steps before may depend on this one */
+    free_saved();
+    reset_step();
+    undone = False;
+    forget_steps();
+    forget_redo();
+    return False;
 }
 
 void undo_join_split(void)
@@ -329,6 +593,147 @@ void undo_delete_arrowhead(void)
     last_action = F_ADD_ARROW_HEAD;
 }
 
+/*
+ * The steps before and after an edit refer to the points of a line or
+ * spline, and to the objects within a compound. When the original and the
+ * changed object are exchanged, the object in the figure keeps these and
+ * only their contents are exchanged.
+ */
+
+#define EXCHANGE_CONTENTS(type, a, b)	{ type swp_ = *(a); \
+	    *(a) = *(b); *(b) = swp_; \
+	    swp_.next = (a)->next; (a)->next = (b)->next; (b)->next = swp_.next; }
+
+static int
+num_sfactors(F_sfactor *f)
+{
+    int		    n = 0;
+
+    for (; f != NULL; f = f->next)
+	++n;
+    return n;
+}
+
+/* return True, if c and d hold equal numbers of objects and points */
+
+static Boolean
+same_shape(F_compound *c, F_compound *d)
+{
+    F_arc	   *a, *b;
+    F_compound	   *c1, *d1;
+    F_ellipse	   *e, *f;
+    F_line	   *l, *m;
+    F_spline	   *s, *r;
+    F_text	   *t, *u;
+
+    for (a = c->arcs, b = d->arcs; a && b; a = a->next, b = b->next)
+	;
+    for (e = c->ellipses, f = d->ellipses; e && f; e = e->next, f = f->next)
+	;
+    for (t = c->texts, u = d->texts; t && u; t = t->next, u = u->next)
+	;
+    if (a || b || e || f || t || u)
+	return False;
+    for (l = c->lines, m = d->lines; l && m; l = l->next, m = m->next)
+	if (num_points(l->points) != num_points(m->points))
+	    return False;
+    for (s = c->splines, r = d->splines; s && r; s = s->next, r = r->next)
+	if (num_points(s->points) != num_points(r->points) ||
+		num_sfactors(s->sfactors) != num_sfactors(r->sfactors))
+	    return False;
+    for (c1 = c->compounds, d1 = d->compounds; c1 && d1;
+		c1 = c1->next, d1 = d1->next)
+	if (!same_shape(c1, d1))
+	    return False;
+    return !l && !m && !s && !r && !c1 && !d1;
+}
+
+/*
+ * The contents of two lists of points, or shape factors, of equal length
+ * were exchanged. Give back the lists, but keep the coordinates.
+ */
+
+static void
+keep_points(F_point **p, F_point **q)
+{
+    F_point	   *a, *b;
+    F_point	   *swp;
+    int		    t;
+
+    swp = *p;
+    *p = *q;
+    *q = swp;
+    for (a = *p, b = *q; a != NULL; a = a->next, b = b->next) {
+	t = a->x; a->x = b->x; b->x = t;
+	t = a->y; a->y = b->y; b->y = t;
+    }
+}
+
+static void
+keep_sfactors(F_sfactor **f, F_sfactor **g)
+{
+    F_sfactor	   *a, *b;
+    F_sfactor	   *swp;
+    double	    t;
+
+    swp = *f;
+    *f = *g;
+    *g = swp;
+    for (a = *f, b = *g; a != NULL; a = a->next, b = b->next) {
+	t = a->s; a->s = b->s; b->s = t;
+    }
+}
+
+/*
+ * The contents of compound c, in the figure, and of d were exchanged. Give
+ * c back its objects, and exchange the contents of these instead. If the
+ * objects within do not match, return False.
+ */
+
+static Boolean
+keep_members(F_compound *c, F_compound *d)
+{
+    F_compound	    swp;
+    F_arc	   *a, *b;
+    F_compound	   *c1, *d1;
+    F_ellipse	   *e, *f;
+    F_line	   *l, *m;
+    F_spline	   *s, *r;
+    F_text	   *t, *u;
+
+    if (!same_shape(c, d))
+	return False;
+    swp = *c;
+    c->arcs = d->arcs;			d->arcs = swp.arcs;
+    c->compounds = d->compounds;	d->compounds = swp.compounds;
+    c->ellipses = d->ellipses;		d->ellipses = swp.ellipses;
+    c->lines = d->lines;		d->lines = swp.lines;
+    c->splines = d->splines;		d->splines = swp.splines;
+    c->texts = d->texts;		d->texts = swp.texts;
+
+    for (a = c->arcs, b = d->arcs; a != NULL; a = a->next, b = b->next)
+	EXCHANGE_CONTENTS(F_arc, a, b);
+    for (e = c->ellipses, f = d->ellipses; e != NULL; e = e->next, f = f->next)
+	EXCHANGE_CONTENTS(F_ellipse, e, f);
+    for (t = c->texts, u = d->texts; t != NULL; t = t->next, u = u->next)
+	EXCHANGE_CONTENTS(F_text, t, u);
+    for (l = c->lines, m = d->lines; l != NULL; l = l->next, m = m->next) {
+	EXCHANGE_CONTENTS(F_line, l, m);
+	keep_points(&l->points, &m->points);
+    }
+    for (s = c->splines, r = d->splines; s != NULL; s = s->next, r = r->next) {
+	EXCHANGE_CONTENTS(F_spline, s, r);
+	keep_points(&s->points, &r->points);
+	keep_sfactors(&s->sfactors, &r->sfactors);
+    }
+    for (c1 = c->compounds, d1 = d->compounds; c1 != NULL;
+		c1 = c1->next, d1 = d1->next) {
+	EXCHANGE_CONTENTS(F_compound, c1, d1);
+	keep_members(c1, d1);
+    }
+    return True;
+}
+
 /*
  * saved_objects.xxxx contains a pointer to the original object,
  * saved_objects.xxxx->next points to the changed object.
@@ -360,6 +765,11 @@ void undo_change(void)
 	swp_l.next = old_l->next;
 	old_l->next = new_l->next;
 	new_l->next = swp_l.next;
+	/* the line in the figure keeps its points */
+	if (num_points(old_l->points) == num_points(new_l->points))
+	    keep_points(&old_l->points, &new_l->points);
+	else
+	    objects_replaced = True;
 	set_action_object(F_EDIT, O_POLYLINE);
 	redisplay_lines(new_l, old_l);
 	break;
@@ -411,6 +821,14 @@ void undo_change(void)
 	swp_s.next = old_s->next;
 	old_s->next = new_s->next;
 	new_s->next = swp_s.next;
+	/* the spline in the figure keeps its points */
+	if (num_points(old_s->points) == num_points(new_s->points) &&
+		num_sfactors(old_s->sfactors) == num_sfactors(new_s->sfactors)) {
+	    keep_points(&old_s->points, &new_s->points);
+	    keep_sfactors(&old_s->sfactors, &new_s->sfactors);
+	} else {
+	    objects_replaced = True;
+	}
 	set_action_object(F_EDIT, O_SPLINE);
 	redisplay_splines(new_s, old_s);
 	break;
@@ -445,6 +863,9 @@ void undo_change(void)
 	swp_c.next = old_c->next;
 	old_c->next = new_c->next;
 	new_c->next = swp_c.next;
+	/* the compound in the figure keeps the objects within */
+	if (!keep_members(old_c, new_c))
+	    objects_replaced = True;
 	set_action_object(F_EDIT, O_COMPOUND);
 	redisplay_compounds(new_c, old_c);
 	break;
@@ -639,6 +1060,91 @@ void undo_move(void)
     swap_newp_lastp();
 }
 
+void undo_movepoint(void)
+{
+    int		    dx, dy;
+    int		    xmin1, ymin1, xmax1, ymax1;
+    int		    xmin2, ymin2, xmax2, ymax2;
+
+    dx = last_position.x - new_position.x;
+    dy = last_position.y - new_position.y;
+    if (last_object == O_POLYLINE)
+	line_bound(saved_objects.lines, &xmin1, &ymin1, &xmax1, &ymax1);
+    else
+	spline_bound(saved_objects.splines, &xmin1, &ymin1, &xmax1, &ymax1);
+    pick_hold_vertices(True);
+    shift_lastpoint(dx, dy);
+    if (last_object == O_POLYLINE)
+	pick_object_changed(O_POLYLINE, saved_objects.lines);
+    else
+	pick_object_changed(O_SPLINE, saved_objects.splines);
+    pick_hold_vertices(False);
+    if (last_object == O_POLYLINE)
+	line_bound(saved_objects.lines, &xmin2, &ymin2, &xmax2, &ymax2);
+    else
+	spline_bound(saved_objects.splines, &xmin2, &ymin2, &xmax2, &ymax2);
+    redisplay_regions(xmin1, ymin1, xmax1, ymax1,
+			  xmin2, ymin2, xmax2, ymax2);
+    swap_newp_lastp();
+}
+
+static void
+translate_shift(struct shift *s)
+{
+    switch (s->type) {
+      case O_ARC:
+	translate_arc((F_arc *) s->obj, s->dx, s->dy);
+	break;
+      case O_COMPOUND:
+	translate_compound((F_compound *) s->obj, s->dx, s->dy);
+	break;
+      case O_ELLIPSE:
+	translate_ellipse((F_ellipse *) s->obj, s->dx, s->dy);
+	break;
+      case O_POLYLINE:
+	translate_line((F_line *) s->obj, s->dx, s->dy);
+	break;
+      case O_SPLINE:
+	translate_spline((F_spline *) s->obj, s->dx, s->dy);
+	break;
+      case O_TXT:
+	translate_text((F_text *) s->obj, s->dx, s->dy);
+	break;
+    }
+}
+
+/*
+ * An alignment moved the members of a compound, or the objects of the
+ * figure. Move them back.
+ */
+
+void undo_align(void)
+{
+    int		    i;
+    F_compound	   *c;
+    int		    xmin, ymin, xmax, ymax;
+
+    for (i = 0; i < last_num_shifts; ++i) {
+	last_shifts[i].dx = -last_shifts[i].dx;
+	last_shifts[i].dy = -last_shifts[i].dy;
+	translate_shift(&last_shifts[i]);
+    }
+    if (last_object == O_COMPOUND) {
+	c = saved_objects.compounds;
+	xmin = c->nwcorner.x;
+	ymin = c->nwcorner.y;
+	xmax = c->secorner.x;
+	ymax = c->secorner.y;
+	compound_bound(c, &c->nwcorner.x, &c->nwcorner.y,
+		    &c->secorner.x, &c->secorner.y);
+	redisplay_regions(xmin, ymin, xmax, ymax, c->nwcorner.x,
+		    c->nwcorner.y, c->secorner.x, c->secorner.y);
+    } else {
+	redisplay_zoomed_region(0, 0, BACKX(CANVAS_WD), BACKY(CANVAS_HT));
+    }
+    set_modifiedflag();
+}
+
 void undo_load(void)
 {
     F_compound	    temp;
@@ -733,13 +1239,38 @@ void swap_newp_lastp(void)
 
 /*
  * Clean_up should be called before committing a user's request. Clean_up
- * will attempt to free all the allocated memories which resulted from
- * delete/remove action.  It will set the last_action to F_NULL.  Thus this
- * routine should be before set_action_object() and set_last_arrows(),
- * if they are to be called in the same routine.
+ * moves the last action to the undo history and frees the actions undone
+ * before. It will set the last_action to F_NULL.  Thus this routine should
+ * be before set_action_object() and set_last_arrows(), if they are to be
+ * called in the same routine.
  */
 
 void clean_up(void)
+{
+    /* record the action in the journal, unless already done */
+    journal_commit();
+
+    if (in_undo) {
+	/* called by the functions that reverse an action */
+	free_saved();
+    } else {
+	if (last_action != F_NULL && !undone)
+	    push_history(store_step());
+	else
+	    free_saved();
+	reset_step();
+	undone = False;
+	forget_redo();
+	trim_history();
+    }
+    last_action = F_NULL;
+    ++action_count;
+}
+
+/* Free the memory which resulted from a delete/remove action. */
+
+static void
+free_saved(void)
 {
     if (last_action == F_EDIT) {
 	switch (last_object) {
@@ -836,6 +1367,10 @@ void clean_up(void)
 	saved_objects.splines = NULL;
 	saved_objects.texts = NULL;
 	free_linkinfo(&last_links);
+    } else if (last_action == F_ALIGN) {
+	free((char *) last_shifts);
+	last_shifts = NULL;
+	last_num_shifts = 0;
     } else if (last_action == F_CONVERT) {
 	if (last_object == O_POLYLINE)
 	    saved_objects.splines = NULL;
@@ -848,6 +1383,12 @@ void clean_up(void)
 	free((char *) last_back_arrow);
     } else if (last_action == F_ADD_ARROW_HEAD ||
 	       last_action == F_DELETE_ARROW_HEAD) {
+	if (last_action == F_DELETE_ARROW_HEAD) {
+	    free((char *) saved_for_arrow);
+	    free((char *) saved_back_arrow);
+	}
+	saved_for_arrow = NULL;
+	saved_back_arrow = NULL;
 	saved_objects.splines = NULL;
 	saved_objects.lines = NULL;
 	saved_objects.arcs = NULL;
@@ -857,6 +1398,568 @@ void clean_up(void)
     last_action = F_NULL;
 }
 
+/* copy the last action to s */
+
+static void
+get_step(undo_step *s)
+{
+    s->action = last_action;
+    s->object = last_object;
+    s->saved = saved_objects;
+    s->tails = object_tails;
+    s->saved_for_arrow = saved_for_arrow;
+    s->saved_back_arrow = saved_back_arrow;
+    s->latest_line = latest_line;
+    s->latest_spline = latest_spline;
+    s->last_position = last_position;
+    s->new_position = new_position;
+    s->arcpointnum = last_arcpointnum;
+    s->prev_point = last_prev_point;
+    s->selected_point = last_selected_point;
+    s->next_point = last_next_point;
+    s->selected_sfactor = last_selected_sfactor;
+    s->links = last_links;
+    s->linkmode = last_linkmode;
+    s->for_arrow = last_for_arrow;
+    s->back_arrow = last_back_arrow;
+    s->origin_tension = last_origin_tension;
+    s->extremity_tension = last_extremity_tension;
+    s->shifts = last_shifts;
+    s->num_shifts = last_num_shifts;
+}
+
+/* make s the last action */
+
+static void
+set_step(undo_step *s)
+{
+    last_action = s->action;
+    last_object = s->object;
+    saved_objects = s->saved;
+    object_tails = s->tails;
+    saved_for_arrow = s->saved_for_arrow;
+    saved_back_arrow = s->saved_back_arrow;
+    latest_line = s->latest_line;
+    latest_spline = s->latest_spline;
+    last_position = s->last_position;
+    new_position = s->new_position;
+    last_arcpointnum = s->arcpointnum;
+    last_prev_point = s->prev_point;
+    last_selected_point = s->selected_point;
+    last_next_point = s->next_point;
+    last_selected_sfactor = s->selected_sfactor;
+    last_links = s->links;
+    last_linkmode = s->linkmode;
+    last_for_arrow = s->for_arrow;
+    last_back_arrow = s->back_arrow;
+    last_origin_tension = s->origin_tension;
+    last_extremity_tension = s->extremity_tension;
+    last_shifts = s->shifts;
+    last_num_shifts = s->num_shifts;
+}
+
+/*
+ * Forget the last action, without freeing anything. Object_tails is kept,
+ * it may be set before the objects are added, see u_drag.c.
+ */
+
+static void
+reset_step(void)
+{
+    memset(&saved_objects, 0, sizeof(F_compound));
+    saved_for_arrow = NULL;
+    saved_back_arrow = NULL;
+    latest_line = NULL;
+    latest_spline = NULL;
+    last_prev_point = NULL;
+    last_selected_point = NULL;
+    last_next_point = NULL;
+    last_selected_sfactor = NULL;
+    last_links = NULL;
+    last_for_arrow = NULL;
+    last_back_arrow = NULL;
+    last_shifts = NULL;
+    last_num_shifts = 0;
+    last_action = F_NULL;
+}
+
+static size_t
+comments_size(char *comments)
+{
+    return comments ? strlen(comments) + 1 : 0;
+}
+
+static size_t
+points_size(F_point *p)
+{
+    size_t	    n = 0;
+
+    for (; p != NULL; p = p->next)
+	n += sizeof(F_point);
+    return n;
+}
+
+static size_t
+arrows_size(F_arrow *for_arrow, F_arrow *back_arrow)
+{
+    return (for_arrow ? sizeof(F_arrow) : 0) +
+		(back_arrow ? sizeof(F_arrow) : 0);
+}
+
+static size_t	members_size(F_compound *c);
+
+/* the memory held by an object */
+
+static size_t
+object_size(int type, void *obj)
+{
+    F_arc	   *a;
+    F_compound	   *c;
+    F_ellipse	   *e;
+    F_line	   *l;
+    F_spline	   *s;
+    F_sfactor	   *f;
+    F_text	   *t;
+    size_t	    n;
+
+    switch (type) {
+      case O_ARC:
+	a = (F_arc *) obj;
+	return sizeof(F_arc) + arrows_size(a->for_arrow, a->back_arrow) +
+		comments_size(a->comments);
+      case O_COMPOUND:
+	c = (F_compound *) obj;
+	return sizeof(F_compound) + members_size(c) +
+		comments_size(c->comments);
+      case O_ELLIPSE:
+	e = (F_ellipse *) obj;
+	return sizeof(F_ellipse) + comments_size(e->comments);
+      case O_POLYLINE:
+	l = (F_line *) obj;
+	return sizeof(F_line) + points_size(l->points) +
+		arrows_size(l->for_arrow, l->back_arrow) +
+		(l->pic ? sizeof(F_pic) : 0) + comments_size(l->comments);
+      case O_SPLINE:
+	s = (F_spline *) obj;
+	n = sizeof(F_spline) + points_size(s->points) +
+		arrows_size(s->for_arrow, s->back_arrow) +
+		comments_size(s->comments);
+	for (f = s->sfactors; f != NULL; f = f->next)
+	    n += sizeof(F_sfactor);
+	return n;
+      case O_TXT:
+	t = (F_text *) obj;
+	return sizeof(F_text) + comments_size(t->cstring) +
+		comments_size(t->comments);
+    }
+    return 0;
+}
+
+/* the memory held by obj and the objects following it in its list */
+
+static size_t
+list_size(int type, void *obj)
+{
+    size_t	    n = 0;
+
+    while (obj != NULL) {
+	n += object_size(type, obj);
+	switch (type) {
+	  case O_ARC:
+	    obj = ((F_arc *) obj)->next;
+	    break;
+	  case O_COMPOUND:
+	    obj = ((F_compound *) obj)->next;
+	    break;
+	  case O_ELLIPSE:
+	    obj = ((F_ellipse *) obj)->next;
+	    break;
+	  case O_POLYLINE:
+	    obj = ((F_line *) obj)->next;
+	    break;
+	  case O_SPLINE:
+	    obj = ((F_spline *) obj)->next;
+	    break;
+	  case O_TXT:
+	    obj = ((F_text *) obj)->next;
+	    break;
+	  default:
+	    obj = NULL;
+	}
+    }
+    return n;
+}
+
+static size_t
+members_size(F_compound *c)
+{
+    return list_size(O_ARC, c->arcs) + list_size(O_COMPOUND, c->compounds) +
+		list_size(O_ELLIPSE, c->ellipses) +
+		list_size(O_POLYLINE, c->lines) +
+		list_size(O_SPLINE, c->splines) + list_size(O_TXT, c->texts);
+}
+
+/* the object last acted on, in saved_objects */
+
+static void *
+saved_object(void)
+{
+    switch (last_object) {
+      case O_ARC:
+	return saved_objects.arcs;
+      case O_COMPOUND:
+	return saved_objects.compounds;
+      case O_ELLIPSE:
+	return saved_objects.ellipses;
+      case O_POLYLINE:
+	return saved_objects.lines;
+      case O_SPLINE:
+	return saved_objects.splines;
+      case O_TXT:
+	return saved_objects.texts;
+    }
+    return NULL;
+}
+
+/*
+ * The memory held by the last action, beyond the objects in the figure:
+ * deleted objects and the original of changed objects.
+ */
+
+static size_t
+saved_size(void)
+{
+    void	   *obj = saved_object();
+
+    switch (last_action) {
+      case F_EDIT:
+	if (last_object == O_FIGURE)
+	    return comments_size(saved_objects.comments);
+	return obj ? object_size(last_object, obj) : 0;
+      case F_DELETE:
+      case F_JOIN:
+      case F_SPLIT:
+      case F_LOAD:
+	if (last_action == F_LOAD || last_object == O_ALL_OBJECT ||
+		last_object == O_FIGURE)
+	    return members_size(&saved_objects);
+	return list_size(last_object, obj);
+      case F_BREAK:
+	return sizeof(F_compound);
+      case F_DELETE_ARROW_HEAD:
+	return arrows_size(saved_for_arrow, saved_back_arrow);
+      case F_ALIGN:
+	return last_num_shifts * sizeof(struct shift);
+    }
+    return 0;
+}
+
+/* move the last action to a new step */
+
+static undo_step *
+store_step(void)
+{
+    undo_step	   *s;
+
+    if ((s = malloc(sizeof(undo_step))) == NULL) {
+	free_saved();
+	reset_step();
+	return NULL;
+    }
+    get_step(s);
+    s->size = sizeof(undo_step) + saved_size();
+    s->count = action_count;
+    reset_step();
+    return s;
+}
+
+static void
+load_step(undo_step *s)
+{
+    set_step(s);
+    free(s);
+}
+
+/* free the memory held by step s, and s */
+
+static void
+discard_step(undo_step *s)
+{
+    undo_step	    last;
+
+    get_step(&last);
+    set_step(s);
+    free_saved();
+    set_step(&last);
+    free(s);
+}
+
+static void
+push_history(undo_step *s)
+{
+    if (s == NULL)
+	return;
+    s->prev = newest;
+    s->next = NULL;
+    if (newest)
+	newest->next = s;
+    else
+	oldest = s;
+    newest = s;
+    history_size += s->size;
+}
+
+static undo_step *
+pop_history(void)
+{
+    undo_step	   *s = newest;
+
+    newest = s->prev;
+    if (newest)
+	newest->next = NULL;
+    else
+	oldest = NULL;
+    history_size -= s->size;
+    return s;
+}
+
+static void
+push_redo(undo_step *s)
+{
+    if (s == NULL)
+	return;
+    s->prev = redo_steps;
+    s->next = NULL;
+    redo_steps = s;
+    history_size += s->size;
+}
+
+static undo_step *
+pop_redo(void)
+{
+    undo_step	   *s = redo_steps;
+
+    redo_steps = s->prev;
+    history_size -= s->size;
+    return s;
+}
+
+/* forget the actions that can be undone, but not the last action */
+
+static void
+forget_steps(void)
+{
+    while (newest != NULL)
+	discard_step(pop_history());
+}
+
+static void
+forget_redo(void)
+{
+    while (redo_steps != NULL)
+	discard_step(pop_redo());
+}
+
+/* drop the oldest actions, until the history fits into its memory */
+
+static void
+trim_history(void)
+{
+    undo_step	   *s;
+    size_t	    max;
+
+    max = appres.undo_memory > 0 ? (size_t) appres.undo_memory * 1024 : 0;
+    while (oldest != NULL && history_size > max) {
+	s = oldest;
+	oldest = s->next;
+	if (oldest)
+	    oldest->prev = NULL;
+	else
+	    newest = NULL;
+	history_size -= s->size;
+	discard_step(s);
+    }
+}
+
+/*
+ * Forget the undo history, except for the last action. Called when the
+ * objects of the figure are exchanged, e.g., by opening a compound.
+ */
+
+void
+clear_undo(void)
+{
+    forget_steps();
+    forget_redo();
+}
+
+/*
+ * A number of actions make up one, e.g., placing copies of an object
+ * several times. Begin_undo_group() marks the beginning, end_undo_group()
+ * forgets the actions since but the last one.
+ */
+
+static unsigned long	group_start;
+
+void
+begin_undo_group(void)
+{
+    group_start = action_count;
+}
+
+void
+end_undo_group(void)
+{
+    while (newest != NULL && newest->count > group_start)
+	discard_step(pop_history());
+}
+
+static void
+ref_position(int type, void *obj, int *x, int *y)
+{
+    switch (type) {
+      case O_ARC:
+	*x = ((F_arc *) obj)->point[0].x;
+	*y = ((F_arc *) obj)->point[0].y;
+	break;
+      case O_COMPOUND:
+	*x = ((F_compound *) obj)->nwcorner.x;
+	*y = ((F_compound *) obj)->nwcorner.y;
+	break;
+      case O_ELLIPSE:
+	*x = ((F_ellipse *) obj)->center.x;
+	*y = ((F_ellipse *) obj)->center.y;
+	break;
+      case O_POLYLINE:
+	*x = ((F_line *) obj)->points->x;
+	*y = ((F_line *) obj)->points->y;
+	break;
+      case O_SPLINE:
+	*x = ((F_spline *) obj)->points->x;
+	*y = ((F_spline *) obj)->points->y;
+	break;
+      case O_TXT:
+	*x = ((F_text *) obj)->base_x;
+	*y = ((F_text *) obj)->base_y;
+	break;
+    }
+}
+
+static void
+add_position(int type, void *obj)
+{
+    struct shift   *s = &pending_shifts[num_pending++];
+
+    s->type = type;
+    s->obj = obj;
+    ref_position(type, obj, &s->dx, &s->dy);
+}
+
+/*
+ * Remember the positions of the objects in c, before they are aligned.
+ * Set_latestshifts() then records how far they were moved.
+ */
+
+void
+save_positions(F_compound *c)
+{
+    F_arc	   *a;
+    F_compound	   *cc;
+    F_ellipse	   *e;
+    F_line	   *l;
+    F_spline	   *s;
+    F_text	   *t;
+
+    free((char *) pending_shifts);
+    num_pending = object_count(c);
+    if ((pending_shifts = malloc(num_pending * sizeof(struct shift) + 1))
+		== NULL) {
+	num_pending = 0;
+	return;
+    }
+    num_pending = 0;
+    for (a = c->arcs; a != NULL; a = a->next)
+	add_position(O_ARC, a);
+    for (cc = c->compounds; cc != NULL; cc = cc->next)
+	add_position(O_COMPOUND, cc);
+    for (e = c->ellipses; e != NULL; e = e->next)
+	add_position(O_ELLIPSE, e);
+    for (l = c->lines; l != NULL; l = l->next)
+	add_position(O_POLYLINE, l);
+    for (s = c->splines; s != NULL; s = s->next)
+	add_position(O_SPLINE, s);
+    for (t = c->texts; t != NULL; t = t->next)
+	add_position(O_TXT, t);
+}
+
+/* keep the objects moved since save_positions(), and how far */
+
+void
+set_latestshifts(void)
+{
+    struct shift   *s;
+    int		    i, x, y;
+
+    last_num_shifts = 0;
+    for (i = 0; i < num_pending; ++i) {
+	s = &pending_shifts[i];
+	ref_position(s->type, s->obj, &x, &y);
+	if (x == s->dx && y == s->dy)
+	    continue;
+	s->dx = x - s->dx;
+	s->dy = y - s->dy;
+	pending_shifts[last_num_shifts++] = *s;
+    }
+    if (last_num_shifts > 0 && (last_shifts = realloc(pending_shifts,
+		    last_num_shifts * sizeof(struct shift))) != NULL) {
+	pending_shifts = NULL;
+    } else {
+	last_shifts = NULL;
+	last_num_shifts = 0;
+    }
+    free((char *) pending_shifts);
+    pending_shifts = NULL;
+    num_pending = 0;
+}
+
+/*
+ * Move the point of the last F_MOVE_POINT action by dx, dy, and the last
+ * point of a polygon together with the first.
+ */
+
+void
+shift_lastpoint(int dx, int dy)
+{
+    F_point	   *p = last_selected_point;
+
+    pick_point_moved(p, p->x + dx, p->y + dy);
+    p->x += dx;
+    p->y += dy;
+    if (last_object == O_POLYLINE && saved_objects.lines->type == T_POLYGON
+		&& saved_objects.lines->points == p) {
+	p = last_prev_point->next;
+	pick_point_moved(p, p->x + dx, p->y + dy);
+	p->x += dx;
+	p->y += dy;
+    }
+}
+
+/*
+ * Return the last action and, in object, the type of object it applies to.
+ * For F_MOVE and F_MOVE_POINT, dx and dy give the displacement and links
+ * is True if lines linked to the object were moved, too.
+ */
+
+int
+get_last_action(int *object, int *dx, int *dy, Boolean *links)
+{
+    *object = last_object;
+    *dx = new_position.x - last_position.x;
+    *dy = new_position.y - last_position.y;
+    *links = (last_links != NULL);
+    return last_action;
+}
+
 void set_latestarc(F_arc *arc)
 {
     saved_objects.arcs = arc;
@@ -929,13 +2032,22 @@ void set_newposition(int x, int y)
     new_position.y = y;
 }
 
+/*
+ * Loading a figure or deleting all of it replaces the colors and depths,
+ * which are kept for one action only. The history before is forgotten.
+ */
+
 void set_action(int action)
 {
+    if (action == F_LOAD && !in_undo)
+	clear_undo();
     last_action = action;
 }
 
 void set_action_object(int action, int object)
 {
+    if (action == F_DELETE && object == O_FIGURE && !in_undo)
+	clear_undo();
     last_action = action;
     last_object = object;
 }
@@ -26,8 +26,14 @@ extern F_arrow		*saved_for_arrow;
 extern F_arrow		*saved_back_arrow;
 extern F_line		*latest_line;		/* for undo_join (line) */
 extern F_spline		*latest_spline;		/* for undo_join (spline) */
+extern unsigned long	 action_count;
 extern void		 undo(void);
+extern void		 redo(void);
+extern void		 clear_undo(void);
+extern void		 begin_undo_group(void);
+extern void		 end_undo_group(void);
 extern void clean_up (void);
+extern int get_last_action (int *object, int *dx, int *dy, Boolean *links);
 extern void set_action (int action);
 extern void set_action_object (int action, int object);
 extern void set_last_arcpointnum (int num);
@@ -47,5 +53,8 @@ extern void set_latestobjects (F_compound *objects);
 extern void set_latestspline (F_spline *spline);
 extern void set_latesttext (F_text *text);
 extern void set_newposition (int x, int y);
+extern void save_positions (F_compound *c);
+extern void set_latestshifts (void);
+extern void shift_lastpoint (int dx, int dy);
 
 #endif /* U_UNDO_H */
@@ -44,6 +44,7 @@
 #include "mode.h"
 #include "paintop.h"
 
+#include "d_line.h"
 #include "d_text.h"
 #include "e_edit.h"
 #include "u_pan.h"
@@ -252,6 +253,7 @@ canvas_selected(Widget tool, XButtonEvent *event, String *params,
     int		    rx, ry, cx, cy;
     unsigned int    mask;
     int    x, y;
+    XEvent	    motion, next;
 
 
     static char	    compose_buf[2];
@@ -269,6 +271,20 @@ canvas_selected(Widget tool, XButtonEvent *event, String *params,
       /****************/
       case MotionNotify:
 
+	/* skip to the latest of the motion events queued right after this
+	   one, so that the handler runs once per batch instead of lagging
+	   behind; keep the order of the other events, and every point of a
+	   freehand line */
+	while (canvas_locmove_proc != freehand_get_intermediatepoint &&
+		    XEventsQueued(event->display, QueuedAfterReading) > 0) {
+	    XPeekEvent(event->display, &next);
+	    if (next.type != MotionNotify ||
+			next.xmotion.window != event->window)
+		break;
+	    XNextEvent(event->display, &motion);
+	    event = (XButtonEvent *) &motion;
+	}
+
 #if defined(SMOOTHMOTION)
 	/* translate from zoomed coords to object coords */
 	x = BACKX(event->x);
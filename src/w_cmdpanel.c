@@ -21,11 +21,13 @@
 #include "mode.h"
 #include "object.h"
 #include "d_text.h"
+#include "f_journal.h"
 #include "f_read.h"
 #include "f_util.h"
 #include "u_create.h"
 #include "u_fonts.h"
 #include "u_pan.h"
+#include "u_print.h"
 #include "u_redraw.h"
 #include "u_search.h"
 #include "u_undo.h"
@@ -42,6 +44,7 @@
 #include "w_msgpanel.h"
 #include "w_mousefun.h"
 #include "w_print.h"
+#include "w_rottext.h"
 #include "w_rulers.h"
 #include "w_srchrepl.h"
 #include "w_util.h"
@@ -173,6 +176,7 @@ menu_def file_menu_items[] = {
 
 menu_def edit_menu_items[] = {
 	{"Undo               (Meta-U) ", 0, undo, False},
+	{"Redo          (Shift-Meta-U)", 0, redo, False},
 	{"Paste Objects      (Meta-T) ", 0, paste, False},
 	{"Paste Text         (F18/F20)", 6, paste_primary_selection, False},
 	{"Search/Replace...  (Meta-I) ", -1, popup_search_panel, False},
@@ -574,11 +578,22 @@ quit(Widget w, XtPointer closure, XtPointer call_data)
 	    return;	/* cancel, don't quit */
 	}
 
+    /* the figure was saved, or the user discarded the changes */
+    journal_close();
+    /* let exports and print jobs still running finish */
+    wait_export_jobs();
     goodbye(False);	/* finish up and exit */
 }
 
 void goodbye(Boolean abortflag)
 {
+    if (appres.DEBUG) {
+	long	items, bytes, hits, misses;
+
+	XRotCacheStatistics(&items, &bytes, &hits, &misses);
+	fprintf(stderr, "Rotated text cache: %ld items, %ld bytes, "
+		"%ld hits, %ld misses\n", items, bytes, hits, misses);
+    }
 #ifdef I18N
 #ifdef I18N_USE_PREEDIT
   kill_preedit();
@@ -1385,6 +1400,7 @@ void update_cur_filename(char *newname)
 
 	update_def_filename();		/* update default filename in export panel */
 	update_wm_title(cur_filename);	/* and window title bar */
+	watch_refresh_file();		/* for -autorefresh */
 }
 
 static void
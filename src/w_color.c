@@ -68,6 +68,7 @@
 #include "w_setup.h"
 #include "w_util.h"
 
+#include "f_read.h"
 #include "f_util.h"
 
 /* EXPORTS */
@@ -1083,6 +1084,7 @@ void c_user_colors(F_compound *obj)
     F_text	   *t;
     F_compound	   *c;
 
+    expand_compound(obj);
     /* traverse the compounds in this compound */
     for (c = obj->compounds; c != NULL; c = c->next) {
 	c_user_colors(c);
@@ -1425,6 +1427,7 @@ color_used(int color, F_compound *list)
     F_line	   *l;
     F_spline	   *s;
 
+    expand_compound(list);
     for (a = list->arcs; a != NULL; a = a->next)
 	if (a->fill_color == color || a->pen_color == color)
 	    return True;
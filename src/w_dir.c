@@ -55,6 +55,7 @@
 #include "mode.h"
 #include "w_browse.h"
 #include "w_dir.h"
+#include "w_dircache.h"
 #include "w_drawprim.h"		/* for max_char_height */
 #include "w_export.h"
 #include "w_file.h"
@@ -71,7 +72,6 @@
 
 static char	CurrentSelectionName[PATH_MAX];
 static int	file_entry_cnt, dir_entry_cnt;
-static char   **file_list, **dir_list;
 static char   **filelist, **dirlist;
 static char    *dirmask;
 
@@ -87,8 +87,14 @@ static void	ParentDir(Widget w, XEvent *event, String *params,
 				Cardinal *num_params);
 static void	CallbackRescan(Widget widget, XtPointer closure,
 				XtPointer call_data);
-static Boolean	MakeFileList(char *dir_name, char *mask, char ***_dirs,
-				char ***files);
+static void	RescanAction(Widget widget, XEvent *event, String *params,
+				Cardinal *num_params);
+static void	RescanDir(Boolean reread);
+static void	MakeFileList(char *mask, char **dirs, int ndirs,
+				char **files, int nfiles);
+static void	ShowFileList(char **dirs, int ndirs, char **files,
+				int nfiles);
+static void	ListDirectory(char *dir, Boolean reread);
 
 /* Static variables */
 
@@ -109,7 +115,7 @@ static String	mask_text_translations =
 static XtActionsRec actionTable[] = {
     {"ParentDir", (XtActionProc)ParentDir},
     {"SetDir", (XtActionProc)SetDir},
-    {"Rescan", (XtActionProc)Rescan},
+    {"Rescan", (XtActionProc)RescanAction},
 };
 
 /* Function:	FileSelected() is called when the user selects a file.
@@ -373,11 +379,11 @@ create_dirinfo(Boolean file_exp, Widget parent, Widget below, Widget *ret_beside
 					parent, Args, ArgCount);
     XtOverrideTranslations(*mask_w, XtParseTranslationTable(mask_text_translations));
 
-    /* get the first directory listing */
+    /* get the first directory listing, the list widgets are made below */
 
     FirstArg(XtNstring, &dirmask);
     GetValues(*mask_w);
-    if (MakeFileList(dir, dirmask, &dir_list, &file_list) == False)
+    if (dircache_list(dir, ShowFileList) == False)
 	file_msg("No files in directory?");
 
     FirstArg(XtNlabel, "  Current Dir");
@@ -463,7 +469,7 @@ create_dirinfo(Boolean file_exp, Widget parent, Widget below, Widget *ret_beside
     dir_viewport = XtCreateManagedWidget("dirvport", viewportWidgetClass,
 					 parent, Args, ArgCount);
 
-    FirstArg(XtNlist, file_list);
+    FirstArg(XtNlist, filelist);
     /* for file panel use only one column */
     if (file_panel) {
 	NextArg(XtNdefaultColumns, 1);
@@ -475,7 +481,7 @@ create_dirinfo(Boolean file_exp, Widget parent, Widget below, Widget *ret_beside
     XtOverrideTranslations(*flist_w,
 			   XtParseTranslationTable(list_panel_translations));
 
-    FirstArg(XtNlist, dir_list);
+    FirstArg(XtNlist, dirlist);
     *dlist_w = XtCreateManagedWidget("dir_list_panel", figListWidgetClass,
 				     dir_viewport, Args, ArgCount);
     XtOverrideTranslations(*dlist_w,
@@ -513,56 +519,40 @@ create_dirinfo(Boolean file_exp, Widget parent, Widget below, Widget *ret_beside
     return;
 }
 
-/* Function:	SPComp() compares two string pointers for qsort().
- * Arguments:	s1, s2: strings to be compared.
- * Returns:	Value of strcmp().
- * Notes:
- */
-
-static int
-SPComp(char **s1, char **s2)
-{
-    return (strcmp(*s1, *s2));
-}
-
 #define MAX_MASKS	20
 #define MAX_MASK_LEN	64
 
-Boolean
-MakeFileList(char *dir_name, char *mask, char ***dir_list, char ***file_list)
+/* Function:	MakeFileList() puts the names of a directory that match
+ *		the mask into filelist and dirlist.
+ * Arguments:	mask:	Wildcard patterns separated by blanks.
+ *		dirs, ndirs:	The sorted sub-directories.
+ *		files, nfiles:	The sorted files.
+ * Returns:	Nothing.
+ * Notes:	The names are not copied, they belong to the directory cache.
+ */
+
+static void
+MakeFileList(char *mask, char **dirs, int ndirs, char **files, int nfiles)
 {
-    DIR		  *dirp;
-    DIRSTRUCT	  *dp;
     char	 **cur_file, **cur_directory;
-    char	 **last_file, **last_dir;
-    int		   nmasks,i;
+    int		   nmasks,i,k;
     char	  *wild[MAX_MASKS],*cmask;
     char	buf[MAX_MASK_LEN];
     Boolean	   match;
 
-    set_temp_cursor(wait_cursor);
-    cur_file = filelist;
-    cur_directory = dirlist;
-    last_file = filelist + file_entry_cnt - 1;
-    last_dir = dirlist + dir_entry_cnt - 1;
-
-    dirp = opendir(dir_name);
-    if (dirp == NULL) {
-	reset_cursor();
-	*file_list = filelist;
-	*file_list[0]="";
-	*dir_list = dirlist;
-	*dir_list[0]="..";
-	return False;
+    /* make room for all names */
+    if (nfiles >= file_entry_cnt) {
+	file_entry_cnt = nfiles + NENTRIES;
+	filelist = (char **) realloc(filelist, file_entry_cnt * sizeof(char *));
+    }
+    if (ndirs >= dir_entry_cnt) {
+	dir_entry_cnt = ndirs + NENTRIES;
+	dirlist = (char **) realloc(dirlist, dir_entry_cnt * sizeof(char *));
     }
-    /* process any events to ensure cursor is set to wait_cursor */
-    /*
-     * don't do this inside the following loop because this procedure could
-     * be re-entered if the user presses (e.g.) rescan
-     */
-    app_flush();
 
     /* make copy of mask */
+    if (mask == NULL)
+	mask = "";
     if (strlen(mask) < MAX_MASK_LEN) {
 	    cmask = buf;
 	    strcpy(cmask, mask);
@@ -575,60 +565,84 @@ MakeFileList(char *dir_name, char *mask, char ***dir_list, char ***file_list)
     nmasks = 1;
     while ((wild[nmasks]=strtok((char*) NULL, " \t")) && nmasks < MAX_MASKS)
 	nmasks++;
-    for (dp = readdir(dirp); dp != NULL; dp = readdir(dirp)) {
-	/* skip over '.' (current dir) */
-	if (!strcmp(dp->d_name, "."))
-	    continue;
+
+    cur_directory = dirlist;
+    for (k = 0; k < ndirs; k++) {
 	/* if don't want to see the hidden files (beginning with ".") skip them */
-	if (!show_hidden && dp->d_name[0]=='.' && strcmp(dp->d_name,".."))
+	if (!show_hidden && dirs[k][0]=='.' && strcmp(dirs[k],".."))
 	    continue;
-
-	if (IsDirectory(dir_name, dp->d_name)) {
-	    *cur_directory++ = strdup(dp->d_name);
-	    if (cur_directory == last_dir) {	/* out of space, make more */
-		dirlist = (char **) realloc(dirlist,
-					2 * dir_entry_cnt * sizeof(char *));
-		cur_directory = dirlist + dir_entry_cnt - 1;
-		dir_entry_cnt = 2 * dir_entry_cnt;
-		last_dir = dirlist + dir_entry_cnt - 1;
-	    }
-	} else {
-	    /* check if matches regular expression */
-	    match=False;
-	    for (i=0; i<nmasks; i++) {
-		if (wild_match(dp->d_name, wild[i])) {
-		    int wild_match (char *string, char *pattern);
-		    match = True;
-		    break;
-		}
-	    }
-	    if (!match)
-		continue;	/* no, do next */
-	    if (wild[i][0] == '*' && dp->d_name[0] == '.')
-		continue;	/* skip files with leading . */
-	    *cur_file++ = strdup(dp->d_name);
-	    if (cur_file == last_file) {	/* out of space, make more */
-		filelist = (char **) realloc(filelist,
-				       2 * file_entry_cnt * sizeof(char *));
-		cur_file = filelist + file_entry_cnt - 1;
-		file_entry_cnt = 2 * file_entry_cnt;
-		last_file = filelist + file_entry_cnt - 1;
+	*cur_directory++ = dirs[k];
+    }
+    cur_file = filelist;
+    for (k = 0; k < nfiles; k++) {
+	if (!show_hidden && files[k][0]=='.')
+	    continue;
+	/* check if matches regular expression */
+	match=False;
+	for (i=0; i<nmasks; i++) {
+	    if (wild_match(files[k], wild[i])) {
+		match = True;
+		break;
 	    }
 	}
+	if (!match)
+	    continue;	/* no, do next */
+	if (wild[i][0] == '*' && files[k][0] == '.')
+	    continue;	/* skip files with leading . */
+	*cur_file++ = files[k];
     }
     *cur_file = NULL;
     *cur_directory = NULL;
-    if (cur_file != filelist)
-	qsort(filelist, cur_file - filelist, sizeof(char *), (int(*)())SPComp);
-    if (cur_directory != dirlist)
-	qsort(dirlist, cur_directory - dirlist, sizeof(char *), (int(*)())SPComp);
-    *file_list = filelist;
-    *dir_list = dirlist;
-    reset_cursor();
-    closedir(dirp);
     if (cmask != buf)
 	    free(cmask);	/* free copy of mask */
-    return True;
+}
+
+/* Function:	ShowFileList() puts the names of a directory into the list
+ *		widgets of the panel that is up.
+ * Arguments:	As for MakeFileList(), without the mask.
+ * Returns:	Nothing.
+ * Notes:	Called by dircache_list(), for a large directory again when
+ *		it is read to the end. The file selected stays highlighted.
+ */
+
+static void
+ShowFileList(char **dirs, int ndirs, char **files, int nfiles)
+{
+    Widget	flist = (Widget) 0;
+    int		i;
+
+    MakeFileList(dirmask, dirs, ndirs, files, nfiles);
+    if (browse_up) {
+	NewList(flist = browse_flist, filelist);
+	NewList(browse_dlist, dirlist);
+    } else if (file_up) {
+	NewList(flist = file_flist,filelist);
+	NewList(file_dlist,dirlist);
+    } else if (export_up) {
+	NewList(flist = exp_flist, filelist);
+	NewList(exp_dlist, dirlist);
+    }
+    if (flist == (Widget) 0 || CurrentSelectionName[0] == '\0')
+	return;
+    for (i = 0; filelist[i] != NULL; i++)
+	if (strcmp(filelist[i], CurrentSelectionName) == 0) {
+	    XawListHighlight(flist, i);
+	    break;
+	}
+}
+
+/* list dir, or show only ".." if it cannot be read; if reread, do not take
+   the names kept in the directory cache */
+
+static void
+ListDirectory(char *dir, Boolean reread)
+{
+    static char	*parent[] = { ".." };
+
+    if (reread)
+	dircache_forget(dir);
+    if (dircache_list(dir, ShowFileList) == False)
+	ShowFileList(parent, 1, NULL, 0);
 }
 
 /* Function:	ParentDir() changes to the parent directory.
@@ -687,7 +701,9 @@ DoChangeDir(char *dir)
     }
     if (change_directory(ndir) != 0 ) {
 	return;				/* some problem, return */
-    } else if (MakeFileList(ndir, dirmask, &dirlist, &filelist) == False) {
+    }
+    CurrentSelectionName[0] = '\0';
+    if (dircache_list(ndir, ShowFileList) == False) {
 	file_msg("Unable to list directory %s", ndir);
 	return;
     }
@@ -698,32 +714,39 @@ DoChangeDir(char *dir)
 	SetValues(browse_dir);
 	strcpy(cur_browse_dir,ndir);	/* update global var */
 	XawTextSetInsertionPoint(browse_dir, strlen(ndir));
-	NewList(browse_flist, filelist);
-	NewList(browse_dlist, dirlist);
     } else if (file_up) {
 	SetValues(file_dir);
 	update_file_export_dir(ndir);
 	XawTextSetInsertionPoint(file_dir, strlen(ndir));
-	NewList(file_flist,filelist);
-	NewList(file_dlist,dirlist);
     } else if (export_up) {
 	SetValues(exp_dir);
 	strcpy(cur_export_dir,ndir);	/* update global var */
 	XawTextSetInsertionPoint(exp_dir, strlen(ndir));
-	NewList(exp_flist, filelist);
-	NewList(exp_dlist, dirlist);
     }
-    CurrentSelectionName[0] = '\0';
 }
 
 void
 CallbackRescan(Widget widget, XtPointer closure, XtPointer call_data)
 {
-     Rescan(0, 0, 0, 0);
+     RescanDir(True);
+}
+
+/* the user asked for a rescan, read the directory again */
+
+static void
+RescanAction(Widget widget, XEvent *event, String *params, Cardinal *num_params)
+{
+     RescanDir(True);
 }
 
 void
 Rescan(Widget widget, XEvent *event, String *params, Cardinal *num_params)
+{
+     RescanDir(False);
+}
+
+static void
+RescanDir(Boolean reread)
 {
     char	*dir;
 
@@ -739,9 +762,7 @@ Rescan(Widget widget, XEvent *event, String *params, Cardinal *num_params)
 	if (change_directory(dir))	/* make sure we are there */
 	    return;
 	strcpy(cur_browse_dir,dir);	/* save in global var */
-	(void) MakeFileList(dir, dirmask, &dir_list, &file_list);
-	NewList(browse_flist, file_list);
-	NewList(browse_dlist, dir_list);
+	ListDirectory(dir, reread);
     } else if (file_up) {
 	FirstArg(XtNstring, &dirmask);
 	GetValues(file_mask);
@@ -750,9 +771,7 @@ Rescan(Widget widget, XEvent *event, String *params, Cardinal *num_params)
 	if (change_directory(dir))	/* make sure we are there */
 	    return;
 	update_file_export_dir(dir);
-	(void) MakeFileList(dir, dirmask, &dir_list, &file_list);
-	NewList(file_flist,file_list);
-	NewList(file_dlist,dir_list);
+	ListDirectory(dir, reread);
     } else if (export_up) {
 	FirstArg(XtNstring, &dirmask);
 	GetValues(exp_mask);
@@ -761,14 +780,16 @@ Rescan(Widget widget, XEvent *event, String *params, Cardinal *num_params)
 	if (change_directory(dir))	/* make sure we are there */
 	    return;
 	strcpy(cur_export_dir,dir);	/* save in global var */
-	(void) MakeFileList(dir, dirmask, &dir_list, &file_list);
-	NewList(exp_flist, file_list);
-	NewList(exp_dlist, dir_list);
+	ListDirectory(dir, reread);
     }
 }
 
 void NewList(Widget listwidget, String *list)
 {
+	/* not yet made, see create_dirinfo() */
+	if (listwidget == (Widget) 0)
+		return;
+
 	/* install the new list */
 	XawListChange(listwidget, list, 0, 0, True);
 
@@ -800,6 +821,26 @@ IsDirectory(char *path, char *file)
 	return False;
 }
 
+/* Function:	IsDirEntry() tests if a directory entry is a directory.
+ * Arguments:	path:	Pathname of the directory.
+ *		dp:	The entry, as returned by readdir().
+ * Returns:	True or False.
+ * Notes:	The type is taken from readdir() where it is known, else
+ *		the entry is stat()ed.
+ */
+
+Boolean
+IsDirEntry(char *path, DIRSTRUCT *dp)
+{
+#if defined(HAVE_STRUCT_DIRENT_D_TYPE) && defined(DT_UNKNOWN)
+    if (dp->d_type == DT_DIR)
+	return True;
+    if (dp->d_type != DT_UNKNOWN && dp->d_type != DT_LNK)
+	return False;
+#endif
+    return IsDirectory(path, dp->d_name);
+}
+
 /* Function:	MakeFullPath() creates the full pathname for the given file.
  * Arguments:	filename:	Name of the file in question.
  *		pathname:	Buffer for full name.
@@ -50,6 +50,8 @@
 #ifndef W_DIR_H
 #define W_DIR_H
 
+#include "dirstruct.h"
+
 /* Useful constants. */
 
 #define EOS	'\0'		/* End-of-string. */
@@ -71,6 +73,7 @@ extern void	update_file_export_dir(const char *restrict dir);
 extern char	       *SaveString();
 extern void		MakeFullPath(char *root, char *filename, char *pathname);
 extern Boolean		IsDirectory(char *path, char *file);
+extern Boolean		IsDirEntry(char *path, DIRSTRUCT *dp);
 extern void parseuserpath (char *path, char *longpath);
 extern void Rescan (Widget widget, XEvent *event, String *params, Cardinal *num_params);
 
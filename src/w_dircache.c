@@ -0,0 +1,400 @@
+/*
+ * FIG : Facility for Interactive Generation of figures
+ * Copyright (c) 1985-1988 by Supoj Sutanthavibul
+ * Parts Copyright (c) 1989-2015 by Brian V. Smith
+ * Parts Copyright (c) 1991 by Paul King
+ * Parts Copyright (c) 2016-2020 by Thomas Loimer
+ *
+ * Any party obtaining a copy of these files is granted, free of charge, a
+ * full and unrestricted irrevocable, world-wide, paid up, royalty-free,
+ * nonexclusive right and license to deal in this software and documentation
+ * files (the "Software"), including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense and/or sell copies of
+ * the Software, and to permit persons who receive copies from any such
+ * party to do so, with the only requirement being that the above copyright
+ * and this permission notice remain intact.
+ *
+ */
+/*
+ * Keep the listings of the last directories shown in the file, export and
+ * browse panels. A listing is taken again if its directory did not change
+ * since it was read: if the modification time of the directory is the same
+ * and, with inotify, no event arrived for it. Inotify does not see changes
+ * made on another host to a directory on NFS, the modification time does.
+ * A directory is read DIR_CHUNK entries at a time in an Xt work procedure;
+ * the names of the first chunk are shown at once, all names at the end.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#ifdef HAVE_SYS_INOTIFY_H
+#include <sys/inotify.h>
+#endif
+
+#include "fig.h"
+#include "resources.h"
+#include "w_dir.h"
+#include "w_dircache.h"
+
+#define DIRCACHE_SIZE	8	/* number of directories kept */
+#define DIR_CHUNK	1000	/* entries read at a time */
+
+typedef struct listing {
+    char	*path;
+    time_t	 mtime;		/* of the directory, when it was read */
+    time_t	 read_time;
+    Boolean	 complete;
+    Boolean	 changed;	/* an inotify event arrived for it */
+    Boolean	 dead;		/* free it when it is no longer shown */
+    int	 wd;		/* inotify watch, or -1 */
+    char	**dirs, **files;
+    int	 ndirs, nfiles, max_dirs, max_files;
+    int	 sorted_dirs, sorted_files;
+    struct listing *next;
+} listing;
+
+static listing	*listings = NULL;	/* the most recently used first */
+static listing	*shown = NULL;		/* its names are in the list widgets */
+static listing	*reading = NULL;
+static DIR	*reading_dirp = NULL;
+static dircache_proc reading_show;
+static XtWorkProcId read_proc = 0;
+#ifdef HAVE_SYS_INOTIFY_H
+static int	 notify_fd = -1;
+static XtInputId notify_input_id = 0;
+#endif
+
+#ifdef HAVE_SYS_INOTIFY_H
+/* whether another listing has the watch wd, e.g., for another name of a
+   directory */
+
+static Boolean
+watched(int wd, listing *l)
+{
+    listing	   *m;
+
+    for (m = listings; m != NULL; m = m->next)
+	if (m != l && m->wd == wd)
+	    return True;
+    return shown != NULL && shown != l && shown->wd == wd;
+}
+#endif /* HAVE_SYS_INOTIFY_H */
+
+static void
+free_listing(listing *l)
+{
+    int		    i;
+
+#ifdef HAVE_SYS_INOTIFY_H
+    if (l->wd >= 0 && !watched(l->wd, l))
+	inotify_rm_watch(notify_fd, l->wd);
+#endif
+    for (i = 0; i < l->ndirs; i++)
+	free(l->dirs[i]);
+    for (i = 0; i < l->nfiles; i++)
+	free(l->files[i]);
+    free(l->dirs);
+    free(l->files);
+    free(l->path);
+    free(l);
+}
+
+/* remove l from the cache, keep it while its names are shown */
+
+static void
+discard(listing *l)
+{
+    listing	  **pl;
+
+    for (pl = &listings; *pl != NULL; pl = &(*pl)->next)
+	if (*pl == l) {
+	    *pl = l->next;
+	    break;
+	}
+    if (l == shown)
+	l->dead = True;
+    else
+	free_listing(l);
+}
+
+static void
+show_listing(listing *l, dircache_proc show)
+{
+    listing	   *old = shown;
+
+    shown = l;
+    show(l->dirs, l->ndirs, l->files, l->nfiles);
+    if (old != NULL && old != l && old->dead)
+	free_listing(old);
+}
+
+static int
+cmp_names(const void *a, const void *b)
+{
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+/* sort the names from sorted to n, and merge them with those before */
+
+static void
+merge(char **list, int sorted, int n)
+{
+    char	  **tmp;
+    int		    i, j, k;
+
+    if (sorted == n)
+	return;
+    qsort(list + sorted, n - sorted, sizeof(char *), cmp_names);
+    if (sorted == 0 || strcmp(list[sorted - 1], list[sorted]) <= 0)
+	return;
+    if ((tmp = malloc(n * sizeof(char *))) == NULL) {
+	qsort(list, n, sizeof(char *), cmp_names);
+	return;
+    }
+    for (i = 0, j = sorted, k = 0; i < sorted && j < n; )
+	tmp[k++] = strcmp(list[i], list[j]) <= 0 ? list[i++] : list[j++];
+    while (i < sorted)
+	tmp[k++] = list[i++];
+    while (j < n)
+	tmp[k++] = list[j++];
+    memcpy(list, tmp, n * sizeof(char *));
+    free(tmp);
+}
+
+static Boolean
+add_name(char ***list, int *n, int *max, char *name)
+{
+    char	  **l;
+
+    if (*n == *max) {
+	*max = *max ? 2 * *max : NENTRIES;
+	if ((l = realloc(*list, *max * sizeof(char *))) == NULL)
+	    return False;
+	*list = l;
+    }
+    if (((*list)[*n] = strdup(name)) == NULL)
+	return False;
+    ++*n;
+    return True;
+}
+
+/* read the next chunk of the directory, return True at the end */
+
+static Boolean
+read_chunk(void)
+{
+    listing	   *l = reading;
+    DIRSTRUCT	   *dp;
+    Boolean	    ok = True, done = False;
+    int		    n;
+
+    for (n = 0; n < DIR_CHUNK && ok; n++) {
+	if ((dp = readdir(reading_dirp)) == NULL) {
+	    done = True;
+	    break;
+	}
+	if (strcmp(dp->d_name, ".") == 0)
+	    continue;
+	if (IsDirEntry(l->path, dp))
+	    ok = add_name(&l->dirs, &l->ndirs, &l->max_dirs, dp->d_name);
+	else
+	    ok = add_name(&l->files, &l->nfiles, &l->max_files, dp->d_name);
+    }
+    merge(l->dirs, l->sorted_dirs, l->ndirs);
+    l->sorted_dirs = l->ndirs;
+    merge(l->files, l->sorted_files, l->nfiles);
+    l->sorted_files = l->nfiles;
+    if (done || !ok) {
+	closedir(reading_dirp);
+	reading_dirp = NULL;
+	reading = NULL;
+	/* if out of memory, read it again next time */
+	l->complete = ok;
+	return True;
+    }
+    return False;
+}
+
+static Boolean
+read_more(XtPointer client_data)
+{
+    listing	   *l = reading;
+    Boolean	    done;
+
+    (void)client_data;
+    if ((done = read_chunk())) {
+	read_proc = 0;
+	/* another directory may be shown meanwhile */
+	if (l == shown)
+	    show_listing(l, reading_show);
+    }
+    return done;
+}
+
+static void
+stop_reading(void)
+{
+    if (reading == NULL)
+	return;
+    if (read_proc != 0)
+	XtRemoveWorkProc(read_proc);
+    read_proc = 0;
+    closedir(reading_dirp);
+    reading_dirp = NULL;
+    discard(reading);
+    reading = NULL;
+}
+
+#ifdef HAVE_SYS_INOTIFY_H
+/* mark the directories changed, called by XtAppAddInput */
+
+static void
+notify_input(XtPointer client_data, int *fd, XtInputId *id)
+{
+    union {
+	struct inotify_event ev;	/* for the alignment */
+	char	buf[4096];
+    } u;
+    struct inotify_event *ev;
+    listing	   *l;
+    char	   *p;
+    ssize_t	    len;
+
+    while ((len = read(*fd, u.buf, sizeof(u.buf))) > 0) {
+	for (p = u.buf; p < u.buf + len; p += sizeof(*ev) + ev->len) {
+	    ev = (struct inotify_event *) p;
+	    for (l = listings; l != NULL; l = l->next) {
+		if (!(ev->mask & IN_Q_OVERFLOW) && ev->wd != l->wd)
+		    continue;
+		l->changed = True;
+		if (ev->mask & IN_IGNORED)
+		    l->wd = -1;
+	    }
+	}
+    }
+}
+#endif /* HAVE_SYS_INOTIFY_H */
+
+static void
+watch(listing *l)
+{
+    l->wd = -1;
+#ifdef HAVE_SYS_INOTIFY_H
+    if (notify_fd < 0 && (notify_fd = inotify_init1(IN_NONBLOCK |
+				IN_CLOEXEC)) >= 0)
+	notify_input_id = XtAppAddInput(tool_app, notify_fd,
+			(XtPointer) XtInputReadMask,
+			(XtInputCallbackProc) notify_input, (XtPointer) NULL);
+    if (notify_fd >= 0)
+	l->wd = inotify_add_watch(notify_fd, l->path, IN_CREATE | IN_DELETE |
+			IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF |
+			IN_MOVE_SELF);
+#endif
+}
+
+/* whether the directory did not change since l was read */
+
+static Boolean
+unchanged(listing *l)
+{
+    struct stat	    st;
+
+    if (!l->complete || l->changed || stat(l->path, &st) != 0 ||
+		st.st_mtime != l->mtime)
+	return False;
+    /* without a watch, a change within the second the directory was read
+       is not seen */
+    return l->wd >= 0 || l->read_time > l->mtime;
+}
+
+/* drop the names of dir, to read it again */
+
+void
+dircache_forget(char *dir)
+{
+    listing	   *l;
+
+    for (l = listings; l != NULL; l = l->next)
+	if (strcmp(l->path, dir) == 0)
+	    break;
+    if (l == NULL)
+	return;
+    if (l == reading)
+	stop_reading();
+    else
+	discard(l);
+}
+
+/*
+ * Show the names in the directory dir with show(), at once if they are in
+ * the cache, else as the directory is read. Return False if dir cannot be
+ * read.
+ */
+
+Boolean
+dircache_list(char *dir, dircache_proc show)
+{
+    listing	   *l, **pl;
+    struct stat	    st;
+    DIR		   *dirp;
+    int		    n;
+
+#ifdef HAVE_SYS_INOTIFY_H
+    /* take the events not yet read */
+    if (notify_fd >= 0)
+	notify_input(NULL, &notify_fd, &notify_input_id);
+#endif
+    for (pl = &listings; (l = *pl) != NULL; pl = &l->next)
+	if (strcmp(l->path, dir) == 0)
+	    break;
+    if (l != NULL && (l == reading || unchanged(l))) {
+	/* the names read so far, if it is still being read */
+	*pl = l->next;
+	l->next = listings;
+	listings = l;
+	if (l == reading)
+	    reading_show = show;
+	show_listing(l, show);
+	return True;
+    }
+
+    stop_reading();
+    if (l != NULL)
+	discard(l);
+    if (stat(dir, &st) != 0 || (dirp = opendir(dir)) == NULL)
+	return False;
+    if ((l = calloc(1, sizeof(listing))) == NULL ||
+		(l->path = strdup(dir)) == NULL) {
+	free(l);
+	closedir(dirp);
+	return False;
+    }
+    l->mtime = st.st_mtime;
+    l->read_time = time(NULL);
+    /* watch before reading, to see changes while it is read */
+    watch(l);
+    l->next = listings;
+    listings = l;
+    reading = l;
+    reading_dirp = dirp;
+    reading_show = show;
+    for (n = 1, pl = &listings->next; *pl != NULL; pl = &(*pl)->next)
+	if (++n > DIRCACHE_SIZE) {
+	    discard(*pl);
+	    break;
+	}
+
+    /* a small directory is read at once */
+    if (!read_chunk())
+	read_proc = XtAppAddWorkProc(tool_app, read_more, NULL);
+    show_listing(l, show);
+    return True;
+}
@@ -50,6 +50,7 @@
 #include "w_cursor.h"
 #include "w_file.h"
 #include "w_rottext.h"
+#include "u_redraw.h"
 
 /* EXPORTS */
 
@@ -70,6 +71,30 @@ static XRectangle clip[1];
 static int	parsesize(char *name);
 static Boolean	openwinfonts;
 static Boolean  font_scalable[NUM_FONTS];
+static Boolean	font_known[NUM_FONTS];	/* the fonts of the family are listed */
+static Boolean	font_cached[NUM_FONTS];	/* and were read from the cache */
+static void	read_font_cache(void);
+static void	remove_font_cache(void);
+static void	discover_font(int f);
+
+/*
+ * The fonts found by lookfont(), by family and requested size, so that a
+ * font is found without walking x_fontinfo[].xfontlist. While the canvas
+ * is redrawn, lookfont_budget() loads fonts until this took FONT_BUDGET
+ * seconds. The fonts requested thereafter are queued and loaded together
+ * when xfig is idle, see load_pending_fonts(), then the canvas is redrawn.
+ * Until then, their texts are drawn greeked.
+ */
+
+#define FONT_BUDGET	0.2
+
+static struct xfont *font_table[NUM_FONTS][MAX_X_FONT_SIZE + 1];
+static unsigned char font_pending[NUM_FONTS][MAX_X_FONT_SIZE + 1];
+static Boolean	budget_on = False;
+static Boolean	load_queued = False;
+static double	font_time;		/* time spent loading, this redraw */
+
+static Boolean	load_pending_fonts(XtPointer client_data);
 
 #define MAXNAMES 300
 
@@ -87,11 +112,8 @@ int SutherlandHodgmanPolygoClip (XPoint *inVertices, XPoint *outVertices, int in
 
 void init_font(void)
 {
-    struct xfont   *newfont, *nf;
-    int		    f, count, i, p, ss;
-    char	    template[300];
-    char	    backup_template[300];
-    char	  **fontlist, **fname;
+    int		    f, count;
+    char	  **fontlist;
 
     if (appres.boldFont == NULL || *appres.boldFont == '\0')
 	appres.boldFont = BOLD_FONT;
@@ -124,11 +146,10 @@ void init_font(void)
      * Now initialize the font structure for the X fonts corresponding to the
      * Postscript fonts for the canvas.	 OpenWindows can use any LaserWriter
      * fonts at any size, so we don't need to load anything if we are using
-     * it.
+     * it. Otherwise, the fonts of a family are found by discover_font()
+     * when the family is first used.
      */
 
-    /* if the user hasn't disallowed scalable fonts, check that the
-       server really has them by checking for font of 0-0 size */
     openwinfonts = False;
     if (appres.scalablefonts) {
 	/* first look for OpenWindow style font names (e.g. times-roman) */
@@ -137,101 +158,290 @@ void init_font(void)
             for (f=0; f<NUM_FONTS; f++) { /* copy the OpenWindow font names */
                 x_fontinfo[f].template = ps_fontinfo[f+1].name;
                 font_scalable[f] = True;
+		font_known[f] = True;
             }
             XFreeFontNames(fontlist);
-	} else {
-            for (f = 0; f < NUM_FONTS; f++) {
-                strcpy(template,x_fontinfo[f].template);  /* nope, check for font size 0 */
-                strcat(template,"0-0-*-*-*-*-");
-                /* add ISO8859 (if not Symbol font or ZapfDingbats) to font name in non-international mode*/
-                if (
+	    return;
+	}
+    }
+
+    read_font_cache();
+}
+
+/*
+ * The X fonts of a family are listed the first time the family is used.
+ * What was found is kept in $HOME/FONT_CACHE for the X server vendor,
+ * release and font path, and the options, it was found with; on the next
+ * start it is read instead of asking the server. If a font named in the
+ * file cannot be loaded, the file is removed.
+ */
+
+#define FONT_CACHE	".xfigfonts"
+#define FONT_CACHE_ID	"xfig font cache 1"
+
+static char    *font_entry[NUM_FONTS];	/* the lines of the family in the cache */
+static unsigned long font_key;
+static Boolean	font_cache_off = False;
+
+static Boolean
+font_cache_name(char *name)
+{
+    char	   *home;
+
+    if (font_cache_off || (home = getenv("HOME")) == NULL || *home == '\0' ||
+		strlen(home) + sizeof FONT_CACHE + 8 > PATH_MAX)
+	return False;
+    sprintf(name, "%s/%s", home, FONT_CACHE);
+    return True;
+}
+
+/* a hash of the server vendor, release, font path and the options */
+
+static unsigned long
+make_font_key(void)
+{
+    char	  **path;
+    char	    buf[64], *c;
+    int		    i, n = 0;
+    unsigned long   h = 5381;
+
+    sprintf(buf, "%d %d %d", VendorRelease(tool_d), appres.scalablefonts,
 #ifdef I18N
-                    !appres.international &&
+		appres.international
+#else
+		0
 #endif
-                    strstr(template,"ymbol") == NULL &&
-                    strstr(template,"ingbats") == NULL)
-                        strcat(template,"ISO8859-*");
-                else
-                    strcat(template,"*-*");
-
-                if ((fontlist = XListFonts(tool_d, template, 1, &count)))
-                    font_scalable[f] = True;
-                else
-                    font_scalable[f] = False;
-
-                XFreeFontNames(fontlist);
-            }
+		);
+    for (c = buf; *c; c++)
+	h = h * 33 + (unsigned char)*c;
+    for (c = ServerVendor(tool_d); *c; c++)
+	h = h * 33 + (unsigned char)*c;
+    if ((path = XGetFontPath(tool_d, &n)) != NULL) {
+	for (i = 0; i < n; i++) {
+	    for (c = path[i]; *c; c++)
+		h = h * 33 + (unsigned char)*c;
+	    h = h * 33 + ',';
 	}
+	XFreeFontPath(path);
     }
+    return h & 0xffffffffUL;
+}
 
-    /* no scalable fonts - query the server for all the font
-       names and sizes and build a list of them */
+static struct xfont *
+new_xfont(int size, char *name)
+{
+    struct xfont   *nf;
+
+    if ((nf = (struct xfont *) malloc(sizeof(struct xfont))) == NULL)
+	return NULL;
+    nf->size = size;
+    nf->fname = name;
+    nf->bname = name;
+    nf->fstruct = NULL;
+    nf->fset = NULL;
+    nf->next = NULL;
+    return nf;
+}
+
+static void
+read_font_cache(void)
+{
+    FILE	   *fp;
+    char	    name[PATH_MAX], line[512], fname[512];
+    struct xfont   *nf, *last;
+    unsigned long   key;
+    int		    f, scalable, count, size;
+
+    font_key = make_font_key();
+    if (!font_cache_name(name) || (fp = fopen(name, "r")) == NULL)
+	return;
+    if (fgets(line, sizeof line, fp) == NULL ||
+		strcmp(line, FONT_CACHE_ID "\n") != 0 ||
+		fgets(line, sizeof line, fp) == NULL ||
+		sscanf(line, "%lx", &key) != 1 || key != font_key) {
+	fclose(fp);
+	return;
+    }
+    while (fgets(line, sizeof line, fp) != NULL) {
+	if (sscanf(line, "family %d %d %d", &f, &scalable, &count) != 3 ||
+		f < 0 || f >= NUM_FONTS || font_known[f])
+	    break;
+	font_entry[f] = strdup(line);
+	font_scalable[f] = scalable;
+	last = NULL;
+	while (count-- > 0 && fgets(line, sizeof line, fp) != NULL &&
+		    sscanf(line, "%d %511s", &size, fname) == 2) {
+	    if ((nf = new_xfont(size, strdup(fname))) == NULL)
+		break;
+	    if (last == NULL)
+		x_fontinfo[f].xfontlist = nf;
+	    else
+		last->next = nf;
+	    last = nf;
+	    /* keep the lines for writing the cache */
+	    font_entry[f] = realloc(font_entry[f],
+			strlen(font_entry[f]) + strlen(line) + 1);
+	    strcat(font_entry[f], line);
+	}
+	if (count >= 0) {
+	    /* a broken file, list the fonts of this family anew */
+	    free(font_entry[f]);
+	    font_entry[f] = NULL;
+	    x_fontinfo[f].xfontlist = NULL;
+	    font_scalable[f] = False;
+	    break;
+	}
+	font_known[f] = True;
+	font_cached[f] = True;
+    }
+    fclose(fp);
+}
+
+static void
+write_font_cache(void)
+{
+    FILE	   *fp;
+    char	    name[PATH_MAX], tmp[PATH_MAX + 8];
+    int		    f;
+
+    if (!font_cache_name(name))
+	return;
+    sprintf(tmp, "%s.%d", name, (int)getpid());
+    if ((fp = fopen(tmp, "w")) == NULL)
+	return;
+    fprintf(fp, "%s\n%lx\n", FONT_CACHE_ID, font_key);
+    for (f = 0; f < NUM_FONTS; f++)
+	if (font_entry[f])
+	    fputs(font_entry[f], fp);
+    if (fclose(fp) != 0 || rename(tmp, name) != 0)
+	unlink(tmp);
+}
+
+/* a font from the cache could not be loaded, discover fonts anew */
+
+static void
+remove_font_cache(void)
+{
+    char	    name[PATH_MAX];
+
+    if (font_cache_name(name))
+	unlink(name);
+    font_cache_off = True;
+}
 
-    for (f = 0; f < NUM_FONTS; f++) {
-        if (!font_scalable[f]) {
-	    nf = NULL;
-	    strcpy(template,x_fontinfo[f].template);
-	    strcat(template,"*-*-*-*-*-*-");
-	    strcpy(backup_template,x_backup_fontinfo[f].template);
-	    strcat(backup_template,"*-*-*-*-*-*-");
-	    /* add ISO8859 (if not Symbol font or ZapfDingbats) to font name in non-international mode*/
-	    if (
+static void
+font_template(char *template, char *base, char *sizes)
+{
+    strcpy(template, base);
+    strcat(template, sizes);
+    /* add ISO8859 (if not Symbol font or ZapfDingbats) to font name in non-international mode*/
+    if (
 #ifdef I18N
-		!appres.international &&
+	!appres.international &&
 #endif
-		strstr(template,"ymbol") == NULL &&
-		strstr(template,"ingbats") == NULL) {
-		    strcat(template,"ISO8859-*");
-		    strcat(backup_template,"ISO8859-*");
-	    } else {
-		strcat(template,"*-*");
-		strcat(backup_template,"*-*");
-            }
-	    /* don't free the Fontlist because we keep pointers into it */
-	    p = 0;
+	strstr(template,"ymbol") == NULL &&
+	strstr(template,"ingbats") == NULL)
+	    strcat(template,"ISO8859-*");
+    else
+	strcat(template,"*-*");
+}
 
-	    if ((fontlist = XListFonts(tool_d, template, MAXNAMES, &count))==0)
-	        fontlist = XListFonts(tool_d, backup_template, MAXNAMES, &count);
+/* find the X fonts of family f */
 
-            if (fontlist == 0) {
-		/* no fonts by that name found, substitute the -normal font name */
-		flist[p].fn = appres.normalFont;
-		flist[p++].s = 12;	/* just set the size to 12 */
-	    } else {
-		fname = fontlist; /* go through the list finding point
-				   * sizes */
-		while (count--) {
+static void
+discover_font(int f)
+{
+    struct xfont   *nf, *newfont;
+    int		    count, i, p, ss;
+    char	    template[300];
+    char	    backup_template[300];
+    char	    line[512];
+    char	  **fontlist, **fname;
+
+    font_known[f] = True;
+
+    /* if the user hasn't disallowed scalable fonts, check that the
+       server really has them by checking for font of 0-0 size */
+    if (appres.scalablefonts) {
+	font_template(template, x_fontinfo[f].template, "0-0-*-*-*-*-");
+	if ((fontlist = XListFonts(tool_d, template, 1, &count))) {
+	    font_scalable[f] = True;
+	    XFreeFontNames(fontlist);
+	}
+    }
+
+    sprintf(line, "family %d %d ", f, font_scalable[f]);
+
+    /* no scalable fonts - query the server for all the font
+       names and sizes and build a list of them */
+
+    if (!font_scalable[f]) {
+	nf = NULL;
+	font_template(template, x_fontinfo[f].template, "*-*-*-*-*-*-");
+	font_template(backup_template, x_backup_fontinfo[f].template,
+			"*-*-*-*-*-*-");
+	/* don't free the Fontlist because we keep pointers into it */
+	p = 0;
+
+	if ((fontlist = XListFonts(tool_d, template, MAXNAMES, &count))==0)
+	    fontlist = XListFonts(tool_d, backup_template, MAXNAMES, &count);
+
+	if (fontlist == 0) {
+	    /* no fonts by that name found, substitute the -normal font name */
+	    flist[p].fn = appres.normalFont;
+	    flist[p++].s = 12;	/* just set the size to 12 */
+	} else {
+	    fname = fontlist; /* go through the list finding point
+			       * sizes */
+	    while (count--) {
 		ss = parsesize(*fname);	/* get the point size from
 					 * the name */
 		flist[p].fn = *fname++;	/* save name of this size
 					 * font */
 		flist[p++].s = ss;	/* and save size */
-		}
 	    }
-	    /* start at size 4 and go to 50 */
-	    for (ss = 4; ss <= 50; ss++) {
-		for (i = 0; i < p; i++)
-			if (flist[i].s == ss)	/* found size */
-			    break;
-		/* if found size, allocate the font */
-		if (i < p && flist[i].s == ss) {
-			newfont = (struct xfont *) malloc(sizeof(struct xfont));
-			if (nf == NULL)
-			    x_fontinfo[f].xfontlist = newfont;
-			else
-			    nf->next = newfont;
-			nf = newfont;	/* keep current ptr */
-			nf->size = ss;	/* store the size here */
-			if (appres.DEBUG)
-			    fprintf(stderr,"Font: %s\n",flist[i].fn);
-			nf->fname = flist[i].fn;	/* keep actual name */
-			nf->fstruct = NULL;
-		        nf->fset = NULL;
-			nf->next = NULL;
-		    }
-	    } /* next size */
-        } /* !font_scalable[f] */
-    } /* next font, f */
+	}
+	/* start at size 4 and go to 50 */
+	count = 0;
+	for (ss = 4; ss <= 50; ss++) {
+	    for (i = 0; i < p; i++)
+		if (flist[i].s == ss)	/* found size */
+		    break;
+	    /* if found size, allocate the font */
+	    if (i < p && flist[i].s == ss) {
+		if ((newfont = new_xfont(ss, flist[i].fn)) == NULL)
+		    break;
+		if (nf == NULL)
+		    x_fontinfo[f].xfontlist = newfont;
+		else
+		    nf->next = newfont;
+		nf = newfont;	/* keep current ptr */
+		if (appres.DEBUG)
+		    fprintf(stderr,"Font: %s\n",flist[i].fn);
+		++count;
+	    }
+	} /* next size */
+    } else {
+	count = 0;
+    }
+
+    /* remember the fonts found, unless the names are too long for the
+       cache file */
+    font_entry[f] = malloc(strlen(line) + 16 + count * 300);
+    if (font_entry[f] == NULL)
+	return;
+    sprintf(font_entry[f], "%s%d\n", line, count);
+    if (!font_scalable[f])
+	for (nf = x_fontinfo[f].xfontlist; nf != NULL; nf = nf->next) {
+	    if (strlen(nf->fname) > 255 || strchr(nf->fname, ' ')) {
+		free(font_entry[f]);
+		font_entry[f] = NULL;
+		return;
+	    }
+	    sprintf(font_entry[f] + strlen(font_entry[f]), "%d %s\n",
+			nf->size, nf->fname);
+	}
+    write_font_cache();
 }
 
 /* parse the point size of font 'name' */
@@ -270,6 +480,7 @@ lookfont(int fnum, int size)
 	char		template[300], *sub;
 	Boolean		found;
 	struct xfont   *newfont, *nf, *oldnf;
+	int		request;
 
 #ifdef I18N
 	char **mcharset;
@@ -286,6 +497,15 @@ lookfont(int fnum, int size)
 	else if (size > MAX_X_FONT_SIZE)
 	    size = MAX_X_FONT_SIZE;	/* maximum allowable */
 
+	/* found before? */
+	request = size;
+	if ((nf = font_table[fnum][request]) != NULL && nf->fstruct != NULL)
+	    return nf->fstruct;
+
+	/* list the fonts of the family when first used */
+	if (!font_known[fnum])
+	    discover_font(fnum);
+
 	/* if user asks, adjust for correct font size */
 	if (appres.correct_font_size)
 	    size = round(size*80.0/72.0);
@@ -425,6 +645,9 @@ lookfont(int fnum, int size)
 		}
 	    }
 	    if (fontst == NULL) {
+		/* the cache is out of date, list the fonts anew next time */
+		if (font_cached[fnum])
+		    remove_font_cache();
 		/* even that font doesn't exist, use a plain one */
 		file_msg("Can't find %s, using %s", fn, appres.normalFont);
 		fontst = XLoadQueryFont(tool_d, appres.normalFont);
@@ -440,9 +663,158 @@ lookfont(int fnum, int size)
 	    nf->fset = fontset;
 	} /* if (nf->fstruct == NULL) */
 
+	font_table[fnum][request] = nf;
 	return (nf->fstruct);
 }
 
+/* start or stop the time budget for loading fonts, see font_table */
+
+void
+font_budget(Boolean on)
+{
+	budget_on = on;
+	font_time = 0.0;
+}
+
+/*
+ * As lookfont(), but if loading fonts took too long already during this
+ * redraw, queue the font and return NULL.
+ */
+
+XFontStruct *
+lookfont_budget(int fnum, int size)
+{
+	XFontStruct    *fontst;
+	double		start;
+
+	if (fnum == DEFAULT)
+	    fnum = 0;
+	if (size < 0)
+	    size = DEF_FONTSIZE;
+	size = max2(MIN_X_FONT_SIZE, min2(size, MAX_X_FONT_SIZE));
+	if (font_table[fnum][size] != NULL || !budget_on ||
+			font_time < FONT_BUDGET) {
+	    start = seconds();
+	    fontst = lookfont(fnum, size);
+	    font_time += seconds() - start;
+	    return fontst;
+	}
+	if (!font_pending[fnum][size]) {
+	    font_pending[fnum][size] = 1;
+	    if (!load_queued) {
+		XtAppAddWorkProc(tool_app, load_pending_fonts, NULL);
+		load_queued = True;
+	    }
+	}
+	return NULL;
+}
+
+/* load one of the queued fonts each time xfig is idle, after the last
+   one redraw the canvas */
+
+static Boolean
+load_pending_fonts(XtPointer client_data)
+{
+	int		f, s;
+
+	(void)client_data;
+	for (f = 0; f < NUM_FONTS; f++)
+	    for (s = MIN_X_FONT_SIZE; s <= MAX_X_FONT_SIZE; s++)
+		if (font_pending[f][s]) {
+		    font_pending[f][s] = 0;
+		    (void)lookfont(f, s);
+		    return False;	/* call again */
+		}
+	load_queued = False;
+	redisplay_canvas();
+	return True;		/* done, remove the work procedure */
+}
+
+/*
+ * While text_batch(True) is on, horizontal texts painted on the same
+ * baseline in the same color are collected and drawn with one XDrawText()
+ * request, each text an item with its own font. The batch is drawn when
+ * a text does not fit into it, before any other text is drawn, and by
+ * text_batch(False) or flush_text_batch().
+ */
+
+#define TEXT_BATCH	64
+
+static struct {
+    Window	w;
+    int		x, y;		/* the start of the first item */
+    Pixel	fg;
+    int		pen;		/* the end of the last item */
+    Font	font;		/* of the last item */
+    int		n;
+    XTextItem	items[TEXT_BATCH];
+} batch;
+static Boolean	batch_on = False;
+
+void
+flush_text_batch(void)
+{
+    GC		gc;
+
+    if (batch.n == 0)
+	return;
+    /* check for preview cancel once for the whole batch */
+    if (!check_cancel()) {
+	/* gccache[PAINT] has the color of the batch, but keep its font */
+	gc = XCreateGC(tool_d, batch.w, (unsigned long) 0, 0);
+	XCopyGC(tool_d, gccache[PAINT], GCForeground|GCBackground|GCFunction|
+		GCPlaneMask|GCClipMask|GCClipXOrigin|GCClipYOrigin, gc);
+	XDrawText(tool_d, batch.w, gc, batch.x, batch.y, batch.items, batch.n);
+	XFreeGC(tool_d, gc);
+    }
+    batch.n = 0;
+}
+
+void
+text_batch(Boolean on)
+{
+    if (!on)
+	flush_text_batch();
+    batch_on = on;
+}
+
+static void
+batch_text(Window w, int x, int y, XFontStruct *fstruct, char *string,
+	Color color, Pixel xfg)
+{
+    XTextItem	*item;
+    int		len;
+
+    if (*string == '\0')
+	return;
+    if (batch.n > 0 && (batch.w != w || batch.y != y || batch.fg != xfg ||
+				batch.n == TEXT_BATCH))
+	flush_text_batch();
+    if (xfg != gc_color[PAINT]) {
+	set_x_fg_color(gccache[PAINT], color);
+	gc_color[PAINT] = xfg;
+    }
+
+    len = strlen(string);
+    item = &batch.items[batch.n];
+    item->chars = string;
+    item->nchars = len;
+    if (batch.n == 0) {
+	batch.w = w;
+	batch.x = x;
+	batch.y = y;
+	batch.fg = xfg;
+	item->delta = 0;
+	item->font = fstruct->fid;
+    } else {
+	item->delta = x - batch.pen;
+	item->font = fstruct->fid == batch.font ? None : fstruct->fid;
+    }
+    batch.font = fstruct->fid;
+    batch.pen = x + XTextWidth(fstruct, string, len);
+    ++batch.n;
+}
+
 /* print "string" in window "w" using font specified in fstruct at angle
 	"angle" (radians) at (x,y)
    If background is != COLOR_NONE, draw background color ala DrawImageString
@@ -467,6 +839,19 @@ pw_text(Window w, int x, int y, int op, int depth, XFontStruct *fstruct,
     /* get the X colors */
     xfg = x_color(color);
     xbg = x_color(background);
+
+    if (batch_on && op == PAINT && background == COLOR_NONE &&
+		fabs(angle) < 0.0001
+#ifdef I18N
+		&& !appres.international
+#endif
+		) {
+	batch_text(w, ZOOMX(x), ZOOMY(y), fstruct, string, color, xfg);
+	return;
+    }
+    /* keep the order of drawing */
+    flush_text_batch();
+
     if ((xfg != gc_color[op]) ||
 	(background != COLOR_NONE && (xbg != gc_background[op]))) {
 	    /* don't change the colors for ERASE */
@@ -28,6 +28,8 @@ typedef struct { int x,y; } zXPoint ;
 
 extern void pw_text(Window w, int x, int y, int op, int depth, XFontStruct *fstruct,
 	float angle, char *string, Color color, Color background);
+extern void	text_batch(Boolean on);
+extern void	flush_text_batch(void);
 extern void pw_vector(Window w, int x1, int y1, int x2, int y2, int op,
 	  int line_width, int line_style, float style_val, Color color);
 extern void pw_curve(Window w, int xstart, int ystart, int xend, int yend,
@@ -95,6 +97,8 @@ extern XFontStruct *roman_font;
 extern XFontStruct *button_font;
 extern XFontStruct *canvas_font;
 extern XFontStruct *lookfont(int fnum, int size);
+extern XFontStruct *lookfont_budget(int fnum, int size);
+extern void	font_budget(Boolean on);
 extern GC	    makegc(int op, Pixel fg, Pixel bg);
 
 /* patterns like bricks, etc */
@@ -20,6 +20,7 @@
 #include "object.h"
 #include "mode.h"
 #include "e_edit.h"
+#include "f_journal.h"
 #include "f_read.h"
 #include "f_util.h"
 #include "u_create.h"
@@ -30,6 +31,7 @@
 #include "w_file.h"
 #include "w_indpanel.h"
 #include "w_layers.h"
+#include "w_libcache.h"
 #include "w_msgpanel.h"
 #include "w_util.h"
 #include "w_setup.h"
@@ -50,6 +52,8 @@
 #define FILE_ALT_WID	260	/* width of file alternatives panel */
 #define PREVIEW_CANVAS_W 232	/* width of landscape preview canvas (swap W, H for portrait) */
 #define PREVIEW_CANVAS_H 180	/* height of landscape preview */
+#define PREVIEW_CACHE_SIZE 24	/* previews kept in memory */
+#define PREFETCH	2	/* previews drawn ahead on either side */
 
 /* file modes for popup panel */
 
@@ -77,6 +81,7 @@ Widget		comments_widget;
 Pixmap		preview_land_pixmap, preview_port_pixmap;
 Boolean		cancel_preview = False;
 Boolean		preview_in_progress = False;
+Boolean		background_preview = False;	/* drawn while xfig is idle */
 void		load_request(Widget w, XButtonEvent *ev);		/* this is needed by main() */
 
 /* LOCALS */
@@ -106,6 +111,7 @@ static void	file_panel_cancel(Widget w, XButtonEvent *ev);
 static void	do_load(Widget w, XButtonEvent *ev), do_merge(Widget w, XButtonEvent *ev);
 static void	merge_request(Widget w, XButtonEvent *ev), cancel_request(Widget w, XButtonEvent *ev), save_request(Widget w, XButtonEvent *ev);
 static void	clear_preview(void);
+static void	close_disk_previews(void);
 
 DeclareStaticArgs(15);
 static Widget	file_stat_label, file_status, num_obj_label, num_objects;
@@ -190,6 +196,7 @@ file_panel_dismiss(void)
     FirstArg(XtNstring, "\0");
     SetValues(file_selfile);	/* clear Filename string */
     XtPopdown(file_popup);
+    close_disk_previews();
     file_up = popup_up = False;
     /* in case the colormap was switched while previewing */
     redisplay_canvas();
@@ -508,6 +515,8 @@ do_save(Widget w, XButtonEvent *ev)
 		    update_cur_filename(fname);	/* update cur_filename */
 		}
 		reset_modifiedflag();
+		/* the saved file is the base of the journal */
+		journal_saved(fname);
 		if (file_up)
 		    file_panel_dismiss();
 	    }
@@ -525,8 +534,10 @@ do_save(Widget w, XButtonEvent *ev)
 	/* not using popup => filename not changed so ok to write existing file */
 	warnexist = False;
 	(void) renamefile(cur_filename);
-	if (write_file(cur_filename, True) == 0)
+	if (write_file(cur_filename, True) == 0) {
 	    reset_modifiedflag();
+	    journal_saved(cur_filename);
+	}
     }
 }
 
@@ -1171,7 +1182,11 @@ void create_file_panel(void)
 Boolean
 check_cancel(void)
 {
-    if (preview_in_progress) {
+    /*
+     * Don't dispatch events during a preview drawn in a work proc; they
+     * would go to the canvas while canvas_win and the zoom are redirected.
+     */
+    if (preview_in_progress && !background_preview) {
 	process_pending();
 	return cancel_preview;
     }
@@ -1212,7 +1227,263 @@ file_preview_stop(Widget w, XButtonEvent *ev)
     process_pending();
 }
 
-void preview_figure(char *filename, Widget parent, Widget canvas, Widget size_widget, Pixmap port_pixmap, Pixmap land_pixmap)
+/*
+ * The last PREVIEW_CACHE_SIZE previews are kept in memory, with the
+ * modification time and size of their Fig file, and with the preview_cache
+ * resource also on disk, see w_libcache.c. After a preview is shown, the
+ * previews of the PREFETCH files on either side of it in the file list are
+ * drawn while xfig is idle. As the pixels are kept, previews are only
+ * cached on TrueColor and DirectColor visuals.
+ */
+
+typedef struct {
+    char	*path;		/* NULL, if the slot is free */
+    time_t	 mtime;
+    off_t	 size;
+    Boolean	 ok;		/* False, if the file could not be read */
+    Boolean	 landscape;
+    Pixmap	 pixmap;	/* PREVIEW_CANVAS_W square */
+    char	 figsize[50];
+    char	*comments;
+    unsigned long used;
+} preview_rec;
+
+static preview_rec previews[PREVIEW_CACHE_SIZE];
+static unsigned long preview_clock = 0;
+static GC	 preview_gc = (GC) 0;
+static libcache	*preview_disk = NULL;	/* of preview_disk_dir */
+static char	 preview_disk_dir[PATH_MAX];
+static XtWorkProcId prefetch_proc = 0;
+static Boolean	 prefetching = False;	/* a preview is drawn ahead */
+
+static Boolean
+cache_previews(void)
+{
+    return tool_vclass == TrueColor || tool_vclass == DirectColor;
+}
+
+static libcache *
+disk_previews(void)
+{
+    if (!appres.preview_cache)
+	return NULL;
+    if (preview_disk_dir[0] == '\0' ||
+		strcmp(preview_disk_dir, cur_file_dir) != 0) {
+	libcache_close(preview_disk);
+	preview_disk = libcache_open(cur_file_dir, LIBCACHE_PREVIEWS);
+	strcpy(preview_disk_dir, cur_file_dir);
+    }
+    return preview_disk;
+}
+
+/* write the previews kept on disk, called when the file panel goes down */
+
+static void
+close_disk_previews(void)
+{
+    /* and stop drawing previews ahead */
+    if (prefetch_proc != 0) {
+	XtRemoveWorkProc(prefetch_proc);
+	prefetch_proc = 0;
+    }
+    libcache_close(preview_disk);
+    preview_disk = NULL;
+    preview_disk_dir[0] = '\0';
+}
+
+/* whether the preview of the file name in the current directory can be
+   cached, and if so, its path and status */
+
+static Boolean
+preview_file(char *name, char *path, struct stat *st)
+{
+    if (!cache_previews() || strchr(name, '/') != NULL ||
+		strlen(cur_file_dir) + strlen(name) + 2 > PATH_MAX)
+	return False;
+    sprintf(path, "%s/%s", cur_file_dir, name);
+    return stat(path, st) == 0;
+}
+
+/* the slot of path, else a free one, else the one used least recently */
+
+static preview_rec *
+preview_slot(char *path)
+{
+    preview_rec	   *r = &previews[0];
+    int		    i;
+
+    for (i = 0; i < PREVIEW_CACHE_SIZE; i++)
+	if (previews[i].path != NULL && strcmp(previews[i].path, path) == 0)
+	    break;
+    if (i < PREVIEW_CACHE_SIZE)
+	r = &previews[i];
+    else
+	for (i = 1; i < PREVIEW_CACHE_SIZE && r->path != NULL; i++)
+	    if (previews[i].path == NULL || previews[i].used < r->used)
+		r = &previews[i];
+    if (r->pixmap == (Pixmap) 0) {
+	r->pixmap = XCreatePixmap(tool_d, canvas_win, PREVIEW_CANVAS_W,
+			PREVIEW_CANVAS_W, tool_dpth);
+	if (preview_gc == (GC) 0)
+	    preview_gc = XCreateGC(tool_d, r->pixmap, (unsigned long) 0, 0);
+    }
+    return r;
+}
+
+static Boolean
+set_preview(preview_rec *r, char *path, struct stat *st)
+{
+    free(r->path);
+    free(r->comments);
+    r->comments = NULL;
+    if ((r->path = strdup(path)) == NULL)
+	return False;
+    r->mtime = st->st_mtime;
+    r->size = st->st_size;
+    r->used = ++preview_clock;
+    return True;
+}
+
+/* the preview of the file name at path, from memory or disk, or NULL */
+
+static preview_rec *
+cached_preview(char *name, char *path, struct stat *st)
+{
+    preview_rec	   *r;
+    char	   *info, *c;
+    int		    i, n;
+
+    for (i = 0; i < PREVIEW_CACHE_SIZE; i++) {
+	r = &previews[i];
+	if (r->path != NULL && strcmp(r->path, path) == 0 &&
+		    r->mtime == st->st_mtime && r->size == st->st_size) {
+	    r->used = ++preview_clock;
+	    return r;
+	}
+    }
+
+    /* a pixmap is only written if the preview is found */
+    r = preview_slot(path);
+    if (libcache_get(disk_previews(), name, r->pixmap, PREVIEW_CANVAS_W,
+			PREVIEW_CANVAS_H, &info))
+	r->landscape = True;
+    else if (libcache_get(disk_previews(), name, r->pixmap, PREVIEW_CANVAS_H,
+			PREVIEW_CANVAS_W, &info))
+	r->landscape = False;
+    else
+	return NULL;
+    if (!set_preview(r, path, st))
+	return NULL;
+    r->ok = True;
+    /* the size of the figure, and its comments on the following lines */
+    c = strchr(info, '\n');
+    n = c ? c - info : strlen(info);
+    if (n >= (int)sizeof(r->figsize))
+	n = sizeof(r->figsize) - 1;
+    memcpy(r->figsize, info, n);
+    r->figsize[n] = '\0';
+    if (c != NULL && c[1] != '\0')
+	r->comments = strdup(c + 1);
+    return r;
+}
+
+/* keep the preview of the file name at path, drawn into pixmap */
+
+static void
+keep_preview(char *name, char *path, struct stat *st, Boolean ok,
+		Boolean landscape, Pixmap pixmap, char *figsize, char *comments)
+{
+    preview_rec	   *r;
+    char	   *info;
+    int		    width, height;
+
+    r = preview_slot(path);
+    if (!set_preview(r, path, st))
+	return;
+    if (!(r->ok = ok))
+	return;
+    width = landscape ? PREVIEW_CANVAS_W : PREVIEW_CANVAS_H;
+    height = landscape ? PREVIEW_CANVAS_H : PREVIEW_CANVAS_W;
+    XCopyArea(tool_d, pixmap, r->pixmap, preview_gc, 0, 0, width, height,
+		0, 0);
+    r->landscape = landscape;
+    strcpy(r->figsize, figsize);
+    if (comments == NULL)
+	comments = "";
+    if (*comments)
+	r->comments = strdup(comments);
+
+    if ((info = malloc(strlen(figsize) + strlen(comments) + 2)) != NULL) {
+	sprintf(info, "%s\n%s", figsize, comments);
+	libcache_put(disk_previews(), name, pixmap, width, height, info);
+	free(info);
+    }
+}
+
+/* put the pixmap in the preview canvas, set the width and height and
+   center it */
+
+static void
+set_preview_canvas(Widget canvas, Pixmap pixmap, Boolean landscape)
+{
+    FirstArg(XtNbackgroundPixmap, pixmap);
+    if (landscape) {
+	NextArg(XtNwidth, PREVIEW_CANVAS_W);
+	NextArg(XtNheight, PREVIEW_CANVAS_H);
+	NextArg(XtNvertDistance, (PREVIEW_CANVAS_W-PREVIEW_CANVAS_H)/2+4);
+	NextArg(XtNhorizDistance, 4);
+    } else {
+	NextArg(XtNwidth, PREVIEW_CANVAS_H);
+	NextArg(XtNheight, PREVIEW_CANVAS_W);
+	NextArg(XtNvertDistance, 4);
+	NextArg(XtNhorizDistance, (PREVIEW_CANVAS_W-PREVIEW_CANVAS_H)/2+4);
+    }
+    SetValues(canvas);
+    XtManageChild(canvas);
+}
+
+static void
+show_cached_preview(preview_rec *r, char *filename, Widget canvas,
+		Widget size_widget, Pixmap port_pixmap, Pixmap land_pixmap)
+{
+    Pixmap	pixmap = r->landscape ? land_pixmap : port_pixmap;
+
+    /* unmanage the preview widget in case we need to change its shape */
+    XtUnmanageChild(canvas);
+    /* fool the toolkit into drawing the new pixmap */
+    FirstArg(XtNbackgroundPixmap, (Pixmap)0);
+    SetValues(canvas);
+
+    if (r->landscape)
+	XCopyArea(tool_d, r->pixmap, pixmap, preview_gc, 0, 0,
+		    PREVIEW_CANVAS_W, PREVIEW_CANVAS_H, 0, 0);
+    else
+	XCopyArea(tool_d, r->pixmap, pixmap, preview_gc, 0, 0,
+		    PREVIEW_CANVAS_H, PREVIEW_CANVAS_W, 0, 0);
+
+    FirstArg(XtNlabel, filename);
+    SetValues(preview_name);
+    FirstArg(XtNstring, r->comments ? r->comments : "");
+    SetValues(comments_widget);
+    if (size_widget) {
+	FirstArg(XtNlabel, r->figsize);
+	SetValues(preview_size);
+    }
+    set_preview_canvas(canvas, pixmap, r->landscape);
+}
+
+/*
+ * Read the figure filename and draw it into land_pixmap or port_pixmap,
+ * depending on its orientation. Return the status of read_figc(), and the
+ * orientation, the size in figsize and a copy of the comments of the
+ * figure. Unless the preview is drawn ahead, show its name, size and
+ * comments while it is drawn.
+ */
+
+static int
+draw_preview(char *filename, Widget parent, Widget size_widget,
+		Pixmap port_pixmap, Pixmap land_pixmap, Boolean *landscape,
+		char *figsize, char **comments)
 {
     fig_settings    settings;
     int		save_objmask;
@@ -1221,35 +1492,18 @@ void preview_figure(char *filename, Widget parent, Widget canvas, Widget size_wi
     Boolean	save_shownums;
     F_compound	*figure;
     int		xmin, xmax, ymin, ymax;
-    float	width, height, size;
+    float	width, height;
     int		pixwidth, pixheight;
     int		i, status;
-    char	figsize[50];
-    Pixel	pb;
+
+    *landscape = False;
+    *figsize = '\0';
+    *comments = NULL;
 
     /* alloc a compound object - we must do it this way so free_compound()
        works properly */
     figure = create_compound();
 
-    /* if already previewing file, return */
-    if (preview_in_progress == True)
-	return;
-
-    /* clear the cancel flag */
-    cancel_preview = False;
-
-    /* and any request to load a file */
-    file_load_request = False;
-    /* and merge */
-    file_merge_request = False;
-    /* and save */
-    file_save_request = False;
-    /* and cancel */
-    file_cancel_request = False;
-
-    /* say we are in progress */
-    preview_in_progress = True;
-
     /* save active layer array and set all to True */
     save_active_layers();
     save_depths();
@@ -1262,21 +1516,6 @@ void preview_figure(char *filename, Widget parent, Widget canvas, Widget size_wi
 	save_nuser_colors();
     }
 
-    /* make the cancel button sensitive */
-    XtSetSensitive(preview_stop, True);
-    /* change label to read "Previewing" */
-    FirstArg(XtNlabel, "Previewing");
-    SetValues(preview_label);
-    /* get current background color of label */
-    FirstArg(XtNbackground, &pb);
-    GetValues(preview_label);
-    /* set it to red while previewing */
-    FirstArg(XtNbackground, x_color(YELLOW));
-    SetValues(preview_label);
-
-    /* give filename a chance to appear in the Filename field */
-    process_pending();
-
     /* first, save current zoom settings */
     save_zoomscale	= display_zoomscale;
     save_zoomxoff	= zoomxoff;
@@ -1286,17 +1525,6 @@ void preview_figure(char *filename, Widget parent, Widget canvas, Widget size_wi
     save_shownums	= appres.shownums;
     appres.shownums	= False;
 
-    /* insure that the most recent colormap is installed */
-    set_cmap(XtWindow(parent));
-
-    /* make wait cursor */
-    XDefineCursor(tool_d, XtWindow(parent), wait_cursor);
-    /* define it for the file list panel too */
-    XDefineCursor(tool_d, XtWindow(file_flist), wait_cursor);
-    /* but use a "hand" cursor for the Preview Stop button */
-    XDefineCursor(tool_d, XtWindow(preview_stop), pick9_cursor);
-    process_pending();
-
     /* if we haven't already saved colors of the images on the canvas */
     if (!image_colors_are_saved) {
 	image_colors_are_saved = True;
@@ -1309,43 +1537,32 @@ void preview_figure(char *filename, Widget parent, Widget canvas, Widget size_wi
 	save_avail_image_cols = avail_image_cols;
     }
 
-    /* unmanage the preview widget in case we need to change its shape (port<->land) */
-    XtUnmanageChild(canvas);
-    /* fool the toolkit into drawing the new pixmap */
-    FirstArg(XtNbackgroundPixmap, (Pixmap)0);
-    SetValues(canvas);
-
     /* read the figure into the local F_compound "figure" */
 
     /* we'll ignore the stuff returned in "settings" */
-    if ((status = read_figc(filename,figure, DONT_MERGE, REMAP_IMAGES, 0,0,&settings)) != 0) {
-	switch (status) {
-	   case -1: file_msg("Bad format");
-		   break;
-	   case -2: file_msg("File is empty");
-		   break;
-	   default: file_msg("Error reading %s: %s",filename,strerror(errno));
-	}
-	/* clear pixmap of any figure so user knows something went wrong */
-	clear_preview();
-    } else {
+    if ((status = read_figc(filename,figure, DONT_MERGE, REMAP_IMAGES, 0,0,&settings)) == 0) {
 	/*
 	 *  successful read, get the size
 	*/
 
 	add_compound_depth(figure);	/* count objects at each depth */
 
-	/* update the preview name */
-	FirstArg(XtNlabel, filename);
-	SetValues(preview_name);
+	if (figure->comments)
+	    *comments = strdup(figure->comments);
 
-	/* put in any comments */
-	if (figure->comments) {
-	    FirstArg(XtNstring, figure->comments);
-	} else {
-	    FirstArg(XtNstring, "");
+	if (!prefetching) {
+	    /* update the preview name */
+	    FirstArg(XtNlabel, filename);
+	    SetValues(preview_name);
+
+	    /* put in any comments */
+	    if (figure->comments) {
+		FirstArg(XtNstring, figure->comments);
+	    } else {
+		FirstArg(XtNstring, "");
+	    }
+	    SetValues(comments_widget);
 	}
-	SetValues(comments_widget);
 
 	/* get bounds of figure */
 	xmin = figure->nwcorner.x;
@@ -1354,7 +1571,6 @@ void preview_figure(char *filename, Widget parent, Widget canvas, Widget size_wi
 	ymax = figure->secorner.y;
 	width = xmax - xmin;
 	height = ymax - ymin;
-	size = max2(width,height) / ZOOM_FACTOR;
 	/* calculate size in current units */
 	if (width < PIX_PER_INCH || height < PIX_PER_INCH) {
 	    /* for small figures, show more decimal places */
@@ -1377,6 +1593,7 @@ void preview_figure(char *filename, Widget parent, Widget canvas, Widget size_wi
 	}
 
 	/* now switch the drawing canvas to our preview window and set width/height */
+	*landscape = settings.landscape;
 	if (settings.landscape) {
 	    canvas_win = (Window) land_pixmap;
 	    pixwidth = PREVIEW_CANVAS_W;
@@ -1420,20 +1637,6 @@ void preview_figure(char *filename, Widget parent, Widget canvas, Widget size_wi
 
 	/* restore marker flag */
 	cur_objmask = save_objmask;
-
-	/* put the pixmap back in and set the width and height and center it */
-	FirstArg(XtNbackgroundPixmap, canvas_win);
-	NextArg(XtNwidth, pixwidth);
-	NextArg(XtNheight, pixheight);
-	if (settings.landscape) {
-	    NextArg(XtNvertDistance, (PREVIEW_CANVAS_W-PREVIEW_CANVAS_H)/2+4);
-	    NextArg(XtNhorizDistance, 4);
-	} else {
-	    NextArg(XtNvertDistance, 4);
-	    NextArg(XtNhorizDistance, (PREVIEW_CANVAS_W-PREVIEW_CANVAS_H)/2+4);
-	}
-	SetValues(canvas);
-	XtManageChild(canvas);
     }
 
     /* free the figure compound */
@@ -1457,29 +1660,17 @@ void preview_figure(char *filename, Widget parent, Widget canvas, Widget size_wi
     /* restore shownums */
     appres.shownums	= save_shownums;
 
-    /* reset cursors */
-    XUndefineCursor(tool_d, XtWindow(parent));
-    XUndefineCursor(tool_d, XtWindow(file_flist));
-    XUndefineCursor(tool_d, XtWindow(preview_stop));
-
-    /* reset the cancel button and flag */
-    cancel_preview = False;
-
-    /* make the cancel button insensitive */
-    XtSetSensitive(preview_stop, False);
+    return status;
+}
 
-    /* change label to read "Preview" */
-    FirstArg(XtNlabel, "Preview");
-    /* and change background to original color */
-    NextArg(XtNbackground, pb);
-    SetValues(preview_label);
+/* do what was requested while a preview was drawn, return True if the
+   panel was closed or a file loaded, merged or saved */
 
-    process_pending();
-    /* check if user had double clicked on filename which means he wanted
-       to load the file, not just preview it */
-
-    /* say we are finished */
-    preview_in_progress = False;
+static Boolean
+preview_requests(void)
+{
+    Boolean	done = file_cancel_request || file_load_request ||
+			file_merge_request || file_save_request;
 
     if (file_cancel_request) {
 	cancel_preview = False;
@@ -1506,4 +1697,217 @@ void preview_figure(char *filename, Widget parent, Widget canvas, Widget size_wi
 	redisplay_region(0, 0, CANVAS_WD, CANVAS_HT);
 	request_redraw = False;
     }
+    return done;
+}
+
+static Boolean
+compressed_name(char *name)
+{
+    char	   *c = strrchr(name, '.');
+
+    return c != NULL && (strcmp(c, ".gz") == 0 || strcmp(c, ".Z") == 0 ||
+		strcmp(c, ".z") == 0);
+}
+
+/*
+ * Draw the preview of the next file around the one selected in the file
+ * list that is not cached yet, one at each call of the work procedure.
+ * Compressed files are skipped, they would be uncompressed on disk. No
+ * events are dispatched while it is drawn, so it is kept short.
+ */
+
+static Boolean
+prefetch_previews(XtPointer client_data)
+{
+    static Pixmap   pixmap = (Pixmap) 0;
+    XawListReturnStruct *cur;
+    struct stat	    st;
+    String	   *list;
+    Boolean	    landscape;
+    int		    n, i, j, k, status;
+    char	    name[PATH_MAX], path[PATH_MAX], figsize[50];
+    char	   *comments;
+
+    (void)client_data;
+    /* preview_figure() starts it again */
+    if (!file_up || preview_in_progress) {
+	prefetch_proc = 0;
+	return True;
+    }
+
+    cur = XawListShowCurrent(file_flist);
+    k = cur->list_index;
+    XtFree((char *)cur);
+    FirstArg(XtNlist, &list);
+    NextArg(XtNnumberStrings, &n);
+    GetValues(file_flist);
+    name[0] = '\0';
+    /* the next one first, then the previous one, and so on */
+    for (i = 1; k != XAW_LIST_NONE && i <= 2 * PREFETCH; i++) {
+	j = i % 2 ? k + (i + 1) / 2 : k - i / 2;
+	if (j < 0 || j >= n || compressed_name(list[j]))
+	    continue;
+	if (preview_file(list[j], path, &st) &&
+		    cached_preview(list[j], path, &st) == NULL) {
+	    strcpy(name, list[j]);
+	    break;
+	}
+    }
+    if (name[0] == '\0') {
+	prefetch_proc = 0;
+	return True;
+    }
+
+    if (pixmap == (Pixmap) 0)
+	pixmap = XCreatePixmap(tool_d, canvas_win, PREVIEW_CANVAS_W,
+			PREVIEW_CANVAS_W, tool_dpth);
+    cancel_preview = False;
+    file_load_request = False;
+    file_merge_request = False;
+    file_save_request = False;
+    file_cancel_request = False;
+    preview_in_progress = prefetching = background_preview = True;
+    /* messages belong to the file shown, not to this one */
+    quiet_msgs = True;
+
+    status = draw_preview(name, file_popup, (Widget) 0, pixmap, pixmap,
+			&landscape, figsize, &comments);
+
+    quiet_msgs = False;
+    /* a preview cut short is not kept */
+    if (!cancel_preview)
+	keep_preview(name, path, &st, status == 0, landscape, pixmap, figsize,
+			comments);
+    free(comments);
+    preview_in_progress = prefetching = background_preview = False;
+    cancel_preview = False;
+    return False;
+}
+
+static void
+start_prefetch(void)
+{
+    if (cache_previews() && prefetch_proc == 0)
+	prefetch_proc = XtAppAddWorkProc(tool_app, prefetch_previews, NULL);
+}
+
+void preview_figure(char *filename, Widget parent, Widget canvas, Widget size_widget, Pixmap port_pixmap, Pixmap land_pixmap)
+{
+    preview_rec	*r;
+    struct stat	st;
+    Boolean	keep, landscape;
+    int		status;
+    char	path[PATH_MAX];
+    char	figsize[50];
+    char	*comments;
+    Pixel	pb;
+
+    /* if already previewing file, return */
+    if (preview_in_progress == True)
+	return;
+
+    /* show a cached preview at once */
+    keep = preview_file(filename, path, &st);
+    if (keep && (r = cached_preview(filename, path, &st)) != NULL && r->ok) {
+	show_cached_preview(r, filename, canvas, size_widget, port_pixmap,
+			land_pixmap);
+	start_prefetch();
+	return;
+    }
+
+    /* clear the cancel flag */
+    cancel_preview = False;
+
+    /* and any request to load a file */
+    file_load_request = False;
+    /* and merge */
+    file_merge_request = False;
+    /* and save */
+    file_save_request = False;
+    /* and cancel */
+    file_cancel_request = False;
+
+    /* say we are in progress */
+    preview_in_progress = True;
+
+    /* make the cancel button sensitive */
+    XtSetSensitive(preview_stop, True);
+    /* change label to read "Previewing" */
+    FirstArg(XtNlabel, "Previewing");
+    SetValues(preview_label);
+    /* get current background color of label */
+    FirstArg(XtNbackground, &pb);
+    GetValues(preview_label);
+    /* set it to red while previewing */
+    FirstArg(XtNbackground, x_color(YELLOW));
+    SetValues(preview_label);
+
+    /* give filename a chance to appear in the Filename field */
+    process_pending();
+
+    /* insure that the most recent colormap is installed */
+    set_cmap(XtWindow(parent));
+
+    /* make wait cursor */
+    XDefineCursor(tool_d, XtWindow(parent), wait_cursor);
+    /* define it for the file list panel too */
+    XDefineCursor(tool_d, XtWindow(file_flist), wait_cursor);
+    /* but use a "hand" cursor for the Preview Stop button */
+    XDefineCursor(tool_d, XtWindow(preview_stop), pick9_cursor);
+    process_pending();
+
+    /* unmanage the preview widget in case we need to change its shape (port<->land) */
+    XtUnmanageChild(canvas);
+    /* fool the toolkit into drawing the new pixmap */
+    FirstArg(XtNbackgroundPixmap, (Pixmap)0);
+    SetValues(canvas);
+
+    status = draw_preview(filename, parent, size_widget, port_pixmap,
+			land_pixmap, &landscape, figsize, &comments);
+    if (status != 0) {
+	switch (status) {
+	   case -1: file_msg("Bad format");
+		   break;
+	   case -2: file_msg("File is empty");
+		   break;
+	   default: file_msg("Error reading %s: %s",filename,strerror(status));
+	}
+	/* clear pixmap of any figure so user knows something went wrong */
+	clear_preview();
+    } else {
+	set_preview_canvas(canvas, landscape ? land_pixmap : port_pixmap,
+			landscape);
+    }
+    /* a preview cut short is not kept */
+    if (keep && !cancel_preview)
+	keep_preview(filename, path, &st, status == 0, landscape,
+			landscape ? land_pixmap : port_pixmap, figsize, comments);
+    free(comments);
+
+    /* reset cursors */
+    XUndefineCursor(tool_d, XtWindow(parent));
+    XUndefineCursor(tool_d, XtWindow(file_flist));
+    XUndefineCursor(tool_d, XtWindow(preview_stop));
+
+    /* reset the cancel button and flag */
+    cancel_preview = False;
+
+    /* make the cancel button insensitive */
+    XtSetSensitive(preview_stop, False);
+
+    /* change label to read "Preview" */
+    FirstArg(XtNlabel, "Preview");
+    /* and change background to original color */
+    NextArg(XtNbackground, pb);
+    SetValues(preview_label);
+
+    process_pending();
+    /* check if user had double clicked on filename which means he wanted
+       to load the file, not just preview it */
+
+    /* say we are finished */
+    preview_in_progress = False;
+
+    if (!preview_requests())
+	start_prefetch();
 }
@@ -38,6 +38,7 @@ extern Widget	file_popup;
 extern Boolean	check_cancel(void);
 extern Boolean	cancel_preview;
 extern Boolean	preview_in_progress;
+extern Boolean	background_preview;
 extern void preview_figure (char *filename, Widget parent, Widget canvas, Widget size_widget, Pixmap port_pixmap, Pixmap land_pixmap);
 extern int renamefile (char *file);
 extern void file_panel_dismiss (void);
@@ -25,6 +25,7 @@
 #include "w_intersect.h"
 #include "w_msgpanel.h"
 #include "f_util.h"
+#include "u_draw.h"
 #include "u_quartic.h"
 #include <math.h>
 #undef I
@@ -67,27 +68,6 @@ fget_line_from_points(double * c,
   c[2] = (s1x * s2y) - (s1y * s2x);
 }
 
-/* returns True if the bounding box defined by corners p1a - p1b	*/
-/* overlaps the box defined by p2a - p2b				*/
-
-static Boolean
-boxes_overlap(struct f_point * p1a, struct f_point * p1b,
-	      struct f_point * p2a, struct f_point * p2b)
-{
-  Boolean rc;
-  int p1_min_x = (p1a->x < p1b->x) ? p1a->x : p1b->x;
-  int p1_max_x = (p1a->x > p1b->x) ? p1a->x : p1b->x;
-  int p1_min_y = (p1a->y < p1b->y) ? p1a->y : p1b->y;
-  int p1_max_y = (p1a->y > p1b->y) ? p1a->y : p1b->y;
-  int p2_min_x = (p2a->x < p2b->x) ? p2a->x : p2b->x;
-  int p2_max_x = (p2a->x > p2b->x) ? p2a->x : p2b->x;
-  int p2_min_y = (p2a->y < p2b->y) ? p2a->y : p2b->y;
-  int p2_max_y = (p2a->y > p2b->y) ? p2a->y : p2b->y;
-  rc = ((p1_max_x < p2_min_x) || (p1_min_x > p2_max_x) ||
-	(p1_max_y < p2_min_y) || (p1_min_y > p2_max_y)) ? False : True;
-  return rc;
-}
-
 static void
 do_circle_ellipse_intersect(r, X, Y, e, x, y, arc, isect_cb)
      double r, X, Y;
@@ -988,15 +968,48 @@ intersect_ellipse_polyline_handler(F_ellipse * e, F_line *  l, int x, int y, ise
   do_intersect_ellipse_polyline(ecx, ecy, ea, eb, theta, l, x, y, NULL, isect_cb);
 }
 
+/*
+ * Return the polyline drawn for spline s, or NULL. Delete it with
+ * delete_text_bounding_box(), the points are allocated in one array.
+ */
+
+static F_line *
+build_spline_polyline(F_spline * s)
+{
+  zXPoint * pts;
+  struct f_point * points;
+  int i, n;
+  F_line * f_line_p;
+
+  if ((n = spline_points(s, &pts)) == 0)
+    return NULL;
+  if ((f_line_p = malloc(sizeof(F_line))) == NULL)
+    return NULL;
+  if ((points = malloc(n * sizeof(struct f_point))) == NULL) {
+    free(f_line_p);
+    return NULL;
+  }
+  f_line_p->type = T_POLYLINE;
+  f_line_p->points = points;
+  for (i = 0; i < n; i++) {
+    points[i].x = pts[i].x;
+    points[i].y = pts[i].y;
+    points[i].next = (i < n - 1) ? &points[i+1] : NULL;
+  }
+  return f_line_p;
+}
+
 static void
-intersect_ellipse_spline_handler(obj1, obj2, x, y)
-     void * obj1;
-     void * obj2;
+intersect_ellipse_spline_handler(e, s, x, y)
+     F_ellipse * e;
+     F_spline * s;
      int x, y;
 {
-  put_msg("Ellipse-spline intersections not yet implemented");
-  beep();
-  snap_msg_set = True;
+  F_line * f_line_p = build_spline_polyline(s);
+  if (f_line_p) {
+    intersect_ellipse_polyline_handler(e, f_line_p, x, y, NULL);
+    delete_text_bounding_box(f_line_p);
+  }
 }
 
 void
@@ -1018,9 +1031,16 @@ build_text_bounding_box(F_text * t)
    */
   struct f_point * points;
   int i;
-  F_line * f_line_p = malloc(sizeof(F_line));
+  F_line * f_line_p;
+
+  if ((f_line_p = malloc(sizeof(F_line))) == NULL)
+    return NULL;
+  if ((points = malloc(5 * sizeof(struct f_point))) == NULL) {
+    free(f_line_p);
+    return NULL;
+  }
   f_line_p->type = T_BOX;
-  f_line_p->points = points = malloc(5 * sizeof(struct f_point));
+  f_line_p->points = points;
 
   points[0].x = 0;		points[0].y =   t->descent;
   points[1].x = t->length;	points[1].y =   t->descent;
@@ -1058,7 +1078,8 @@ intersect_ellipse_text_handler(e, t, x, y)
      int x, y;
 {
   F_line * f_line_p = build_text_bounding_box(t);
-  intersect_ellipse_polyline_handler(e, f_line_p, x, y, NULL);
+  if (f_line_p)
+    intersect_ellipse_polyline_handler(e, f_line_p, x, y, NULL);
   delete_text_bounding_box(f_line_p);
 }
 
@@ -1095,74 +1116,226 @@ intersect_ellipse_arc_handler(F_ellipse * e, F_arc * a, int x, int y, isect_cb_s
   }
 }
 
-void
-intersect_polyline_polyline_handler(F_line * l1, F_line * l2, int x, int y, isect_cb_s * isect_cb)
-{
+/*
+ * A segment of a polyline, for the sweep in intersect_polylines(). The
+ * segments of both polylines are kept in one array, sorted by their left
+ * end.
+ */
+
+typedef struct {
+  int xmin, xmax;
+  int ymin, ymax;
+  int line;			/* 0 for the first, 1 for the second polyline */
+  int seg_idx;			/* the number of the segment in its polyline */
   struct f_point * p1;
   struct f_point * p2;
-  struct f_point * p1_start;
-  struct f_point * p2_start;
-  double c1[3];
-  double c2[3];
-#define lA c1[0]
-#define lB c1[1]
-#define lC c1[2]
-#define lD c2[0]
-#define lE c2[1]
-#define lF c2[2]
-  double ci[2][2];
-#define ciA ci[0][0]
-#define ciB ci[0][1]
-#define ciC ci[1][0]
-#define ciD ci[1][1]
-  double det;
+} sweep_seg_s;
+
+/* tolerance of the parameters along the segments, to find intersections at vertices */
+#define SWEEP_EPS	1e-9
+
+static int
+compare_sweep_segs(const void * a, const void * b)
+{
+  const sweep_seg_s * s1 = a;
+  const sweep_seg_s * s2 = b;
+
+  return (s1->xmin > s2->xmin) - (s1->xmin < s2->xmin);
+}
+
+static int
+add_sweep_segs(sweep_seg_s * segs, int n, F_line * l, int line)
+{
+  struct f_point * p;
+  struct f_point * p_start;
+  int seg_idx;
+
+  p_start = NULL;
+  for (seg_idx = -1, p = l->points; p != NULL; seg_idx++, p = p->next) {
+    if (p_start) {
+      segs[n].xmin = (p_start->x < p->x) ? p_start->x : p->x;
+      segs[n].xmax = (p_start->x > p->x) ? p_start->x : p->x;
+      segs[n].ymin = (p_start->y < p->y) ? p_start->y : p->y;
+      segs[n].ymax = (p_start->y > p->y) ? p_start->y : p->y;
+      segs[n].line = line;
+      segs[n].seg_idx = seg_idx;
+      segs[n].p1 = p_start;
+      segs[n++].p2 = p;
+    }
+    p_start = p;
+  }
+  return n;
+}
+
+/* intersect segment a of the first polyline with segment b of the second */
+
+static void
+intersect_sweep_segs(sweep_seg_s * a, sweep_seg_s * b, int x, int y,
+		     double * mind, isect_cb_s * isect_cb)
+{
+  double d1x = (double)(a->p2->x) - (double)(a->p1->x);
+  double d1y = (double)(a->p2->y) - (double)(a->p1->y);
+  double d2x = (double)(b->p2->x) - (double)(b->p1->x);
+  double d2y = (double)(b->p2->y) - (double)(b->p1->y);
+  double ex = (double)(b->p1->x) - (double)(a->p1->x);
+  double ey = (double)(b->p1->y) - (double)(a->p1->y);
+  double det = (d1x * d2y) - (d1y * d2x);
+  double t, u;
   double ix, iy;
   double dist;
+
+  if (det == 0.0)		/* parallel segments */
+    return;
+  t = ((ex * d2y) - (ey * d2x)) / det;
+  u = ((ex * d1y) - (ey * d1x)) / det;
+  if ((t < -SWEEP_EPS) || (t > 1.0 + SWEEP_EPS) ||
+      (u < -SWEEP_EPS) || (u > 1.0 + SWEEP_EPS))
+    return;
+  ix = (double)(a->p1->x) + (t * d1x);
+  iy = (double)(a->p1->y) + (t * d1y);
+  snap_found = True;
+  if (isect_cb)
+    insert_isect(isect_cb, ix, iy, b->seg_idx);
+  else {
+    dist = hypot(iy - (double)y, ix - (double)x);
+    if (dist < *mind) {
+      *mind = dist;
+      snap_gx = (int)rint(ix);
+      snap_gy = (int)rint(iy);
+    }
+  }
+}
+
+static void
+intersect_no_memory(void)
+{
+  put_msg("Not enough memory to intersect the objects.");
+  beep();
+  snap_msg_set = True;
+}
+
+/*
+ * Intersect the polylines l1 and l2. The segments of both are swept from
+ * left to right. The plane is cut into horizontal bands about as high as
+ * an average segment, and each band keeps the segments of either polyline
+ * whose x-range reaches the sweep line. A segment is only compared to the
+ * segments of the other polyline in the bands it crosses, a pair only in
+ * the lowest band shared. If isect_cb is non-null, all intersects are
+ * returned with the number of the segment of l2, otherwise the intersect
+ * closest to (x, y) is put into snap_gx, snap_gy.
+ */
+
+static void
+intersect_polylines(F_line * l1, F_line * l2, int x, int y, isect_cb_s * isect_cb)
+{
+  struct f_point * p;
+  sweep_seg_s * segs;
+  sweep_seg_s * s;
+  sweep_seg_s * a;
+  int * active;			/* the segments in the bands, per polyline */
+  int * start;			/* where the band starts in active[] */
+  int * nr_active;		/* the number of segments in the band */
+  int nr_segs, nr_bands, nr_touched;
+  int ymin, ymax, height;
+  double sum;
+  int i, j, k, o, b, b1, b2;
+  int * act;
   double mind;
-  int seg_idx;
+
+  nr_segs = 0;
+  for (p = l1->points; p != NULL; p = p->next)
+    ++nr_segs;
+  for (p = l2->points; p != NULL; p = p->next)
+    ++nr_segs;
+  if (nr_segs < 4)		/* at least one segment each */
+    return;
+  if ((segs = malloc(nr_segs * sizeof(sweep_seg_s))) == NULL) {
+    intersect_no_memory();
+    return;
+  }
+  nr_segs = add_sweep_segs(segs, 0, l1, 0);
+  nr_segs = add_sweep_segs(segs, nr_segs, l2, 1);
+
+  /* the height of the bands */
+  ymin = segs[0].ymin;
+  ymax = segs[0].ymax;
+  sum = 0.0;
+  for (i = 0; i < nr_segs; i++) {
+    if (segs[i].ymin < ymin) ymin = segs[i].ymin;
+    if (segs[i].ymax > ymax) ymax = segs[i].ymax;
+    sum += (double)(segs[i].ymax - segs[i].ymin);
+  }
+  height = (int)(sum / nr_segs) + 1;
+  if ((double)(ymax - ymin) / height > nr_segs)
+    height = (ymax - ymin) / nr_segs + 1;
+  nr_bands = (ymax - ymin) / height + 1;
+#define BAND(yy)	(((yy) - ymin) / height)
+
+  /* make room for every segment in each band it crosses */
+  start = calloc(2 * nr_bands + 1, sizeof(int));
+  nr_active = calloc(2 * nr_bands, sizeof(int));
+  if (start == NULL || nr_active == NULL) {
+    free(start);
+    free(nr_active);
+    free(segs);
+    intersect_no_memory();
+    return;
+  }
+  for (i = 0; i < nr_segs; i++)
+    for (b = BAND(segs[i].ymin); b <= BAND(segs[i].ymax); b++)
+      ++start[segs[i].line * nr_bands + b + 1];
+  for (b = 0; b < 2 * nr_bands; b++)
+    start[b + 1] += start[b];
+  nr_touched = start[2 * nr_bands];
+  if ((active = malloc(nr_touched * sizeof(int))) == NULL) {
+    free(start);
+    free(nr_active);
+    free(segs);
+    intersect_no_memory();
+    return;
+  }
+
+  qsort(segs, nr_segs, sizeof(sweep_seg_s), compare_sweep_segs);
 
   mind = HUGE_VAL;
-  p1_start = NULL;
-  for (p1 = l1->points; p1 != NULL; p1 = p1->next) {
-    if (p1_start) {
-      get_line_from_points(c1, p1_start, p1);
-      p2_start = NULL;
-      for (seg_idx = -1, p2 = l2->points; p2 != NULL; seg_idx++, p2 = p2->next) {
-	if (p2_start) {
-	  if (True == boxes_overlap(p1_start, p1, p2_start, p2)) {
-	    get_line_from_points(c2, p2_start, p2);
-	    det = (lB * lD) - (lA * lE);
-	    ciA = lE/det;
-	    ciB = -lD/det;
-	    ciC = -lB/det;
-	    ciD = lA/det;
-	    ix = (lC * ciA) + (lF * ciC);
-	    iy = (lC * ciB) + (lF * ciD);
-	    snap_found = True;
-	    if (isect_cb) {
-	      if ((True == is_point_on_segment((double)(p1_start->x), (double)(p1_start->y),
-					       ix, iy,
-					       (double)(p1->x), (double)(p1->y))) &&
-		  (True == is_point_on_segment((double)(p2_start->x), (double)(p2_start->y),
-					       ix, iy,
-					       (double)(p2->x), (double)(p2->y))))
-		insert_isect(isect_cb, ix, iy, seg_idx);
-	    }
-	    else {
-	      dist = hypot(iy - (double)y, ix - (double)x);
-	      if (dist < mind) {
-		mind = dist;
-		snap_gx = (int)rint(ix);
-		snap_gy = (int)rint(iy);
-	      }
-	    }
-	  }
-	}
-	p2_start = p2;
+  for (i = 0; i < nr_segs; i++) {
+    s = &segs[i];
+    o = 1 - s->line;
+    b1 = BAND(s->ymin);
+    b2 = BAND(s->ymax);
+    for (b = b1; b <= b2; b++) {
+      /* drop the segments of the other polyline left of s, test the others */
+      act = active + start[o * nr_bands + b];
+      for (j = k = 0; j < nr_active[o * nr_bands + b]; j++) {
+	a = &segs[act[j]];
+	if (a->xmax < s->xmin)
+	  continue;
+	act[k++] = act[j];
+	if ((a->ymax < s->ymin) || (a->ymin > s->ymax))
+	  continue;
+	if (BAND((a->ymin > s->ymin) ? a->ymin : s->ymin) != b)
+	  continue;
+	if (s->line == 0)
+	  intersect_sweep_segs(s, a, x, y, &mind, isect_cb);
+	else
+	  intersect_sweep_segs(a, s, x, y, &mind, isect_cb);
       }
+      nr_active[o * nr_bands + b] = k;
+      active[start[s->line * nr_bands + b] + nr_active[s->line * nr_bands + b]++] = i;
     }
-    p1_start = p1;
   }
+#undef BAND
+
+  free(active);
+  free(start);
+  free(nr_active);
+  free(segs);
+}
+
+void
+intersect_polyline_polyline_handler(F_line * l1, F_line * l2, int x, int y, isect_cb_s * isect_cb)
+{
+  intersect_polylines(l1, l2, x, y, isect_cb);
   if (!isect_cb) {
     if (False == snap_found) {
       put_msg("Selected polylines do not intersect.");
@@ -1173,14 +1346,16 @@ intersect_polyline_polyline_handler(F_line * l1, F_line * l2, int x, int y, isec
 }
 
 static void
-intersect_polyline_spline_handler(obj1, obj2, x, y)
-     void * obj1;
-     void * obj2;
+intersect_polyline_spline_handler(l, s, x, y)
+     F_line * l;
+     F_spline * s;
      int x, y;
 {
-  put_msg("Polyline-spline intersections not yet implemented");
-  beep();
-  snap_msg_set = True;
+  F_line * f_line_p = build_spline_polyline(s);
+  if (f_line_p) {
+    intersect_polylines(l, f_line_p, x, y, NULL);
+    delete_text_bounding_box(f_line_p);
+  }
 }
 
 static void
@@ -1190,7 +1365,8 @@ intersect_polyline_text_handler(l, t, x, y)
      int x, y;
 {
   F_line * f_line_p = build_text_bounding_box(t);
-  intersect_polyline_polyline_handler(l, f_line_p, x, y, NULL);
+  if (f_line_p)
+    intersect_polyline_polyline_handler(l, f_line_p, x, y, NULL);
   delete_text_bounding_box(f_line_p);
 }
 
@@ -1207,14 +1383,17 @@ intersect_polyline_arc_handler(F_line * l,  F_arc *a,  int x, int y, isect_cb_s
 }
 
 static void
-intersect_spline_spline_handler(obj1, obj2, x, y)
-     void * obj1;
-     void * obj2;
+intersect_spline_spline_handler(s1, s2, x, y)
+     F_spline * s1;
+     F_spline * s2;
      int x, y;
 {
-  put_msg("Spline-spline intersections not yet implemented");
-  beep();
-  snap_msg_set = True;
+  F_line * f1_line_p = build_spline_polyline(s1);
+  F_line * f2_line_p = build_spline_polyline(s2);
+  if (f1_line_p && f2_line_p)
+    intersect_polylines(f1_line_p, f2_line_p, x, y, NULL);
+  delete_text_bounding_box(f1_line_p);
+  delete_text_bounding_box(f2_line_p);
 }
 
 static void
@@ -1223,20 +1402,25 @@ intersect_spline_text_handler(s, t, x, y)
      F_text * t;
      int x, y;
 {
-  put_msg("Spline-text intersections not yet implemented");
-  beep();
-  snap_msg_set = True;
+  F_line * f1_line_p = build_spline_polyline(s);
+  F_line * f2_line_p = build_text_bounding_box(t);
+  if (f1_line_p && f2_line_p)
+    intersect_polylines(f1_line_p, f2_line_p, x, y, NULL);
+  delete_text_bounding_box(f1_line_p);
+  delete_text_bounding_box(f2_line_p);
 }
 
 static void
-intersect_spline_arc_handler(obj1, obj2, x, y)
-     void * obj1;
-     void * obj2;
+intersect_spline_arc_handler(s, a, x, y)
+     F_spline * s;
+     F_arc * a;
      int x, y;
 {
-  put_msg("Spline-arc intersections not yet implemented");
-  beep();
-  snap_msg_set = True;
+  F_line * f_line_p = build_spline_polyline(s);
+  if (f_line_p) {
+    intersect_polyline_arc_handler(f_line_p, a, x, y, NULL);
+    delete_text_bounding_box(f_line_p);
+  }
 }
 
 static void
@@ -1247,7 +1431,8 @@ intersect_text_text_handler(t1, t2, x, y)
 {
   F_line * f1_line_p = build_text_bounding_box(t1);
   F_line * f2_line_p = build_text_bounding_box(t2);
-  intersect_polyline_polyline_handler(f1_line_p, f2_line_p, x, y, NULL);
+  if (f1_line_p && f2_line_p)
+    intersect_polyline_polyline_handler(f1_line_p, f2_line_p, x, y, NULL);
   delete_text_bounding_box(f1_line_p);
   delete_text_bounding_box(f2_line_p);
 }
@@ -1259,7 +1444,8 @@ intersect_text_arc_handler(t, a, x, y)
      int x, y;
 {
   F_line * f_line_p = build_text_bounding_box(t);
-  intersect_polyline_arc_handler(f_line_p, a, x, y, NULL);
+  if (f_line_p)
+    intersect_polyline_arc_handler(f_line_p, a, x, y, NULL);
   delete_text_bounding_box(f_line_p);
 }
 
@@ -1345,7 +1531,7 @@ intersect_spline_handler(obj1, obj2, type2, x, y)
     intersect_ellipse_spline_handler(obj2, obj1, x, y);
     break;
   case O_POLYLINE:
-    intersect_polyline_spline_handler(obj2, obj2, x, y);
+    intersect_polyline_spline_handler(obj2, obj1, x, y);
     break;
   case O_SPLINE:
     intersect_spline_spline_handler(obj1, obj2, x, y);
@@ -1371,7 +1557,7 @@ intersect_text_handler(obj1, obj2, type2, x, y)
     intersect_ellipse_text_handler(obj2, obj1, x, y);
     break;
   case O_POLYLINE:
-    intersect_polyline_text_handler(obj2, obj2, x, y);
+    intersect_polyline_text_handler(obj2, obj1, x, y);
     break;
   case O_SPLINE:
     intersect_spline_text_handler(obj2, obj1, x, y);
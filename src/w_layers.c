@@ -725,6 +725,9 @@ any_active_in_compound(F_compound *cmpnd)
 	F_text	   *t;
 	F_compound *c;
 
+	/* the depths in a compound that is not read yet are unknown */
+	if (cmpnd->lazy != NULL)
+	    return True;
 	for (a = cmpnd->arcs; a != NULL; a = a->next)
 	    if (active_layer(a->depth))
 		return True;
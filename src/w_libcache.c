@@ -0,0 +1,446 @@
+/*
+ * FIG : Facility for Interactive Generation of figures
+ * Copyright (c) 1985-1988 by Supoj Sutanthavibul
+ * Parts Copyright (c) 1989-2015 by Brian V. Smith
+ * Parts Copyright (c) 1991 by Paul King
+ * Parts Copyright (c) 2016-2020 by Thomas Loimer
+ *
+ * Any party obtaining a copy of these files is granted, free of charge, a
+ * full and unrestricted irrevocable, world-wide, paid up, royalty-free,
+ * nonexclusive right and license to deal in this software and documentation
+ * files (the "Software"), including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense and/or sell copies of
+ * the Software, and to permit persons who receive copies from any such
+ * party to do so, with the only requirement being that the above copyright
+ * and this permission notice remain intact.
+ *
+ */
+/*
+ * Keep the icons of the objects of a library, and the previews of the
+ * figures in a directory, on disk, so that they need not be read and drawn
+ * again. The icons of one kind, e.g., of one icon size, of a directory are
+ * in one file in $HOME/LIBCACHE_DIR, each with the name, modification time
+ * and size of the Fig file it was drawn from; an icon is only taken if
+ * these still match. The pixels are stored run-length encoded, as
+ * XGetImage() returns them, for the depth and the color masks given in the
+ * header of the file. Hence, icons are only cached for TrueColor and
+ * DirectColor visuals, where a color has the same pixel value in every
+ * session. With each icon, a string can be kept.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "fig.h"
+#include "resources.h"
+#include "w_libcache.h"
+
+#define LIBCACHE_DIR	".xfigicons"
+#define LIBCACHE_ID	"xfig icon cache 2"
+
+typedef struct {
+	char	*name;
+	long	 mtime;
+	long	 fsize;
+	int	 width, height;
+	int	 bytes_per_line;
+	int	 len;		/* of the encoded pixels */
+	unsigned char *data;
+	char	*info;
+	Boolean	 stale;		/* the Fig file changed */
+} icon_rec;
+
+struct libcache {
+	icon_rec *icons;
+	int	 num_icons, num_sorted, alloc_icons;
+	char	*dir;
+	char	 cache_file[PATH_MAX];
+	Boolean	 dirty;
+};
+
+static GC	 icon_gc = (GC) 0;
+
+static Boolean	stat_object(libcache *c, char *name, long *mtime, long *fsize);
+
+static Boolean
+usable_visual(void)
+{
+    return tool_vclass == TrueColor || tool_vclass == DirectColor;
+}
+
+/* the header identifying the format of the pixels */
+
+static void
+make_header(char *buf)
+{
+    sprintf(buf, "%s\n%d %d %d %lx %lx %lx\n", LIBCACHE_ID, tool_dpth,
+		ImageByteOrder(tool_d), BitmapPad(tool_d), tool_v->red_mask,
+		tool_v->green_mask, tool_v->blue_mask);
+}
+
+static Boolean
+make_cache_name(char *cache_file, char *dir, int kind)
+{
+    char	   *home, *c;
+    unsigned long   h = 5381;
+
+    if ((home = getenv("HOME")) == NULL || *home == '\0' ||
+		strlen(home) + sizeof LIBCACHE_DIR + 24 > PATH_MAX)
+	return False;
+    for (c = dir; *c; c++)
+	h = h * 33 + (unsigned char)*c;
+    sprintf(cache_file, "%s/%s", home, LIBCACHE_DIR);
+    if (mkdir(cache_file, 0700) != 0 && errno != EEXIST)
+	return False;
+    sprintf(cache_file + strlen(cache_file), "/%08lx-%d", h & 0xffffffffUL,
+		kind);
+    return True;
+}
+
+static int
+cmp_icons(const void *a, const void *b)
+{
+    return strcmp(((const icon_rec *)a)->name, ((const icon_rec *)b)->name);
+}
+
+static icon_rec *
+new_icon(libcache *c)
+{
+    icon_rec	   *r;
+
+    if (c->num_icons == c->alloc_icons) {
+	c->alloc_icons = c->alloc_icons ? 2 * c->alloc_icons : 256;
+	if ((r = realloc(c->icons, c->alloc_icons * sizeof(icon_rec))) ==
+			NULL) {
+	    c->alloc_icons = c->num_icons;
+	    return NULL;
+	}
+	c->icons = r;
+    }
+    r = &c->icons[c->num_icons];
+    memset(r, 0, sizeof(icon_rec));
+    return r;
+}
+
+static void
+free_icon(icon_rec *r)
+{
+    free(r->name);
+    free(r->data);
+    free(r->info);
+}
+
+static void
+read_cache(libcache *c)
+{
+    FILE	   *fp;
+    char	    header[256], buf[256], line[PATH_MAX];
+    icon_rec	   *r;
+    size_t	    n;
+    int		    infolen;
+
+    if ((fp = fopen(c->cache_file, "r")) == NULL)
+	return;
+    make_header(header);
+    n = strlen(header);
+    if (fread(buf, 1, n, fp) != n || strncmp(buf, header, n) != 0 ||
+		fgets(line, sizeof line, fp) == NULL ||
+		strncmp(line, c->dir, strlen(c->dir)) != 0 ||
+		line[strlen(c->dir)] != '\n') {
+	fclose(fp);
+	return;
+    }
+    while (fgets(line, sizeof line, fp) != NULL) {
+	if ((r = new_icon(c)) == NULL)
+	    break;
+	line[strcspn(line, "\n")] = '\0';
+	if ((r->name = strdup(line)) == NULL)
+	    break;
+	if (fgets(line, sizeof line, fp) == NULL ||
+		sscanf(line, "%ld %ld %d %d %d %d %d", &r->mtime, &r->fsize,
+			&r->width, &r->height, &r->bytes_per_line, &r->len,
+			&infolen) != 7 || r->len <= 0 || infolen < 0 ||
+		(r->data = malloc(r->len)) == NULL ||
+		fread(r->data, 1, r->len, fp) != (size_t)r->len ||
+		(infolen > 0 && ((r->info = malloc(infolen + 1)) == NULL ||
+			fread(r->info, 1, infolen, fp) != (size_t)infolen))) {
+	    free_icon(r);
+	    break;
+	}
+	if (r->info)
+	    r->info[infolen] = '\0';
+	++c->num_icons;
+    }
+    fclose(fp);
+    qsort(c->icons, c->num_icons, sizeof(icon_rec), cmp_icons);
+    c->num_sorted = c->num_icons;
+}
+
+static void
+write_cache(libcache *c)
+{
+    FILE	   *fp;
+    char	    header[256], tmp[PATH_MAX + 16];
+    icon_rec	   *r;
+    long	    mtime, fsize;
+    int		    i, infolen;
+    Boolean	    ok;
+
+    sprintf(tmp, "%s.%d", c->cache_file, (int)getpid());
+    if ((fp = fopen(tmp, "w")) == NULL)
+	return;
+    make_header(header);
+    ok = fprintf(fp, "%s%s\n", header, c->dir) > 0;
+    for (i = 0; i < c->num_icons && ok; i++) {
+	r = &c->icons[i];
+	/* drop the icons of files changed or deleted meanwhile */
+	if (r->stale || !stat_object(c, r->name, &mtime, &fsize) ||
+		    mtime != r->mtime || fsize != r->fsize)
+	    continue;
+	infolen = r->info ? strlen(r->info) : 0;
+	ok = fprintf(fp, "%s\n%ld %ld %d %d %d %d %d\n", r->name, r->mtime,
+			r->fsize, r->width, r->height, r->bytes_per_line,
+			r->len, infolen) > 0 &&
+		fwrite(r->data, 1, r->len, fp) == (size_t)r->len &&
+		fwrite(r->info, 1, infolen, fp) == (size_t)infolen;
+    }
+    if (fclose(fp) != 0 || !ok || rename(tmp, c->cache_file) != 0)
+	unlink(tmp);
+}
+
+/* open the icon cache of kind for the directory dir */
+
+libcache *
+libcache_open(char *dir, int kind)
+{
+    libcache	   *c;
+
+    if (!usable_visual() || (c = calloc(1, sizeof(libcache))) == NULL)
+	return NULL;
+    if (!make_cache_name(c->cache_file, dir, kind) ||
+		(c->dir = strdup(dir)) == NULL) {
+	free(c);
+	return NULL;
+    }
+    read_cache(c);
+    return c;
+}
+
+/* write the cache, if it changed, and free it */
+
+void
+libcache_close(libcache *c)
+{
+    int		    i;
+
+    if (c == NULL)
+	return;
+    if (c->dirty)
+	write_cache(c);
+    for (i = 0; i < c->num_icons; i++)
+	free_icon(&c->icons[i]);
+    free(c->icons);
+    free(c->dir);
+    free(c);
+}
+
+static Boolean
+stat_object(libcache *c, char *name, long *mtime, long *fsize)
+{
+    struct stat	    st;
+    char	    path[PATH_MAX];
+
+    if (strlen(c->dir) + strlen(name) + 2 > PATH_MAX ||
+		strchr(name, '\n') != NULL)
+	return False;
+    sprintf(path, "%s/%s", c->dir, name);
+    if (stat(path, &st) != 0)
+	return False;
+    *mtime = (long)st.st_mtime;
+    *fsize = (long)st.st_size;
+    return True;
+}
+
+/*
+ * Run-length encode the n bytes in src into dst, which must have room for
+ * n + n/128 + 1 bytes. A count c < 128 is followed by c+1 bytes, a count
+ * c >= 128 by one byte repeated c-125 times.
+ */
+
+static int
+encode(unsigned char *dst, unsigned char *src, int n)
+{
+    unsigned char  *d = dst;
+    int		    i = 0, j, run;
+
+    while (i < n) {
+	/* a run of at least 3 bytes? */
+	for (run = 1; i + run < n && run < 130 && src[i + run] == src[i]; run++)
+	    ;
+	if (run >= 3) {
+	    *d++ = run + 125;
+	    *d++ = src[i];
+	    i += run;
+	    continue;
+	}
+	/* literal bytes, up to the next run of 3 */
+	for (j = i; j < n && j - i < 128; j++)
+	    if (j + 2 < n && src[j] == src[j + 1] && src[j] == src[j + 2])
+		break;
+	*d++ = j - i - 1;
+	memcpy(d, src + i, j - i);
+	d += j - i;
+	i = j;
+    }
+    return d - dst;
+}
+
+static Boolean
+decode(unsigned char *dst, int n, unsigned char *src, int len)
+{
+    unsigned char  *end = src + len;
+    int		    c, k = 0;
+
+    while (src < end) {
+	c = *src++;
+	if (c < 128) {
+	    if (k + c + 1 > n || src + c + 1 > end)
+		return False;
+	    memcpy(dst + k, src, c + 1);
+	    src += c + 1;
+	    k += c + 1;
+	} else {
+	    if (k + c - 125 > n || src >= end)
+		return False;
+	    memset(dst + k, *src++, c - 125);
+	    k += c - 125;
+	}
+    }
+    return k == n;
+}
+
+static void
+make_gc(Pixmap pixmap)
+{
+    if (icon_gc == (GC) 0)
+	icon_gc = XCreateGC(tool_d, pixmap, (unsigned long) 0, 0);
+}
+
+/*
+ * Put the cached icon of the file name, of width x height pixels, into
+ * pixmap, if there is one. Return the string kept with it in *info, if info
+ * is not NULL; the string belongs to the cache.
+ */
+
+Boolean
+libcache_get(libcache *c, char *name, Pixmap pixmap, int width, int height,
+		char **info)
+{
+    XImage	   *image;
+    icon_rec	    key, *r;
+    char	   *data;
+    long	    mtime, fsize;
+    int		    n;
+
+    if (c == NULL || c->num_sorted == 0)
+	return False;
+    key.name = name;
+    if ((r = bsearch(&key, c->icons, c->num_sorted, sizeof(icon_rec),
+				cmp_icons)) == NULL || r->stale)
+	return False;
+    if (!stat_object(c, name, &mtime, &fsize) || mtime != r->mtime ||
+		fsize != r->fsize) {
+	r->stale = c->dirty = True;
+	return False;
+    }
+    if (r->width != width || r->height != height)
+	return False;
+
+    n = r->bytes_per_line * height;
+    if ((data = malloc(n)) == NULL)
+	return False;
+    if (!decode((unsigned char *)data, n, r->data, r->len) ||
+		(image = XCreateImage(tool_d, tool_v, tool_dpth, ZPixmap, 0,
+			data, width, height, BitmapPad(tool_d),
+			r->bytes_per_line)) == NULL) {
+	free(data);
+	r->stale = c->dirty = True;
+	return False;
+    }
+    make_gc(pixmap);
+    XPutImage(tool_d, pixmap, icon_gc, image, 0, 0, 0, 0, width, height);
+    XDestroyImage(image);
+    if (info)
+	*info = r->info ? r->info : "";
+    return True;
+}
+
+/* the icon of the file name, read from the cache or put since */
+
+static icon_rec *
+find_icon(libcache *c, char *name)
+{
+    icon_rec	    key, *r;
+    int		    i;
+
+    key.name = name;
+    if ((r = bsearch(&key, c->icons, c->num_sorted, sizeof(icon_rec),
+				cmp_icons)) != NULL)
+	return r;
+    for (i = c->num_sorted; i < c->num_icons; i++)
+	if (strcmp(c->icons[i].name, name) == 0)
+	    return &c->icons[i];
+    return NULL;
+}
+
+/* keep the icon of the file name, width x height pixels of pixmap */
+
+void
+libcache_put(libcache *c, char *name, Pixmap pixmap, int width, int height,
+		char *info)
+{
+    XImage	   *image;
+    icon_rec	    new, *r;
+    long	    mtime, fsize;
+    int		    n;
+
+    if (c == NULL)
+	return;
+    /* an icon kept before is replaced in place, at most one per name */
+    if ((r = find_icon(c, name)) != NULL)
+	r->stale = c->dirty = True;
+    if (!stat_object(c, name, &mtime, &fsize) ||
+		(image = XGetImage(tool_d, pixmap, 0, 0, width, height,
+			AllPlanes, ZPixmap)) == NULL)
+	return;
+    n = image->bytes_per_line * height;
+    memset(&new, 0, sizeof(icon_rec));
+    if ((new.name = strdup(name)) != NULL &&
+		(new.data = malloc(n + n / 128 + 1)) != NULL &&
+		(info == NULL || (new.info = strdup(info)) != NULL) &&
+		(r != NULL || (r = new_icon(c)) != NULL)) {
+	new.mtime = mtime;
+	new.fsize = fsize;
+	new.width = width;
+	new.height = height;
+	new.bytes_per_line = image->bytes_per_line;
+	new.len = encode(new.data, (unsigned char *)image->data, n);
+	if (r == &c->icons[c->num_icons])
+	    ++c->num_icons;
+	else
+	    free_icon(r);
+	*r = new;
+	c->dirty = True;
+    } else {
+	free_icon(&new);
+    }
+    XDestroyImage(image);
+}
@@ -0,0 +1,32 @@
+/*
+ * FIG : Facility for Interactive Generation of figures
+ * Copyright (c) 1985-1988 by Supoj Sutanthavibul
+ * Parts Copyright (c) 1989-2015 by Brian V. Smith
+ * Parts Copyright (c) 1991 by Paul King
+ * Parts Copyright (c) 2016-2020 by Thomas Loimer
+ *
+ * Any party obtaining a copy of these files is granted, free of charge, a
+ * full and unrestricted irrevocable, world-wide, paid up, royalty-free,
+ * nonexclusive right and license to deal in this software and documentation
+ * files (the "Software"), including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense and/or sell copies of
+ * the Software, and to permit persons who receive copies from any such
+ * party to do so, with the only requirement being that the above copyright
+ * and this permission notice remain intact.
+ *
+ */
+#ifndef W_LIBCACHE_H
+#define W_LIBCACHE_H
+
+#define LIBCACHE_PREVIEWS	0	/* the kind of the previews of figures */
+
+typedef struct libcache libcache;
+
+extern libcache	*libcache_open(char *dir, int kind);
+extern Boolean	libcache_get(libcache *c, char *name, Pixmap pixmap,
+			int width, int height, char **info);
+extern void	libcache_put(libcache *c, char *name, Pixmap pixmap,
+			int width, int height, char *info);
+extern void	libcache_close(libcache *c);
+
+#endif /* W_LIBCACHE_H */
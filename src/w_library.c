@@ -32,6 +32,7 @@
 #include "w_dir.h"
 #include "w_file.h"
 #include "w_indpanel.h"
+#include "w_libcache.h"
 #include "w_library.h"
 #include "w_listwidget.h"
 #include "w_layers.h"
@@ -59,6 +60,8 @@
 #define N_LIB_OBJECT_MAX  400		/* max number of objects in a library */
 #define N_LIB_NAME_MAX	  81		/* max length of library name + 1 */
 #define N_LIB_LINE_MAX    300		/* one line in the file */
+#define LIB_DIRS_CACHE	  ".xfiglibs"	/* in $HOME, the library directories */
+#define LIB_DIRS_ID	  "xfig library cache 1"
 
 #define MAIN_WIDTH	  435		/* width of main panel */
 #define LIB_PREVIEW_SIZE  150		/* size (square) of preview canvas */
@@ -149,6 +152,27 @@ static char	 *viewtypes[] = {"List View", "Icon View"};
 
 static struct lib_rec *library_rec[N_LIB_MAX + 1];
 
+/*
+ * The library directories, as read or taken from the cache. All
+ * sub-directories are kept, also those without .fig files, to see when
+ * .fig files are added to them.
+ */
+struct lib_dir {
+  char	  *path;
+  long	   mtime;		/* of the directory, -1 if it could not be read */
+  Boolean  figs;		/* whether there are .fig files in it */
+  Boolean  queued;		/* to be checked in this session, or checked */
+  int	   nsubs;
+  struct lib_dir **subs;	/* all sub-directories not beginning with '.' */
+  struct lib_dir *next;		/* in the list of directories to check */
+};
+
+static struct lib_dir	*lib_roots[N_LIB_MAX + 1];
+static int		 num_lib_roots = 0;
+static struct lib_dir	*lib_dirs_todo = NULL;
+static Boolean		 lib_dirs_changed = False;
+static XtWorkProcId	 scan_proc = 0;
+
 char		**library_objects_texts=NULL;
 F_libobject	**lib_compounds=NULL;
 
@@ -159,9 +183,16 @@ static Position xposn, yposn;
 
 static Boolean	MakeObjectLibrary(char *library_dir, char **objects_names, F_libobject **libobjects),MakeLibraryFileList(char *dir_name, char **obj_list);
 static int	MakeLibrary(void);
-static Boolean	ScanLibraryDirectory(Boolean at_top, struct lib_rec **librec, char *path, char *longname, char *name, Boolean *figs_at_top, int *nentries);
+static Boolean	PutLibraryTree(Boolean at_top, struct lib_rec **librec, struct lib_dir *dir, char *longname, Boolean *figs_at_top, int *nentries);
+static struct lib_dir *library_dir_tree(char *path);
 static Boolean	PutLibraryEntry(struct lib_rec *librec, char *path, char *lname, char *name);
 static Boolean	lib_just_loaded, icons_made;
+static Boolean	icon_missing[N_LIB_OBJECT_MAX];	/* not in the icon cache */
+static int	next_icon;			/* to make by make_icons() */
+static XtWorkProcId icons_proc = 0;
+static libcache	*icon_cache = NULL;		/* of the library loaded */
+static Boolean	make_icons(XtPointer client_data);
+static void	icons_done(void);
 static Boolean	load_lib_obj(int obj);
 static Widget	make_library_menu(Widget parent, char *name, struct lib_rec **librec, int num);
 
@@ -209,6 +240,13 @@ static void
 library_dismiss(void)
 {
   XtPopdown(library_popup);
+  /* stop drawing icons, the user is going to place an object */
+  if (icons_proc != 0) {
+    XtRemoveWorkProc(icons_proc);
+    icons_proc = 0;
+    library_stop_request = True;
+    icons_done();
+  }
   put_selected_request();
 }
 
@@ -1226,115 +1264,396 @@ PutLibraryEntry(struct lib_rec *librec, char *path, char *lname, char *name)
     return True;
 }
 
-/* scan a library directory and its sub-directories */
+static struct lib_dir *
+new_lib_dir(char *path)
+{
+    struct lib_dir *d;
+
+    if ((d = (struct lib_dir *) calloc(1, sizeof(struct lib_dir))) == NULL)
+	return NULL;
+    if ((d->path = strdup(path)) == NULL) {
+	free(d);
+	return NULL;
+    }
+    d->mtime = -1;
+    return d;
+}
+
+static void
+free_lib_dir(struct lib_dir *d)
+{
+    int		 i;
+
+    for (i = 0; i < d->nsubs; i++)
+	if (d->subs[i])
+	    free_lib_dir(d->subs[i]);
+    free(d->subs);
+    free(d->path);
+    free(d);
+}
+
+static void
+queue_lib_dir(struct lib_dir *d)
+{
+    d->queued = True;
+    d->next = lib_dirs_todo;
+    lib_dirs_todo = d;
+}
+
+/*
+ * Check a library directory. Read it only if it changed since it was read,
+ * and queue its sub-directories to be checked.
+ */
+
+static void
+check_lib_dir(struct lib_dir *d)
+{
+    DIR		*dirp;
+    DIRSTRUCT	*dp;
+    struct stat	 st;
+    struct lib_dir **subs, **s, *sub;
+    char	 path2[PATH_MAX];
+    int		 nsubs, max_subs, i;
+    Boolean	 found;
+
+    found = stat(d->path, &st) == 0;
+    if (found && (long) st.st_mtime == d->mtime) {
+	for (i = 0; i < d->nsubs; i++)
+	    queue_lib_dir(d->subs[i]);
+	return;
+    }
+
+    lib_dirs_changed = True;
+    d->mtime = -1;
+    d->figs = False;
+    subs = NULL;
+    nsubs = max_subs = 0;
+    if (found && (dirp = opendir(d->path)) != NULL) {
+	d->mtime = (long) st.st_mtime;
+	for (dp = readdir(dirp); dp != NULL; dp = readdir(dirp)) {
+	    if (dp->d_name[0] == '.')
+		continue;
+	    if (!IsDirEntry(d->path, dp)) {
+		if (strstr(dp->d_name, ".fig") != NULL)
+		    d->figs = True;
+		continue;
+	    }
+	    if (strlen(d->path) + strlen(dp->d_name) + 2 > PATH_MAX-1) {
+		file_msg("Library path too long: %s/%s", d->path, dp->d_name);
+		continue;
+	    }
+	    sprintf(path2, "%s/%s", d->path, dp->d_name);
+	    /* keep what is known about a sub-directory read before */
+	    for (i = 0; i < d->nsubs; i++)
+		if (d->subs[i] && strcmp(d->subs[i]->path, path2) == 0)
+		    break;
+	    if (i < d->nsubs) {
+		sub = d->subs[i];
+		d->subs[i] = NULL;
+	    } else if ((sub = new_lib_dir(path2)) == NULL) {
+		continue;
+	    }
+	    if (nsubs == max_subs) {
+		max_subs = max_subs ? 2 * max_subs : 16;
+		s = (struct lib_dir **) realloc(subs,
+				max_subs * sizeof(struct lib_dir *));
+		if (s == NULL) {
+		    free_lib_dir(sub);
+		    break;
+		}
+		subs = s;
+	    }
+	    subs[nsubs++] = sub;
+	}
+	closedir(dirp);
+    }
+
+    /* free the sub-directories that are gone */
+    for (i = 0; i < d->nsubs; i++)
+	if (d->subs[i])
+	    free_lib_dir(d->subs[i]);
+    free(d->subs);
+    d->subs = subs;
+    d->nsubs = nsubs;
+    for (i = 0; i < nsubs; i++)
+	queue_lib_dir(subs[i]);
+}
+
+static Boolean
+lib_cache_name(char *name)
+{
+    char	*home;
+
+    if ((home = getenv("HOME")) == NULL || *home == '\0' ||
+		strlen(home) + sizeof LIB_DIRS_CACHE + 8 > PATH_MAX)
+	return False;
+    sprintf(name, "%s/%s", home, LIB_DIRS_CACHE);
+    return True;
+}
+
+/* read a directory and its sub-directories from the cache */
+
+static struct lib_dir *
+read_lib_dir(FILE *fp, int depth)
+{
+    struct lib_dir *d;
+    char	 line[PATH_MAX + 64];
+    long	 mtime;
+    int		 figs, nsubs, n;
+
+    if (depth > 64 || fgets(line, sizeof line, fp) == NULL ||
+		sscanf(line, "%ld %d %d %n", &mtime, &figs, &nsubs, &n) != 3 ||
+		nsubs < 0 || nsubs > 100000)
+	return NULL;
+    line[strcspn(line, "\n")] = '\0';
+    if ((d = new_lib_dir(line + n)) == NULL)
+	return NULL;
+    d->mtime = mtime;
+    d->figs = figs != 0;
+    if (nsubs > 0 && (d->subs = (struct lib_dir **)
+			malloc(nsubs * sizeof(struct lib_dir *))) == NULL) {
+	free_lib_dir(d);
+	return NULL;
+    }
+    while (d->nsubs < nsubs) {
+	if ((d->subs[d->nsubs] = read_lib_dir(fp, depth + 1)) == NULL) {
+	    free_lib_dir(d);
+	    return NULL;
+	}
+	d->nsubs++;
+    }
+    return d;
+}
+
+static void
+read_lib_cache(void)
+{
+    static Boolean read = False;
+    FILE	*fp;
+    char	 name[PATH_MAX], line[64];
+    struct lib_dir *d;
+
+    if (read)
+	return;
+    read = True;
+    if (!lib_cache_name(name) || (fp = fopen(name, "r")) == NULL)
+	return;
+    if (fgets(line, sizeof line, fp) != NULL &&
+		strcmp(line, LIB_DIRS_ID "\n") == 0)
+	while (num_lib_roots < N_LIB_MAX && (d = read_lib_dir(fp, 0)) != NULL)
+	    lib_roots[num_lib_roots++] = d;
+    fclose(fp);
+}
+
+static Boolean
+write_lib_dir(FILE *fp, struct lib_dir *d)
+{
+    int		 i;
+
+    if (fprintf(fp, "%ld %d %d %s\n", d->mtime, d->figs, d->nsubs,
+		d->path) < 0)
+	return False;
+    for (i = 0; i < d->nsubs; i++)
+	if (!write_lib_dir(fp, d->subs[i]))
+	    return False;
+    return True;
+}
+
+/* write the library directories in use */
+
+static void
+write_lib_cache(void)
+{
+    FILE	*fp;
+    char	 name[PATH_MAX], tmp[PATH_MAX + 8];
+    Boolean	 ok;
+    int		 i;
+
+    if (!lib_cache_name(name))
+	return;
+    sprintf(tmp, "%s.%d", name, (int)getpid());
+    if ((fp = fopen(tmp, "w")) == NULL)
+	return;
+    ok = fprintf(fp, "%s\n", LIB_DIRS_ID) > 0;
+    for (i = 0; i < num_lib_roots && ok; i++)
+	if (lib_roots[i]->queued)
+	    ok = write_lib_dir(fp, lib_roots[i]);
+    if (fclose(fp) != 0 || !ok || rename(tmp, name) != 0)
+	unlink(tmp);
+}
+
+/* the library directory path, read from the cache or new, queued for checking */
+
+static struct lib_dir *
+lib_root(char *path)
+{
+    struct lib_dir *d;
+    int		 i;
+
+    for (i = 0; i < num_lib_roots; i++)
+	if (strcmp(lib_roots[i]->path, path) == 0)
+	    break;
+    if (i < num_lib_roots) {
+	d = lib_roots[i];
+    } else {
+	if (num_lib_roots == N_LIB_MAX || (d = new_lib_dir(path)) == NULL)
+	    return NULL;
+	lib_roots[num_lib_roots++] = d;
+    }
+    if (!d->queued)
+	queue_lib_dir(d);
+    return d;
+}
+
+static void
+check_next_lib_dir(void)
+{
+    struct lib_dir *d;
+
+    d = lib_dirs_todo;
+    lib_dirs_todo = d->next;
+    check_lib_dir(d);
+}
+
+/* check one library directory each time xfig is idle */
+
+static Boolean
+scan_library(XtPointer client_data)
+{
+    (void)client_data;
+    if (lib_dirs_todo) {
+	check_next_lib_dir();
+	return False;
+    }
+    scan_proc = 0;
+    if (lib_dirs_changed)
+	write_lib_cache();
+    lib_dirs_changed = False;
+    return True;
+}
+
+/*
+ * Start checking the library directories in the background, so that the
+ * library panel can be opened without waiting for them to be read.
+ */
+
+void
+start_library_scan(void)
+{
+    FILE	*file;
+    struct stat	 st;
+    char	*path;
+    char	 s[N_LIB_LINE_MAX], path2[N_LIB_NAME_MAX];
+
+    path = appres.library_dir;
+    if (path == NULL || stat(path, &st) != 0)
+	return;
+    read_lib_cache();
+    if (S_ISDIR(st.st_mode)) {
+	(void) lib_root(path);
+    } else if ((file = fopen(path, "r")) != NULL) {
+	/* a file with a list of libraries */
+	while (fgets(s, N_LIB_LINE_MAX, file) != NULL)
+	    if (s[0] != '#' && sscanf(s, "%s", path2) == 1)
+		(void) lib_root(path2);
+	fclose(file);
+    }
+    if (lib_dirs_todo && scan_proc == 0)
+	scan_proc = XtAppAddWorkProc(tool_app, scan_library, NULL);
+}
+
+/* the library directory path and its sub-directories, checked */
+
+static struct lib_dir *
+library_dir_tree(char *path)
+{
+    struct lib_dir *d;
+
+    read_lib_cache();
+    d = lib_root(path);
+    /* finish what was not checked in the background */
+    if (scan_proc != 0) {
+	XtRemoveWorkProc(scan_proc);
+	scan_proc = 0;
+    }
+    while (lib_dirs_todo)
+	check_next_lib_dir();
+    if (lib_dirs_changed)
+	write_lib_cache();
+    lib_dirs_changed = False;
+    return d;
+}
+
+/* put a library directory and its sub-directories into lib_rec records */
 /* Inputs:
 	librec	- pointer to lib_rec record to put entry
-	path	- absolute path of library entry
+	dir	- the library directory
 	longname - name with parents prepended (e.g. Electrical / Physical)
-	name	- name of library
    Outputs:
 	figs_at_top - whether or not there are Fig files in toplevel
 	nentries - number of directories found (including subdirectories)
 */
 
 static Boolean
-ScanLibraryDirectory(Boolean at_top, struct lib_rec **librec, char *path, char *longname, char *name, Boolean *figs_at_top, int *nentries)
+PutLibraryTree(Boolean at_top, struct lib_rec **librec, struct lib_dir *dir, char *longname, Boolean *figs_at_top, int *nentries)
 {
-    DIR		*dirp;
-    DIRSTRUCT	*dp;
     struct lib_rec *lp;
-    struct stat	 st;
-    char	 path2[PATH_MAX], lname[N_LIB_NAME_MAX];
+    char	 lname[N_LIB_NAME_MAX], name[N_LIB_NAME_MAX], *c;
     int		 recnum, i;
 
-    dirp = opendir(path);
-    if (dirp == NULL) {
-	file_msg("Can't open directory: %s", path);
-	*nentries = 0;
+    *nentries = 0;
+    *figs_at_top = dir->figs;
+    if (dir->mtime < 0) {
+	file_msg("Can't open directory: %s", dir->path);
 	return False;
     }
 
     recnum = 0;
-
-    /* read the directory to see if there are any .fig files at this level */
-    *figs_at_top = False;
-    for (dp = readdir(dirp); dp != NULL; dp = readdir(dirp)) {
-	if (strstr(dp->d_name,".fig") != NULL && !IsDirectory(path, dp->d_name)) {
-	    /* is a file with .fig in the name */
-	    *figs_at_top = True;
-	    /* if we're at the toplevel scan, put this directory first */
-	    if (at_top) {
-		/* toplevel has .fig files, make a library_rec entry for it */
-		librec[0] = (struct lib_rec *) malloc(sizeof(struct lib_rec));
-		if (librec[0] == 0)
-		    return False;
-		PutLibraryEntry(librec[0], path, "(Toplevel Directory)", "(Toplevel Directory)");
-		recnum++;
-	    }
-	    break;
-	}
+    /* if we're at the toplevel and it has .fig files, put this directory first */
+    if (at_top && dir->figs) {
+	librec[0] = (struct lib_rec *) malloc(sizeof(struct lib_rec));
+	if (librec[0] == 0)
+	    return False;
+	PutLibraryEntry(librec[0], dir->path, "(Toplevel Directory)", "(Toplevel Directory)");
+	recnum++;
     }
 
-    /* now read the directory for the subdirectories */
-    rewinddir(dirp);
-    for (dp = readdir(dirp); dp != NULL; dp = readdir(dirp)) {
-
-	if (strlen(path) + strlen(dp->d_name) + 2 > PATH_MAX-1) {
-            file_msg("Library path too long: %s/%s", path, dp->d_name);
-	    continue;
+    for (i = 0; i < dir->nsubs && recnum < N_LIB_MAX; i++) {
+	c = strrchr(dir->subs[i]->path, '/') + 1;
+	if (strlen(longname) == 0) {
+	    /* check length of name */
+	    if (strlen(c) >= N_LIB_NAME_MAX)
+		continue;
+	    strcpy(lname, c);
+	} else {
+	    /* check length of resulting name */
+	    if (strlen(longname)+strlen(c)+3 >= N_LIB_NAME_MAX)
+		continue;
+	    sprintf(lname, "%s / %s",longname, c);
 	}
-	sprintf(path2, "%s/%s", path, dp->d_name);
-	/* check if directory or file */
-	if (stat(path2, &st) == 0) {
-	    if (S_ISDIR(st.st_mode)) {
-		/* directory, scan any sub-directories recursively */
-		if (dp->d_name[0] != '.') {
-		    if (strlen(longname) == 0) {
-			/* check length of name */
-			if (strlen(dp->d_name) > N_LIB_NAME_MAX)
-			    continue;
-			strcpy(lname, dp->d_name);
-		    } else {
-			/* check length of resulting name */
-			if (strlen(longname)+strlen(dp->d_name)+3 > N_LIB_NAME_MAX)
-			    continue;
-			sprintf(lname, "%s / %s",longname, dp->d_name);
-		    }
-		    /* allocate an entry for this subdir name */
-		    librec[recnum] = (struct lib_rec *) malloc(sizeof(struct lib_rec));
-		    if (librec[recnum] == 0) {
-			/* close the directory */
-			closedir(dirp);
-			/* free allocations */
-			for (i=0; i<recnum-1; i++)
-			    free(librec[i]);
-			return False;
-		    }
-		    lp = librec[recnum];
-		    PutLibraryEntry(lp, path2, lname, dp->d_name);
-		    recnum++;
-		    /* and recurse */
-		    if (!ScanLibraryDirectory(False, lp->subdirs, path2, lname, dp->d_name,
-				&lp->figs_at_top, &lp->nsubs)) {
-			/* close the directory */
-			closedir(dirp);
-			/* free allocations */
-			for (i=0; i<recnum; i++)
-			    free(librec[i]);
-			return False;
-		    }
-		    /* if there are no .fig files in this directory and there
-		       are no subdirs, remove this entry */
-		    if (!lp->figs_at_top && lp->nsubs == 0) {
-			recnum--;
-			/* free the space */
-			free(librec[recnum]);
-		    }
-		}
-	    }
+	strcpy(name, c);
+	/* allocate an entry for this subdir name */
+	librec[recnum] = (struct lib_rec *) malloc(sizeof(struct lib_rec));
+	if (librec[recnum] == 0) {
+	    /* free allocations */
+	    while (--recnum >= 0)
+		free(librec[recnum]);
+	    return False;
+	}
+	lp = librec[recnum];
+	PutLibraryEntry(lp, dir->subs[i]->path, lname, name);
+	recnum++;
+	/* and recurse */
+	(void) PutLibraryTree(False, lp->subdirs, dir->subs[i], lname,
+			&lp->figs_at_top, &lp->nsubs);
+	/* if there are no .fig files in this directory and there
+	   are no subdirs, remove this entry */
+	if (!lp->figs_at_top && lp->nsubs == 0) {
+	    recnum--;
+	    /* free the space */
+	    free(librec[recnum]);
 	}
     }
-    closedir(dirp);
     if (recnum > 0) {
 	/* sort them since the order of files in directories is not necessarily alphabetical */
 	qsort(&librec[0], recnum, sizeof(struct lib_rec *), (int (*)())*LRComp);
@@ -1354,6 +1673,7 @@ MakeLibrary(void)
 {
     FILE	*file;
     struct stat	 st;
+    struct lib_dir *dir;
     char	*path;
     char	 *c, s[N_LIB_LINE_MAX], name[N_LIB_NAME_MAX],path2[N_LIB_NAME_MAX];
     int		 num, numlibs;
@@ -1366,7 +1686,9 @@ MakeLibrary(void)
 	return 0;
     } else if (S_ISDIR(st.st_mode)) {
 	/* if it is directory, scan the sub-directories and search libraries */
-	(void) ScanLibraryDirectory(True, library_rec, path, "", "", &dum, &numlibs);
+	if ((dir = library_dir_tree(path)) == NULL)
+	    return 0;
+	(void) PutLibraryTree(True, library_rec, dir, "", &dum, &numlibs);
 	return numlibs;
     } else {
 	/* if it is a file, it must contain list of libraries */
@@ -1396,7 +1718,10 @@ MakeLibrary(void)
 		}
 		PutLibraryEntry(library_rec[numlibs], path2, name, name);
 		/* and attach its subdirectories */
-		(void) ScanLibraryDirectory(True, library_rec[numlibs]->subdirs, path2, name, "",
+		num = 0;
+		library_rec[numlibs]->figs_at_top = False;
+		if ((dir = library_dir_tree(path2)) != NULL)
+		    (void) PutLibraryTree(True, library_rec[numlibs]->subdirs, dir, name,
 					&library_rec[numlibs]->figs_at_top, &num);
 		library_rec[numlibs]->nsubs = num;
 		numlibs++;
@@ -1418,6 +1743,15 @@ MakeObjectLibrary(char *library_dir, char **objects_names, F_libobject **libobje
     int		itm, j;
     int		num_old_items;
     Boolean	flag, status;
+    char	fname[N_LIB_NAME_MAX + 4];
+
+    /* stop drawing the icons of the previous library */
+    if (icons_proc != 0) {
+	XtRemoveWorkProc(icons_proc);
+	icons_proc = 0;
+	libcache_close(icon_cache);
+	icon_cache = NULL;
+    }
 
     flag = True;
     /* we don't yet have the new icons */
@@ -1468,8 +1802,11 @@ MakeObjectLibrary(char *library_dir, char **objects_names, F_libobject **libobje
 	    SetValues(library_menu_button);
 	    SetValues(icon_size_button);
 	}
+	/* take the icons from the cache, make the others in make_icons() */
+	icon_cache = libcache_open(library_dir, appres.library_icon_size);
+	next_icon = -1;
         itm = 0;
-        while ((objects_names[itm]!=NULL) && (flag==True)) {
+        while (objects_names[itm]!=NULL) {
 	    /* free any previous compound objects */
 	    if (libobjects[itm]->compound != NULL) {
 		free_compound(&libobjects[itm]->compound);
@@ -1480,8 +1817,12 @@ MakeObjectLibrary(char *library_dir, char **objects_names, F_libobject **libobje
 		lib_icons[itm] = XCreatePixmap(tool_d, canvas_win,
 					appres.library_icon_size, appres.library_icon_size,
 					tool_dpth);
-	    /* preview the object into this pixmap */
-	    status = preview_libobj(itm, lib_icons[itm], appres.library_icon_size, 4);
+	    sprintf(fname, "%s.fig", objects_names[itm]);
+	    status = libcache_get(icon_cache, fname, lib_icons[itm],
+				appres.library_icon_size,
+				appres.library_icon_size, NULL);
+	    if ((icon_missing[itm] = !status) && next_icon < 0)
+		next_icon = itm;
 	    /* finally, make the "button" */
 	    if (!lib_buttons[itm]) {
 		FirstArg(XtNborderWidth, 1);
@@ -1505,15 +1846,10 @@ MakeObjectLibrary(char *library_dir, char **objects_names, F_libobject **libobje
 				XtParseTranslationTable(object_icon_translations));
 		XtManageChild(lib_buttons[itm]);
 	    }
-	    /* let the user see it right away */
-	    process_pending();
 	    itm++;
-	    /* if user has requested to stop loading */
-	    if (library_stop_request) {
-		/* make stop button insensitive */
-	        XtSetSensitive(stop, False);
-		break;
-	    }
+	    /* let the user see them soon */
+	    if (itm % 64 == 0)
+		process_pending();
         }
 	if (appres.icon_view) {
 	    /* now we have the icons (used in sel_view) */
@@ -1528,16 +1864,16 @@ MakeObjectLibrary(char *library_dir, char **objects_names, F_libobject **libobje
 	    lib_buttons[j] = (Widget) 0;
 	    lib_icons[j] = (Pixmap) 0;
 	}
-	/* re-enable menu buttons (we don't check for appres.icon_view because
-	   the user may have switched to list view while we were building the pixmaps */
-	FirstArg(XtNsensitive, True);
-	SetValues(library_menu_button);
-	SetValues(icon_size_button);
 
-	if (library_stop_request)
-            libraryStatus("aborted - %d objects loaded out of %d in library",itm,num_list_items);
-	else
-            libraryStatus("%d library objects in library",num_list_items);
+	/* draw the icons not in the cache while the user may look around */
+	if (next_icon >= 0) {
+	    libraryStatus("%d library objects in library, drawing icons",
+			num_list_items);
+	    if (icons_proc == 0)
+		icons_proc = XtAppAddWorkProc(tool_app, make_icons, NULL);
+	} else {
+	    icons_done();
+	}
     } else {
 	flag = False;
     }
@@ -1547,6 +1883,73 @@ MakeObjectLibrary(char *library_dir, char **objects_names, F_libobject **libobje
     return flag;
 }
 
+/*
+ * Draw the next icon not found in the cache, each time xfig is idle. After
+ * the last one, or if the user pressed Stop, write the icon cache.
+ */
+
+static Boolean
+make_icons(XtPointer client_data)
+{
+    Boolean	status;
+    int		itm;
+    char	fname[N_LIB_NAME_MAX + 4];
+
+    (void)client_data;
+    /* try again after another preview */
+    if (preview_in_progress)
+	return False;
+    while (next_icon < num_list_items && !icon_missing[next_icon])
+	next_icon++;
+    if (library_stop_request || next_icon >= num_list_items) {
+	icons_proc = 0;
+	icons_done();
+	return True;
+    }
+
+    itm = next_icon++;
+    icon_missing[itm] = False;
+    /* preview the object into this pixmap */
+    background_preview = True;
+    status = preview_libobj(itm, lib_icons[itm], appres.library_icon_size, 4);
+    background_preview = False;
+    if (status) {
+	sprintf(fname, "%s.fig", cur_objects_names[itm]);
+	libcache_put(icon_cache, fname, lib_icons[itm],
+		    appres.library_icon_size, appres.library_icon_size, NULL);
+	FirstArg(XtNbitmap, lib_icons[itm]);
+	SetValues(lib_buttons[itm]);
+	XtAugmentTranslations(lib_buttons[itm],
+		    XtParseTranslationTable(object_icon_translations));
+    }
+    return False;
+}
+
+static void
+icons_done(void)
+{
+    int		itm, made;
+
+    libcache_close(icon_cache);
+    icon_cache = NULL;
+    /* re-enable menu buttons (we don't check for appres.icon_view because
+       the user may have switched to list view while we were building the pixmaps */
+    FirstArg(XtNsensitive, True);
+    SetValues(library_menu_button);
+    SetValues(icon_size_button);
+    XtSetSensitive(stop, False);
+
+    if (library_stop_request) {
+	for (itm = made = 0; itm < num_list_items; itm++)
+	    if (!icon_missing[itm])
+		made++;
+	libraryStatus("aborted - %d icons drawn out of %d in library",
+			made, num_list_items);
+    } else {
+	libraryStatus("%d library objects in library",num_list_items);
+    }
+}
+
 /* get the list of files in the library dir_name and put in obj_list[] */
 
 static Boolean
@@ -1578,7 +1981,7 @@ MakeLibraryFileList(char *dir_name, char **obj_list)
     if ((numobj+1<N_LIB_OBJECT_MAX) && (dp->d_name[0] != '.') &&
 	((c=strstr(dp->d_name,".fig")) != NULL) &&
 	(strstr(dp->d_name,".fig.bak") == NULL)) {
-	    if (!IsDirectory(dir_name, dp->d_name)) {
+	    if (!IsDirEntry(dir_name, dp)) {
 		*c='\0';
 		strcpy(obj_list[numobj],dp->d_name);
 		numobj++;
@@ -1763,6 +2166,9 @@ sel_item_icon(Widget w, XButtonEvent *ev)
     lib_just_loaded = False;
     for (i=0; i<num_list_items; i++) {
 	if (strcmp(which_name, XtName(lib_buttons[i]))==0) {
+	    /* the icon may be from the cache, read the object */
+	    if (load_lib_obj(i) == False)
+		break;
 	    /* uncolor the border of the *previously selected* icon */
 	    unsel_icon(cur_library_object);
 	    cur_library_object = which_num = old_item = i;
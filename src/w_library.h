@@ -29,4 +29,5 @@ extern F_libobject **lib_compounds;
 extern char	   **library_objects_texts;
 
 extern void	popup_library_panel(void);
+extern void	start_library_scan(void);
 extern void set_comments(char *comments);
@@ -46,6 +46,7 @@
 
 Boolean		popup_up = False;
 Boolean		file_msg_is_popped=False;
+Boolean		quiet_msgs = False;	/* drop messages, e.g., of a preview drawn in the background */
 Widget		file_msg_popup;
 Boolean		first_file_msg;
 Boolean		first_lenmsg = True;
@@ -117,6 +118,8 @@ put_msg(char *format,...)
 {
     va_list ap;
 
+    if (quiet_msgs)
+	return;
     va_start(ap, format);
     vsprintf(prompt, format, ap );
     va_end(ap);
@@ -572,6 +575,8 @@ file_msg(char *format,...)
     XawTextBlock block;
     va_list ap;
 
+    if (quiet_msgs)
+	return;
     if (!update_figs) {
 	popup_file_msg();
 	if (first_file_msg) {
@@ -588,7 +593,11 @@ file_msg(char *format,...)
 
     strcat(tmpstr,"\n");
     if (update_figs) {
-       fprintf(stderr, "%s", tmpstr);
+       /* several files may be updated concurrently, name the file */
+       if (read_file_name)
+	   fprintf(stderr, "%s: %s", read_file_name, tmpstr);
+       else
+	   fprintf(stderr, "%s", tmpstr);
     } else {
 	/* append this message to the file message widget string */
 	block.firstPos = 0;
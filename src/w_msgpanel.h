@@ -28,6 +28,7 @@ extern void	make_dimension_string(float length, char *str, Boolean square);
 extern Boolean	popup_up;
 extern Boolean	first_file_msg;
 extern Boolean	file_msg_is_popped;
+extern Boolean	quiet_msgs;
 extern Widget	file_msg_popup;
 extern Boolean	first_lenmsg;
 
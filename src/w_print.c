@@ -343,6 +343,8 @@ do_print_batch(Widget w)
 	save_exp_lang = cur_exp_lang;
 	cur_exp_lang = LANG_PS;
 	print_to_file(tmp_exp_file, 0,0, backgrnd, NULL, False, 0, grid);
+	/* the export runs in the background, but the file is needed now */
+	wait_export_jobs();
 	cur_exp_lang = save_exp_lang;
 	put_msg("Appending to batch file \"%s\" (%s mode) ... done",
 		    batch_file, appres.landscape ? "LANDSCAPE" : "PORTRAIT");
@@ -40,15 +40,11 @@
 /* ---------------------------------------------------------------------- */
 
 
-/* Make sure cache size is set */
+/* The cache size is limited by appres.rotated_text_cache, kilobytes.
+   Items are looked up in a hash table and evicted least recently used
+   first. */
 
-#ifndef CACHE_SIZE_LIMIT
-#define CACHE_SIZE_LIMIT 0
-#endif /*CACHE_SIZE_LIMIT */
-
-/* Cache by FID if can't find name because OpenWindows screws up */
-
-#define CACHE_FID
+#define CACHE_BUCKETS	1024
 
 /* Make sure a cache method is specified */
 
@@ -100,10 +96,22 @@ typedef struct rotated_text_item_template {
     long int size;
     int cached;
 
-    struct rotated_text_item_template *next;
+    long angle_key;		/* the angle in 1/10000 radians */
+    int align_key;		/* the horizontal alignment, -1 for one line */
+    unsigned int bucket;
+
+    struct rotated_text_item_template *next;	/* more recently used */
+    struct rotated_text_item_template *prev;	/* less recently used */
+    struct rotated_text_item_template *hnext;	/* next in bucket */
 } RotatedTextItem;
 
-RotatedTextItem *first_text_item=NULL;
+RotatedTextItem *first_text_item=NULL;		/* least recently used */
+static RotatedTextItem *last_text_item=NULL;	/* most recently used */
+static RotatedTextItem *cache_table[CACHE_BUCKETS];
+static long cache_size=0;
+static long cache_items=0;
+static long cache_hits=0;
+static long cache_misses=0;
 
 
 /* ---------------------------------------------------------------------- */
@@ -141,6 +149,7 @@ static RotatedTextItem *XRotRetrieveFromCache(Display *dpy, XFontStruct *font, f
 static RotatedTextItem *XRotCreateTextItem(Display *dpy, XFontStruct *font, float angle, char *text, int align);
 static void             XRotAddToLinkedList(Display *dpy, RotatedTextItem *item);
 static void             XRotFreeTextItem(Display *dpy, RotatedTextItem *item);
+static void             XRotUnlinkItem(RotatedTextItem *item);
 static XImage          *XRotMagnifyImage(Display *dpy, XImage *ximage);
 
 
@@ -696,85 +705,58 @@ XRotDrawHorizontalString(Display *dpy, XFontStruct *font, Drawable drawable, GC
 static RotatedTextItem
 *XRotRetrieveFromCache(Display *dpy, XFontStruct *font, float angle, char *text, int align)
 {
-    Font fid;
-    char *font_name=NULL;
-    unsigned long name_value;
-    RotatedTextItem *item=NULL;
-    RotatedTextItem *i1=first_text_item;
-
-    /* get font name, if it exists */
-    if (XGetFontProperty(font, XA_FONT, &name_value)) {
-	DEBUG_PRINT1("got font name OK\n");
-	font_name=XGetAtomName(dpy, name_value);
-	fid=0;
-    }
-#ifdef CACHE_FID
-    /* otherwise rely (unreliably?) on font ID */
-    else {
-	DEBUG_PRINT1("can't get fontname, caching FID\n");
-	font_name=NULL;
-	fid=font->fid;
-    }
-#else
-    /* not allowed to cache font ID's */
-    else {
-	DEBUG_PRINT1("can't get fontname, can't cache\n");
-	font_name=NULL;
-	fid=0;
-    }
-#endif /*CACHE_FID*/
-
-    /* look for a match in cache */
+    RotatedTextItem *item;
+    long angle_key;
+    int align_key;
+    unsigned int h;
+    char *c;
 
     /* matching formula:
        identical text;
-       identical fontname (if defined, font ID's if not);
-       angles close enough (<0.0001 here, could be smaller);
+       identical font ID, fonts are not unloaded while xfig runs;
+       angles equal to 1/10000 radians;
        HORIZONTAL alignment matches, OR it's a one line string;
        magnifications the same */
 
-    while(i1 && !item) {
-	/* match everything EXCEPT fontname/ID */
-	if (strcmp(text, i1->text)==0 &&
-	   fabs(angle-i1->angle)<0.0001 &&
-	   style.magnify==i1->magnify &&
-	   (i1->nl==1 ||
-	    ((align==0)?9:(align-1))%3==
-	      ((i1->align==0)?9:(i1->align-1))%3)) {
-
-	    /* now match fontname/ID */
-	    if (font_name!=NULL && i1->font_name!=NULL) {
-		if (strcmp(font_name, i1->font_name)==0) {
-		    item=i1;
-		    DEBUG_PRINT1("Matched against font names\n");
-		}
-		else
-		    i1=i1->next;
-	    }
-#ifdef CACHE_FID
-	    else if (font_name==NULL && i1->font_name==NULL) {
-		if (fid==i1->fid) {
-		    item=i1;
-		    DEBUG_PRINT1("Matched against FID's\n");
-                }
-		else
-                    i1=i1->next;
+    angle_key=lround(angle*10000.0);
+    align_key= -1;
+    if (align!=NONE)
+	for (c=text; c[0]!='\0' && c[1]!='\0'; c++)
+	    if (*c=='\n') {
+		align_key=((align==0)?9:(align-1))%3;
+		break;
 	    }
-#endif /*CACHE_FID*/
+
+    h=(unsigned int)font->fid*31u + (unsigned int)angle_key*7u +
+	(unsigned int)(align_key+1) + (unsigned int)(style.magnify*100.0);
+    for (c=text; *c!='\0'; c++)
+	h=h*33u + (unsigned char)*c;
+    h%=CACHE_BUCKETS;
+
+    for (item=cache_table[h]; item!=NULL; item=item->hnext)
+	if (item->fid==font->fid && item->angle_key==angle_key &&
+	    item->align_key==align_key && item->magnify==style.magnify &&
+	    strcmp(item->text, text)==0)
+	    break;
+
+    if (item) {
+	DEBUG_PRINT1("**Found target in cache.\n");
+	cache_hits++;
+	/* most recently used now */
+	if (item!=last_text_item) {
+	    XRotUnlinkItem(item);
+	    item->prev=last_text_item;
+	    item->next=NULL;
+	    if (last_text_item)
+		last_text_item->next=item;
 	    else
-		i1=i1->next;
+		first_text_item=item;
+	    last_text_item=item;
 	}
-	else
-	    i1=i1->next;
     }
-
-    if (item)
-	DEBUG_PRINT1("**Found target in cache.\n");
-    if (!item)
+    else {
 	DEBUG_PRINT1("**No match in cache.\n");
-
-    /* no match */
-    if (!item) {
+	cache_misses++;
 	/* create new item */
 	item=XRotCreateTextItem(dpy, font, angle, text, align);
 	if (!item)
@@ -782,28 +764,19 @@ static RotatedTextItem
 
 	/* record what it shows */
 	item->text=strdup(text);
-
-	/* fontname or ID */
-	if (font_name!=NULL) {
-	    item->font_name=strdup(font_name);
-	    item->fid=0;
-	}
-	else {
-	    item->font_name=NULL;
-	    item->fid=fid;
-	}
-
+	item->font_name=NULL;
+	item->fid=font->fid;
 	item->angle=angle;
 	item->align=align;
 	item->magnify=style.magnify;
+	item->angle_key=angle_key;
+	item->align_key=align_key;
+	item->bucket=h;
 
 	/* cache it */
 	XRotAddToLinkedList(dpy, item);
     }
 
-    if (font_name)
-	XFree(font_name);
-
     /* if XImage is cached, need to recreate the bitmap */
 
 #ifdef CACHE_XIMAGES
@@ -854,9 +827,12 @@ static RotatedTextItem
     float sin_angle, cos_angle;
     int it, jt;
     float di, dj;
+    float dj_sin, dj_cos;
     int ic=0;
     float xl, xr, xinc;
     int byte_out;
+    int i0, i1;
+    unsigned char bits;
     int dir, asc, desc;
     XCharStruct overall;
     int old_cols_in=0, old_rows_in=0;
@@ -1092,24 +1068,35 @@ static RotatedTextItem
     for(j=0; j<item->rows_out; j++) {
 
 	/* no point re-calculating these every pass */
-	di=(float)((xl<0)?0:(int)xl)+0.5-(float)item->cols_out/2;
+	i0=(xl<0)?0:(int)xl;
+	i1=(xr>=item->cols_out)?item->cols_out:(int)xr;
+	di=(float)i0+0.5-(float)item->cols_out/2;
 	byte_out=(item->rows_out-j-1)*byte_w_out;
+	dj_sin=dj*sin_angle;
+	dj_cos=dj*cos_angle;
 
-	/* loop through meaningful columns */
-	for(i=((xl<0)?0:(int)xl);
-	    i<((xr>=item->cols_out)?item->cols_out:(int)xr); i++) {
+	/* loop through meaningful columns, collect the bits of an output
+	   byte and store them at once */
+	bits=0;
+	for(i=i0; i<i1; i++) {
 
 	    /* rotate coordinates */
-	    it=(float)item->cols_in/2 + ( di*cos_angle + dj*sin_angle);
-	    jt=(float)item->rows_in/2 - (-di*sin_angle + dj*cos_angle);
+	    it=(float)item->cols_in/2 + ( di*cos_angle + dj_sin);
+	    jt=(float)item->rows_in/2 - (-di*sin_angle + dj_cos);
 
             /* set pixel if required */
             if (it>=0 && it<item->cols_in && jt>=0 && jt<item->rows_in)
                 if ((I_in->data[jt*byte_w_in+it/8] & 128>>(it%8))>0)
-                    item->ximage->data[byte_out+i/8]|=128>>i%8;
+                    bits|=128>>i%8;
 
+	    if (i%8==7 && bits) {
+		item->ximage->data[byte_out+i/8]|=bits;
+		bits=0;
+	    }
 	    di+=1;
 	}
+	if (bits)
+	    item->ximage->data[byte_out+(i-1)/8]|=bits;
 	dj+=1;
 	xl+=xinc;
 	xr+=xinc;
@@ -1154,10 +1141,8 @@ static RotatedTextItem
 static void
 XRotAddToLinkedList(Display *dpy, RotatedTextItem *item)
 {
-
-    static long int current_size=0;
-    static RotatedTextItem *last=NULL;
-    RotatedTextItem *i1=first_text_item, *i2=NULL;
+    long int limit=(long)appres.rotated_text_cache*1024;
+    RotatedTextItem *i1, **h;
 
 #ifdef CACHE_BITMAPS
 
@@ -1181,69 +1166,45 @@ XRotAddToLinkedList(Display *dpy, RotatedTextItem *item)
 
 #endif /*CACHE_BITMAPS */
 
-    /* count number of items in cache, for debugging */
-    if (appres.DEBUG) {
-	int i=0;
-
-	while(i1) {
-	    i++;
-	    i1=i1->next;
-	}
-	DEBUG_PRINT2("Cache has %d items.\n", i);
-	i1=first_text_item;
-    }
-
-    DEBUG_PRINT4("current cache size=%ld, new item=%ld, limit=%ld\n",
-		 current_size, item->size, CACHE_SIZE_LIMIT*1024);
-
     /* if this item is bigger than whole cache, forget it */
-    if (item->size>CACHE_SIZE_LIMIT*1024) {
+    if (item->size>limit) {
 	DEBUG_PRINT1("Too big to cache\n\n");
 	item->cached=0;
 	return;
     }
 
-    /* remove elements from cache as needed */
-    while(i1 && current_size+item->size>CACHE_SIZE_LIMIT*1024) {
-
-	DEBUG_PRINT2("Removed %d bytes\n", i1->size);
-
-	if (i1->font_name!=NULL)
-	    DEBUG_PRINT5("  (`%s'\n   %s\n   angle=%f align=%d)\n",
-			 i1->text, i1->font_name, i1->angle, i1->align);
+    /* remove the least recently used elements from cache as needed */
+    while((i1=first_text_item)!=NULL && cache_size+item->size>limit) {
 
-#ifdef CACHE_FID
-	if (i1->font_name==NULL)
-	    DEBUG_PRINT5("  (`%s'\n  FID=%ld\n   angle=%f align=%d)\n",
-                         i1->text, i1->fid, i1->angle, i1->align);
-#endif /*CACHE_FID*/
+	DEBUG_PRINT2("Removed %ld bytes\n", i1->size);
 
-	current_size-=i1->size;
-
-	i2=i1->next;
+	XRotUnlinkItem(i1);
+	for (h=&cache_table[i1->bucket]; *h!=i1; h=&(*h)->hnext)
+	    ;
+	*h=i1->hnext;
+	cache_size-=i1->size;
+	cache_items--;
 
 	/* free resources used by the unlucky item */
 	XRotFreeTextItem(dpy, i1);
-
-	/* remove it from linked list */
-	first_text_item=i2;
-	i1=i2;
     }
 
     /* add new item to end of linked list */
-    if (first_text_item==NULL) {
-	item->next=NULL;
+    item->next=NULL;
+    item->prev=last_text_item;
+    if (last_text_item)
+	last_text_item->next=item;
+    else
 	first_text_item=item;
-	last=item;
-    }
-    else {
-	item->next=NULL;
-	last->next=item;
-	last=item;
-    }
+    last_text_item=item;
+
+    /* and to its bucket */
+    item->hnext=cache_table[item->bucket];
+    cache_table[item->bucket]=item;
 
     /* new cache size */
-    current_size+=item->size;
+    cache_size+=item->size;
+    cache_items++;
 
     item->cached=1;
 
@@ -1254,6 +1215,45 @@ XRotAddToLinkedList(Display *dpy, RotatedTextItem *item)
 /* ---------------------------------------------------------------------- */
 
 
+/**************************************************************************/
+/*  Take a cached item off the list ordered by use                        */
+/**************************************************************************/
+
+static void
+XRotUnlinkItem(RotatedTextItem *item)
+{
+    if (item->prev)
+	item->prev->next=item->next;
+    else
+	first_text_item=item->next;
+    if (item->next)
+	item->next->prev=item->prev;
+    else
+	last_text_item=item->prev;
+    item->next=item->prev=NULL;
+}
+
+
+/* ---------------------------------------------------------------------- */
+
+
+/**************************************************************************/
+/*  Return the statistics of the cache                                    */
+/**************************************************************************/
+
+void
+XRotCacheStatistics(long *items, long *bytes, long *hits, long *misses)
+{
+    *items=cache_items;
+    *bytes=cache_size;
+    *hits=cache_hits;
+    *misses=cache_misses;
+}
+
+
+/* ---------------------------------------------------------------------- */
+
+
 /**************************************************************************/
 /*  Free the resources used by a text item                                */
 /**************************************************************************/
@@ -67,6 +67,7 @@ int     XRotDrawAlignedImageString(Display*, XFontStruct*, float,
                                    Drawable, GC, int, int, char*, int);
 XPoint *XRotTextExtents(XFontStruct*, float,
 			int, int, char*, int);
+void    XRotCacheStatistics(long*, long*, long*, long*);
 }
 
 #else
@@ -79,6 +80,7 @@ extern int     XRotDrawImageString(Display *dpy, XFontStruct *font, float angle,
 extern int     XRotDrawAlignedString(Display *dpy, XFontStruct *font, float angle, Drawable drawable, GC gc, int x, int y, char *text, int align);
 extern int     XRotDrawAlignedImageString(Display *dpy, XFontStruct *font, float angle, Drawable drawable, GC gc, int x, int y, char *text, int align);
 extern XPoint *XRotTextExtents(XFontStruct *font, float angle, int x, int y, char *text, int align);
+extern void    XRotCacheStatistics(long *items, long *bytes, long *hits, long *misses);
 
 #endif /* __cplusplus */
 
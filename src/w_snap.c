@@ -28,6 +28,7 @@
 #include "w_indpanel.h"
 #include "w_util.h"
 #include "w_msgpanel.h"
+#include "u_pick.h"
 #include "u_quartic.h"
 #include "u_search.h"
 #include "f_util.h"
@@ -114,16 +115,11 @@ snap_polyline_endpoint_handler(l, x, y)
      int x;
      int y;
 {
-  struct f_point * point;
-  double mind = HUGE_VAL;
-  for (point = l->points; point != NULL; point = point->next) {
-    double dist = hypot((double)(point->x - x), (double)(point->y - y));
-    if (dist < mind) {
-      mind = dist;
-      snap_gx = point->x;
-      snap_gy = point->y;
-      snap_found = True;
-    }
+  struct f_point * point = pick_nearest_point(O_POLYLINE, l, x, y);
+  if (point != NULL) {
+    snap_gx = point->x;
+    snap_gy = point->y;
+    snap_found = True;
   }
 }
 
@@ -851,7 +847,8 @@ snap_text_handler(t, x, y)
      int y;
 {
   F_line * f_line_p = build_text_bounding_box(t);
-  snap_polyline_handler(f_line_p, x, y);
+  if (f_line_p)
+    snap_polyline_handler(f_line_p, x, y);
   delete_text_bounding_box(f_line_p);
 }
 
@@ -36,6 +36,7 @@ It provides the following features:
 
  - Spell check all text objects and list misspelled words.
 
+The text objects are looked up in the text index, see u_textindex.c.
 There is currently no way to undo replace/update operations.
 
 ****************************************************************/
@@ -46,6 +47,8 @@ There is currently no way to undo replace/update operations.
 #include "object.h"
 #include "d_text.h"
 #include "e_update.h"
+#include "f_journal.h"
+#include "f_read.h"
 #include "f_util.h"
 #include "w_drawprim.h"
 #include "w_indpanel.h"
@@ -60,12 +63,14 @@ There is currently no way to undo replace/update operations.
 #include "u_bound.h"
 #include "u_fonts.h"
 #include "u_redraw.h"
+#include "u_textindex.h"
 #include "w_canvas.h"
 #include "w_color.h"
 
 #include <stdarg.h>
 
 #define MAX_MISSPELLED_WORDS	200
+#define MAX_REDRAW_TEXTS	200	/* else redraw the whole canvas */
 #define	SEARCH_WIDTH		496	/* width of search message and results */
 
 static String search_panel_translations =
@@ -87,8 +92,11 @@ String	search_results_translations =
 
 static void	search_panel_dismiss(Widget widget, XtPointer closure, XtPointer call_data);
 static void	search_and_replace_text(Widget widget, XtPointer closure, XtPointer call_data);
-static Boolean	search_text_in_compound(F_compound *com, char *pattern, void (*proc) (/* ??? */));
-static Boolean	replace_text_in_compound(F_compound *com, char *pattern, char *dst);
+static int	change_found_texts(char *pattern,
+			Boolean (*change)(F_text *t, char *pattern, char *dst),
+			char *dst);
+static Boolean	replace_text(F_text *t, char *pattern, char *dst);
+static Boolean	update_found_text(F_text *t, char *pattern, char *dst);
 static void	found_text_panel_dismiss(void);
 static void	do_replace(Widget widget, XtPointer closure, XtPointer call_data);
 static void	show_search_result(char *format, ...);
@@ -142,15 +150,6 @@ static Boolean	 do_replace_called;
 DeclareStaticArgs(14);
 
 
-static Boolean compare_string(char *str, char *pattern)
-{
-  if (case_sensitive) {
-    return strncmp(str, pattern, strlen(pattern)) == 0;
-  } else {
-    return strncasecmp(str, pattern, strlen(pattern)) == 0;
-  }
-}
-
 static void
 do_replace(Widget widget, XtPointer closure, XtPointer call_data)
 {
@@ -164,91 +163,123 @@ do_replace(Widget widget, XtPointer closure, XtPointer call_data)
       beep();
       return;
     }
-    replace_text_in_compound(&objects, panel_get_value(search_text_widget),
+    change_found_texts(panel_get_value(search_text_widget), replace_text,
 				panel_get_value(replace_text_widget));
     found_text_panel_dismiss();
-    redisplay_canvas();
     set_modifiedflag();
+    journal_checkpoint();	/* not an undoable action */
     cnt = found_text_cnt;
     search_and_replace_text(None, NULL, NULL);
     show_search_msg("%d object%s replaced", cnt, (cnt != 1)? "s":"");
   }
 }
 
+/*
+ * Apply change to the texts containing pattern and redraw the regions of
+ * the texts changed. Return the number of texts changed.
+ */
+
+static int
+change_found_texts(char *pattern,
+		Boolean (*change)(F_text *t, char *pattern, char *dst), char *dst)
+{
+  F_text	**found, *t;
+  int		  num, cnt, i;
+  int		  xmin1, ymin1, xmax1, ymax1;
+  int		  xmin2, ymin2, xmax2, ymax2;
+  int		  dum;
+  Boolean	  redraw_all;
+
+  num = textindex_find(pattern, case_sensitive, &found);
+  /* redrawing many regions takes longer than redrawing the canvas */
+  redraw_all = num > MAX_REDRAW_TEXTS;
+  cnt = 0;
+  for (i = 0; i < num; i++) {
+    t = found[i];
+    if (!redraw_all)
+      text_bound(t, &xmin1, &ymin1, &xmax1, &ymax1,
+		&dum,&dum,&dum,&dum,&dum,&dum,&dum,&dum);
+    if (!(*change)(t, pattern, dst))
+      continue;
+    /* index the new string, update the bounds of the compounds */
+    textindex_changed(t);
+    cnt++;
+    if (!redraw_all) {
+      text_bound(t, &xmin2, &ymin2, &xmax2, &ymax2,
+		&dum,&dum,&dum,&dum,&dum,&dum,&dum,&dum);
+      redisplay_regions(xmin1, ymin1, xmax1, ymax1,
+			xmin2, ymin2, xmax2, ymax2);
+    }
+  }
+  if (redraw_all && cnt > 0)
+    redisplay_canvas();
+  return cnt;
+}
+
+/* replace each occurrence of pattern in the string of t by dst */
+
 static Boolean
-replace_text_in_compound(F_compound *com, char *pattern, char *dst)
+replace_text(F_text *t, char *pattern, char *dst)
 {
-  F_compound	*c;
-  F_text	*t;
   PR_SIZE	 size;
-  Boolean	 replaced, processed;
-  int		 pat_len, i, j;
-  char		 str[300];
+  size_t	 pat_len, dst_len, len;
+  int		 n;
+  char		*str, *p, *q, *s;
 
   pat_len = strlen(pattern);
   if (pat_len == 0)
 	return False;
+  dst_len = strlen(dst);
 
-  processed = False;
-  for (c = com->compounds; c != NULL; c = c->next) {
-    if (replace_text_in_compound(c, pattern, dst))
-	processed = True;
-  }
-  for (t = com->texts; t != NULL; t = t->next) {
-    replaced = False;
-    if (pat_len <= strlen(t->cstring)) {
-      str[0] = '\0';
-      j = 0;
-      for (i = 0; i <= strlen(t->cstring) - pat_len; i++) {
-        if (compare_string(&t->cstring[i], pattern)) {
-          if (strlen(str) + strlen(dst) < sizeof(str)) {
-            strncat(str, &t->cstring[j], i - j);
-            strcat(str, dst);
-            i += pat_len - 1;
-            j = i + 1;
-            replaced = True;
-          } else {  /* string becomes too long; don't replace it */
-            replaced = False;
-          }
-        }
-      }
-      if (replaced && j < strlen(t->cstring)) {
-        if (strlen(str) + strlen(&t->cstring[j]) < sizeof(str)) {
-          strcat(str, &t->cstring[j]);
-        } else {
-          replaced = False;
-        }
-      }
-      if (replaced) {  /* replace the text object */
-        if (strlen(t->cstring) != strlen(str)) {
-          free(t->cstring);
-          t->cstring = new_string(strlen(str));
-        }
-        strcpy(t->cstring, str);
-        size = textsize(lookfont(x_fontnum(psfont_text(t), t->font),
-				t->size), strlen(t->cstring), t->cstring);
-        t->ascent = size.ascent;
-        t->descent = size.descent;
-        t->length = size.length;
-        processed = True;
-      }
-    }
+  n = 0;
+  for (p = t->cstring; (p = textindex_match(p, pattern, case_sensitive));
+		p += pat_len)
+    n++;
+  if (n == 0)
+	return False;
+
+  len = strlen(t->cstring) - n * pat_len + n * dst_len;
+  if ((str = new_string(len)) == NULL)
+	return False;
+  q = str;
+  for (s = t->cstring; (p = textindex_match(s, pattern, case_sensitive));
+		s = p + pat_len) {
+    memcpy(q, s, p - s);
+    q += p - s;
+    memcpy(q, dst, dst_len);
+    q += dst_len;
   }
-  if (processed)
-    compound_bound(com, &com->nwcorner.x, &com->nwcorner.y,
-			&com->secorner.x, &com->secorner.y);
-  return processed;
+  strcpy(q, s);
+  free(t->cstring);
+  t->cstring = str;
+
+  size = textsize(lookfont(x_fontnum(psfont_text(t), t->font), t->size),
+			len, t->cstring);
+  t->ascent = size.ascent;
+  t->descent = size.descent;
+  t->length = size.length;
+  text_metrics_changed(t);
+  return True;
+}
+
+/* set the attributes of t to those of the indicator panel */
+
+static Boolean
+update_found_text(F_text *t, char *pattern, char *dst)
+{
+  update_text(t);
+  return True;
 }
 
 static void
 do_update(Widget widget, XtPointer closure, XtPointer call_data)
 {
   if (found_text_cnt > 0) {
-    search_text_in_compound(&objects,
-            panel_get_value(search_text_widget), update_text);
+    change_found_texts(panel_get_value(search_text_widget),
+			update_found_text, NULL);
     found_text_panel_dismiss();
-    redisplay_canvas();
     set_modifiedflag();
+    journal_checkpoint();
     show_search_msg("%d object%s updated",
 	found_text_cnt, (found_text_cnt != 1)? "s":"");
   }
@@ -332,7 +363,9 @@ show_text_object(F_text *t)
 static void
 search_and_replace_text(Widget widget, XtPointer closure, XtPointer call_data)
 {
+  F_text **found;
   char	*string;
+  int	 num, i;
 
   show_search_msg("Searching text...");
 
@@ -347,8 +380,11 @@ search_and_replace_text(Widget widget, XtPointer closure, XtPointer call_data)
   do_replace_called = False;
 
   string = panel_get_value(search_text_widget);
-  if (strlen(string)!=0)
-    search_text_in_compound(&objects, string, show_text_object);
+  if (strlen(string)!=0) {
+    num = textindex_find(string, case_sensitive, &found);
+    for (i = 0; i < num; i++)
+      show_text_object(found[i]);
+  }
 
   if (found_text_cnt == 0)
 	show_search_msg("No match");
@@ -364,41 +400,6 @@ search_and_replace_text(Widget widget, XtPointer closure, XtPointer call_data)
   }
 }
 
-static Boolean
-search_text_in_compound(F_compound *com, char *pattern, void (*proc) (/* ??? */))
-{
-  F_compound *c;
-  F_text *t;
-  Boolean match, processed;
-  int pat_len, i;
-  processed = False;
-  for (c = com->compounds; c != NULL; c = c->next) {
-    if (search_text_in_compound(c, pattern, proc))
-	processed = True;
-  }
-  pat_len = strlen(pattern);
-  for (t = com->texts; t != NULL; t = t->next) {
-    match = False;
-    if (pat_len == 0) {
-      match = True;
-    } else if (pat_len <= strlen(t->cstring)) {
-      for (i = 0; !match && i <= strlen(t->cstring) - pat_len; i++) {
-        if (compare_string(&t->cstring[i], pattern))
-	    match = True;
-      }
-    }
-    if (match) {
-      (*proc)(t);
-      if (proc != show_text_object)
-	  processed = True;
-    }
-  }
-  if (processed)
-    compound_bound(com, &com->nwcorner.x, &com->nwcorner.y,
-			&com->secorner.x, &com->secorner.y);
-  return processed;
-}
-
 static void
 search_panel_dismiss(Widget widget, XtPointer closure, XtPointer call_data)
 {
@@ -868,6 +869,8 @@ write_text_from_compound(FILE *fp, F_compound *com)
 {
     F_compound *c;
     F_text *t;
+
+    expand_compound(com);
     for (c = com->compounds; c != NULL; c = c->next) {
 	write_text_from_compound(fp, c);
     }
@@ -906,8 +909,7 @@ spell_correct_word(Widget widget, XtPointer closure, XtPointer call_data)
     /* get the correct word from the ascii widget */
     FirstArg(XtNstring, &corrected_word);
     GetValues(correct_word);
-    replace_text_in_compound(&objects, selected_word, corrected_word);
-    redisplay_canvas();
+    change_found_texts(selected_word, replace_text, corrected_word);
 }
 
 /* show a one-line message in the spelling message (label) widget */
@@ -35,6 +35,7 @@
 #include "w_util.h"
 #include "w_setup.h"
 
+#include <sys/time.h>
 #include <X11/IntrinsicP.h> /* XtResizeWidget() */
 
 #ifdef I18N
@@ -1060,6 +1061,17 @@ void process_pending(void)
     app_flush();
 }
 
+/* the wall clock time in seconds, to measure how long something takes */
+
+double
+seconds(void)
+{
+    struct timeval	tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
 Boolean	user_colors_saved = False;
 XColor	saved_user_colors[MAX_USR_COLS];
 Boolean	saved_userFree[MAX_USR_COLS];
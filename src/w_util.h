@@ -173,6 +173,7 @@ typedef union {
 extern void app_flush (void);
 extern void file_msg_add_grab (void);
 extern void process_pending (void);
+extern double	seconds(void);
 extern void resize_all (int width, int height);
 extern void restore_nuser_colors (void);
 extern void restore_user_colors (void);
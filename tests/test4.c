@@ -0,0 +1,172 @@
+/*
+ * FIG : Facility for Interactive Generation of figures
+ * Copyright (c) 1985-1988 by Supoj Sutanthavibul
+ * Parts Copyright (c) 1989-2007 by Brian V. Smith
+ * Parts Copyright (c) 1991 by Paul King
+ * Parts Copyright (c) 2016-2020 by Thomas Loimer
+ *
+ * Any party obtaining a copy of these files is granted, free of charge, a
+ * full and unrestricted irrevocable, world-wide, paid up, royalty-free,
+ * nonexclusive right and license to deal in this software and documentation
+ * files (the "Software"), including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense and/or sell copies
+ * of the Software, and to permit persons who receive copies from any such
+ * party to do so, with the only requirement being that the above copyright
+ * and this permission notice remain intact.
+ *
+ */
+
+/*
+ *	test4.c: Convert a Fig file to a binary snapshot and back, defined in
+ *	src/f_snapshot.c. Compare the time to read the text and the snapshot.
+ *
+ * A large figure is generated, read with read_fig() and written with
+ * write_file() and write_snapshot(). The snapshot is read back and again
+ * written with write_file(). Both Fig files must be identical. After the
+ * Fig file is written again, with the same size, the snapshot must no
+ * longer be current.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <utime.h>
+
+#include "fig.h"
+#include "resources.h"
+#include "object.h"
+#include "mode.h"
+#include "f_read.h"
+#include "f_save.h"
+#include "f_snapshot.h"
+#include "u_free.h"
+#include "w_util.h"
+
+#define NUM_LINES	2000
+#define NUM_POINTS	100
+
+static int
+make_figure(char *name)
+{
+	FILE	*fp;
+	int	i, j;
+
+	if ((fp = fopen(name, "w")) == NULL)
+		return 1;
+	fputs("#FIG 3.2\nLandscape\nCenter\nInches\nLetter\n100.00\n"
+			"Single\n-2\n1200 2\n0 32 #a0b0c0\n", fp);
+	fputs("6 0 0 12000 12000\n", fp);
+	for (i = 0; i < NUM_LINES; ++i) {
+		fprintf(fp, "# line %d\n", i);
+		fprintf(fp, "2 1 0 1 %d 7 50 -1 -1 0.000 0 0 -1 0 0 %d\n",
+				i % 33, NUM_POINTS);
+		for (j = 0; j < NUM_POINTS; ++j)
+			fprintf(fp, " %d %d", j * 120, (i * 7 + j * 13) % 12000);
+		fputc('\n', fp);
+	}
+	fputs("3 2 0 1 0 7 50 -1 -1 0.000 0 0 0 3\n"
+			" 0 0 600 1200 1200 0\n 0.000 -1.000 0.000\n", fp);
+	fputs("1 3 0 1 0 7 50 -1 -1 0.000 1 0.0000 600 600 300 300 "
+			"600 600 900 600\n", fp);
+	fputs("5 1 0 1 0 7 50 -1 -1 0.000 0 0 1 0 600.000 600.000 "
+			"300 600 600 300 900 600\n 1 1 1.00 60.00 120.00\n", fp);
+	fputs("4 0 0 50 -1 0 12 0.0000 4 135 450 100 100 text\\001\n", fp);
+	fputs("-6\n", fp);
+	return fclose(fp);
+}
+
+static int
+compare_files(char *a, char *b)
+{
+	FILE	*fa, *fb;
+	int	ca, cb;
+
+	if ((fa = fopen(a, "rb")) == NULL)
+		return 1;
+	if ((fb = fopen(b, "rb")) == NULL) {
+		fclose(fa);
+		return 1;
+	}
+	do {
+		ca = getc(fa);
+		cb = getc(fb);
+	} while (ca == cb && ca != EOF);
+	fclose(fa);
+	fclose(fb);
+	return ca != cb;
+}
+
+int
+main(void)
+{
+	char		src[] = "test4.fig";
+	char		txt[] = "test4_text.fig";
+	char		bin[] = "test4_snap.fig";
+	char		snap[PATH_MAX];
+	struct utimbuf	past;
+	fig_settings	settings;
+	double		t, t_text, t_snap;
+	int		status = 0;
+
+	update_figs = True;
+	appres.snapshots = False;
+
+	if (make_figure(src))
+		return 1;
+
+	t = seconds();
+	if (read_fig(src, &objects, DONT_MERGE, 0, 0, &settings))
+		return 1;
+	t_text = seconds() - t;
+	write_file(txt, False);
+	/* a snapshot written in the same second as src is not current */
+	past.actime = past.modtime = time(NULL) - 2;
+	if (utime(src, &past))
+		return 1;
+	if (write_snapshot(src, &objects))
+		return 1;
+
+	snapshot_name(src, snap);
+	if (!snapshot_current(src, snap)) {
+		fprintf(stderr, "Snapshot %s is not current.\n", snap);
+		status = 1;
+	}
+	if (make_figure(src))
+		return 1;
+	if (snapshot_current(src, snap)) {
+		fprintf(stderr, "Snapshot %s is current after %s was written "
+				"again.\n", snap, src);
+		status = 1;
+	}
+
+	free_arc(&objects.arcs);
+	free_compound(&objects.compounds);
+	free_ellipse(&objects.ellipses);
+	free_line(&objects.lines);
+	free_spline(&objects.splines);
+	free_text(&objects.texts);
+	t = seconds();
+	if (read_snapshot(snap, &objects, &settings))
+		return 1;
+	t_snap = seconds() - t;
+	write_file(bin, False);
+
+	if (compare_files(txt, bin)) {
+		fprintf(stderr, "%s and %s differ.\n", txt, bin);
+		status = 1;
+	}
+	printf("Reading %d lines of %d points: text %.3f s, snapshot %.3f s\n",
+			NUM_LINES, NUM_POINTS, t_text, t_snap);
+
+	remove(src);
+	remove(snap);
+	remove(txt);
+	remove(bin);
+	return status;
+}
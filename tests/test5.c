@@ -0,0 +1,362 @@
+/*
+ * FIG : Facility for Interactive Generation of figures
+ * Copyright (c) 1985-1988 by Supoj Sutanthavibul
+ * Parts Copyright (c) 1989-2007 by Brian V. Smith
+ * Parts Copyright (c) 1991 by Paul King
+ * Parts Copyright (c) 2016-2020 by Thomas Loimer
+ *
+ * Any party obtaining a copy of these files is granted, free of charge, a
+ * full and unrestricted irrevocable, world-wide, paid up, royalty-free,
+ * nonexclusive right and license to deal in this software and documentation
+ * files (the "Software"), including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense and/or sell copies
+ * of the Software, and to permit persons who receive copies from any such
+ * party to do so, with the only requirement being that the above copyright
+ * and this permission notice remain intact.
+ *
+ */
+
+/*
+ *	test5.c: Pick objects and points on a large figure, see
+ *	src/u_search.c and src/u_pick.c. Measure the time for a click.
+ *
+ * A grid of short lines is generated, together with a few lines crossing
+ * each other at one point. Clicking on a line must select that line,
+ * clicking on empty space must select nothing. Shift-clicking on the
+ * crossing lines must cycle through them backwards in list order. After
+ * moving a line in place, or taking it from the list and appending it
+ * again, it must be picked at its new place. The highlighting routines
+ * are replaced by the functions below.
+ * A line with many points is added. Clicking on a point must select that
+ * point, also after points were moved, deleted and added.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "fig.h"
+#include "resources.h"
+#include "object.h"
+#include "mode.h"
+#include "u_create.h"
+#include "u_pick.h"
+#include "u_search.h"
+#include "u_translate.h"
+#include "w_layers.h"
+#include "w_util.h"
+#include "w_zoom.h"
+
+#define GRID		320		/* GRID * GRID lines */
+#define SPACE		1000
+#define NUM_STACK	4
+#define NUM_VERTICES	50000
+#define NUM_CLICKS	1000
+
+static void	*highlighted;
+static void	*picked;
+static F_point	*picked_prev, *picked_point;
+
+/* replace the functions in u_markers.c */
+void toggle_archighlight(F_arc *a) { highlighted = a; }
+void toggle_compoundhighlight(F_compound *c) { highlighted = c; }
+void toggle_csrhighlight(int x, int y) { (void)x; (void)y; highlighted = NULL; }
+void toggle_ellipsehighlight(F_ellipse *e) { highlighted = e; }
+void toggle_linehighlight(F_line *l) { highlighted = l; }
+void toggle_splinehighlight(F_spline *s) { highlighted = s; }
+void toggle_texthighlight(F_text *t) { highlighted = t; }
+
+static void
+pick(void *obj, int type, int x, int y, int px, int py)
+{
+	(void)type; (void)x; (void)y; (void)px; (void)py;
+	picked = obj;
+}
+
+static void
+pick_point(void *obj, int type, int x, int y, F_point *p, F_point *q)
+{
+	(void)type; (void)x; (void)y;
+	picked = obj;
+	picked_prev = p;
+	picked_point = q;
+}
+
+static F_line *
+make_line(int x1, int y1, int x2, int y2)
+{
+	F_line	*l;
+	F_point	*p, *q;
+
+	if ((l = create_line()) == NULL || (p = create_point()) == NULL ||
+			(q = create_point()) == NULL)
+		exit(1);
+	l->type = T_POLYLINE;
+	l->depth = 50;
+	p->x = x1;
+	p->y = y1;
+	p->next = q;
+	q->x = x2;
+	q->y = y2;
+	q->next = NULL;
+	l->points = p;
+	return l;
+}
+
+/* lines of the grid, and the stack of lines through (700, 500) */
+static F_line	*stack[NUM_STACK];
+
+static void
+make_figure(void)
+{
+	F_line	*l, *last = NULL;
+	int	i, j, k = 0;
+
+	for (i = 0; i < GRID; ++i) {
+		for (j = 0; j < GRID; ++j) {
+			l = make_line(i * SPACE, j * SPACE,
+					i * SPACE + 400, j * SPACE);
+			if (last)
+				last->next = l;
+			else
+				objects.lines = l;
+			last = l;
+			/* spread the stack over the list */
+			if (k < NUM_STACK && i * GRID + j == k * k * GRID * 5) {
+				stack[k] = make_line(700 - 100 * k, 200,
+						700 + 100 * k, 800);
+				last->next = stack[k];
+				last = stack[k++];
+			}
+		}
+	}
+	while (k < NUM_STACK) {
+		stack[k] = make_line(700 - 100 * k, 200, 700 + 100 * k, 800);
+		last->next = stack[k];
+		last = stack[k++];
+	}
+}
+
+/* a zigzag line with NUM_VERTICES points, right of the grid */
+static F_line *
+make_long_line(void)
+{
+	F_line	*l;
+	F_point	*p, *last = NULL;
+	int	i;
+
+	if ((l = create_line()) == NULL)
+		exit(1);
+	l->type = T_POLYLINE;
+	l->depth = 50;
+	l->points = NULL;
+	for (i = 0; i < NUM_VERTICES; ++i) {
+		if ((p = create_point()) == NULL)
+			exit(1);
+		p->x = (GRID + 10) * SPACE + i % 250 * 400;
+		p->y = i / 250 * 400 + (i & 1) * 100;
+		p->next = NULL;
+		if (last)
+			last->next = p;
+		else
+			l->points = p;
+		last = p;
+	}
+	return l;
+}
+
+static int
+check_point(int x, int y, F_point *prev, F_point *point)
+{
+	picked = NULL;
+	point_search_left(x, y, 0);
+	if (picked_point != point || (point && picked_prev != prev)) {
+		fprintf(stderr, "Wrong point picked at %d, %d.\n", x, y);
+		return 1;
+	}
+	picked_point = NULL;
+	return 0;
+}
+
+int
+main(void)
+{
+	double	t, t_first, t_refit, t_click, t_empty, t_point;
+	F_line	*l, *prev;
+	F_point	*p, *q, *r;
+	int	i, k, x, y;
+	int	status = 0;
+
+	display_zoomscale = 1.0;
+	cur_objmask = M_ALL;
+	for (i = 0; i <= MAX_DEPTH; ++i)
+		active_layers[i] = True;
+	init_searchproc_left(pick);
+	make_figure();
+	srand(5);
+
+	/* the first click builds the index */
+	t = seconds();
+	object_search_left(200, 10, 0);
+	t_first = seconds() - t;
+	if (picked != objects.lines) {
+		fputs("The first line was not picked.\n", stderr);
+		status = 1;
+	}
+
+	t = seconds();
+	for (k = 0; k < NUM_CLICKS; ++k) {
+		i = rand() % (GRID * GRID);
+		x = i / GRID * SPACE + 200;
+		y = i % GRID * SPACE + 10;
+		picked = NULL;
+		object_search_left(x, y, 0);
+		if (picked == NULL || ((F_line *)picked)->points->x != x - 200
+				|| ((F_line *)picked)->points->y != y - 10) {
+			fprintf(stderr, "Wrong line picked at %d, %d.\n", x, y);
+			status = 1;
+			break;
+		}
+	}
+	t_click = (seconds() - t) / NUM_CLICKS;
+
+	/* a shift-click on empty space visits every object */
+	t = seconds();
+	for (k = 0; k < NUM_CLICKS; ++k) {
+		i = rand() % (GRID * GRID);
+		picked = NULL;
+		object_search_left(i / GRID * SPACE + 700,
+				i % GRID * SPACE + 500 + SPACE, k & 1);
+		if (picked != NULL || highlighted != NULL) {
+			fputs("An object was picked on empty space.\n", stderr);
+			status = 1;
+			break;
+		}
+	}
+	t_empty = (seconds() - t) / NUM_CLICKS;
+
+	/* cycle backwards through the stack, and wrap around */
+	for (k = 2 * NUM_STACK - 1; k >= 0; --k) {
+		object_search_left(700, 500, 1);
+		if (highlighted != stack[k % NUM_STACK]) {
+			fprintf(stderr, "Shift-click %d did not highlight "
+					"line %d of the stack.\n",
+					2 * NUM_STACK - k, k % NUM_STACK);
+			status = 1;
+			break;
+		}
+	}
+	/* a click selects the highlighted line */
+	picked = NULL;
+	object_search_left(700, 500, 0);
+	if (picked != stack[0]) {
+		fputs("The highlighted line was not picked.\n", stderr);
+		status = 1;
+	}
+
+	/* after a move, the index is refitted to the moved line */
+	translate_line(stack[1], 0, 2000);
+	pick_object_changed(O_POLYLINE, stack[1]);
+	picked = NULL;
+	t = seconds();
+	object_search_left(700, 2500, 0);
+	t_refit = seconds() - t;
+	if (picked != stack[1]) {
+		fputs("The moved line was not picked.\n", stderr);
+		status = 1;
+	}
+	for (k = 0; k < NUM_STACK; ++k) {
+		object_search_left(700, 500, 1);
+		if (highlighted == stack[1]) {
+			fputs("The moved line was found at its old place.\n",
+					stderr);
+			status = 1;
+			break;
+		}
+	}
+
+	/* move a line as in e_move.c and u_drag.c, to the end of the list */
+	for (prev = objects.lines; prev->next != stack[2]; prev = prev->next)
+		;
+	pick_object_deleted(O_POLYLINE, stack[2]);
+	prev->next = stack[2]->next;
+	for (l = prev; l->next != NULL; l = l->next)
+		;
+	translate_line(stack[2], 0, 4000);
+	l->next = stack[2];
+	stack[2]->next = NULL;
+	pick_object_added(O_POLYLINE, stack[2]);
+	picked = NULL;
+	object_search_left(700, 4500, 0);
+	if (picked != stack[2]) {
+		fputs("The line appended again was not picked.\n", stderr);
+		status = 1;
+	}
+	for (k = 0; k < NUM_STACK; ++k) {
+		object_search_left(700, 500, 1);
+		if (highlighted == stack[2]) {
+			fputs("The line appended again was found at its old "
+					"place.\n", stderr);
+			status = 1;
+			break;
+		}
+	}
+
+	/* points of the long line */
+	for (l = objects.lines; l->next != NULL; l = l->next)
+		;
+	l->next = make_long_line();
+	l = l->next;
+	pick_changed();
+	init_searchproc_left(pick_point);
+	t = seconds();
+	for (k = 0; k < NUM_CLICKS && !status; ++k) {
+		i = rand() % NUM_VERTICES;
+		for (q = NULL, p = l->points; i > 0; q = p, p = p->next, --i)
+			;
+		t -= seconds();
+		status = check_point(p->x + 20, p->y - 20, q, p);
+		t += seconds();
+	}
+	t_point = (seconds() - t) / NUM_CLICKS;
+
+	/* move, delete and add points, as in e_movept.c etc. */
+	q = l->points->next;
+	p = q->next;
+	r = p->next;
+	pick_hold_vertices(True);
+	pick_point_moved(p, p->x, p->y - 50000);
+	p->y -= 50000;
+	pick_object_changed(O_POLYLINE, l);
+	pick_hold_vertices(False);
+	status |= check_point(p->x, p->y, q, p);
+	status |= check_point(p->x, p->y + 50000, NULL, NULL);
+
+	pick_hold_vertices(True);
+	pick_point_deleted(q, p);
+	q->next = r;
+	pick_changed();
+	pick_hold_vertices(False);
+	status |= check_point(p->x, p->y, NULL, NULL);
+	status |= check_point(r->x, r->y, q, r);
+
+	pick_hold_vertices(True);
+	p->y += 50000;
+	p->next = q->next;
+	q->next = p;
+	pick_point_added(O_POLYLINE, l, q, p);
+	pick_changed();
+	pick_hold_vertices(False);
+	status |= check_point(p->x, p->y, q, p);
+	status |= check_point(r->x, r->y, p, r);
+
+	printf("Picking among %d lines: first click %.2f ms, after a move "
+			"%.2f ms, click %.3f ms, click on empty space %.3f ms, "
+			"click on one of %d points %.3f ms\n",
+			GRID * GRID + NUM_STACK, t_first * 1e3, t_refit * 1e3,
+			t_click * 1e3, t_empty * 1e3, NUM_VERTICES, t_point * 1e3);
+	return status;
+}
@@ -0,0 +1,305 @@
+/*
+ * FIG : Facility for Interactive Generation of figures
+ * Copyright (c) 1985-1988 by Supoj Sutanthavibul
+ * Parts Copyright (c) 1989-2007 by Brian V. Smith
+ * Parts Copyright (c) 1991 by Paul King
+ * Parts Copyright (c) 2016-2020 by Thomas Loimer
+ *
+ * Any party obtaining a copy of these files is granted, free of charge, a
+ * full and unrestricted irrevocable, world-wide, paid up, royalty-free,
+ * nonexclusive right and license to deal in this software and documentation
+ * files (the "Software"), including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense and/or sell copies
+ * of the Software, and to permit persons who receive copies from any such
+ * party to do so, with the only requirement being that the above copyright
+ * and this permission notice remain intact.
+ *
+ */
+
+/*
+ *	test6.c: Intersect polylines and splines, see src/w_intersect.c.
+ *
+ * Random walks are intersected with each other. All intersections of two
+ * polylines, and the intersection snapped to when a polyline, a spline or
+ * two splines are selected, must equal the results of testing every pair
+ * of segments. The time to snap to the intersection of two polylines with
+ * many segments is measured.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "fig.h"
+#include "resources.h"
+#include "object.h"
+#include "u_create.h"
+#include "u_draw.h"
+#include "w_intersect.h"
+#include "w_util.h"
+#include "w_snap.h"
+
+#define NUM_SEGS	2000		/* segments compared to brute force */
+#define NUM_LARGE	10000		/* segments for the timing */
+#define NUM_CONTROL	300		/* control points of the splines */
+#define SIZE		5000		/* the walks stay within SIZE x SIZE */
+
+/* replace the functions in w_msgpanel.c and f_util.c */
+void put_msg(char *format, ...) { (void)format; }
+void beep(void) { }
+
+/* a random walk of n points, reflected at the borders */
+static F_point *
+make_walk(int n)
+{
+	F_point	*p, *first = NULL, *last = NULL;
+	int	x = SIZE / 2, y = SIZE / 2;
+
+	while (n-- > 0) {
+		if ((p = create_point()) == NULL)
+			exit(1);
+		x += rand() % 801 - 400;
+		y += rand() % 801 - 400;
+		x = x < 0 ? -x : (x > SIZE ? 2 * SIZE - x : x);
+		y = y < 0 ? -y : (y > SIZE ? 2 * SIZE - y : y);
+		p->x = x;
+		p->y = y;
+		p->next = NULL;
+		if (last)
+			last->next = p;
+		else
+			first = p;
+		last = p;
+	}
+	return first;
+}
+
+static F_line *
+make_line(int n)
+{
+	F_line	*l;
+
+	if ((l = create_line()) == NULL)
+		exit(1);
+	l->type = T_POLYLINE;
+	l->points = make_walk(n);
+	return l;
+}
+
+static F_spline *
+make_spline(int n)
+{
+	F_spline	*s;
+	F_sfactor	*f, *last = NULL;
+	F_point		*p;
+
+	if ((s = create_spline()) == NULL)
+		exit(1);
+	s->type = T_OPEN_INTERP;
+	s->points = make_walk(n);
+	s->sfactors = NULL;
+	for (p = s->points; p != NULL; p = p->next) {
+		if ((f = create_sfactor()) == NULL)
+			exit(1);
+		f->s = (p == s->points || p->next == NULL) ? 0.0 : -1.0;
+		f->next = NULL;
+		if (last)
+			last->next = f;
+		else
+			s->sfactors = f;
+		last = f;
+	}
+	return s;
+}
+
+/* the polyline drawn for the spline */
+static F_line *
+spline_line(F_spline *s)
+{
+	F_line	*l;
+	F_point	*p, *last = NULL;
+	zXPoint	*pts;
+	int	i, n;
+
+	if ((l = create_line()) == NULL)
+		exit(1);
+	l->type = T_POLYLINE;
+	l->points = NULL;
+	n = spline_points(s, &pts);
+	for (i = 0; i < n; ++i) {
+		if ((p = create_point()) == NULL)
+			exit(1);
+		p->x = pts[i].x;
+		p->y = pts[i].y;
+		p->next = NULL;
+		if (last)
+			last->next = p;
+		else
+			l->points = p;
+		last = p;
+	}
+	return l;
+}
+
+/* test every segment of l1 against every segment of l2 */
+static void
+brute_force(F_line *l1, F_line *l2, isect_cb_s *isect_cb)
+{
+	F_point	*a, *b;
+	double	d1x, d1y, d2x, d2y, ex, ey, det, t, u;
+	int	seg_idx;
+
+	for (a = l1->points; a->next != NULL; a = a->next) {
+		for (seg_idx = 0, b = l2->points; b->next != NULL;
+				++seg_idx, b = b->next) {
+			d1x = (double)a->next->x - a->x;
+			d1y = (double)a->next->y - a->y;
+			d2x = (double)b->next->x - b->x;
+			d2y = (double)b->next->y - b->y;
+			ex = (double)b->x - a->x;
+			ey = (double)b->y - a->y;
+			det = d1x * d2y - d1y * d2x;
+			if (det == 0.0)
+				continue;
+			t = (ex * d2y - ey * d2x) / det;
+			u = (ex * d1y - ey * d1x) / det;
+			if (t < -1e-9 || t > 1.0 + 1e-9 ||
+					u < -1e-9 || u > 1.0 + 1e-9)
+				continue;
+			insert_isect(isect_cb, a->x + t * d1x, a->y + t * d1y,
+					seg_idx);
+		}
+	}
+}
+
+static int
+compare_isects(const void *a, const void *b)
+{
+	const isects_s	*i1 = a;
+	const isects_s	*i2 = b;
+
+	if (i1->seg_idx != i2->seg_idx)
+		return i1->seg_idx - i2->seg_idx;
+	if (i1->x != i2->x)
+		return i1->x - i2->x;
+	return i1->y - i2->y;
+}
+
+/* the intersection closest to (x, y), as snapped to */
+static int
+nearest(isect_cb_s *isect_cb, int x, int y)
+{
+	int	i, k = 0;
+
+	for (i = 1; i < isect_cb->nr_isects; ++i)
+		if (hypot(isect_cb->isects[i].x - x, isect_cb->isects[i].y - y)
+				< hypot(isect_cb->isects[k].x - x,
+					isect_cb->isects[k].y - y))
+			k = i;
+	return k;
+}
+
+/* snap to the intersection of obj1 and obj2 close to an expected one */
+static int
+check_snap(void *obj1, int type1, void *obj2, int type2, F_line *l1,
+		F_line *l2, const char *what)
+{
+	isect_cb_s	expect = {NULL, 0, 0};
+	int		k, x, y;
+
+	brute_force(l1, l2, &expect);
+	if (expect.nr_isects == 0) {
+		fprintf(stderr, "The %s do not intersect.\n", what);
+		return 1;
+	}
+	x = expect.isects[expect.nr_isects / 2].x + 30;
+	y = expect.isects[expect.nr_isects / 2].y - 30;
+	k = nearest(&expect, x, y);
+	snap_found = False;
+	snap_msg_set = False;
+	snap_intersect_handler(obj1, type1, obj2, type2, x, y);
+	/* of intersections at nearly the same distance, either may be taken */
+	if (!snap_found || hypot(snap_gx - x, snap_gy - y) > 1.5 +
+			hypot(expect.isects[k].x - x, expect.isects[k].y - y)) {
+		fprintf(stderr, "Snapped to %d, %d instead of %d, %d on the "
+				"%s.\n", snap_gx, snap_gy, expect.isects[k].x,
+				expect.isects[k].y, what);
+		free(expect.isects);
+		return 1;
+	}
+	free(expect.isects);
+	return 0;
+}
+
+int
+main(void)
+{
+	isect_cb_s	found = {NULL, 0, 0};
+	isect_cb_s	expect = {NULL, 0, 0};
+	F_line		*l1, *l2;
+	F_spline	*s1, *s2;
+	double		t;
+	int		i;
+	int		status = 0;
+
+	srand(6);
+
+	/* all intersections of two polylines */
+	l1 = make_line(NUM_SEGS + 1);
+	l2 = make_line(NUM_SEGS + 1);
+	intersect_polyline_polyline_handler(l1, l2, 0, 0, &found);
+	brute_force(l1, l2, &expect);
+	qsort(found.isects, found.nr_isects, sizeof(isects_s), compare_isects);
+	qsort(expect.isects, expect.nr_isects, sizeof(isects_s),
+			compare_isects);
+	if (found.nr_isects != expect.nr_isects) {
+		fprintf(stderr, "Found %d instead of %d intersections.\n",
+				found.nr_isects, expect.nr_isects);
+		status = 1;
+	}
+	for (i = 0; i < found.nr_isects && !status; ++i) {
+		if (compare_isects(&found.isects[i], &expect.isects[i])) {
+			fprintf(stderr, "Wrong intersection %d, %d of segment "
+					"%d.\n", found.isects[i].x,
+					found.isects[i].y,
+					found.isects[i].seg_idx);
+			status = 1;
+		}
+	}
+
+	status |= check_snap(l1, O_POLYLINE, l2, O_POLYLINE, l1, l2,
+			"polylines");
+
+	/* splines, and a polyline with a spline */
+	s1 = make_spline(NUM_CONTROL);
+	s2 = make_spline(NUM_CONTROL);
+	status |= check_snap(l1, O_POLYLINE, s1, O_SPLINE, l1, spline_line(s1),
+			"polyline and spline");
+	status |= check_snap(s1, O_SPLINE, l2, O_POLYLINE, l2, spline_line(s1),
+			"spline and polyline");
+	status |= check_snap(s1, O_SPLINE, s2, O_SPLINE, spline_line(s1),
+			spline_line(s2), "splines");
+
+	/* the time to snap to the intersection of two large polylines */
+	l1 = make_line(NUM_LARGE + 1);
+	l2 = make_line(NUM_LARGE + 1);
+	snap_found = False;
+	t = seconds();
+	snap_intersect_handler(l1, O_POLYLINE, l2, O_POLYLINE, SIZE / 2,
+			SIZE / 2);
+	t = seconds() - t;
+	if (!snap_found) {
+		fputs("The large polylines do not intersect.\n", stderr);
+		status = 1;
+	}
+
+	printf("Intersections of %d and %d segments: %d, snapping to an "
+			"intersection of %d and %d segments: %.2f ms\n",
+			NUM_SEGS, NUM_SEGS, found.nr_isects, NUM_LARGE,
+			NUM_LARGE, t * 1e3);
+	return status;
+}
@@ -0,0 +1,179 @@
+/*
+ * FIG : Facility for Interactive Generation of figures
+ * Copyright (c) 1985-1988 by Supoj Sutanthavibul
+ * Parts Copyright (c) 1989-2007 by Brian V. Smith
+ * Parts Copyright (c) 1991 by Paul King
+ * Parts Copyright (c) 2016-2020 by Thomas Loimer
+ *
+ * Any party obtaining a copy of these files is granted, free of charge, a
+ * full and unrestricted irrevocable, world-wide, paid up, royalty-free,
+ * nonexclusive right and license to deal in this software and documentation
+ * files (the "Software"), including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense and/or sell copies
+ * of the Software, and to permit persons who receive copies from any such
+ * party to do so, with the only requirement being that the above copyright
+ * and this permission notice remain intact.
+ *
+ */
+
+/*
+ *	test7.c: Search the texts of a large figure, see src/u_textindex.c.
+ *
+ * Labels with part numbers are generated at the top level and within
+ * nested compounds. The texts found for a pattern, with and without
+ * regard to case, must equal those found by comparing every text, also
+ * after texts were changed, deleted and added. The time for a search is
+ * measured.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fig.h"
+#include "resources.h"
+#include "object.h"
+#include "u_create.h"
+#include "u_pick.h"
+#include "u_textindex.h"
+#include "w_util.h"
+
+#define NUM_TEXTS	50000
+#define NUM_SEARCHES	1000
+
+static char	*patterns[] = {"part-01", "PART-0123", "x3", "", "t-1", "zzz",
+			"-00042 x", "5"};
+#define NUM_PATTERNS	(int)(sizeof patterns / sizeof patterns[0])
+
+static F_text	*brute[NUM_TEXTS + 10];
+
+static F_text *
+make_text(char *s)
+{
+	F_text	*t;
+
+	if ((t = create_text()) == NULL || (t->cstring = strdup(s)) == NULL)
+		exit(1);
+	t->next = NULL;
+	return t;
+}
+
+static F_compound *
+make_compound(void)
+{
+	F_compound	*c;
+
+	if ((c = create_compound()) == NULL)
+		exit(1);
+	memset(c, 0, sizeof(F_compound));
+	return c;
+}
+
+/* the texts containing pattern, in the order of the figure */
+static int
+search_all(F_compound *c, char *pattern, Boolean case_sensitive, int n)
+{
+	F_compound	*cc;
+	F_text		*t;
+
+	for (cc = c->compounds; cc != NULL; cc = cc->next)
+		n = search_all(cc, pattern, case_sensitive, n);
+	for (t = c->texts; t != NULL; t = t->next)
+		if (textindex_match(t->cstring, pattern, case_sensitive))
+			brute[n++] = t;
+	return n;
+}
+
+static int
+check_search(const char *when)
+{
+	F_text	**found;
+	int	i, n, m;
+	Boolean	case_sensitive;
+
+	for (i = 0; i < 2 * NUM_PATTERNS; ++i) {
+		case_sensitive = i & 1;
+		n = textindex_find(patterns[i / 2], case_sensitive, &found);
+		m = search_all(&objects, patterns[i / 2], case_sensitive, 0);
+		if (n != m || memcmp(found, brute, n * sizeof(F_text *))) {
+			fprintf(stderr, "Searching \"%s\" %s found %d texts "
+					"instead of %d.\n", patterns[i / 2],
+					when, n, m);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+int
+main(void)
+{
+	F_compound	*c1, *c2;
+	F_text		*t, *last = NULL, **found;
+	char		buf[64];
+	double		t_search;
+	int		i, k, n = 0;
+	int		status = 0;
+
+	srand(7);
+	c1 = make_compound();
+	c2 = make_compound();
+	c1->compounds = c2;
+	objects.compounds = c1;
+	for (i = 0; i < NUM_TEXTS; ++i) {
+		sprintf(buf, "Part-%05d X%d", rand() % 20000, rand() % 7);
+		t = make_text(buf);
+		if (i % 10 == 0) {
+			t->next = c1->texts;
+			c1->texts = t;
+		} else if (i % 17 == 0) {
+			t->next = c2->texts;
+			c2->texts = t;
+		} else {
+			if (last)
+				last->next = t;
+			else
+				objects.texts = t;
+			last = t;
+		}
+	}
+
+	status |= check_search("first");
+
+	/* change texts, as search/replace does and by replacing strings */
+	for (t = objects.texts, i = 0; t != NULL; t = t->next, ++i) {
+		if (i % 100 == 0) {
+			free(t->cstring);
+			sprintf(buf, "part-0123 new %d", i);
+			t->cstring = strdup(buf);
+		}
+	}
+	for (t = c1->texts, i = 0; t != NULL; t = t->next, ++i) {
+		if (i % 50 == 0) {
+			strcpy(t->cstring, "PART");
+			textindex_changed(t);
+		}
+	}
+	/* delete two texts, add one */
+	objects.texts = objects.texts->next->next;
+	t = make_text("Part-0123 added");
+	t->next = c2->texts;
+	c2->texts = t;
+	pick_changed();
+	status |= check_search("after changes");
+
+	t_search = seconds();
+	for (k = 0; k < NUM_SEARCHES; ++k) {
+		sprintf(buf, "part-%04d", rand() % 2000);
+		n += textindex_find(buf, False, &found);
+	}
+	t_search = (seconds() - t_search) / NUM_SEARCHES;
+
+	printf("Searching %d texts: %d found, %.3f ms per search\n",
+			NUM_TEXTS, n, t_search * 1e3);
+	return status;
+}
@@ -0,0 +1,655 @@
+/*
+ * FIG : Facility for Interactive Generation of figures
+ * Copyright (c) 1985-1988 by Supoj Sutanthavibul
+ * Parts Copyright (c) 1989-2007 by Brian V. Smith
+ * Parts Copyright (c) 1991 by Paul King
+ * Parts Copyright (c) 2016-2020 by Thomas Loimer
+ *
+ * Any party obtaining a copy of these files is granted, free of charge, a
+ * full and unrestricted irrevocable, world-wide, paid up, royalty-free,
+ * nonexclusive right and license to deal in this software and documentation
+ * files (the "Software"), including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense and/or sell copies
+ * of the Software, and to permit persons who receive copies from any such
+ * party to do so, with the only requirement being that the above copyright
+ * and this permission notice remain intact.
+ *
+ */
+
+/*
+ *	test8.c: Transform the points of a compound, see src/u_transform.c.
+ *
+ * Two equal compounds of lines and splines, with compounds nested within,
+ * are generated. One is translated, scaled, rotated and flipped by
+ * transform_points(), the other one object after the other, as xfig did
+ * before. The points must be equal after each transformation.
+ * Then, two equal compounds of all kinds of objects, with arrows, a
+ * picture and a dimension line, are transformed by scale_compound(),
+ * rotate_compound() and flip_compound(), and as these did before.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fig.h"
+#include "resources.h"
+#include "object.h"
+#include "mode.h"
+#include "e_flip.h"
+#include "e_rotate.h"
+#include "e_scale.h"
+#include "f_read.h"
+#include "u_bound.h"
+#include "u_create.h"
+#include "u_geom.h"
+#include "u_translate.h"
+#include "u_transform.h"
+#include "w_drawprim.h"
+
+#define NUM_OBJECTS	2000
+#define MAX_POINTS	60
+
+/* the functions that transform single objects */
+extern void	rotate_spline(F_spline *s, int x, int y);
+extern void	rotate_text(F_text *t, int x, int y);
+extern void	rotate_ellipse(F_ellipse *e, int x, int y);
+extern void	rotate_arc(F_arc *a, int x, int y);
+extern void	flip_line(F_line *l, int x, int y, int flip_axis);
+extern void	flip_spline(F_spline *s, int x, int y, int flip_axis);
+extern void	flip_text(F_text *t, int x, int y, int flip_axis);
+extern void	flip_ellipse(F_ellipse *e, int x, int y, int flip_axis);
+extern void	flip_arc(F_arc *a, int x, int y, int flip_axis);
+
+/* without a display, there are no fonts */
+XFontStruct *
+lookfont(int fnum, int size)
+{
+	(void)fnum;
+	(void)size;
+	return NULL;
+}
+
+PR_SIZE
+textsize(XFontStruct *fstruct, int n, char *s)
+{
+	PR_SIZE	size;
+
+	(void)fstruct;
+	(void)s;
+	size.length = 100 * n;
+	size.ascent = 120;
+	size.descent = 30;
+	return size;
+}
+
+static F_point *
+make_points(int n)
+{
+	F_point	*first = NULL, *p;
+
+	while (n-- > 0) {
+		if ((p = create_point()) == NULL)
+			exit(1);
+		p->x = rand() % 100000 - 20000;
+		p->y = rand() % 80000 - 20000;
+		p->next = first;
+		first = p;
+	}
+	return first;
+}
+
+static F_compound *
+make_compound(int depth)
+{
+	F_compound	*c;
+	F_line		*l;
+	F_spline	*s;
+	int		i;
+
+	if ((c = create_compound()) == NULL)
+		exit(1);
+	memset(c, 0, sizeof(F_compound));
+	for (i = 0; i < NUM_OBJECTS; ++i) {
+		if (i % 3) {
+			if ((l = create_line()) == NULL)
+				exit(1);
+			l->type = T_POLYLINE;
+			l->points = make_points(1 + rand() % MAX_POINTS);
+			l->next = c->lines;
+			c->lines = l;
+		} else {
+			if ((s = create_spline()) == NULL)
+				exit(1);
+			s->type = T_OPEN_XSPLINE;
+			s->points = make_points(1 + rand() % MAX_POINTS);
+			s->next = c->splines;
+			c->splines = s;
+		}
+	}
+	if (depth > 0) {
+		c->compounds = make_compound(depth - 1);
+		c->compounds->next = make_compound(depth - 1);
+	}
+	return c;
+}
+
+static void
+transform_line(F_line *l, xform *t)
+{
+	F_point	*p;
+
+	switch (t->op) {
+	case XF_TRANSLATE:
+		translate_line(l, t->x, t->y);
+		break;
+	case XF_ROTATE90:
+	case XF_ROTATE:
+		rotate_line(l, t->x, t->y);
+		break;
+	default:	/* see scale_line() and flip_line() */
+		for (p = l->points; p != NULL; p = p->next) {
+			if (t->op == XF_SCALE) {
+				p->x = round(t->x + (p->x - t->x) * t->sx);
+				p->y = round(t->y + (p->y - t->y) * t->sy);
+			} else if (t->op == XF_FLIP_UD) {
+				p->y = t->y + (t->y - p->y);
+			} else {
+				p->x = t->x + (t->x - p->x);
+			}
+		}
+	}
+}
+
+/* transform c one object after the other */
+static void
+transform_objects(F_compound *c, xform *t)
+{
+	F_line		*l, tmp;
+	F_spline	*s;
+	F_compound	*c1;
+
+	for (l = c->lines; l != NULL; l = l->next)
+		transform_line(l, t);
+	/* the points of splines are transformed as those of lines */
+	memset(&tmp, 0, sizeof tmp);
+	tmp.type = T_POLYLINE;
+	for (s = c->splines; s != NULL; s = s->next) {
+		tmp.points = s->points;
+		transform_line(&tmp, t);
+	}
+	for (c1 = c->compounds; c1 != NULL; c1 = c1->next)
+		transform_objects(c1, t);
+}
+
+/* return the number of points that differ */
+static int
+compare(F_compound *c, F_compound *d)
+{
+	F_line		*l, *m;
+	F_spline	*s, *r;
+	F_point		*p, *q;
+	F_compound	*c1, *d1;
+	int		n = 0;
+
+	for (l = c->lines, m = d->lines; l != NULL; l = l->next, m = m->next)
+		for (p = l->points, q = m->points; p != NULL;
+				p = p->next, q = q->next)
+			n += p->x != q->x || p->y != q->y;
+	for (s = c->splines, r = d->splines; s != NULL;
+			s = s->next, r = r->next)
+		for (p = s->points, q = r->points; p != NULL;
+				p = p->next, q = q->next)
+			n += p->x != q->x || p->y != q->y;
+	for (c1 = c->compounds, d1 = d->compounds; c1 != NULL;
+			c1 = c1->next, d1 = d1->next)
+		n += compare(c1, d1);
+	return n;
+}
+
+static F_point *
+point_list(int n, const int *xy)
+{
+	F_point	*first = NULL, *p;
+
+	while (n-- > 0) {
+		if ((p = create_point()) == NULL)
+			exit(1);
+		p->x = xy[2 * n];
+		p->y = xy[2 * n + 1];
+		p->next = first;
+		first = p;
+	}
+	return first;
+}
+
+static F_arrow *
+arrow(float wd, float ht)
+{
+	F_arrow	*a;
+
+	if ((a = create_arrow()) == NULL)
+		exit(1);
+	a->type = 1;
+	a->style = 1;
+	a->thickness = 15.f;
+	a->wd = wd;
+	a->ht = ht;
+	return a;
+}
+
+static F_line *
+add_line(F_compound *c, int type, int n, const int *xy, char *comment)
+{
+	F_line	*l;
+
+	if ((l = create_line()) == NULL)
+		exit(1);
+	memset(l, 0, sizeof(F_line));
+	l->type = type;
+	l->thickness = 15;
+	l->points = point_list(n, xy);
+	l->comments = comment ? strdup(comment) : NULL;
+	l->next = c->lines;
+	c->lines = l;
+	return l;
+}
+
+static F_text *
+add_text(F_compound *c, int x, int y, char *s)
+{
+	F_text	*t;
+
+	if ((t = create_text()) == NULL)
+		exit(1);
+	memset(t, 0, sizeof(F_text));
+	t->type = T_LEFT_JUSTIFIED;
+	t->size = 12;
+	t->base_x = x;
+	t->base_y = y;
+	t->cstring = strdup(s);
+	t->length = 100 * (int)strlen(s);
+	t->ascent = 120;
+	t->descent = 30;
+	t->next = c->texts;
+	c->texts = t;
+	return t;
+}
+
+static F_compound *
+new_compound(void)
+{
+	F_compound	*c;
+
+	if ((c = create_compound()) == NULL)
+		exit(1);
+	memset(c, 0, sizeof(F_compound));
+	return c;
+}
+
+static void
+bound(F_compound *c)
+{
+	compound_bound(c, &c->nwcorner.x, &c->nwcorner.y,
+			&c->secorner.x, &c->secorner.y);
+}
+
+/* a compound of all kinds of objects, a dimension line and a compound */
+static F_compound *
+make_figure(void)
+{
+	static const int	poly[] = {100, 200, 1300, 900, 2500, 400};
+	static const int	box[] = {3000, 3000, 3000, 4200, 5100, 4200,
+						5100, 3000, 3000, 3000};
+	static const int	pic[] = {-600, 1500, -600, 2700, 900, 2700,
+						900, 1500, -600, 1500};
+	static const int	spl[] = {200, 5000, 1500, 6100, 2800, 5300,
+						4000, 6600};
+	static const int	dim[] = {6000, 1000, 9000, 2500};
+	static const int	tick1[] = {6000, 850, 6000, 1150};
+	static const int	tick2[] = {9000, 2350, 9000, 2650};
+	static const int	tbox[] = {7200, 1500, 7200, 2000, 7800, 2000,
+						7800, 1500, 7200, 1500};
+	F_compound	*c, *d, *e;
+	F_line		*l;
+	F_spline	*s;
+	F_arc		*a;
+	F_ellipse	*el;
+
+	c = new_compound();
+
+	l = add_line(c, T_POLYLINE, 3, poly, NULL);
+	l->for_arrow = arrow(60.f, 120.f);
+	l->back_arrow = arrow(45.f, 90.f);
+	l = add_line(c, T_ARCBOX, 5, box, NULL);
+	l->radius = 300;
+	l = add_line(c, T_PICTURE, 5, pic, NULL);
+	if ((l->pic = create_pic()) == NULL)
+		exit(1);
+	l->pic->flipped = 0;
+
+	if ((s = create_spline()) == NULL)
+		exit(1);
+	memset(s, 0, sizeof(F_spline));
+	s->type = T_OPEN_APPROX;
+	s->thickness = 15;
+	s->points = point_list(4, spl);
+	s->for_arrow = arrow(60.f, 120.f);
+	c->splines = s;
+
+	if ((a = create_arc()) == NULL)
+		exit(1);
+	memset(a, 0, sizeof(F_arc));
+	a->type = T_OPEN_ARC;
+	a->thickness = 15;
+	a->point[0].x = 5000;	a->point[0].y = 6000;
+	a->point[1].x = 6000;	a->point[1].y = 5200;
+	a->point[2].x = 7000;	a->point[2].y = 6000;
+	compute_arccenter(a->point[0], a->point[1], a->point[2],
+			&a->center.x, &a->center.y);
+	a->direction = compute_direction(a->point[0], a->point[1],
+			a->point[2]);
+	a->back_arrow = arrow(60.f, 120.f);
+	c->arcs = a;
+
+	if ((el = create_ellipse()) == NULL)
+		exit(1);
+	memset(el, 0, sizeof(F_ellipse));
+	el->type = T_ELLIPSE_BY_RAD;
+	el->direction = 1;
+	el->center.x = 8000;	el->center.y = 7000;
+	el->radiuses.x = 900;	el->radiuses.y = 500;
+	el->start = el->center;
+	el->end.x = 8900;	el->end.y = 7500;
+	c->ellipses = el;
+
+	add_text(c, 400, 8000, "text");
+
+	/* the dimension line, see create_dimline() */
+	d = new_compound();
+	d->comments = strdup("Dimension line: 1.34 in");
+	add_line(d, T_POLYGON, 5, tbox, "text box");
+	add_line(d, T_POLYLINE, 2, tick1, "tick");
+	add_line(d, T_POLYLINE, 2, tick2, "tick");
+	l = add_line(d, T_POLYLINE, 2, dim, "main dimension line");
+	l->for_arrow = arrow(60.f, 120.f);
+	l->back_arrow = arrow(60.f, 120.f);
+	add_text(d, 7300, 1900, "1.34 in");
+	bound(d);
+
+	/* a compound within */
+	e = new_compound();
+	add_line(e, T_POLYLINE, 2, tick1, NULL)->for_arrow =
+						arrow(30.f, 60.f);
+	add_text(e, -2000, -1000, "inner");
+	bound(e);
+
+	d->next = e;
+	c->compounds = d;
+	bound(c);
+	return c;
+}
+
+/* scale_compound(), rotate_compound() and flip_compound(), as before */
+
+static void
+scale_objects(F_compound *c, double sx, double sy, int refx, int refy)
+{
+	F_line		*l;
+	F_spline	*s;
+	F_ellipse	*e;
+	F_text		*t;
+	F_arc		*a;
+	F_compound	*c1;
+	int		x1, y1, x2, y2;
+
+	if (rescale_dimension_line(c, sx, sy, refx, refy))
+		return;
+	x1 = round(refx + (c->nwcorner.x - refx) * sx);
+	y1 = round(refy + (c->nwcorner.y - refy) * sy);
+	x2 = round(refx + (c->secorner.x - refx) * sx);
+	y2 = round(refy + (c->secorner.y - refy) * sy);
+	c->nwcorner.x = min2(x1, x2);
+	c->nwcorner.y = min2(y1, y2);
+	c->secorner.x = max2(x1, x2);
+	c->secorner.y = max2(y1, y2);
+	for (l = c->lines; l != NULL; l = l->next)
+		scale_line(l, sx, sy, refx, refy);
+	for (s = c->splines; s != NULL; s = s->next)
+		scale_spline(s, sx, sy, refx, refy);
+	for (a = c->arcs; a != NULL; a = a->next)
+		scale_arc(a, sx, sy, refx, refy);
+	for (e = c->ellipses; e != NULL; e = e->next)
+		scale_ellipse(e, sx, sy, refx, refy);
+	for (t = c->texts; t != NULL; t = t->next)
+		scale_text(t, sx, sy, refx, refy);
+	for (c1 = c->compounds; c1 != NULL; c1 = c1->next) {
+		scale_objects(c1, sx, sy, refx, refy);
+		c->nwcorner.x = min2(c->nwcorner.x, c1->nwcorner.x);
+		c->nwcorner.y = min2(c->nwcorner.y, c1->nwcorner.y);
+		c->secorner.x = max2(c->secorner.x, c1->secorner.x);
+		c->secorner.y = max2(c->secorner.y, c1->secorner.y);
+	}
+}
+
+static void
+rotate_objects(F_compound *c, int x, int y)
+{
+	F_line		*l;
+	F_spline	*s;
+	F_ellipse	*e;
+	F_text		*t;
+	F_arc		*a;
+	F_compound	*c1;
+
+	for (l = c->lines; l != NULL; l = l->next)
+		rotate_line(l, x, y);
+	for (a = c->arcs; a != NULL; a = a->next)
+		rotate_arc(a, x, y);
+	for (e = c->ellipses; e != NULL; e = e->next)
+		rotate_ellipse(e, x, y);
+	for (s = c->splines; s != NULL; s = s->next)
+		rotate_spline(s, x, y);
+	for (t = c->texts; t != NULL; t = t->next)
+		rotate_text(t, x, y);
+	for (c1 = c->compounds; c1 != NULL; c1 = c1->next)
+		rotate_objects(c1, x, y);
+	bound(c);
+}
+
+static void
+flip_objects(F_compound *c, int x, int y, int flip_axis)
+{
+	F_line		*l;
+	F_spline	*s;
+	F_ellipse	*e;
+	F_text		*t;
+	F_arc		*a;
+	F_compound	*c1;
+	int		p, q;
+
+	if (flip_axis == UD_FLIP) {
+		p = y + (y - c->nwcorner.y);
+		q = y + (y - c->secorner.y);
+		c->nwcorner.y = min2(p, q);
+		c->secorner.y = max2(p, q);
+	} else {
+		p = x + (x - c->nwcorner.x);
+		q = x + (x - c->secorner.x);
+		c->nwcorner.x = min2(p, q);
+		c->secorner.x = max2(p, q);
+	}
+	for (l = c->lines; l != NULL; l = l->next)
+		flip_line(l, x, y, flip_axis);
+	for (a = c->arcs; a != NULL; a = a->next)
+		flip_arc(a, x, y, flip_axis);
+	for (e = c->ellipses; e != NULL; e = e->next)
+		flip_ellipse(e, x, y, flip_axis);
+	for (s = c->splines; s != NULL; s = s->next)
+		flip_spline(s, x, y, flip_axis);
+	for (t = c->texts; t != NULL; t = t->next)
+		flip_text(t, x, y, flip_axis);
+	for (c1 = c->compounds; c1 != NULL; c1 = c1->next)
+		flip_objects(c1, x, y, flip_axis);
+}
+
+static int
+same_points(F_point *p, F_point *q)
+{
+	for (; p != NULL && q != NULL; p = p->next, q = q->next)
+		if (p->x != q->x || p->y != q->y)
+			return 0;
+	return p == q;
+}
+
+static int
+same_arrow(F_arrow *a, F_arrow *b)
+{
+	if (a == NULL || b == NULL)
+		return a == b;
+	return a->thickness == b->thickness && a->wd == b->wd &&
+		a->ht == b->ht;
+}
+
+/* return the number of objects that differ */
+static int
+compare_all(F_compound *c, F_compound *d)
+{
+	F_line		*l, *m;
+	F_spline	*s, *r;
+	F_arc		*a, *b;
+	F_ellipse	*e, *f;
+	F_text		*t, *u;
+	F_compound	*c1, *d1;
+	int		i, n = 0;
+
+	n += c->nwcorner.x != d->nwcorner.x || c->nwcorner.y != d->nwcorner.y
+		|| c->secorner.x != d->secorner.x
+		|| c->secorner.y != d->secorner.y;
+	for (l = c->lines, m = d->lines; l != NULL; l = l->next, m = m->next)
+		n += !same_points(l->points, m->points) ||
+			l->radius != m->radius ||
+			!same_arrow(l->for_arrow, m->for_arrow) ||
+			!same_arrow(l->back_arrow, m->back_arrow) ||
+			(l->type == T_PICTURE &&
+				l->pic->flipped != m->pic->flipped);
+	for (s = c->splines, r = d->splines; s != NULL;
+			s = s->next, r = r->next)
+		n += !same_points(s->points, r->points) ||
+			!same_arrow(s->for_arrow, r->for_arrow);
+	for (a = c->arcs, b = d->arcs; a != NULL; a = a->next, b = b->next) {
+		for (i = 0; i < 3; ++i)
+			n += a->point[i].x != b->point[i].x ||
+				a->point[i].y != b->point[i].y;
+		n += a->center.x != b->center.x || a->center.y != b->center.y ||
+			a->direction != b->direction ||
+			!same_arrow(a->back_arrow, b->back_arrow);
+	}
+	for (e = c->ellipses, f = d->ellipses; e != NULL;
+			e = e->next, f = f->next)
+		n += e->center.x != f->center.x || e->center.y != f->center.y ||
+			e->radiuses.x != f->radiuses.x ||
+			e->radiuses.y != f->radiuses.y ||
+			e->start.x != f->start.x || e->start.y != f->start.y ||
+			e->end.x != f->end.x || e->end.y != f->end.y ||
+			e->type != f->type || e->angle != f->angle ||
+			e->direction != f->direction;
+	for (t = c->texts, u = d->texts; t != NULL; t = t->next, u = u->next)
+		n += t->base_x != u->base_x || t->base_y != u->base_y ||
+			t->angle != u->angle || t->size != u->size ||
+			t->type != u->type || t->length != u->length ||
+			strcmp(t->cstring, u->cstring);
+	for (c1 = c->compounds, d1 = d->compounds; c1 != NULL;
+			c1 = c1->next, d1 = d1->next)
+		n += compare_all(c1, d1);
+	return n;
+}
+
+static int
+check_figure(void)
+{
+	F_compound	*fig, *ref;
+	char		*name[] = {"scale", "scale", "rotate", "rotate",
+				"rotate", "flip", "flip"};
+	int		axis, i, n;
+	int		status = 0;
+
+	fig = make_figure();
+	ref = make_figure();
+	for (i = 0; i < (int)(sizeof name / sizeof name[0]); ++i) {
+		switch (i) {
+		case 0:
+			scale_compound(fig, 1.37, 0.61, 300, 4000);
+			scale_objects(ref, 1.37, 0.61, 300, 4000);
+			break;
+		case 1:
+			scale_compound(fig, -1.0, 2.0, -20, 70);
+			scale_objects(ref, -1.0, 2.0, -20, 70);
+			break;
+		case 2:
+		case 3:
+		case 4:
+			rotn_dirn = i == 3 ? -1 : 1;
+			act_rotnangle = i == 4 ? 33.0 : 90.0;
+			rotate_compound(fig, 5000, 6000);
+			rotate_objects(ref, 5000, 6000);
+			break;
+		default:
+			axis = i == 5 ? UD_FLIP : LR_FLIP;
+			flip_compound(fig, -555, 777, axis);
+			flip_objects(ref, -555, 777, axis);
+			break;
+		}
+		if ((n = compare_all(fig, ref))) {
+			fprintf(stderr, "Compound %s %d: %d objects differ.\n",
+					name[i], i, n);
+			status = 1;
+		}
+	}
+	return status;
+}
+
+int
+main(void)
+{
+	F_compound	*bulk, *single;
+	xform		t[] = {
+		{XF_TRANSLATE, 1234, -567, 0.f, 0.f, 0},
+		{XF_SCALE, 300, 4000, 1.37f, 0.61f, 0},
+		{XF_SCALE, -20, 70, -1.0f, 2.0f, 0},
+		{XF_ROTATE90, 5000, 6000, 0.f, 0.f, 1},
+		{XF_ROTATE90, -300, 100, 0.f, 0.f, -1},
+		{XF_ROTATE, 2000, 3000, 0.f, 0.f, 1},
+		{XF_FLIP_UD, 0, 777, 0.f, 0.f, 0},
+		{XF_FLIP_LR, -555, 0, 0.f, 0.f, 0}
+	};
+	char		*name[] = {"translate", "scale", "scale", "rotate",
+				"rotate", "rotate", "flip", "flip"};
+	int		i, n;
+	int		status = 0;
+
+	srand(8);
+	bulk = make_compound(2);
+	srand(8);
+	single = make_compound(2);
+
+	for (i = 0; i < (int)(sizeof t / sizeof t[0]); ++i) {
+		rotn_dirn = t[i].dirn;
+		act_rotnangle = t[i].op == XF_ROTATE90 ? 90.0 : 33.0;
+		transform_points(bulk, &t[i], False, NULL);
+		transform_objects(single, &t[i]);
+		if ((n = compare(bulk, single))) {
+			fprintf(stderr, "Transformation %d, %s: %d points "
+					"differ.\n", i, name[i], n);
+			status = 1;
+		}
+	}
+	if (check_figure())
+		status = 1;
+	return status;
+}
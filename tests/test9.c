@@ -0,0 +1,328 @@
+/*
+ * FIG : Facility for Interactive Generation of figures
+ * Copyright (c) 1985-1988 by Supoj Sutanthavibul
+ * Parts Copyright (c) 1989-2007 by Brian V. Smith
+ * Parts Copyright (c) 1991 by Paul King
+ * Parts Copyright (c) 2016-2020 by Thomas Loimer
+ *
+ * Any party obtaining a copy of these files is granted, free of charge, a
+ * full and unrestricted irrevocable, world-wide, paid up, royalty-free,
+ * nonexclusive right and license to deal in this software and documentation
+ * files (the "Software"), including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense and/or sell copies
+ * of the Software, and to permit persons who receive copies from any such
+ * party to do so, with the only requirement being that the above copyright
+ * and this permission notice remain intact.
+ *
+ */
+
+/*
+ *	test9.c: Undo an edit, and the action before, see src/u_undo.c.
+ *
+ * A point of a line is moved, then the line is edited; the objects of a
+ * compound are aligned, then the compound is edited. Undoing twice must
+ * restore the line and the compound, and redoing twice must repeat the
+ * changes. The actions are recorded as in e_movept.c, e_align.c and
+ * e_edit.c. Last, a line is placed twice as an array of copies, see
+ * u_drag.c, and both placements are undone.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fig.h"
+#include "resources.h"
+#include "mode.h"
+#include "object.h"
+#include "u_create.h"
+#include "u_list.h"
+#include "u_translate.h"
+#include "u_undo.h"
+
+static char	message[256];
+
+/* replace the functions in w_msgpanel.c, w_canvas.c, w_layers.c, mode.c
+   and u_redraw.c */
+void
+put_msg(char *format, ...)
+{
+	va_list	ap;
+
+	va_start(ap, format);
+	vsnprintf(message, sizeof message, format, ap);
+	va_end(ap);
+}
+void setCompLED(int on) { (void)on; }
+void redisplay_line(F_line *l) { (void)l; }
+void redisplay_lines(F_line *l1, F_line *l2) { (void)l1; (void)l2; }
+void redisplay_compounds(F_compound *c1, F_compound *c2)
+{
+	(void)c1;
+	(void)c2;
+}
+void redisplay_regions(int xmin1, int ymin1, int xmax1, int ymax1,
+		int xmin2, int ymin2, int xmax2, int ymax2)
+{
+	(void)xmin1; (void)ymin1; (void)xmax1; (void)ymax1;
+	(void)xmin2; (void)ymin2; (void)xmax2; (void)ymax2;
+}
+void redisplay_zoomed_region(int xmin, int ymin, int xmax, int ymax)
+{
+	(void)xmin; (void)ymin; (void)xmax; (void)ymax;
+}
+void set_modifiedflag(void) { }
+void set_modifiedobject(int type, void *obj) { (void)type; (void)obj; }
+void update_layers(void) { }
+
+static F_point *
+point_list(int n, const int *xy)
+{
+	F_point	*first = NULL, *p;
+
+	while (n-- > 0) {
+		if ((p = create_point()) == NULL)
+			exit(1);
+		p->x = xy[2 * n];
+		p->y = xy[2 * n + 1];
+		p->next = first;
+		first = p;
+	}
+	return first;
+}
+
+static F_line *
+make_line(int n, const int *xy)
+{
+	F_line	*l;
+
+	if ((l = create_line()) == NULL)
+		exit(1);
+	memset(l, 0, sizeof(F_line));
+	l->type = T_POLYLINE;
+	l->thickness = 1;
+	l->depth = 50;
+	l->points = point_list(n, xy);
+	add_depth(O_POLYLINE, l->depth);
+	return l;
+}
+
+/* return 0, if the points of l are at xy */
+static int
+compare_points(F_line *l, const int *xy)
+{
+	F_point	*p;
+	int	n = 0;
+
+	for (p = l->points; p != NULL; p = p->next, xy += 2)
+		n += p->x != xy[0] || p->y != xy[1];
+	return n;
+}
+
+static int
+check(int failed, const char *what)
+{
+	if (failed)
+		fprintf(stderr, "%s\n", what);
+	return failed;
+}
+
+static int
+undo_twice(void)
+{
+	int	status = 0;
+
+	message[0] = '\0';
+	undo();
+	status |= check(strcmp(message, "Undo complete"),
+			"The edit was not undone.");
+	message[0] = '\0';
+	undo();
+	status |= check(strcmp(message, "Undo complete"),
+			"The action before the edit was not undone.");
+	return status;
+}
+
+static int
+redo_twice(void)
+{
+	int	status = 0;
+
+	message[0] = '\0';
+	redo();
+	status |= check(strcmp(message, "Redo complete"),
+			"The action before the edit was not redone.");
+	message[0] = '\0';
+	redo();
+	status |= check(strcmp(message, "Redo complete"),
+			"The edit was not redone.");
+	return status;
+}
+
+/* move a point of a line, edit the line, undo and redo */
+static int
+check_line(void)
+{
+	static const int	start[] = {0, 0, 1000, 0, 1000, 1000};
+	static const int	moved[] = {0, 0, 2000, 500, 1000, 1000};
+	static const int	edited[] = {0, 0, 2000, 500, 1500, 1000};
+	F_line		*l, *old_l;
+	F_point		*p;
+	int		status = 0;
+
+	l = make_line(3, start);
+	objects.lines = l;
+
+	/* move the second point, see fix_movedlinepoint() */
+	p = l->points->next;
+	clean_up();
+	set_latestline(l);
+	set_last_prevpoint(l->points);
+	set_last_selectedpoint(p);
+	set_lastposition(p->x, p->y);
+	set_newposition(2000, 500);
+	set_action_object(F_MOVE_POINT, O_POLYLINE);
+	p->x = 2000;
+	p->y = 500;
+
+	/* edit the line, see make_window_line() and done_line() */
+	old_l = copy_line(l);
+	l->thickness = 3;
+	l->points->next->next->x = 1500;
+	clean_up();
+	old_l->next = l;
+	set_latestline(old_l);
+	set_action_object(F_EDIT, O_POLYLINE);
+
+	status |= undo_twice();
+	status |= check(objects.lines != l || l->points->next != p,
+			"The line is not the one in the figure.");
+	status |= check(l->thickness != 1 || compare_points(l, start),
+			"Undo did not restore the line.");
+
+	status |= redo_twice();
+	status |= check(l->points->next != p,
+			"The line lost its points.");
+	status |= check(l->thickness != 3 || compare_points(l, edited),
+			"Redo did not repeat the edit.");
+
+	/* and undo only the edit */
+	undo();
+	status |= check(l->thickness != 1 || compare_points(l, moved),
+			"Undo did not restore the moved point.");
+	return status;
+}
+
+/* align the objects of a compound, edit the compound, undo and redo */
+static int
+check_compound(void)
+{
+	static const int	start[] = {0, 3000, 1000, 3000};
+	static const int	aligned[] = {300, 3000, 1300, 3000};
+	static const int	edited[] = {300, 4000, 1300, 4000};
+	F_compound	*c, *old_c;
+	F_line		*m;
+	int		status = 0;
+
+	if ((c = create_compound()) == NULL)
+		exit(1);
+	memset(c, 0, sizeof(F_compound));
+	m = make_line(2, start);
+	c->lines = m;
+	c->lines->next = make_line(2, start);
+	objects.compounds = c;
+
+	/* align, see align_ok() */
+	save_positions(c);
+	translate_line(m, 300, 0);
+	clean_up();
+	set_latestcompound(c);
+	set_latestshifts();
+	set_action_object(F_ALIGN, O_COMPOUND);
+
+	/* edit, see make_window_compound() and done_compound() */
+	old_c = copy_compound(c);
+	translate_compound(c, 0, 1000);
+	clean_up();
+	old_c->next = c;
+	set_latestcompound(old_c);
+	set_action_object(F_EDIT, O_COMPOUND);
+
+	status |= undo_twice();
+	status |= check(objects.compounds != c || c->lines != m,
+			"The compound lost the objects within.");
+	status |= check(compare_points(m, start),
+			"Undo did not restore the objects within.");
+
+	status |= redo_twice();
+	status |= check(c->lines != m, "The compound lost its objects.");
+	status |= check(compare_points(m, edited),
+			"Redo did not repeat the edit.");
+
+	undo();
+	status |= check(compare_points(m, aligned),
+			"Undo did not restore the alignment.");
+	return status;
+}
+
+/* place copies of l, see array_place_line() */
+static void
+array_place(F_line *l, int copies)
+{
+	F_line	*first = NULL, *new_l;
+	int	i;
+
+	clean_up();
+	tail(&objects, &object_tails);
+	begin_undo_group();
+	for (i = 1; i <= copies; ++i) {
+		new_l = copy_line(l);
+		translate_line(new_l, 0, 2000 * i);
+		add_line(new_l);
+		if (first == NULL)
+			first = new_l;
+	}
+	saved_objects.lines = first;
+	set_action_object(F_ADD, O_ALL_OBJECT);
+	end_undo_group();
+}
+
+/* place an array of copies twice, undo both */
+static int
+check_array(void)
+{
+	static const int	start[] = {0, 6000, 1000, 6000};
+	F_line		*l;
+	int		status = 0;
+
+	l = make_line(2, start);
+	clean_up();
+	objects.lines = l;
+	array_place(l, 2);
+	array_place(l, 3);
+
+	status |= undo_twice();
+	status |= check(objects.lines != l || l->next != NULL,
+			"Undo did not remove the copies.");
+	return status;
+}
+
+int
+main(void)
+{
+	int	status = 0;
+
+	appres.undo_memory = DEF_UNDO_MEMORY;
+	if (check_line())
+		status = 1;
+	if (check_compound())
+		status = 1;
+	if (check_array())
+		status = 1;
+	return status;
+}